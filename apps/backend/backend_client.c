@@ -96,7 +96,7 @@ ce_find_byid(struct client_entry *ce_list,
  * @retval     0    OK 
  * @retval    -1    Error
  */
-static int
+int
 ce_client_descr(struct client_entry *ce,
                 cbuf               **cbp)
 {
@@ -355,6 +355,8 @@ backend_client_rm(clixon_handle        h,
     for (c = *ce_prev; c; c = c->ce_next){
         if (c == ce){
             if (ce->ce_s){
+                get_worker_stop(h, ce, 1);
+                get_statedata_async_stop(h, ce);
                 clixon_event_unreg_fd(ce->ce_s, from_client);
                 close(ce->ce_s);
                 ce->ce_s = 0;
@@ -370,6 +372,24 @@ backend_client_rm(clixon_handle        h,
     return retval;
 }
 
+/*! Count nodes marked in commit journal
+ *
+ * @param[in]     x    XML node
+ * @param[in,out] arg  Number of marked nodes
+ * @retval        0    OK
+ * @see xmldb_journal_get
+ */
+static int
+clixon_stats_journal_count(cxobj *x,
+                           void  *arg)
+{
+    uint64_t *nr = (uint64_t *)arg;
+
+    if (xml_flag(x, XML_FLAG_COMMIT_DIRTY))
+        (*nr)++;
+    return 0;
+}
+
 /*! Get clixon per datastore stats
  *
  * @param[in]     h       Clixon handle
@@ -387,6 +407,7 @@ clixon_stats_datastore_get(clixon_handle h,
     cxobj    *xt = NULL; /* should not be freed */
     uint64_t  nr = 0;
     size_t    sz = 0;
+    uint64_t  journal = 0;
     cxobj    *xn = NULL;
     int       ret;
 
@@ -404,9 +425,11 @@ clixon_stats_datastore_get(clixon_handle h,
     if (xt != NULL){
         if (xml_stats(xt, &nr, &sz) < 0)
             goto done;
+        if (xml_apply0(xt, CX_ELMNT, clixon_stats_journal_count, &journal) < 0)
+            goto done;
         cprintf(cb, "<datastore><name>%s</name><nr>%" PRIu64 "</nr>"
-                "<size>%zu</size></datastore>",
-                dbname, nr, sz);
+                "<size>%zu</size><journal>%" PRIu64 "</journal></datastore>",
+                dbname, nr, sz, journal);
     }
  ok:
     retval = 0;
@@ -1198,6 +1221,7 @@ from_client_create_subscription(clixon_handle h,
                       starttime?&start:NULL, stoptime?&stop:NULL,
                       ce_event_cb, (void*)ce) < 0)
         goto done;
+    ce->ce_notify++;
     /* Replay of this stream to specific subscription according to start and
      * stop (if present). 
      * RFC 5277: If <startTime> is not present, this is not a replay
@@ -1419,6 +1443,10 @@ from_client_stats(clixon_handle h,
 {
     int        retval = -1;
     uint64_t   nr;
+    uint64_t   misses;
+    uint32_t   inr;
+    uint64_t   lnr;
+    uint64_t   pruned;
     yang_stmt *ym;
     char      *str;
     int        modules = 0;
@@ -1440,6 +1468,70 @@ from_client_stats(clixon_handle h,
     yang_stats_global(&nr);
     cprintf(cbret, "<yangnr>%" PRIu64 "</yangnr>", nr);
     cprintf(cbret, "</global>");
+    nr = misses = 0;
+    inr = 0;
+    xpath_index_stats(&nr, &misses, &inr);
+    cprintf(cbret, "<xpath-index xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", nr);
+    cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cbret, "<indexes>%u</indexes>", inr);
+    cprintf(cbret, "</xpath-index>");
+    nr = misses = 0;
+    xpath_list_optimize_stats(&nr, &misses);
+    cprintf(cbret, "<xpath-optimize xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", nr);
+    cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cbret, "</xpath-optimize>");
+    nr = misses = 0;
+    inr = 0;
+    xpath_cache_stats(&nr, &misses, &inr);
+    cprintf(cbret, "<xpath-cache xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", nr);
+    cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cbret, "<entries>%u</entries>", inr);
+    cprintf(cbret, "</xpath-cache>");
+    nr = misses = lnr = 0;
+    validate_leafref_stats(&lnr, &nr, &misses);
+    cprintf(cbret, "<leafref-index xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<builds>%" PRIu64 "</builds>", lnr);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", nr);
+    cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cbret, "</leafref-index>");
+    nr = misses = 0;
+    validate_xpath_stats(&nr, &misses);
+    cprintf(cbret, "<constraints xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<evaluated>%" PRIu64 "</evaluated>", nr);
+    cprintf(cbret, "<skipped>%" PRIu64 "</skipped>", misses);
+    cprintf(cbret, "</constraints>");
+    nr = misses = 0;
+    clixon_plugin_statedata_stats(&nr, &misses);
+    cprintf(cbret, "<state-callbacks xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<calls>%" PRIu64 "</calls>", nr);
+    cprintf(cbret, "<skipped>%" PRIu64 "</skipped>", misses);
+    nr = misses = 0;
+    clixon_plugin_statedata_async_stats(&nr, &misses);
+    cprintf(cbret, "<async-calls>%" PRIu64 "</async-calls>", nr);
+    cprintf(cbret, "<async-timeouts>%" PRIu64 "</async-timeouts>", misses);
+    cprintf(cbret, "</state-callbacks>");
+    nr = misses = lnr = 0;
+    inr = 0;
+    clixon_plugin_statedata_cache_stats(&nr, &misses, &lnr, &inr);
+    cprintf(cbret, "<state-cache xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", nr);
+    cprintf(cbret, "<misses>%" PRIu64 "</misses>", misses);
+    cprintf(cbret, "<stale>%" PRIu64 "</stale>", lnr);
+    cprintf(cbret, "<entries>%u</entries>", inr);
+    cprintf(cbret, "</state-cache>");
+    nr = misses = lnr = pruned = 0;
+    inr = 0;
+    nacm_compiled_stats(&nr, &misses, &inr, &lnr, &pruned);
+    cprintf(cbret, "<nacm-compiled xmlns=\"%s\">", CLIXON_LIB_NS);
+    cprintf(cbret, "<compiles>%" PRIu64 "</compiles>", nr);
+    cprintf(cbret, "<hits>%" PRIu64 "</hits>", misses);
+    cprintf(cbret, "<users>%u</users>", inr);
+    cprintf(cbret, "<skipped>%" PRIu64 "</skipped>", lnr);
+    cprintf(cbret, "<pruned>%" PRIu64 "</pruned>", pruned);
+    cprintf(cbret, "</nacm-compiled>");
     cprintf(cbret, "<datastores xmlns=\"%s\">", CLIXON_LIB_NS);
     if (clixon_stats_datastore_get(h, "running", cbret) < 0)
         goto done;
@@ -1663,6 +1755,7 @@ from_client_msg(clixon_handle        h,
     char                *namespace = NULL;
     int                  nr = 0;
     cbuf                *cbce = NULL;
+    int                  streamerr = 0;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     yspec = clicon_dbspec_yang(h);
@@ -1840,7 +1933,18 @@ from_client_msg(clixon_handle        h,
             }
         }
         clixon_err_reset();
-        if ((ret = rpc_callback_call(h, xe, ce, &nr, cbret)) < 0){
+        ce->ce_reply = cbret;
+        ret = rpc_callback_call(h, xe, ce, &nr, cbret);
+        ce->ce_reply = NULL;
+        if (ret < 0){
+            if (clixon_msg_writer_streamed(ce->ce_writer)){
+                /* Part of reply already sent: cannot be replaced by error, end it and close */
+                clixon_log(h, LOG_WARNING, "%s Error in streamed reply of %s, closing session %u",
+                           __FUNCTION__, xml_name(xe), ce->ce_id);
+                cbuf_reset(cbret);
+                streamerr++;
+                goto reply;
+            }
             if (netconf_operation_failed(cbret, "application", clixon_err_reason())< 0)
                 goto done;
             clixon_log(h, LOG_NOTICE, "%s Error in rpc_callback_call:%s", __FUNCTION__, xml_name(xe));
@@ -1868,7 +1972,18 @@ from_client_msg(clixon_handle        h,
         }
     } /* while */
  reply:
-    if (cbuf_len(cbret) == 0)
+    if (ce->ce_worker) /* Reply is sent by read worker */
+        goto ok;
+    if (ce->ce_async && clixon_plugin_statedata_async_pending(ce->ce_async)){
+        /* Request is re-dispatched when asynchronous state callbacks are done, see get_statedata */
+        if ((ce->ce_async_msg = strdup(msg)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        goto ok;
+    }
+    if (cbuf_len(cbret) == 0 && !clixon_msg_writer_streamed(ce->ce_writer))
         if (netconf_operation_failed(cbret, "application",
                                      clixon_err_category()?clixon_err_reason():"unknown")< 0)
             goto done;
@@ -1877,7 +1992,7 @@ from_client_msg(clixon_handle        h,
        parse errors */
     if (ce_client_descr(ce, &cbce) < 0)
         goto done;
-    if (send_msg_reply(ce->ce_s, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
+    if (clixon_msg_writer_end(ce->ce_writer, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0){
         switch (errno){
         case EPIPE:
             /* man (2) write: 
@@ -1894,7 +2009,9 @@ from_client_msg(clixon_handle        h,
             goto done;
         }
     }
-    // ok:
+    if (streamerr)
+        shutdown(ce->ce_s, SHUT_RDWR);
+ ok:
     retval = 0;
   done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
@@ -1919,6 +2036,67 @@ from_client_msg(clixon_handle        h,
     return retval;// -1 here terminates backend
 }
 
+/*! Handle requests in input buffer of a client
+ *
+ * A client may send several requests without waiting for replies.
+ * Stop if the client is removed, a request is served by a read worker, or if the client does
+ * not read its replies.
+ * @param[in]   h    Clixon handle
+ * @param[in]   ce   Client entry
+ * @param[in]   rd   If set, read from socket if no complete request is buffered
+ * @retval      0    OK
+ * @retval     -1    Error
+ */
+static int
+from_client_input(clixon_handle        h,
+                  struct client_entry *ce,
+                  int                  rd)
+{
+    int                  retval = -1;
+    struct client_entry *c;
+    int                  s = ce->ce_s;
+    int                  eof = 0;
+    cbuf                *cbce = NULL;
+    cbuf                *cb = NULL;
+
+    if (ce_client_descr(ce, &cbce) < 0)
+        goto done;
+    if (rd){
+        if (clixon_msg_reader_rcv(ce->ce_reader, cbuf_get(cbce), &cb, &eof) < 0)
+            goto done;
+    }
+    else if (clixon_msg_reader_next(ce->ce_reader, cbuf_get(cbce), &cb, &eof) < 0)
+        goto done;
+    while (cb != NULL){
+        if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
+            goto done;
+        cbuf_free(cb);
+        cb = NULL;
+        /* Client may have been removed by the request */
+        for (c = backend_client_list(h); c && c != ce; c = c->ce_next);
+        if (c == NULL || ce->ce_s != s)
+            goto ok;
+        /* Remaining requests are handled when worker exits or asynchronous state callbacks
+         * are done, or when output is drained, see from_client_resume */
+        if (ce->ce_worker || ce->ce_async_msg || clixon_msg_writer_full(ce->ce_writer))
+            goto ok;
+        if (clixon_msg_reader_next(ce->ce_reader, cbuf_get(cbce), &cb, &eof) < 0)
+            goto done;
+    }
+    if (eof){
+        backend_client_rm(h, ce);
+        netconf_monitoring_counter_inc(h, "dropped-sessions");
+    }
+ ok:
+    retval = 0;
+  done:
+    if (cb)
+        cbuf_free(cb);
+    if (cbce)
+        cbuf_free(cbce);
+    return retval;
+}
+
 /*! Internal clixon message has arrived from a client. Receive and dispatch.
  *
  * Internal clixon is NETCONF 1.1 chunked encoding
@@ -1935,35 +2113,98 @@ from_client(int   s,
     int                  retval = -1;
     struct client_entry *ce = (struct client_entry *)arg;
     clixon_handle        h = ce->ce_handle;
-    int                  eof = 0;
-    cbuf                *cbce = NULL;
-    cbuf                *cb = NULL;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
     if (s != ce->ce_s){
         clixon_err(OE_NETCONF, EINVAL, "Internal error: s != ce->ce_s");
         goto done;
     }
-    if (ce_client_descr(ce, &cbce) < 0)
-        goto done;
-    if (clixon_msg_rcv11(s, cbuf_get(cbce), 0, &cb, &eof) < 0) /* XXX why not descr here? */
-        goto done;
-    if (eof){
-        backend_client_rm(h, ce);
-        netconf_monitoring_counter_inc(h, "dropped-sessions");
-    }
-    else if (from_client_msg(h, ce, cbuf_get(cb)) < 0)
+    if (from_client_input(h, ce, 1) < 0)
         goto done;
     retval = 0;
   done:
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "retval:%d", retval);
-    if (cb)
-        cbuf_free(cb);
-    if (cbce)
-        cbuf_free(cbce);
     return retval; /* -1 here terminates backend */
 }
 
+/*! Stop and resume reading requests from a client depending on its output queue
+ *
+ * Instead of blocking on a client that does not read its replies, no more requests are read
+ * from it until the queued replies are sent.
+ * @param[in]   mw    Message writer of client
+ * @param[in]   full  1: queue is full, 0: queue is drained
+ * @param[in]   arg   Client entry
+ * @retval      0     OK
+ * @retval     -1     Error
+ * @see clixon_msg_writer_backpressure
+ */
+int
+from_client_backpressure(clixon_msg_writer *mw,
+                         int                full,
+                         void              *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    clixon_handle        h = ce->ce_handle;
+
+    if (full){
+        clixon_event_unreg_fd(ce->ce_s, from_client);
+        return 0;
+    }
+    /* Else resumed when worker or asynchronous state callbacks are done */
+    if (ce->ce_worker || ce->ce_async_msg)
+        return 0;
+    return from_client_resume(h, ce);
+}
+
+/*! Resume client session after its request has been served by a read worker
+ *
+ * Or after the asynchronous state callbacks of its get request are done, then the request is
+ * re-dispatched and merges the state of the callbacks.
+ * Or after its queued replies are sent.
+ * Handle requests received while the worker was running, then wait for more input
+ * @param[in]   h    Clixon handle
+ * @param[in]   ce   Client entry
+ * @retval      0    OK
+ * @retval     -1    Error
+ * @see get_worker
+ * @see get_statedata_async_done
+ */
+int
+from_client_resume(clixon_handle        h,
+                   struct client_entry *ce)
+{
+    int                  retval = -1;
+    char                *msg;
+    struct client_entry *c;
+
+    if ((msg = ce->ce_async_msg) != NULL){
+        ce->ce_async_msg = NULL;
+        if (from_client_msg(h, ce, msg) < 0)
+            goto done;
+        /* Client may have been removed */
+        for (c = backend_client_list(h); c && c != ce; c = c->ce_next);
+        if (c == NULL)
+            goto ok;
+        /* Request failed before merging the state */
+        if (ce->ce_async_msg == NULL)
+            get_statedata_async_stop(h, ce);
+    }
+    /* Client does not read its replies, resumed by from_client_backpressure */
+    if (ce->ce_worker || ce->ce_async_msg || clixon_msg_writer_full(ce->ce_writer))
+        goto ok;
+    if (clixon_event_reg_fd_prio(ce->ce_s, from_client, (void*)ce, "local netconf client socket",
+                                 clicon_option_bool(h, "CLICON_SOCK_PRIO")) < 0)
+        goto done;
+    if (from_client_input(h, ce, 0) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    return retval;
+}
+
 /*! Init backend rpc: Set up standard netconf rpc callbacks
  *
  * @param[in]  h     Clixon handle
@@ -42,7 +42,10 @@
  */
 int backend_monitoring_state_get(clixon_handle h, yang_stmt *yspec, char *xpath, cvec *nsc, cxobj **xret, cxobj **xerr);
 int backend_client_rm(clixon_handle h, struct client_entry *ce);
+int ce_client_descr(struct client_entry *ce, cbuf **cbp);
 int from_client(int fd, void *arg);
+int from_client_backpressure(clixon_msg_writer *mw, int full, void *arg);
+int from_client_resume(clixon_handle h, struct client_entry *ce);
 int backend_rpc_init(clixon_handle h);
 
 #endif  /* _BACKEND_CLIENT_H_ */
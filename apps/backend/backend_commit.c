@@ -101,8 +101,16 @@ generic_validate(clixon_handle       h,
     int        ret;
     cbuf      *cb = NULL;
 
-    /* All entries */
-    if ((ret = xml_yang_validate_all_top(h, td->td_target, xret)) < 0)
+    /* All entries, with must/when of unchanged entries only if affected by the diff */
+    if (clicon_option_bool(h, "CLICON_VALIDATE_INCREMENTAL"))
+        ret = xml_yang_validate_all_diff(h, td->td_target,
+                                         td->td_dvec, td->td_dlen,
+                                         td->td_avec, td->td_alen,
+                                         td->td_tcvec, td->td_clen,
+                                         xret);
+    else
+        ret = xml_yang_validate_all_top(h, td->td_target, xret);
+    if (ret < 0)
         goto done;
     if (ret == 0)
         goto fail;
@@ -498,7 +506,9 @@ validate_common(clixon_handle       h,
     if (xmldb_cache_get(h, db) != NULL){
         if (xmldb_populate(h, db) < 0)
             goto done;
-        if (xmldb_write_cache2file(h, db) < 0)
+        /* With write-ahead log, datastore file and log are already in sync with cache */
+        if (!clicon_option_bool(h, "CLICON_XMLDB_WAL") &&
+            xmldb_write_cache2file(h, db) < 0)
             goto done;
     }
     /* This is the state we are going to */
@@ -518,16 +528,19 @@ validate_common(clixon_handle       h,
     /* Clear flags xpath for get */
     xml_apply0(td->td_src, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
                (void*)(XML_FLAG_MARK|XML_FLAG_CHANGE));
-    /* 3. Compute differences */
-    if (xml_diff(td->td_src,
-                 td->td_target,
-                 &td->td_dvec,      /* removed: only in running */
-                 &td->td_dlen,
-                 &td->td_avec,      /* added: only in candidate */
-                 &td->td_alen,
-                 &td->td_scvec,     /* changed: original values */
-                 &td->td_tcvec,     /* changed: wanted values */
-                 &td->td_clen) < 0)
+    /* 3. Compute differences 
+     * If the commit journal is valid, only marked subtrees of the target differ from running
+     */
+    if (xml_diff_flagged(td->td_src,
+                         td->td_target,
+                         xmldb_journal_get(h, db) ? XML_FLAG_COMMIT_DIRTY : 0x0,
+                         &td->td_dvec,      /* removed: only in running */
+                         &td->td_dlen,
+                         &td->td_avec,      /* added: only in candidate */
+                         &td->td_alen,
+                         &td->td_scvec,     /* changed: original values */
+                         &td->td_tcvec,     /* changed: wanted values */
+                         &td->td_clen) < 0)
         goto done;
     if (clixon_debug_get() & CLIXON_DBG_DETAIL)
         transaction_dbg(h, CLIXON_DBG_DETAIL, td, __FUNCTION__);
@@ -52,6 +52,7 @@
 #include <syslog.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <sys/types.h>
@@ -173,12 +174,54 @@ client_get_streams(clixon_handle   h,
     goto done;
 }
 
+/*! Asynchronous state data callbacks of a get request are done, or the deadline has passed
+ *
+ * Re-dispatch the request, which merges the state of the callbacks, see get_statedata
+ * @param[in]  h      Clixon handle
+ * @param[in]  arg    Client entry
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+get_statedata_async_done(clixon_handle h,
+                         void         *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+
+    return from_client_resume(h, ce);
+}
+
+/*! Stop waiting for asynchronous state data callbacks of a client session
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @retval     0       OK
+ */
+int
+get_statedata_async_stop(clixon_handle        h,
+                         struct client_entry *ce)
+{
+    if (ce->ce_async){
+        clixon_plugin_statedata_async_free(h, ce->ce_async);
+        ce->ce_async = NULL;
+    }
+    if (ce->ce_async_msg){
+        free(ce->ce_async_msg);
+        ce->ce_async_msg = NULL;
+    }
+    return 0;
+}
+
 /*! Get system state-data, including streams and plugins
  *
+ * Asynchronous state callbacks are started first. If they are pending, the request is
+ * suspended and re-dispatched when they are done, then their state is merged.
  * @param[in]     h       Clixon handle
+ * @param[in]     ce      Client entry, or NULL. Asynchronous callbacks only for client requests
  * @param[in]     xpath   XPath selection, may be used to filter early
  * @param[in]     nsc     XML Namespace context for xpath
  * @param[in,out] xret    Existing XML tree, merge x into this, or rpc-error
+ * @retval        2       Asynchronous state callbacks pending, no reply
  * @retval        1       OK
  * @retval        0       Statedata callback failed (error in xret)
  * @retval       -1       Error (fatal)
@@ -194,24 +237,41 @@ client_get_streams(clixon_handle   h,
  * message. But this needs to be explored in all sub-functions
  */
 static int
-get_statedata(clixon_handle     h,
-              char             *xpath,
-              cvec             *nsc,
-              cxobj           **xret)
+get_statedata(clixon_handle        h,
+              struct client_entry *ce,
+              char                *xpath,
+              cvec                *nsc,
+              cxobj              **xret)
 {
-    int        retval = -1;
-    yang_stmt *yspec;
-    yang_stmt *ymod;
-    cxobj     *x1 = NULL;
-    int        ret;
-    cbuf      *cb = NULL;
-    cxobj     *xerr = NULL;
-    
+    int                     retval = -1;
+    yang_stmt              *yspec;
+    yang_stmt              *ymod;
+    cxobj                  *x1 = NULL;
+    int                     ret;
+    cbuf                   *cb = NULL;
+    cxobj                  *xerr = NULL;
+    struct statedata_async *sa = NULL;
+
     clixon_debug(CLIXON_DBG_BACKEND, "");
     if ((yspec = clicon_dbspec_yang(h)) == NULL){
         clixon_err(OE_YANG, ENOENT, "No yang spec");
         goto done;
     }
+    if (ce != NULL && ce->ce_async != NULL){ /* Re-dispatched, asynchronous callbacks done */
+        sa = ce->ce_async;
+        ce->ce_async = NULL;
+    }
+    else if (ce != NULL && ce->ce_reply != NULL){
+        if ((ret = clixon_plugin_statedata_async_start(h, yspec, nsc, xpath,
+                                                       get_statedata_async_done, ce, &sa)) < 0)
+            goto done;
+        if (ret == 1){
+            ce->ce_async = sa;
+            sa = NULL;
+            retval = 2;
+            goto done;
+        }
+    }
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -310,9 +370,17 @@ get_statedata(clixon_handle     h,
         goto done;
     if (ret == 0)
         goto fail;
+    if (sa != NULL){
+        if ((ret = clixon_plugin_statedata_async_merge(sa, yspec, xret)) < 0)
+            goto done;
+        if (ret == 0)
+            goto fail;
+    }
     retval = 1; /* OK */
  done:
     clixon_debug(CLIXON_DBG_BACKEND, "retval:%d", retval);
+    if (sa)
+        clixon_plugin_statedata_async_free(h, sa);
     if (xerr)
         xml_free(xerr);
     if (x1)
@@ -391,9 +459,11 @@ filter_xpath_again(clixon_handle h,
  * @param[in]  username User name for NACM access
  * @param[in]  depth    Nr of levels to print, -1 is all, 0 is none
  * @param[in]  wdef     With-defaults parameter
+ * @param[in]  ce       Client entry, stream reply to client while serialized if cbret is its reply
  * @param[out] cbret    Return xml tree, eg <rpc-reply>..., <rpc-error.. 
  * @retval     0        OK
  * @retval    -1        Error
+ * @see clixon_msg_writer_start
  */
 static int
 get_nacm_and_reply(clixon_handle        h,
@@ -405,10 +475,12 @@ get_nacm_and_reply(clixon_handle        h,
                    char                *username,
                    int32_t              depth,
                    withdefaults_type    wdef,
+                   struct client_entry *ce,
                    cbuf                *cbret)
 {
     int     retval = -1;
     cxobj  *xnacm = NULL;
+    int     stream = 0;
 
     /* Pre-NACM access step */
     xnacm = clicon_nacm_cache(h);
@@ -423,6 +495,11 @@ get_nacm_and_reply(clixon_handle        h,
     else{
         if (xml_name_set(xret, NETCONF_OUTPUT_DATA) < 0)
             goto done;
+        if (ce && ce->ce_writer && ce->ce_reply == cbret){
+            if (clixon_msg_writer_start(ce->ce_writer, cbret) < 0)
+                goto done;
+            stream++;
+        }
         /* Top level is data, so add 1 to depth if significant */
         if (clixon_xml2cbuf1(cbret, xret, 0, 0, NULL, depth>0?depth+1:depth, 0, wdef) < 0)
             goto done;
@@ -430,6 +507,8 @@ get_nacm_and_reply(clixon_handle        h,
     cprintf(cbret, "</rpc-reply>");
     retval = 0;
  done:
+    if (stream)
+        clixon_msg_writer_stop(ce->ce_writer);
     return retval;
 }
 
@@ -576,6 +655,104 @@ get_pagination_partial(clixon_handle        h,
     goto done;
 }
 
+/*! Split a list-pagination xpath into the xpath of the list parent and the list step
+ *
+ * Only plain location paths where the last step has no predicates are split,
+ * eg /a/b[k='1']/c gives parent /a/b[k='1']
+ * @param[in]  xpath    XPath of list or leaf-list
+ * @param[out] xparent  XPath of parent, or NULL if list is top-level. Free with free()
+ * @retval     1        OK, xparent set
+ * @retval     0        XPath is not a plain location path
+ * @retval    -1        Error
+ */
+static int
+list_pagination_parent(char  *xpath,
+                       char **xparent)
+{
+    char *p;
+    char *slash = NULL;
+    char  quote = 0;
+    int   depth = 0;
+
+    *xparent = NULL;
+    if (xpath == NULL || *xpath != '/')
+        return 0;
+    for (p = xpath; *p; p++){
+        if (quote){
+            if (*p == quote)
+                quote = 0;
+            continue;
+        }
+        switch (*p){
+        case '\'':
+        case '"':
+            quote = *p;
+            break;
+        case '[':
+            depth++;
+            break;
+        case ']':
+            depth--;
+            break;
+        case '|':
+        case '(':
+        case ' ':
+            if (depth == 0)
+                return 0;
+            break;
+        case '/':
+            if (depth == 0){
+                if (p[1] == '/') /* descendant-or-self */
+                    return 0;
+                slash = p;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    /* Last step: no predicates and not "." or ".." */
+    if (slash == NULL || strchr(slash, '[') != NULL || slash[1] == '.' || slash[1] == '\0')
+        return 0;
+    if (slash != xpath &&
+        (*xparent = strndup(xpath, slash - xpath)) == NULL){
+        clixon_err(OE_UNIX, errno, "strndup");
+        return -1;
+    }
+    return 1;
+}
+
+/*! Reverse the order of element children, callback of xml_childvec_apply
+ *
+ * Other children, eg attributes, are kept in place
+ * @param[in] vec      Vector of children
+ * @param[in] len      Length of vec
+ * @param[in] arg      Not used
+ * @retval    0        OK
+ */
+static int
+list_pagination_reverse(cxobj **vec,
+                        int     len,
+                        void   *arg)
+{
+    cxobj *x;
+    int    i = 0;
+    int    j = len-1;
+
+    while (i < j){
+        if (xml_type(vec[i]) != CX_ELMNT)
+            i++;
+        else if (xml_type(vec[j]) != CX_ELMNT)
+            j--;
+        else {
+            x = vec[i];
+            vec[i++] = vec[j];
+            vec[j--] = x;
+        }
+    }
+    return 0;
+}
+
 /*! Specialized get for list-pagination
  *
  * It is specialized enough to have its own function. Specifically, extra attributes as well
@@ -632,14 +809,14 @@ get_list_pagination(clixon_handle        h,
     cxobj    **xvec = NULL;
     size_t     xlen;
     cxobj     *x;
-    cxobj     *xj;
     cxobj     *xp;
     char      *sort_by = NULL;
     char      *direction = NULL;
     char      *where = NULL;
+    char      *xparent = NULL;
+    uint32_t   nr;
     int        extflag = 0;
     int        i;
-    int        j;
     int        ret;
 #ifdef LIST_PAGINATION_REMAINING
     cxobj     *xcache;
@@ -723,6 +900,18 @@ get_list_pagination(clixon_handle        h,
         goto done;
     if (ret == 0)
         goto ok;
+    /* Config list without where: copy only the window from the datastore cache */
+    if (content == CONTENT_CONFIG && where == NULL){
+        if ((ret = list_pagination_parent(xpath, &xparent)) < 0)
+            goto done;
+        if (ret == 1){
+            if ((ret = xmldb_get_window(h, db, nsc, xparent, ylist, sort_by, direction != NULL,
+                                        offset, limit, wdef, &xret, &nr)) < 0)
+                goto done;
+            if (ret == 1)
+                goto reply;
+        }
+    }
     /* Read config */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
@@ -756,8 +945,10 @@ get_list_pagination(clixon_handle        h,
     case CONTENT_NONCONFIG: /* state data only */
         if (partial_pagination_cb) /* Partial reads, special handling */
             break;
-        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, &xret)) < 0)
+        if ((ret = get_statedata(h, ce, xpath?xpath:"/", nsc, &xret)) < 0)
             goto done;
+        if (ret == 2) /* Reply when asynchronous state callbacks are done */
+            goto ok;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
                 goto done;
@@ -804,23 +995,8 @@ get_list_pagination(clixon_handle        h,
         if (direction &&
             (x = xpath_first(xret, nsc, "%s", xpath?xpath:"/")) != NULL &&
             (xp = xml_parent(x)) != NULL &&
-            (xvec = xml_childvec_get(xp)) != NULL){
-            j = xml_child_nr(xp);
-            for (i=0; i<j; i++){
-                x = xvec[i];
-                if (xml_type(x) != CX_ELMNT)
-                    continue;
-                j--;
-                for (; j>i; j--){
-                    xj = xvec[j];
-                    if (xml_type(xj) == CX_ELMNT){
-                        xvec[j] = x;
-                        xvec[i] = xj;
-                    }
-                    break;
-                }
-            }
-        }
+            xml_childvec_apply(xp, list_pagination_reverse, NULL) < 0)
+            goto done;
         /* the "offset" parameter (see Section 3.1.5)
            lastly "the "limit" parameter (see Section 3.1.7) */
         if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
@@ -858,6 +1034,7 @@ get_list_pagination(clixon_handle        h,
         }
 #endif
     }
+ reply:
     if (xpath_vec(xret, nsc, "%s", &xvec, &xlen, xpath?xpath:"/") < 0)
         goto done;
     /* Help function to filter out anything that is outside of xpath */
@@ -883,13 +1060,15 @@ get_list_pagination(clixon_handle        h,
             cbuf_free(cba);
     }
 #endif /* LIST_PAGINATION_REMAINING */
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, ce, cbret) < 0)
         goto done;
  ok:
     retval = 0;
  done:
     if (xvec)
         free(xvec);
+    if (xparent)
+        free(xparent);
     if (cbmsg)
         cbuf_free(cbmsg);
     if (xerr)
@@ -944,6 +1123,10 @@ get_common(clixon_handle        h,
     cxobj            *xlpg2 = NULL;
     withdefaults_type wdef;
     char             *wdefstr;
+#ifdef XML_ARENA_GET
+    xml_arena        *xa = NULL;
+    xml_arena        *xa0 = NULL;
+#endif
 
     wdef = WITHDEFAULTS_EXPLICIT;
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
@@ -1009,6 +1192,12 @@ get_common(clixon_handle        h,
             goto ok;
         }
     }
+#ifdef XML_ARENA_GET
+    /* The reply tree is transient: allocate the copy of the datastore in an arena */
+    if ((xa = xml_arena_new()) == NULL)
+        goto done;
+    xa0 = xml_arena_set(xa);
+#endif
     /* Read configuration */
     switch (content){
     case CONTENT_CONFIG:    /* config data only */
@@ -1072,6 +1261,10 @@ get_common(clixon_handle        h,
             goto done;
         break;
     }/* switch content */
+#ifdef XML_ARENA_GET
+    /* State data and other nodes not created in arena, but in arena tree if added to it */
+    xml_arena_set(xa0);
+#endif
     /* If not only config,
      * get state data from plugins as defined by plugin_statedata(), if any 
      */
@@ -1081,8 +1274,10 @@ get_common(clixon_handle        h,
         break;
     case CONTENT_ALL:       /* both config and state */
     case CONTENT_NONCONFIG: /* state data only */
-        if ((ret = get_statedata(h, xpath?xpath:"/", nsc, &xret)) < 0)
+        if ((ret = get_statedata(h, ce, xpath?xpath:"/", nsc, &xret)) < 0)
             goto done;
+        if (ret == 2) /* Reply when asynchronous state callbacks are done */
+            goto ok;
         if (ret == 0){ /* Error from callback (error in xret) */
             if (clixon_xml2cbuf(cbret, xret, 0, 0, NULL, -1, 0) < 0)
                 goto done;
@@ -1135,7 +1330,7 @@ get_common(clixon_handle        h,
         goto done;
     if (filter_xpath_again(h, yspec, xret, xvec, xlen, xpath, nsc) < 0)
         goto done;
-    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, cbret) < 0)
+    if (get_nacm_and_reply(h, xret, xvec, xlen, xpath, nsc, username, depth, wdef, ce, cbret) < 0)
         goto done;
  ok:
     retval = 0;
@@ -1163,9 +1358,234 @@ get_common(clixon_handle        h,
         free(xpath);
     if (xpath01)
         free(xpath01);
+#ifdef XML_ARENA_GET
+    if (xa){ /* After xml_free of xret and xerr */
+        xml_arena_set(xa0);
+        xml_arena_free(xa);
+    }
+#endif
+    return retval;
+}
+
+/*! Number of running read workers, see CLICON_BACKEND_READ_WORKERS
+ */
+static uint32_t _get_workers = 0;
+
+/*! Check if a get request may be served by a read worker
+ *
+ * Only requests of the whole running datastore, where a worker is worth the cost of fork.
+ * The session must not have queued output or notifications that may interleave with the
+ * reply of the worker.
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[in]  db      Database name
+ * @param[in]  cbret   Return buffer
+ * @retval     1       Yes
+ * @retval     0       No
+ */
+static int
+get_worker_check(clixon_handle        h,
+                 struct client_entry *ce,
+                 cxobj               *xe,
+                 char                *db,
+                 cbuf                *cbret)
+{
+    int    max;
+    cxobj *xfilter;
+    char  *select;
+
+    if ((max = clicon_option_int(h, "CLICON_BACKEND_READ_WORKERS")) <= 0 ||
+        _get_workers >= (uint32_t)max)
+        return 0;
+    if (strcmp(db, "running") != 0)
+        return 0;
+    /* Only called from client session, not internally */
+    if (ce == NULL || ce->ce_reply != cbret || ce->ce_writer == NULL ||
+        ce->ce_notify || ce->ce_worker)
+        return 0;
+    if ((xfilter = xml_find(xe, "filter")) != NULL &&
+        ((select = xml_find_value(xfilter, "select")) == NULL || strcmp(select, "/") != 0))
+        return 0;
+    if (clixon_msg_writer_flush(ce->ce_writer) != 0)
+        return 0;
+    return 1;
+}
+
+/*! Serve get request in read worker process and send reply to client
+ *
+ * The reply is sent with blocking writes, the worker does not run the event loop
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[in]  content Get config/state/both
+ * @param[in]  db      Database name
+ * @param[in]  cbret   Return buffer
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+get_worker_run(clixon_handle        h,
+               struct client_entry *ce,
+               cxobj               *xe,
+               netconf_content      content,
+               char                *db,
+               cbuf                *cbret)
+{
+    int           retval = -1;
+    cbuf         *cbce = NULL;
+
+    if (clixon_msg_writer_blocking(ce->ce_writer) < 0)
+        goto done;
+    if (get_common(h, ce, xe, content, db, cbret) < 0){
+        if (clixon_msg_writer_streamed(ce->ce_writer)){
+            /* Part of reply already sent: end it and close, see from_client_msg */
+            shutdown(ce->ce_s, SHUT_RDWR);
+            goto done;
+        }
+        cbuf_reset(cbret);
+        if (netconf_operation_failed(cbret, "application", clixon_err_reason()) < 0)
+            goto done;
+    }
+    if (cbuf_len(cbret) == 0 && !clixon_msg_writer_streamed(ce->ce_writer))
+        if (netconf_operation_failed(cbret, "application", "unknown") < 0)
+            goto done;
+    if (ce_client_descr(ce, &cbce) < 0)
+        goto done;
+    if (clixon_msg_writer_end(ce->ce_writer, cbuf_get(cbce), cbuf_get(cbret), cbuf_len(cbret)+1) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbce)
+        cbuf_free(cbce);
     return retval;
 }
 
+static int get_worker_done(int fd, void *arg);
+
+/*! Stop waiting for read worker of a client session
+ *
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  force   Kill worker, eg if client is removed
+ * @retval     0       OK
+ */
+int
+get_worker_stop(clixon_handle        h,
+                struct client_entry *ce,
+                int                  force)
+{
+    int status = 0;
+
+    if (ce->ce_worker == 0)
+        return 0;
+    clixon_event_unreg_fd(ce->ce_worker_fd, get_worker_done);
+    close(ce->ce_worker_fd);
+    if (force)
+        kill(ce->ce_worker, SIGKILL);
+    while (waitpid(ce->ce_worker, &status, 0) < 0 && errno == EINTR)
+        ;
+    if (!force && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        clixon_log(h, LOG_WARNING, "%s: read worker %d of session %u failed",
+                   __FUNCTION__, ce->ce_worker, ce->ce_id);
+    ce->ce_worker = 0;
+    ce->ce_worker_fd = -1;
+    _get_workers--;
+    return 0;
+}
+
+/*! Read worker has exited, resume client session
+ *
+ * Nothing is written to the pipe, it reaches EOF when the worker exits
+ * @param[in]  fd    Read end of pipe from worker
+ * @param[in]  arg   Client entry
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+get_worker_done(int   fd,
+                void *arg)
+{
+    struct client_entry *ce = (struct client_entry *)arg;
+    clixon_handle        h = ce->ce_handle;
+    char                 buf[8];
+
+    if (read(fd, buf, sizeof(buf)) > 0)
+        return 0;
+    get_worker_stop(h, ce, 0);
+    return from_client_resume(h, ce);
+}
+
+/*! Serve get request in a forked read worker process
+ *
+ * The worker has a copy-on-write snapshot of the datastore cache, sends the reply directly
+ * to the client and exits. Meanwhile the backend serves other clients, but not further
+ * requests of this session, whose socket is unregistered until the worker has exited.
+ * Only config is read by workers. State data callbacks are called in the backend, since
+ * plugins may keep state, or use sockets shared with the backend.
+ * @param[in]  h       Clixon handle
+ * @param[in]  ce      Client entry
+ * @param[in]  xe      Request: <rpc><xn></rpc>
+ * @param[in]  content Get config/state/both
+ * @param[in]  db      Database name
+ * @param[in]  cbret   Return buffer, not used in backend if worker started
+ * @retval     1       Worker started, reply is sent by worker
+ * @retval     0       Not applicable, serve request in backend
+ * @retval    -1       Error
+ * @see CLICON_BACKEND_READ_WORKERS
+ */
+static int
+get_worker(clixon_handle        h,
+           struct client_entry *ce,
+           cxobj               *xe,
+           netconf_content      content,
+           char                *db,
+           cbuf                *cbret)
+{
+    int   retval = -1;
+    int   fd[2] = {-1, -1};
+    pid_t pid;
+
+    if (get_worker_check(h, ce, xe, db, cbret) == 0)
+        goto fail;
+    if (content != CONTENT_CONFIG)
+        goto fail;
+    if (pipe(fd) < 0){
+        clixon_err(OE_UNIX, errno, "pipe");
+        goto done;
+    }
+    if ((pid = fork()) < 0){
+        clixon_err(OE_UNIX, errno, "fork");
+        goto done;
+    }
+    if (pid == 0){ /* Worker */
+        close(fd[0]);
+        /* Drop event state of backend without modifying its epoll set, which is shared */
+        clixon_event_exit();
+        _exit(get_worker_run(h, ce, xe, content, db, cbret) < 0 ? 1 : 0);
+    }
+    close(fd[1]);
+    fd[1] = -1;
+    clixon_debug(CLIXON_DBG_BACKEND, "read worker %d of session %u", pid, ce->ce_id);
+    ce->ce_worker = pid;
+    ce->ce_worker_fd = fd[0];
+    fd[0] = -1;
+    _get_workers++;
+    clixon_event_unreg_fd(ce->ce_s, from_client);
+    if (clixon_event_reg_fd(ce->ce_worker_fd, get_worker_done, ce, "read worker") < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (fd[0] != -1)
+        close(fd[0]);
+    if (fd[1] != -1)
+        close(fd[1]);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
 /*! Retrieve all or part of a specified configuration.
  *
  * @param[in]  h       Clixon handle
@@ -1187,11 +1607,18 @@ from_client_get_config(clixon_handle h,
     int                  retval = -1;
     char                *db;
     struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
 
     if ((db = netconf_db_find(xe, "source")) == NULL){
         clixon_err(OE_XML, 0, "db not found");
         goto done;
     }
+    if ((ret = get_worker(h, ce, xe, CONTENT_CONFIG, db, cbret)) < 0)
+        goto done;
+    if (ret == 1){
+        retval = 0;
+        goto done;
+    }
     retval = get_common(h, ce, xe, CONTENT_CONFIG, db, cbret);
  done:
     return retval;
@@ -1219,9 +1646,14 @@ from_client_get(clixon_handle h,
     netconf_content      content = CONTENT_ALL;
     char                *attr;
     struct client_entry *ce = (struct client_entry *)arg;
+    int                  ret;
 
     /* Clixon extensions: content */
     if ((attr = xml_find_value(xe, "content")) != NULL)
         content = netconf_content_str2int(attr);
+    if ((ret = get_worker(h, ce, xe, content, "running", cbret)) < 0)
+        return -1;
+    if (ret == 1)
+        return 0;
     return get_common(h, ce, xe, content, "running", cbret);
 }
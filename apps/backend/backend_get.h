@@ -42,6 +42,8 @@
  */
 int from_client_get_config(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
 int from_client_get(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg);
+int get_worker_stop(clixon_handle h, struct client_entry *ce, int force);
+int get_statedata_async_stop(clixon_handle h, struct client_entry *ce);
 int from_client_get_pageable_list(clixon_handle h, cxobj *xe, cbuf *cbret, void *arg, void *regarg); /* XXX */
 
 #endif  /* _BACKEND_GET_H_ */
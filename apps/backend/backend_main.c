@@ -118,6 +118,7 @@ backend_terminate(clixon_handle h)
     clicon_data_cvec_del(h, "netconf-statistics");
     if ((x = clicon_nacm_ext(h)) != NULL)
         xml_free(x);
+    nacm_compiled_reset(h);
     if ((x = clicon_conf_xml(h)) != NULL)
         xml_free(x);
     confirmed_commit_free(h);
@@ -128,7 +129,9 @@ backend_terminate(clixon_handle h)
     clixon_process_delete_all(h); 
 
     xpath_optimize_exit();
+    xpath_cache_exit();
     clixon_pagination_free(h);
+    clixon_plugin_statedata_free(h);
     
     if (pidfile)
         unlink(pidfile);   
@@ -740,6 +743,8 @@ main(int    argc,
 
     if ((sz = clicon_option_int(h, "CLICON_LOG_STRING_LIMIT")) != 0)
         clixon_log_string_limit_set(sz);
+    if ((sz = clicon_option_int(h, "CLICON_XPATH_INDEX_THRESHOLD")) > 0)
+        xpath_index_threshold_set(sz);
     
 #ifndef HAVE_LIBXML2
     if (clicon_yang_regexp(h) ==  REGEXP_LIBXML2){
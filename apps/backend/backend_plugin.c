@@ -52,6 +52,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -321,6 +322,1062 @@ clixon_plugin_statedata_one(clixon_plugin_t *cp,
     goto done;
 }
 
+/*! Subtree registered for a state data callback
+ *
+ * @see clixon_plugin_statedata_register
+ */
+typedef struct {
+    qelem_t         sr_qelem;  /* List header */
+    plgstatedata_t *sr_fn;     /* State data callback */
+    cvec           *sr_steps;  /* Steps of subtree, name is namespace (or NULL), value is node name */
+    uint32_t        sr_ttl;    /* Time-to-live of cached state in ms, 0: not cached */
+} statedata_subtree_t;
+
+/*! Cached state of a plugin callback and requested xpath
+ *
+ * @see statedata_cache_get
+ */
+struct statedata_cache{
+    struct timeval sc_expire; /* Fresh until this time */
+    cxobj         *sc_xml;    /* Bound and sorted state tree, or NULL if no state */
+};
+
+/* State data callback statistics */
+static uint64_t _statedata_calls = 0;
+static uint64_t _statedata_skipped = 0;
+
+/* State cache statistics */
+static uint64_t _statedata_cache_hits = 0;
+static uint64_t _statedata_cache_misses = 0;
+static uint64_t _statedata_cache_stale = 0;
+static uint32_t _statedata_cache_entries = 0;
+
+/*! Get steps of an absolute location path
+ *
+ * @param[in]     xs     XPath parse tree of relative location path
+ * @param[in]     nsc    XPath namespace context
+ * @param[in]     steps  Steps, name is namespace (or NULL), value is node name
+ * @param[in,out] stop   Set if a step is not a child node name, further steps are ignored
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+statedata_steps_traverse(xpath_tree *xs,
+                         cvec       *nsc,
+                         cvec       *steps,
+                         int        *stop)
+{
+    xpath_tree *xn;
+    char       *ns;
+    cg_var     *cv;
+
+    if (*stop || xs == NULL)
+        return 0;
+    switch (xs->xs_type){
+    case XP_RELLOCPATH:
+        if (statedata_steps_traverse(xs->xs_c0, nsc, steps, stop) < 0)
+            return -1;
+        if (xs->xs_int == A_DESCENDANT_OR_SELF) /* "//" */
+            *stop = 1;
+        return statedata_steps_traverse(xs->xs_c1, nsc, steps, stop);
+    case XP_STEP:
+        if (xs->xs_int != A_CHILD ||
+            (xn = xs->xs_c0) == NULL ||
+            xn->xs_type != XP_NODE ||
+            xn->xs_s1 == NULL ||
+            strcmp(xn->xs_s1, "*") == 0)
+            break;
+        ns = xml_nsctx_get(nsc, xn->xs_s0);
+        if (xn->xs_s0 && ns == NULL)
+            break;
+        if ((cv = cvec_add(steps, CGV_STRING)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_add");
+            return -1;
+        }
+        if (ns && cv_name_set(cv, ns) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_name_set");
+            return -1;
+        }
+        if (cv_string_set(cv, xn->xs_s1) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_string_set");
+            return -1;
+        }
+        return 0;
+    default:
+        break;
+    }
+    *stop = 1;
+    return 0;
+}
+
+/*! Get leading child steps of an xpath if it is an absolute location path
+ *
+ * Steps after a wildcard, "//" or other axes are ignored, ie "/a:x/a:y//a:z" gives x and y.
+ * @param[in]  xpath  XPath
+ * @param[in]  nsc    XPath namespace context
+ * @param[out] stepsp Steps, or NULL if xpath is not an absolute location path. Free with cvec_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_xpath_steps(const char *xpath,
+                      cvec       *nsc,
+                      cvec      **stepsp)
+{
+    int         retval = -1;
+    xpath_tree *xptree = NULL;
+    xpath_tree *xs;
+    cvec       *steps = NULL;
+    int         stop = 0;
+
+    *stepsp = NULL;
+    if (xpath == NULL)
+        goto ok;
+    if (xpath_parse(xpath, &xptree) < 0)
+        goto done;
+    /* Skip single-child expression nodes down to the location path */
+    xs = xptree;
+    while (xs != NULL && xs->xs_type != XP_LOCPATH && xs->xs_c1 == NULL)
+        xs = xs->xs_c0;
+    if (xs == NULL || xs->xs_type != XP_LOCPATH ||
+        (xs = xs->xs_c0) == NULL || xs->xs_type != XP_ABSPATH || xs->xs_int != A_ROOT)
+        goto ok;
+    if ((steps = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (statedata_steps_traverse(xs->xs_c0, nsc, steps, &stop) < 0)
+        goto done;
+    *stepsp = steps;
+    steps = NULL;
+ ok:
+    retval = 0;
+ done:
+    if (steps)
+        cvec_free(steps);
+    if (xptree)
+        xpath_tree_free(xptree);
+    return retval;
+}
+
+/*! Check if two subtrees given by steps intersect, ie one is a prefix of the other
+ *
+ * @param[in]  steps0  Steps of subtree
+ * @param[in]  steps1  Steps of subtree
+ * @retval     1       Intersects
+ * @retval     0       Disjoint
+ */
+static int
+statedata_steps_intersect(cvec *steps0,
+                          cvec *steps1)
+{
+    int     i;
+    cg_var *cv0;
+    cg_var *cv1;
+
+    for (i=0; i<cvec_len(steps0) && i<cvec_len(steps1); i++){
+        cv0 = cvec_i(steps0, i);
+        cv1 = cvec_i(steps1, i);
+        if (strcmp(cv_string_get(cv0), cv_string_get(cv1)) != 0)
+            return 0;
+        if (cv_name_get(cv0) && cv_name_get(cv1) &&
+            strcmp(cv_name_get(cv0), cv_name_get(cv1)) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/*! Check if the state data callback of a plugin should be called for a request
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  cp     Plugin handle
+ * @param[in]  steps  Steps of requested xpath, or NULL if not an absolute location path
+ * @param[out] ttl    Smallest time-to-live of intersecting subtrees in ms, 0: not cached
+ * @retval     1      Call: a registered subtree intersects the request, or no subtree registered
+ * @retval     0      Do not call: no registered subtree intersects the request
+ */
+static int
+statedata_subtree_match(clixon_handle    h,
+                        clixon_plugin_t *cp,
+                        cvec            *steps,
+                        uint32_t        *ttl)
+{
+    plgstatedata_t      *fn;
+    statedata_subtree_t *srhead = NULL;
+    statedata_subtree_t *sr;
+    int                  registered = 0;
+    int                  match = 0;
+
+    *ttl = 0;
+    if ((fn = clixon_plugin_api_get(cp)->ca_statedata) == NULL)
+        return 1;
+    clicon_ptr_get(h, "statedata-subtrees", (void**)&srhead);
+    if ((sr = srhead) != NULL){
+        do {
+            if (sr->sr_fn == fn){
+                registered++;
+                if (steps == NULL || statedata_steps_intersect(steps, sr->sr_steps)){
+                    if (match == 0 || sr->sr_ttl < *ttl)
+                        *ttl = sr->sr_ttl;
+                    match++;
+                }
+            }
+            sr = NEXTQ(statedata_subtree_t *, sr);
+        } while (sr && sr != srhead);
+    }
+    if (registered && match == 0)
+        return 0;
+    return 1;
+}
+
+/*! Get time-to-live of state of requested xpath from the state-cache-ttl YANG extension
+ *
+ * The extension of the deepest YANG node of the requested path applies.
+ * @param[in]  yspec  Yang spec
+ * @param[in]  steps  Steps of requested xpath, or NULL
+ * @param[out] ttl    Time-to-live in ms, 0: not cached
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_yang_ttl(yang_stmt *yspec,
+                   cvec      *steps,
+                   uint32_t  *ttl)
+{
+    int        retval = -1;
+    cg_var    *cv = NULL;
+    yang_stmt *y = NULL;
+    char      *value;
+    int        exist;
+    char      *reason = NULL;
+    int        ret;
+
+    *ttl = 0;
+    while (steps != NULL && (cv = cvec_each(steps, cv)) != NULL){
+        if (y == NULL){
+            if (cv_name_get(cv) == NULL ||
+                (y = yang_find_module_by_namespace(yspec, cv_name_get(cv))) == NULL)
+                break;
+        }
+        if ((y = yang_find_datanode(y, cv_string_get(cv))) == NULL)
+            break;
+        value = NULL;
+        exist = 0;
+        if (yang_extension_value(y, "state-cache-ttl", CLIXON_LIB_NS, &exist, &value) < 0)
+            goto done;
+        if (exist && value){
+            if ((ret = parse_uint32(value, ttl, &reason)) < 0){
+                clixon_err(OE_YANG, errno, "parse_uint32");
+                goto done;
+            }
+            if (ret == 0){
+                clixon_err(OE_YANG, EINVAL, "state-cache-ttl %s: %s", value, reason);
+                goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    if (reason)
+        free(reason);
+    return retval;
+}
+
+/*! Get cached state of a plugin and requested xpath
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  cp     Plugin handle
+ * @param[in]  xpath  Requested xpath
+ * @param[out] xp     Cached state tree, or NULL if no state. Do not modify or free
+ * @retval     1      Fresh cached state
+ * @retval     0      No cached state, or expired
+ * @retval    -1      Error
+ */
+static int
+statedata_cache_get(clixon_handle    h,
+                    clixon_plugin_t *cp,
+                    char            *xpath,
+                    cxobj          **xp)
+{
+    int                     retval = -1;
+    clicon_hash_t          *cache = NULL;
+    struct statedata_cache *sc;
+    cbuf                   *cb = NULL;
+    struct timeval          now;
+
+    *xp = NULL;
+    clicon_ptr_get(h, "statedata-cache", (void**)&cache);
+    if (cache == NULL){
+        _statedata_cache_misses++;
+        goto miss;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s %s", clixon_plugin_name_get(cp), xpath?xpath:"/");
+    if ((sc = clicon_hash_value(cache, cbuf_get(cb), NULL)) == NULL){
+        _statedata_cache_misses++;
+        goto miss;
+    }
+    gettimeofday(&now, NULL);
+    if (timercmp(&now, &sc->sc_expire, >)){
+        _statedata_cache_stale++;
+        goto miss;
+    }
+    _statedata_cache_hits++;
+    *xp = sc->sc_xml;
+    retval = 1;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+ miss:
+    retval = 0;
+    goto done;
+}
+
+/*! Remove entries from state cache
+ *
+ * @param[in]  cache  State cache
+ * @param[in]  all    0: remove expired entries, 1: remove all entries
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_cache_purge(clicon_hash_t *cache,
+                      int            all)
+{
+    char                  **keys = NULL;
+    size_t                  nkeys = 0;
+    size_t                  i;
+    struct statedata_cache *sc;
+    struct timeval          now;
+
+    if (clicon_hash_keys(cache, &keys, &nkeys) < 0)
+        return -1;
+    gettimeofday(&now, NULL);
+    for (i=0; i<nkeys; i++){
+        if ((sc = clicon_hash_value(cache, keys[i], NULL)) == NULL)
+            continue;
+        if (!all && !timercmp(&now, &sc->sc_expire, >))
+            continue;
+        if (sc->sc_xml)
+            xml_free(sc->sc_xml);
+        clicon_hash_del(cache, keys[i]);
+        _statedata_cache_entries--;
+    }
+    if (keys)
+        free(keys);
+    return 0;
+}
+
+/*! Cache state of a plugin and requested xpath
+ *
+ * The cache is only filled by the backend process: state data is not read in read workers,
+ * where the cache would be lost when the worker exits, see get_worker
+ * @param[in]  h      Clixon handle
+ * @param[in]  cp     Plugin handle
+ * @param[in]  xpath  Requested xpath
+ * @param[in]  ttl    Time-to-live in ms
+ * @param[in]  x      Bound and sorted state tree, or NULL if no state. Copied
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see STATE_CACHE_SIZE
+ */
+static int
+statedata_cache_set(clixon_handle    h,
+                    clixon_plugin_t *cp,
+                    char            *xpath,
+                    uint32_t         ttl,
+                    cxobj           *x)
+{
+    int                     retval = -1;
+    clicon_hash_t          *cache = NULL;
+    struct statedata_cache  sc0 = {{0,},};
+    struct statedata_cache *sc;
+    cbuf                   *cb = NULL;
+    struct timeval          now;
+    struct timeval          t;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&cache);
+    if (cache == NULL){
+        if ((cache = clicon_hash_init()) == NULL)
+            goto done;
+        if (clicon_ptr_set(h, "statedata-cache", cache) < 0)
+            goto done;
+    }
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s %s", clixon_plugin_name_get(cp), xpath?xpath:"/");
+    if ((sc = clicon_hash_value(cache, cbuf_get(cb), NULL)) == NULL){
+        if (_statedata_cache_entries >= STATE_CACHE_SIZE){
+            if (statedata_cache_purge(cache, 0) < 0)
+                goto done;
+            if (_statedata_cache_entries >= STATE_CACHE_SIZE &&
+                statedata_cache_purge(cache, 1) < 0)
+                goto done;
+        }
+        if (clicon_hash_add(cache, cbuf_get(cb), &sc0, sizeof(sc0)) == NULL)
+            goto done;
+        if ((sc = clicon_hash_value(cache, cbuf_get(cb), NULL)) == NULL)
+            goto done;
+        _statedata_cache_entries++;
+    }
+    else if (sc->sc_xml){
+        xml_free(sc->sc_xml);
+        sc->sc_xml = NULL;
+    }
+    if (x && (sc->sc_xml = xml_dup(x)) == NULL)
+        goto done;
+    gettimeofday(&now, NULL);
+    t.tv_sec = ttl/1000;
+    t.tv_usec = (ttl%1000)*1000;
+    timeradd(&now, &t, &sc->sc_expire);
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Register a subtree that a state data callback provides state for
+ *
+ * If a plugin registers one or more subtrees for its ca_statedata callback, the callback is only
+ * called for requests whose xpath intersects a registered subtree. Callbacks without registered
+ * subtrees are called for all requests.
+ * Should be called in clixon_plugin_init.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     State data callback, same as ca_statedata of the plugin
+ * @param[in]  nsc    XPath namespace context
+ * @param[in]  xpath  Absolute path of subtree, eg "/if:interfaces"
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *    cvec *nsc = xml_nsctx_init("ex", "urn:example:clixon");
+ *    if (clixon_plugin_statedata_register(h, example_statedata, nsc, "/ex:state") < 0)
+ *       err;
+ *    xml_nsctx_free(nsc);
+ * @endcode
+ * @see clixon_plugin_statedata_cache_register  Also cache the state
+ */
+int
+clixon_plugin_statedata_register(clixon_handle   h,
+                                 plgstatedata_t *fn,
+                                 cvec           *nsc,
+                                 char           *xpath)
+{
+    return clixon_plugin_statedata_cache_register(h, fn, nsc, xpath, 0);
+}
+
+/*! Register a subtree that a state data callback provides state for, and cache its state
+ *
+ * As clixon_plugin_statedata_register, but the state returned by the callback is cached per
+ * requested xpath, and merged without calling the callback while it is fresh.
+ * If a request intersects several registered subtrees of the callback, the smallest
+ * time-to-live applies.
+ * A time-to-live may also be declared with the state-cache-ttl YANG extension.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     State data callback, same as ca_statedata of the plugin
+ * @param[in]  nsc    XPath namespace context
+ * @param[in]  xpath  Absolute path of subtree, eg "/if:interfaces"
+ * @param[in]  ttl    Time-to-live of cached state in ms, 0: not cached
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_plugin_statedata_cache_register(clixon_handle   h,
+                                       plgstatedata_t *fn,
+                                       cvec           *nsc,
+                                       char           *xpath,
+                                       uint32_t        ttl)
+{
+    int                  retval = -1;
+    statedata_subtree_t *srhead = NULL;
+    statedata_subtree_t *sr = NULL;
+
+    if ((sr = malloc(sizeof(*sr))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(sr, 0, sizeof(*sr));
+    sr->sr_fn = fn;
+    sr->sr_ttl = ttl;
+    if (statedata_xpath_steps(xpath, nsc, &sr->sr_steps) < 0)
+        goto done;
+    if (sr->sr_steps == NULL){
+        clixon_err(OE_PLUGIN, EINVAL, "State data subtree %s is not an absolute path", xpath);
+        goto done;
+    }
+    clicon_ptr_get(h, "statedata-subtrees", (void**)&srhead);
+    ADDQ(sr, srhead);
+    if (clicon_ptr_set(h, "statedata-subtrees", srhead) < 0)
+        goto done;
+    sr = NULL;
+    retval = 0;
+ done:
+    if (sr){
+        if (sr->sr_steps)
+            cvec_free(sr->sr_steps);
+        free(sr);
+    }
+    return retval;
+}
+
+/*! Registered asynchronous state data callback
+ *
+ * @see clixon_plugin_statedata_async_register
+ */
+typedef struct {
+    qelem_t               sa_qelem;
+    plgstatedata_async_t *sa_fn;     /* Asynchronous state data callback */
+    cvec                 *sa_steps;  /* Steps of subtree, or NULL for all requests */
+} statedata_async_reg_t;
+
+/*! Asynchronous state data callbacks of one request
+ *
+ * @see clixon_plugin_statedata_async_start
+ */
+struct statedata_async{
+    clixon_handle         sa_h;
+    yang_stmt            *sa_yspec;
+    cvec                 *sa_nsc;      /* Namespace context of request (copy) */
+    char                 *sa_xpath;    /* Requested xpath (copy) */
+    int                   sa_pending;  /* Number of callbacks not done */
+    int                   sa_starting; /* Callbacks are being started */
+    cxobj                *sa_xstate;   /* Merged state of done callbacks */
+    cxobj                *sa_xerr;     /* First error of done callbacks */
+    statedata_async_cb_t *sa_fn;       /* Called when all callbacks are done or at deadline */
+    void                 *sa_arg;      /* Argument of sa_fn */
+};
+
+/*! Pending asynchronous state data callback
+ */
+typedef struct {
+    qelem_t                 sp_qelem;
+    uint32_t                sp_id;  /* Identifies callback in clixon_plugin_statedata_async_done */
+    struct statedata_async *sp_sa;  /* Request of callback */
+} statedata_pending_t;
+
+/* Last id of asynchronous state data callback */
+static uint32_t _statedata_async_id = 0;
+
+/* Asynchronous state data callback statistics */
+static uint64_t _statedata_async_calls = 0;
+static uint64_t _statedata_async_timeouts = 0;
+
+/*! Register an asynchronous state data callback
+ *
+ * The callback is called with an id for every get request intersecting the subtree and
+ * returns without waiting for the state, eg after sending a request to a dataplane daemon.
+ * When the state is available, typically in an event loop callback of the plugin, the plugin
+ * calls clixon_plugin_statedata_async_done with the id.
+ * Callbacks of a request are called concurrently, the state is merged as it arrives and the
+ * request is answered when all are done, or when CLICON_STATE_ASYNC_TIMEOUT has passed.
+ * Meanwhile the backend serves other sessions.
+ * Should be called in clixon_plugin_init.
+ * @param[in]  h      Clixon handle
+ * @param[in]  fn     Asynchronous state data callback
+ * @param[in]  nsc    XPath namespace context
+ * @param[in]  xpath  Absolute path of subtree, eg "/if:interfaces", or NULL for all requests
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *    static int
+ *    example_statedata_async(clixon_handle h, cvec *nsc, char *xpath, uint32_t id)
+ *    {
+ *       // Send request to dataplane with id, reply is handled in an fd callback that calls
+ *       // clixon_plugin_statedata_async_done(h, id, xstate)
+ *    }
+ *    ...
+ *    if (clixon_plugin_statedata_async_register(h, example_statedata_async, NULL, NULL) < 0)
+ *       err;
+ * @endcode
+ */
+int
+clixon_plugin_statedata_async_register(clixon_handle         h,
+                                       plgstatedata_async_t *fn,
+                                       cvec                 *nsc,
+                                       char                 *xpath)
+{
+    int                    retval = -1;
+    statedata_async_reg_t *rhead = NULL;
+    statedata_async_reg_t *r = NULL;
+
+    if ((r = malloc(sizeof(*r))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(r, 0, sizeof(*r));
+    r->sa_fn = fn;
+    if (xpath != NULL){
+        if (statedata_xpath_steps(xpath, nsc, &r->sa_steps) < 0)
+            goto done;
+        if (r->sa_steps == NULL){
+            clixon_err(OE_PLUGIN, EINVAL, "State data subtree %s is not an absolute path", xpath);
+            goto done;
+        }
+    }
+    clicon_ptr_get(h, "statedata-async", (void**)&rhead);
+    ADDQ(r, rhead);
+    if (clicon_ptr_set(h, "statedata-async", rhead) < 0)
+        goto done;
+    r = NULL;
+    retval = 0;
+ done:
+    if (r){
+        if (r->sa_steps)
+            cvec_free(r->sa_steps);
+        free(r);
+    }
+    return retval;
+}
+
+/*! Check if asynchronous state data callbacks are registered
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     1      Yes
+ * @retval     0      No
+ */
+int
+clixon_plugin_statedata_async_registered(clixon_handle h)
+{
+    statedata_async_reg_t *rhead = NULL;
+
+    clicon_ptr_get(h, "statedata-async", (void**)&rhead);
+    return rhead != NULL;
+}
+
+/*! Remove pending callbacks of a request
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  sa     Asynchronous state data callbacks of request
+ * @retval     n      Number of removed pending callbacks
+ */
+static int
+statedata_async_pending_rm(clixon_handle           h,
+                           struct statedata_async *sa)
+{
+    statedata_pending_t *sphead = NULL;
+    statedata_pending_t *sp;
+    statedata_pending_t *spnext;
+    int                  n = 0;
+    int                  last;
+
+    clicon_ptr_get(h, "statedata-async-pending", (void**)&sphead);
+    if ((sp = sphead) == NULL)
+        return 0;
+    do {
+        spnext = NEXTQ(statedata_pending_t *, sp);
+        last = (spnext == sphead);
+        if (sp->sp_sa == sa){
+            DELQ(sp, sphead, statedata_pending_t *);
+            free(sp);
+            n++;
+        }
+        sp = spnext;
+    } while (sphead && !last);
+    if (sphead)
+        clicon_ptr_set(h, "statedata-async-pending", sphead);
+    else
+        clicon_ptr_del(h, "statedata-async-pending");
+    return n;
+}
+
+/*! All asynchronous state data callbacks of a request are done, or the deadline has passed
+ *
+ * Called as a timeout from the event loop
+ * @param[in]  s      Not used
+ * @param[in]  arg    Asynchronous state data callbacks of request
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+statedata_async_complete(int   s,
+                         void *arg)
+{
+    struct statedata_async *sa = (struct statedata_async *)arg;
+    clixon_handle           h = sa->sa_h;
+    int                     n;
+
+    clixon_event_unreg_timeout(statedata_async_complete, sa);
+    if ((n = statedata_async_pending_rm(h, sa)) > 0){
+        _statedata_async_timeouts += n;
+        clixon_log(h, LOG_WARNING, "%s: %d state data callbacks not done before deadline",
+                   __FUNCTION__, n);
+    }
+    sa->sa_pending = 0;
+    /* sa may be freed by sa_fn */
+    return sa->sa_fn(h, sa->sa_arg);
+}
+
+/*! Start asynchronous state data callbacks of a request
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  yspec  Yang spec
+ * @param[in]  nsc    Namespace context
+ * @param[in]  xpath  Requested xpath
+ * @param[in]  fn     Called from event loop when all callbacks are done or at deadline
+ * @param[in]  arg    Argument of fn
+ * @param[out] sap    Asynchronous callbacks of request, NULL if none. Free with
+ *                    clixon_plugin_statedata_async_free
+ * @retval     1      Callbacks pending, fn will be called
+ * @retval     0      No callbacks, or all done
+ * @retval    -1      Error
+ * @see clixon_plugin_statedata_async_merge
+ */
+int
+clixon_plugin_statedata_async_start(clixon_handle            h,
+                                    yang_stmt               *yspec,
+                                    cvec                    *nsc,
+                                    char                    *xpath,
+                                    statedata_async_cb_t    *fn,
+                                    void                    *arg,
+                                    struct statedata_async **sap)
+{
+    int                     retval = -1;
+    statedata_async_reg_t  *rhead = NULL;
+    statedata_async_reg_t  *r;
+    statedata_pending_t    *sphead = NULL;
+    statedata_pending_t    *sp;
+    struct statedata_async *sa = NULL;
+    cvec                   *steps = NULL;
+    struct timeval          t;
+    struct timeval          t1;
+    uint32_t                ms;
+
+    *sap = NULL;
+    clicon_ptr_get(h, "statedata-async", (void**)&rhead);
+    if (rhead == NULL)
+        goto none;
+    if (statedata_xpath_steps(xpath, nsc, &steps) < 0)
+        goto done;
+    r = rhead;
+    do {
+        if (steps != NULL && r->sa_steps != NULL &&
+            !statedata_steps_intersect(steps, r->sa_steps)){
+            _statedata_skipped++;
+            continue;
+        }
+        if (sa == NULL){
+            if ((sa = malloc(sizeof(*sa))) == NULL){
+                clixon_err(OE_UNIX, errno, "malloc");
+                goto done;
+            }
+            memset(sa, 0, sizeof(*sa));
+            sa->sa_h = h;
+            sa->sa_yspec = yspec;
+            sa->sa_fn = fn;
+            sa->sa_arg = arg;
+            sa->sa_starting = 1;
+            if (nsc && (sa->sa_nsc = cvec_dup(nsc)) == NULL){
+                clixon_err(OE_UNIX, errno, "cvec_dup");
+                goto done;
+            }
+            if ((sa->sa_xpath = strdup(xpath?xpath:"/")) == NULL){
+                clixon_err(OE_UNIX, errno, "strdup");
+                goto done;
+            }
+        }
+        if ((sp = malloc(sizeof(*sp))) == NULL){
+            clixon_err(OE_UNIX, errno, "malloc");
+            goto done;
+        }
+        memset(sp, 0, sizeof(*sp));
+        sp->sp_id = ++_statedata_async_id;
+        sp->sp_sa = sa;
+        sphead = NULL;
+        clicon_ptr_get(h, "statedata-async-pending", (void**)&sphead);
+        ADDQ(sp, sphead);
+        if (clicon_ptr_set(h, "statedata-async-pending", sphead) < 0)
+            goto done;
+        sa->sa_pending++;
+        _statedata_async_calls++;
+        if (r->sa_fn(h, nsc, xpath, sp->sp_id) < 0)
+            goto done;
+    } while ((r = NEXTQ(statedata_async_reg_t *, r)) != rhead);
+    if (sa == NULL)
+        goto none;
+    sa->sa_starting = 0;
+    *sap = sa;
+    if (sa->sa_pending == 0){
+        sa = NULL;
+        goto none;
+    }
+    ms = clicon_option_int(h, "CLICON_STATE_ASYNC_TIMEOUT");
+    gettimeofday(&t, NULL);
+    t1.tv_sec = ms/1000;
+    t1.tv_usec = (ms%1000)*1000;
+    timeradd(&t, &t1, &t);
+    sa = NULL;
+    if (clixon_event_reg_timeout(t, statedata_async_complete, *sap, "state data deadline") < 0)
+        goto done;
+    retval = 1;
+ done:
+    if (retval < 0){
+        if (sa)
+            clixon_plugin_statedata_async_free(h, sa);
+        else if (*sap)
+            clixon_plugin_statedata_async_free(h, *sap);
+        *sap = NULL;
+    }
+    if (steps)
+        cvec_free(steps);
+    return retval;
+ none:
+    retval = 0;
+    goto done;
+}
+
+/*! Asynchronous state data callback is done
+ *
+ * Called by a plugin when the state of an asynchronous callback is available.
+ * State arriving after the deadline of the request is discarded.
+ * @param[in]  h       Clixon handle
+ * @param[in]  id      Id of callback
+ * @param[in]  xstate  State tree with top symbol as in ca_statedata, or NULL. Consumed
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see clixon_plugin_statedata_async_register
+ */
+int
+clixon_plugin_statedata_async_done(clixon_handle h,
+                                   uint32_t      id,
+                                   cxobj        *xstate)
+{
+    int                     retval = -1;
+    statedata_pending_t    *sphead = NULL;
+    statedata_pending_t    *sp;
+    struct statedata_async *sa = NULL;
+    cxobj                  *xerr = NULL;
+    struct timeval          t;
+    int                     ret;
+
+    clicon_ptr_get(h, "statedata-async-pending", (void**)&sphead);
+    if ((sp = sphead) != NULL){
+        do {
+            if (sp->sp_id == id){
+                sa = sp->sp_sa;
+                DELQ(sp, sphead, statedata_pending_t *);
+                free(sp);
+                if (sphead)
+                    clicon_ptr_set(h, "statedata-async-pending", sphead);
+                else
+                    clicon_ptr_del(h, "statedata-async-pending");
+                break;
+            }
+            sp = NEXTQ(statedata_pending_t *, sp);
+        } while (sp != sphead);
+    }
+    if (sa == NULL){
+        clixon_debug(CLIXON_DBG_BACKEND, "State data callback %u not pending", id);
+        goto ok;
+    }
+    if (xstate != NULL && xml_child_nr(xstate) > 0 && sa->sa_xerr == NULL){
+        clixon_debug_xml(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, xstate, "Async %u STATE:", id);
+        if ((ret = xml_bind_yang(h, xstate, YB_MODULE, sa->sa_yspec, &xerr)) < 0)
+            goto done;
+        if (ret == 0){
+            if (clixon_netconf_internal_error(xerr,
+                                              ". Internal error, asynchronous state callback returned invalid XML", NULL) < 0)
+                goto done;
+            sa->sa_xerr = xerr;
+            xerr = NULL;
+        }
+        else {
+            if (xml_sort_recurse(xstate) < 0)
+                goto done;
+            if (xml_default_nopresence(xstate, 2, 0) < 0)
+                goto done;
+            if (xpath_first(xstate, sa->sa_nsc, "%s", sa->sa_xpath) != NULL){
+                if ((ret = netconf_trymerge(xstate, sa->sa_yspec, &sa->sa_xstate)) < 0)
+                    goto done;
+                if (ret == 0){
+                    sa->sa_xerr = sa->sa_xstate;
+                    sa->sa_xstate = NULL;
+                }
+            }
+        }
+    }
+    if (--sa->sa_pending == 0 && !sa->sa_starting){
+        /* Complete from event loop, replaces deadline */
+        clixon_event_unreg_timeout(statedata_async_complete, sa);
+        gettimeofday(&t, NULL);
+        if (clixon_event_reg_timeout(t, statedata_async_complete, sa, "state data done") < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (xstate)
+        xml_free(xstate);
+    return retval;
+}
+
+/*! Check if asynchronous state data callbacks of a request are pending
+ *
+ * @param[in]  sa     Asynchronous state data callbacks of request
+ * @retval     1      Pending
+ * @retval     0      All done, or deadline passed
+ */
+int
+clixon_plugin_statedata_async_pending(struct statedata_async *sa)
+{
+    return sa->sa_pending > 0;
+}
+
+/*! Merge state of done asynchronous state data callbacks of a request
+ *
+ * @param[in]     sa      Asynchronous state data callbacks of request
+ * @param[in]     yspec   Yang spec
+ * @param[in,out] xret    State XML tree is merged with existing tree.
+ * @retval        1       OK
+ * @retval        0       Statedata callback failed (xret set with netconf-error)
+ * @retval       -1       Error
+ */
+int
+clixon_plugin_statedata_async_merge(struct statedata_async *sa,
+                                    yang_stmt              *yspec,
+                                    cxobj                 **xret)
+{
+    if (sa->sa_xerr){
+        if (*xret)
+            xml_free(*xret);
+        *xret = sa->sa_xerr;
+        sa->sa_xerr = NULL;
+        return 0;
+    }
+    if (sa->sa_xstate == NULL)
+        return 1;
+    return netconf_trymerge(sa->sa_xstate, yspec, xret);
+}
+
+/*! Free asynchronous state data callbacks of a request
+ *
+ * Callbacks still pending are discarded when they are done
+ * @param[in]  h      Clixon handle
+ * @param[in]  sa     Asynchronous state data callbacks of request
+ */
+int
+clixon_plugin_statedata_async_free(clixon_handle           h,
+                                   struct statedata_async *sa)
+{
+    clixon_event_unreg_timeout(statedata_async_complete, sa);
+    statedata_async_pending_rm(h, sa);
+    if (sa->sa_xstate)
+        xml_free(sa->sa_xstate);
+    if (sa->sa_xerr)
+        xml_free(sa->sa_xerr);
+    if (sa->sa_nsc)
+        cvec_free(sa->sa_nsc);
+    if (sa->sa_xpath)
+        free(sa->sa_xpath);
+    free(sa);
+    return 0;
+}
+
+/*! Get asynchronous state data callback statistics
+ *
+ * @param[out] calls     Number of asynchronous state data callbacks called
+ * @param[out] timeouts  Number of asynchronous state data callbacks not done before deadline
+ * @retval     0         OK
+ */
+int
+clixon_plugin_statedata_async_stats(uint64_t *calls,
+                                    uint64_t *timeouts)
+{
+    *calls = _statedata_async_calls;
+    *timeouts = _statedata_async_timeouts;
+    return 0;
+}
+
+/*! Free registered state data subtrees, asynchronous callbacks and state cache
+ *
+ * @param[in]  h      Clixon handle
+ */
+int
+clixon_plugin_statedata_free(clixon_handle h)
+{
+    statedata_subtree_t   *srhead = NULL;
+    statedata_subtree_t   *sr;
+    statedata_async_reg_t *rhead = NULL;
+    statedata_async_reg_t *r;
+    statedata_pending_t   *sphead = NULL;
+    statedata_pending_t   *sp;
+    clicon_hash_t         *cache = NULL;
+
+    clicon_ptr_get(h, "statedata-cache", (void**)&cache);
+    if (cache){
+        statedata_cache_purge(cache, 1);
+        clicon_hash_free(cache);
+        clicon_ptr_del(h, "statedata-cache");
+    }
+    clicon_ptr_get(h, "statedata-subtrees", (void**)&srhead);
+    while ((sr = srhead) != NULL){
+        DELQ(sr, srhead, statedata_subtree_t *);
+        if (sr->sr_steps)
+            cvec_free(sr->sr_steps);
+        free(sr);
+    }
+    clicon_ptr_del(h, "statedata-subtrees");
+    clicon_ptr_get(h, "statedata-async", (void**)&rhead);
+    while ((r = rhead) != NULL){
+        DELQ(r, rhead, statedata_async_reg_t *);
+        if (r->sa_steps)
+            cvec_free(r->sa_steps);
+        free(r);
+    }
+    clicon_ptr_del(h, "statedata-async");
+    clicon_ptr_get(h, "statedata-async-pending", (void**)&sphead);
+    while ((sp = sphead) != NULL){
+        DELQ(sp, sphead, statedata_pending_t *);
+        free(sp);
+    }
+    clicon_ptr_del(h, "statedata-async-pending");
+    return 0;
+}
+
+/*! Get state data callback statistics
+ *
+ * @param[out] calls    Number of state data callbacks called
+ * @param[out] skipped  Number of state data callbacks not called since no registered subtree
+ *                      intersects the request
+ * @retval     0        OK
+ */
+int
+clixon_plugin_statedata_stats(uint64_t *calls,
+                              uint64_t *skipped)
+{
+    *calls = _statedata_calls;
+    *skipped = _statedata_skipped;
+    return 0;
+}
+
+/*! Get state cache statistics
+ *
+ * @param[out] hits     Number of requests served from the state cache
+ * @param[out] misses   Number of requests of subtrees with a time-to-live not in the cache
+ * @param[out] stale    Number of requests of subtrees with a time-to-live with expired cached state
+ * @param[out] entries  Number of cached entries
+ * @retval     0        OK
+ */
+int
+clixon_plugin_statedata_cache_stats(uint64_t *hits,
+                                    uint64_t *misses,
+                                    uint64_t *stale,
+                                    uint32_t *entries)
+{
+    *hits = _statedata_cache_hits;
+    *misses = _statedata_cache_misses;
+    *stale = _statedata_cache_stale;
+    *entries = _statedata_cache_entries;
+    return 0;
+}
+
 /*! Go through all backend statedata callbacks and collect state data
  *
  * This is internal system call, plugin is invoked (does not call) this function
@@ -348,9 +1405,44 @@ clixon_plugin_statedata_all(clixon_handle   h,
     clixon_plugin_t *cp = NULL;
     cbuf            *cberr = NULL;
     cxobj           *xerr = NULL;
+    cvec            *steps = NULL;
+    uint32_t         ttl;
+    uint32_t         yttl;
+    cxobj           *xc;
 
     clixon_debug(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, "");
+    /* Steps of requested xpath, matched with registered subtrees */
+    if (statedata_xpath_steps(xpath, nsc, &steps) < 0)
+        goto done;
+    if (statedata_yang_ttl(yspec, steps, &yttl) < 0)
+        goto done;
     while ((cp = clixon_plugin_each(h, cp)) != NULL) {
+        if (statedata_subtree_match(h, cp, steps, &ttl) == 0){
+            _statedata_skipped++;
+            continue;
+        }
+        if (clixon_plugin_api_get(cp)->ca_statedata == NULL)
+            continue;
+        if (ttl == 0)
+            ttl = yttl;
+        if (ttl){
+            if ((ret = statedata_cache_get(h, cp, xpath, &xc)) < 0)
+                goto done;
+            if (ret == 1){ /* Fresh cached state, merge a copy */
+                if (xc != NULL){
+                    if ((x = xml_dup(xc)) == NULL)
+                        goto done;
+                    if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
+                        goto done;
+                    if (ret == 0)
+                        goto fail;
+                    xml_free(x);
+                    x = NULL;
+                }
+                continue;
+            }
+        }
+        _statedata_calls++;
         if ((ret = clixon_plugin_statedata_one(cp, h, nsc, xpath, &x)) < 0)
             goto done;
         if (ret == 0){
@@ -368,11 +1460,13 @@ clixon_plugin_statedata_all(clixon_handle   h,
             xerr = NULL;
             goto fail;
         }
-        if (x == NULL)
-            continue;
-        if (xml_child_nr(x) == 0){
+        if (x != NULL && xml_child_nr(x) == 0){
             xml_free(x);
             x = NULL;
+        }
+        if (x == NULL){
+            if (ttl && statedata_cache_set(h, cp, xpath, ttl, NULL) < 0)
+                goto done;
             continue;
         }
         clixon_debug_xml(CLIXON_DBG_BACKEND | CLIXON_DBG_DETAIL, x, "%s STATE:", clixon_plugin_name_get(cp));
@@ -396,11 +1490,15 @@ clixon_plugin_statedata_all(clixon_handle   h,
         if (xml_default_nopresence(x, 2, 0) < 0)
             goto done;
         if (xpath_first(x, nsc, "%s", xpath) != NULL){
+            if (ttl && statedata_cache_set(h, cp, xpath, ttl, x) < 0)
+                goto done;
             if ((ret = netconf_trymerge(x, yspec, xret)) < 0)
                 goto done;
             if (ret == 0)
                 goto fail;
         }
+        else if (ttl && statedata_cache_set(h, cp, xpath, ttl, NULL) < 0)
+            goto done;
         if (x){
             xml_free(x);
             x = NULL;
@@ -408,6 +1506,8 @@ clixon_plugin_statedata_all(clixon_handle   h,
     } /* while plugin */
     retval = 1;
  done:
+    if (steps)
+        cvec_free(steps);
     if (xerr)
         xml_free(xerr);
     if (cberr)
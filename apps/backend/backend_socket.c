@@ -290,6 +290,17 @@ backend_accept_client(int   fd,
         break;
     }
     ce->ce_s = s;
+#ifdef REPLY_STREAM_BUFSIZE
+    if ((ce->ce_writer = clixon_msg_writer_new(s, REPLY_STREAM_BUFSIZE)) == NULL)
+        goto done;
+#else
+    if ((ce->ce_writer = clixon_msg_writer_new(s, 0)) == NULL)
+        goto done;
+#endif
+    if (clixon_msg_writer_backpressure(ce->ce_writer, from_client_backpressure, ce) < 0)
+        goto done;
+    if ((ce->ce_reader = clixon_msg_reader_new(s)) == NULL)
+        goto done;
     /*
      * Register callback for actual data socket
      */
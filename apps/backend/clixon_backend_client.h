@@ -59,6 +59,9 @@ struct client_entry{
     struct client_entry  *ce_next;    /* The clients linked list */
     struct sockaddr       ce_addr;    /* The clients (UNIX domain) address */
     int                   ce_s;       /* Stream socket to client */
+    clixon_msg_writer    *ce_writer;  /* Output queue and reply stream of socket */
+    clixon_msg_reader    *ce_reader;  /* Input buffer of socket, requests may be pipelined */
+    cbuf                 *ce_reply;   /* Reply buffer of ongoing rpc, may be streamed */
     int                   ce_nr;      /* Client number (for dbg/tracing) */
     uint32_t              ce_id;      /* Session id, accessor functions: clicon_session_id_get/set */
     char                 *ce_username;/* Translated from peer user cred */
@@ -73,6 +76,11 @@ struct client_entry{
     uint32_t              ce_in_bad_rpcs;    /* Not correct <rpc> messages */
     uint32_t              ce_out_rpc_errors; /*  <rpc-error> messages*/
     uint32_t              ce_out_notifications; /* Outgoing notifications */
+    int                   ce_notify;  /* Session has event stream subscriptions */
+    pid_t                 ce_worker;  /* Read worker serving a request of session, or 0 */
+    int                   ce_worker_fd; /* Pipe from read worker, EOF when worker exits */
+    struct statedata_async *ce_async; /* Asynchronous state callbacks of a get request, or NULL */
+    char                 *ce_async_msg; /* Get request re-dispatched when ce_async is done */
 };
 typedef struct client_entry client_entry;
 
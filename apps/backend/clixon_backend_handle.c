@@ -196,12 +196,18 @@ backend_client_delete(clixon_handle        h,
     for (c = *ce_prev; c; c = c->ce_next){
         if (c == ce){
             *ce_prev = c->ce_next;
+            if (ce->ce_writer)
+                clixon_msg_writer_free(ce->ce_writer);
+            if (ce->ce_reader)
+                clixon_msg_reader_free(ce->ce_reader);
             if (ce->ce_username)
                 free(ce->ce_username);
             if (ce->ce_transport)
                 free(ce->ce_transport);
             if (ce->ce_source_host)
                 free(ce->ce_source_host);
+            if (ce->ce_async_msg)
+                free(ce->ce_async_msg);
             ce->ce_next = NULL;
             free(ce);
             break;
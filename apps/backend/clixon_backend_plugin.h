@@ -91,6 +91,31 @@ typedef struct {
     cxobj            *pd_xstate;    /* Returned xml state tree */
 } pagination_data_t;
 
+/* Asynchronous state data callbacks of one request, see clixon_plugin_statedata_async_start */
+struct statedata_async;
+
+/*! Asynchronous state data callback
+ *
+ * Start retrieving state for a request and return without waiting.
+ * When done, call clixon_plugin_statedata_async_done with the id
+ * @param[in]  h      Clixon handle
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  Requested xpath
+ * @param[in]  id     Identifies the callback in clixon_plugin_statedata_async_done
+ * @retval     0      OK, started
+ * @retval    -1      Error
+ * @see clixon_plugin_statedata_async_register
+ */
+typedef int (plgstatedata_async_t)(clixon_handle h, cvec *nsc, char *xpath, uint32_t id);
+
+/*! Called when all asynchronous state data callbacks of a request are done or at deadline
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  arg    Argument given to clixon_plugin_statedata_async_start
+ * @see clixon_plugin_statedata_async_start
+ */
+typedef int (statedata_async_cb_t)(clixon_handle h, void *arg);
+
 /*
  * Prototypes
  */
@@ -101,6 +126,20 @@ int clixon_plugin_pre_daemon_all(clixon_handle h);
 int clixon_plugin_daemon_all(clixon_handle h);
 
 int clixon_plugin_statedata_all(clixon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath, cxobj **xtop);
+int clixon_plugin_statedata_register(clixon_handle h, plgstatedata_t *fn, cvec *nsc, char *xpath);
+int clixon_plugin_statedata_cache_register(clixon_handle h, plgstatedata_t *fn, cvec *nsc, char *xpath, uint32_t ttl);
+int clixon_plugin_statedata_free(clixon_handle h);
+int clixon_plugin_statedata_stats(uint64_t *calls, uint64_t *skipped);
+int clixon_plugin_statedata_cache_stats(uint64_t *hits, uint64_t *misses, uint64_t *stale, uint32_t *entries);
+int clixon_plugin_statedata_async_register(clixon_handle h, plgstatedata_async_t *fn, cvec *nsc, char *xpath);
+int clixon_plugin_statedata_async_registered(clixon_handle h);
+int clixon_plugin_statedata_async_start(clixon_handle h, yang_stmt *yspec, cvec *nsc, char *xpath,
+                                        statedata_async_cb_t *fn, void *arg, struct statedata_async **sap);
+int clixon_plugin_statedata_async_done(clixon_handle h, uint32_t id, cxobj *xstate);
+int clixon_plugin_statedata_async_pending(struct statedata_async *sa);
+int clixon_plugin_statedata_async_merge(struct statedata_async *sa, yang_stmt *yspec, cxobj **xret);
+int clixon_plugin_statedata_async_free(clixon_handle h, struct statedata_async *sa);
+int clixon_plugin_statedata_async_stats(uint64_t *calls, uint64_t *timeouts);
 int clixon_plugin_lockdb_all(clixon_handle h, char *db, int lock, int id);
 
 int clixon_pagination_cb_register(clixon_handle h, handler_function fn, char *path, void *arg);
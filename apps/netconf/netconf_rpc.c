@@ -466,9 +466,9 @@ netconf_notification_cb(int   s,
     /* handle close from remote end: this will exit the client */
     if (eof){
         clixon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
+        clixon_event_unreg_fd(s, netconf_notification_cb);
         close(s);
         errno = ESHUTDOWN;
-        clixon_event_unreg_fd(s, netconf_notification_cb);
         goto done;
     }
     if ((ret = clixon_xml_parse_string(cbuf_get(cbmsg), YB_RPC, yspec, &xt, &xerr)) < 0)
@@ -494,9 +494,9 @@ netconf_notification_cb(int   s,
     }
     if (netconf_output(1, cb, "notification") < 0){
         clixon_err(OE_PROTO, ESHUTDOWN, "Socket unexpected close");
+        clixon_event_unreg_fd(s, netconf_notification_cb);
         close(s);
         errno = ESHUTDOWN;
-        clixon_event_unreg_fd(s, netconf_notification_cb);
         goto done;
     }
     fflush(stdout);
@@ -198,8 +198,7 @@ yang_patch_strip_after_last_slash(char* val)
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
  * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
  * @param[in]  target_val       value in "target" field of edit in YANG patch
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
+ * @param[in]  xvalues          "value" of an edit in YANG patch, its children are the values
  * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
  * @retval     0    OK
  * @retval    -1    Error
@@ -214,13 +213,13 @@ yang_patch_do_replace(clixon_handle  h,
                       ietf_ds_t      ds,
                       cbuf          *simple_patch_request_uri,
                       char          *target_val,       
-                      int            value_vec_len,
-                      cxobj        **value_vec,
+                      cxobj         *xvalues,
                       cxobj         *x_simple_patch
                       )
 {
     int    retval = -1;
     cxobj *value_vec_tmp = NULL;
+    cxobj *xv = NULL;
     cbuf  *delete_req_uri = NULL;
     cbuf  *post_req_uri = NULL;
     cbuf  *json_simple_patch = NULL;
@@ -264,11 +263,9 @@ yang_patch_do_replace(clixon_handle  h,
     }
     // Now insert the new values into the data
     // (which will include the key value and all other mandatory values)
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
+    while ((xv = xml_child_each(xvalues, xv, CX_ERROR)) != NULL) {
+        value_vec_tmp = xml_dup(xv);
+        xml_addsub(x_simple_patch, value_vec_tmp);
     }
     // Convert the data to json
     if (clixon_json2cbuf(json_simple_patch, x_simple_patch, 0, 0) < 0)
@@ -300,8 +297,7 @@ yang_patch_do_replace(clixon_handle  h,
  * @param[in]  media_out Output media
  * @param[in]  ds       0 if "data" resource, 1 if rfc8527 "ds" resource
  * @param[in]  simplepatch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
+ * @param[in]  xvalues          "value" of an edit in YANG patch, its children are the values
  * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
  * @retval     0    OK
  * @retval    -1    Error
@@ -315,13 +311,13 @@ yang_patch_do_create(clixon_handle  h,
                      restconf_media media_out,
                      ietf_ds_t      ds,
                      cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
+                     cxobj         *xvalues,
                      cxobj         *x_simple_patch
                      )
 {
     int    retval = -1;
     cxobj *value_vec_tmp = NULL;
+    cxobj *xv = NULL;
     cbuf  *cb = NULL;
     
     // Send the POST request
@@ -329,12 +325,10 @@ yang_patch_do_create(clixon_handle  h,
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
     }
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            if ((value_vec_tmp = xml_dup(value_vec[k])) == NULL)
-                goto done;
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
+    while ((xv = xml_child_each(xvalues, xv, CX_ERROR)) != NULL) {
+        if ((value_vec_tmp = xml_dup(xv)) == NULL)
+            goto done;
+        xml_addsub(x_simple_patch, value_vec_tmp);
     }
     if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
         goto done;
@@ -358,8 +352,7 @@ yang_patch_do_create(clixon_handle  h,
  * @param[in]  media_out        Output media
  * @param[in]  ds       0       if "data" resource, 1 if rfc8527 "ds" resource
  * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len    number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec        pointer to the "value" array of an edit in YANG patch
+ * @param[in]  xvalues          "value" of an edit in YANG patch, its children are the values
  * @param[in]  x_simple_patch   pointer to XML containing module name, e.g. <ietf-interfaces:interface/>
  * @param[in]  where_val       value in "where" field of edit in YANG patch
  * @param[in]  api_path        full API path, e.g. "/restconf/data/example-jukebox:jukebox/playlist=Foo-One" 
@@ -375,8 +368,7 @@ yang_patch_do_insert(clixon_handle  h,
                      restconf_media media_out,
                      ietf_ds_t      ds,
                      cbuf          *simple_patch_request_uri,
-                     int            value_vec_len,
-                     cxobj        **value_vec,
+                     cxobj         *xvalues,
                      cxobj         *x_simple_patch,
                      char          *where_val,
                      char          *api_path,
@@ -385,6 +377,7 @@ yang_patch_do_insert(clixon_handle  h,
 {
     int     retval = -1;
     cxobj  *value_vec_tmp = NULL;
+    cxobj  *xv = NULL;
     cbuf   *json_simple_patch;
     cg_var *cv;
     cbuf   *point_str = NULL;
@@ -399,11 +392,9 @@ yang_patch_do_insert(clixon_handle  h,
         goto done;
     }
     // Loop through the XML, and get each value
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
+    while ((xv = xml_child_each(xvalues, xv, CX_ERROR)) != NULL) {
+        value_vec_tmp = xml_dup(xv);
+        xml_addsub(x_simple_patch, value_vec_tmp);
     }
     if ((json_simple_patch = yang_patch_xml2json_modified_cbuf(x_simple_patch)) == NULL)
         goto done;
@@ -450,8 +441,7 @@ yang_patch_do_insert(clixon_handle  h,
  * @param[in]  media_out       Output media
  * @param[in]  ds       0      if "data" resource, 1 if rfc8527 "ds" resource
  * @param[in]  simple_patch_request_uri URI for patch request, e.g. "/restconf/data/ietf-interfaces:interfaces"
- * @param[in]  value_vec_len   number of elements in the "value" array of an edit in YANG patch
- * @param[in]  value_vec       pointer to the "value" array of an edit in YANG patch
+ * @param[in]  xvalues         "value" of an edit in YANG patch, its children are the values
  * @param[in]  x_simple_patch  pointer to XML containing module name, e.g. "<ietf-interfaces:interface/>"
  * @param[in]  where_val       value in "where" field of edit in YANG patch
  * @param[in]  key_xn          XML with key tag and value, e.g. "<name>Foo-One</name>"
@@ -467,14 +457,14 @@ yang_patch_do_merge(clixon_handle  h,
                     restconf_media media_out,
                     ietf_ds_t      ds,
                     cbuf          *simple_patch_request_uri,
-                    int            value_vec_len,
-                    cxobj        **value_vec,
+                    cxobj         *xvalues,
                     cxobj         *x_simple_patch,
                     cxobj         *key_xn
                     )
 {
     int    retval = -1;
     cxobj *value_vec_tmp = NULL;
+    cxobj *xv = NULL;
     cbuf  *cb = NULL;
     cbuf  *json_simple_patch = NULL;
         
@@ -486,11 +476,9 @@ yang_patch_do_merge(clixon_handle  h,
         xml_addsub(x_simple_patch, key_xn);
     
     // Loop through the XML, create JSON from each one, and submit a simple patch
-    for (int k = 0; k < value_vec_len; k++) {
-        if (value_vec[k] != NULL) {
-            value_vec_tmp = xml_dup(value_vec[k]);
-            xml_addsub(x_simple_patch, value_vec_tmp);
-        }
+    while ((xv = xml_child_each(xvalues, xv, CX_ERROR)) != NULL) {
+        value_vec_tmp = xml_dup(xv);
+        xml_addsub(x_simple_patch, value_vec_tmp);
         cbuf_reset(cb); /* reuse cb */
         if (clixon_json2cbuf(cb, x_simple_patch, 0, 0) < 0)
             goto done;
@@ -540,15 +528,13 @@ yang_patch_do_value(clixon_handle  h,
                     )
 {
     int     retval = -1;
-    cxobj **values_child_vec;
+    cxobj  *xvalues;
     char   *key_node_id;
     cbuf   *patch_header = NULL;
     cxobj  *x_simple_patch = NULL;
-    int     value_vec_len;
-    cxobj **value_vec;
 
-    values_child_vec = xml_childvec_get(xn);
-    key_node_id = xml_name(*values_child_vec);
+    xvalues = xml_child_i(xn, 0);
+    key_node_id = xml_name(xvalues);
     /* Create cbufs:s */
     if ((patch_header = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
@@ -557,23 +543,21 @@ yang_patch_do_value(clixon_handle  h,
     cprintf(patch_header, "%s:%s", modname, key_node_id);
     if ((x_simple_patch = xml_new(cbuf_get(patch_header), NULL, CX_ELMNT)) == NULL)
         goto done;
-    value_vec_len = xml_child_nr(*values_child_vec);
-    value_vec = xml_childvec_get(*values_child_vec);
     switch (operation){
     case YANG_PATCH_OP_REPLACE:
-        if (yang_patch_do_replace(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, target_val, value_vec_len, value_vec, x_simple_patch) < 0)
+        if (yang_patch_do_replace(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, target_val, xvalues, x_simple_patch) < 0)
             goto done;
         break;
     case YANG_PATCH_OP_CREATE:
-        if (yang_patch_do_create(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch) < 0)
+        if (yang_patch_do_create(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, xvalues, x_simple_patch) < 0)
             goto done;
         break;
     case YANG_PATCH_OP_INSERT:
-        if (yang_patch_do_insert(h, req, pi, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, where_val, api_path, point_val) < 0)
+        if (yang_patch_do_insert(h, req, pi, pretty, media_out, ds, simple_patch_request_uri, xvalues, x_simple_patch, where_val, api_path, point_val) < 0)
             goto done;
         break;
     case YANG_PATCH_OP_MERGE:
-        if (yang_patch_do_merge(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, value_vec_len, value_vec, x_simple_patch, key_xn) < 0)
+        if (yang_patch_do_merge(h, req, pi, qvec, pretty, media_out, ds, simple_patch_request_uri, xvalues, x_simple_patch, key_xn) < 0)
             goto done;
         break;
     default:
@@ -626,7 +610,6 @@ yang_patch_do_edit(clixon_handle  h,
     char      *point_val = NULL;
     char      *target_val = NULL;
     char      *modname;
-    cxobj    **key_vec = NULL;
     cxobj     *key_xn = NULL;
     int        i;
     cxobj     *x; /* general purpose xml-tree pointer */
@@ -696,8 +679,7 @@ yang_patch_do_edit(clixon_handle  h,
         goto done;
     modname = yang_argument_get(ymod);
     // XXX this seems to be hardcoded to a yang list?
-    if ((key_vec = xml_childvec_get(xbot)) != NULL)
-        key_xn = key_vec[0];
+    key_xn = xml_child_i(xbot, 0);
     // Get values (for "delete" and "remove", there are no values)
     xpath_vec(xn, NULL, "value", &vec, &veclen);
 
@@ -1067,11 +1067,11 @@ restconf_connection_close1(restconf_conn *rc)
     }
     rsock = rc->rc_socket;
     clixon_debug(CLIXON_DBG_RESTCONF, "%s", rsock->rs_description?rsock->rs_description:"");
+    clixon_event_unreg_fd(rc->rc_s, restconf_connection);
     if (close(rc->rc_s) < 0){
         clixon_err(OE_UNIX, errno, "close");
         goto done;
     }
-    clixon_event_unreg_fd(rc->rc_s, restconf_connection);
     /* re-set timer */
     if (rc->rc_callhome){
         if (rsock->rs_periodic)
@@ -70,7 +70,7 @@
 #include <clixon/clixon_backend.h>
 
 /* Command line options to be passed to getopt(3) */
-#define BACKEND_EXAMPLE_OPTS "a:m:M:n:rsS:x:iuUtV:"
+#define BACKEND_EXAMPLE_OPTS "a:A:C:m:M:n:rsS:x:iuUtV:"
 
 /* Enabling this improves performance in tests, but there may trigger the "double XPath"
  * problem.
@@ -118,6 +118,19 @@ static int _reset = 0;
  */
 static int _state = 0;
 
+/*! Asynchronous state callbacks done after a delay in ms
+ *
+ * Simulates state retrieved from a dataplane daemon over IPC
+ * Start backend with -- -A <ms>
+ */
+static int _state_async_ms = 0;
+
+/*! Time-to-live in ms of cached state of all subtrees of the state callback
+ *
+ * Start backend with -- -C <ms>
+ */
+static uint32_t _state_cache_ms = 0;
+
 /*! File where state XML is read from, if _state is true -- -sS <file>
  *
  * Primarily for testing
@@ -545,6 +558,100 @@ example_statedata(clixon_handle   h,
     return retval;
 }
 
+/*! Pending asynchronous state request
+ */
+struct example_async {
+    clixon_handle ea_h;
+    uint32_t      ea_id;  /* Id of asynchronous state callback */
+    int           ea_op;  /* Value of state op leaf-list */
+};
+
+/*! Reply of simulated dataplane has arrived, asynchronous state callback is done
+ *
+ * @param[in]  s      Not used
+ * @param[in]  arg    Pending asynchronous state request
+ */
+static int
+example_statedata_async_reply(int   s,
+                              void *arg)
+{
+    int                   retval = -1;
+    struct example_async *ea = (struct example_async *)arg;
+    cbuf                 *cb = NULL;
+    cxobj                *xstate = NULL;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "<state xmlns=\"urn:example:clixon\"><op>%d</op></state>", ea->ea_op);
+    if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xstate, NULL) < 0)
+        goto done;
+    /* xstate is consumed */
+    if (clixon_plugin_statedata_async_done(ea->ea_h, ea->ea_id, xstate) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    free(ea);
+    return retval;
+}
+
+/*! Start asynchronous state request to simulated dataplane, reply after -A <ms>
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  nsc    Namespace context of xpath
+ * @param[in]  xpath  Requested xpath
+ * @param[in]  id     Id of asynchronous state callback
+ * @param[in]  op     Value of state op leaf-list in reply
+ * @see clixon_plugin_statedata_async_register
+ */
+static int
+example_statedata_async_start(clixon_handle h,
+                              uint32_t      id,
+                              int           op)
+{
+    struct example_async *ea;
+    struct timeval        t;
+    struct timeval        t1;
+
+    if ((ea = malloc(sizeof(*ea))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return -1;
+    }
+    ea->ea_h = h;
+    ea->ea_id = id;
+    ea->ea_op = op;
+    gettimeofday(&t, NULL);
+    t1.tv_sec = _state_async_ms/1000;
+    t1.tv_usec = (_state_async_ms%1000)*1000;
+    timeradd(&t, &t1, &t);
+    return clixon_event_reg_timeout(t, example_statedata_async_reply, ea, "example async state");
+}
+
+/*! Asynchronous state callback of first simulated dataplane daemon
+ */
+static int
+example_statedata_async1(clixon_handle h,
+                         cvec         *nsc,
+                         char         *xpath,
+                         uint32_t      id)
+{
+    return example_statedata_async_start(h, id, 44);
+}
+
+/*! Asynchronous state callback of second simulated dataplane daemon
+ */
+static int
+example_statedata_async2(clixon_handle h,
+                         cvec         *nsc,
+                         char         *xpath,
+                         uint32_t      id)
+{
+    return example_statedata_async_start(h, id, 45);
+}
+
 /*! Called to get state data from plugin by reading a file, also pagination
  *
  * The example shows how to read and parse a state XML file, (which is cached in the -i case).
@@ -1440,6 +1547,7 @@ clixon_plugin_init(clixon_handle h)
     int            argc; /* command-line options (after --) */
     char         **argv;
     int            c;
+    cvec          *nsc = NULL;
 
     clixon_debug(CLIXON_DBG_INIT, "backend");
 
@@ -1453,6 +1561,12 @@ clixon_plugin_init(clixon_handle h)
         case 'a':
             _action_instanceid = optarg;
             break;
+        case 'A': /* asynchronous state callbacks */
+            _state_async_ms = atoi(optarg);
+            break;
+        case 'C': /* state cache time-to-live */
+            _state_cache_ms = atoi(optarg);
+            break;
         case 'm':
             _mount_yang = optarg;
             break;
@@ -1494,6 +1608,27 @@ clixon_plugin_init(clixon_handle h)
         clixon_err(OE_PLUGIN, EINVAL, "Both -m and -M must be given for mounts");
         goto done;
     }
+    /* Subtrees of example_statedata, it is not called for requests of other data */
+    if ((nsc = xml_nsctx_init("if", "urn:ietf:params:xml:ns:yang:ietf-interfaces")) == NULL)
+        goto done;
+    if (xml_nsctx_add(nsc, "ex", "urn:example:clixon") < 0)
+        goto done;
+    if (xml_nsctx_add(nsc, "ev", "urn:example:events") < 0)
+        goto done;
+    if (clixon_plugin_statedata_cache_register(h, example_statedata, nsc, "/if:interfaces", _state_cache_ms) < 0)
+        goto done;
+    if (clixon_plugin_statedata_cache_register(h, example_statedata, nsc, "/ex:state", _state_cache_ms) < 0)
+        goto done;
+    if (clixon_plugin_statedata_cache_register(h, example_statedata, nsc, "/ev:events", _state_cache_ms) < 0)
+        goto done;
+    if (_state_async_ms){
+        if (clixon_plugin_statedata_async_register(h, example_statedata_async1, nsc, "/ex:state") < 0)
+            goto done;
+        if (clixon_plugin_statedata_async_register(h, example_statedata_async2, nsc, "/ex:state") < 0)
+            goto done;
+    }
+    xml_nsctx_free(nsc);
+    nsc = NULL;
     if (_state_file){
         api.ca_statedata = example_statefile; /* Switch state data callback */
         if (_state_xpath){
@@ -1572,5 +1707,7 @@ clixon_plugin_init(clixon_handle h)
     /* Return plugin API */
     return &api;
  done:
+    if (nsc)
+        xml_nsctx_free(nsc);
     return NULL;
 }
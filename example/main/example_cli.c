@@ -161,6 +161,111 @@ example_client_rpc(clixon_handle h,
     return retval;
 }
 
+/*! Print id, message-id and x of a reply of the example rpc
+ */
+static int
+example_client_rpc_print(cbuf    *cb,
+                         uint32_t id,
+                         cxobj   *xret)
+{
+    cxobj *xr;
+    cxobj *x = NULL;
+    char  *msgid = NULL;
+
+    if ((xr = xml_find_type(xret, NULL, "rpc-reply", CX_ELMNT)) != NULL){
+        msgid = xml_find_value(xr, "message-id");
+        x = xml_find_type(xr, NULL, "x", CX_ELMNT);
+    }
+    cprintf(cb, "%u %s %s\n", id, msgid?msgid:"-", x?xml_body(x):"error");
+    return 0;
+}
+
+/*! Reply callback of pipelined example rpc
+ */
+static int
+example_client_rpc_reply(clixon_handle h,
+                         uint32_t      id,
+                         cxobj        *xret,
+                         void         *arg)
+{
+    cbuf *cb = (cbuf *)arg;
+
+    if (xret == NULL){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Backend closed");
+        return -1;
+    }
+    return example_client_rpc_print(cb, id, xret);
+}
+
+/*! Example of pipelined "downcalls", send several RPCs to the backend without waiting
+ *
+ * All but the last reply are delivered to a callback, the last is waited for.
+ * Replies are printed in the order they arrive: request id, message-id and x
+ * @param[in]  h     Clixon handle
+ * @param[in]  cvv   Vector of cli string and instantiated variables
+ * @param[in]  argv  Number of requests
+ */
+int
+example_client_rpc_pipeline(clixon_handle h,
+                            cvec         *cvv,
+                            cvec         *argv)
+{
+    int                retval = -1;
+    cg_var            *cva;
+    int                nr;
+    int                i;
+    struct clicon_msg *msg = NULL;
+    uint32_t           id = 0;
+    cxobj             *xret = NULL;
+    cbuf              *cb = NULL;
+
+    if (cvec_len(argv) != 1){
+        clixon_err(OE_PLUGIN, EINVAL, "Expected argument: <nr>");
+        goto done;
+    }
+    if ((nr = atoi(cv_string_get(cvec_i(argv, 0)))) < 1){
+        clixon_err(OE_PLUGIN, EINVAL, "Invalid number of requests");
+        goto done;
+    }
+    cva = cvec_find(cvv, "a");
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    for (i = 1; i <= nr; i++){
+        if ((msg = clicon_msg_encode(0, "<rpc xmlns=\"%s\" username=\"%s\" message-id=\"%d\">"
+                                     "<example xmlns=\"urn:example:clixon\"><x>%s-%d</x></example></rpc>",
+                                     NETCONF_BASE_NAMESPACE,
+                                     clicon_username_get(h),
+                                     i,
+                                     cv_string_get(cva), i)) == NULL)
+            goto done;
+        if (clicon_rpc_async_msg(h, msg, i<nr?example_client_rpc_reply:NULL, cb, &id) < 0)
+            goto done;
+        free(msg);
+        msg = NULL;
+    }
+    /* Earlier replies are delivered to the callback while waiting */
+    if (clicon_rpc_async_wait(h, id, &xret) < 0)
+        goto done;
+    if (example_client_rpc_print(cb, id, xret) < 0)
+        goto done;
+    if (clicon_rpc_async_pending(h) != 0){
+        clixon_err(OE_PROTO, EFAULT, "Replies missing");
+        goto done;
+    }
+    cligen_output(stdout, "%s", cbuf_get(cb));
+    retval = 0;
+ done:
+    if (msg)
+        free(msg);
+    if (xret)
+        xml_free(xret);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
 /*! Translate function from an original value to a new.
  *
  * In this case, assume string and increment characters, eg HAL->IBM
@@ -47,14 +47,23 @@
  */
 #undef RPC_USERNAME_ASSERT
 
-/*! Optimize special list key searches in XPath finds
+/*! Optimize list key searches in XPath finds
  *
- * Identify xpaths that search for exactly a list key, eg: "y[k='3']" and then call
- * binary search. This only works if "y" has proper yang binding and is sorted by system
- * Dont optimize on "hierarchical" lists such as: a/y[k='3'], where a is another list.
+ * Identify xpath steps whose predicates are all equalities and cover the list keys,
+ * eg: "y[k1='3'][k2='4']" or "y[k2='4' and k1='3']", or a leaf-list value: "y[.='3']",
+ * and then call binary search. Also applies to nested lists, eg a[k='1']/y[k='3'].
+ * This only works if "y" has proper yang binding.
  */
 #define XPATH_LIST_OPTIMIZE
 
+/*! Cache parsed XPath trees
+ *
+ * Number of parsed xpath-trees kept in a least-recently-used cache keyed by xpath string,
+ * so that xpath_vec_ctx() and the xpath API functions do not parse the same xpath again.
+ * Undefine to parse every time.
+ */
+#define XPATH_CACHE_SIZE 256
+
 /*! Add explicit search indexes, so that binary search can be made for non-key list indexes
  *
  * This also applies if there are multiple keys and you want to search on only the second for 
@@ -76,6 +85,21 @@
  */
 #define STATE_ORDERED_BY_SYSTEM
 
+/*! Max number of entries in the backend state cache
+ *
+ * State of callbacks with a time-to-live is cached per plugin and requested xpath.
+ * When full, expired entries are removed, and if still full, all entries.
+ * @see clixon_plugin_statedata_cache_register
+ */
+#define STATE_CACHE_SIZE 256
+
+/*! Max number of users with compiled NACM data node rules
+ *
+ * NACM rules are compiled per user on first access and kept until the NACM config changes.
+ * When full, all compiled rules are discarded.
+ */
+#define NACM_COMPILED_USERS 64
+
 /*! Top-symbol in clixon datastores
  *
  * This is traditionally same as NETCONF_INPUT_CONFIG ("config") but can be different
@@ -107,12 +131,36 @@
  */
 #define XML_PARENT_CANDIDATE
 
+/*! Allocate the transient XML reply tree of get/get-config in an arena
+ *
+ * Nodes copied from the datastore cache are allocated in large blocks and freed together
+ * when the reply has been sent, see xml_arena_new()
+ */
+#define XML_ARENA_GET
+
+/*! Store children of large ordered-by system lists in chunks
+ *
+ * When a list parent has more than XML_CHILDVEC_CHUNK_THRESHOLD children and a child is
+ * inserted or removed in the middle, the flat child vector is converted to a vector of
+ * fixed-size chunks so that an insert or remove only moves pointers within one chunk.
+ * Iteration and binary search work as before, via xml_child_i and xml_child_each.
+ */
+#define XML_CHILD_CHUNKS
+
 /*! Enable "remaining" attribute (sub-feature of list pagination)
  *
  * See "remaining" annotation defined in module ietf-list-pagination.yang
  */
 #undef LIST_PAGINATION_REMAINING
 
+/*! Max number of cached sorted views used by list pagination with sort-by
+ *
+ * A view is a vector of list entries in a datastore cache sorted by a leaf.
+ * It is reused by subsequent requests until the datastore changes.
+ * If not set, the list is sorted on every sort-by request
+ */
+#define LIST_PAGINATION_VIEWS 8
+
 /*! If backend is restarted, cli and netconf client will retry (once) and reconnect
  *
  * Note, if client has locked or had edits in progress, these will be lost
@@ -121,6 +169,32 @@
  */
 #define PROTO_RESTART_RECONNECT
 
+/*! Stream large backend replies to clients in NETCONF chunks of this size while serializing
+ *
+ * Also bounds the output queued for a client before the backend waits for it to read.
+ * Output is otherwise sent with non-blocking writes from the event loop.
+ * If not set, a reply is assembled in memory and sent when complete
+ * @see clixon_msg_writer_new
+ */
+#define REPLY_STREAM_BUFSIZE 65536
+
+/*! Bound of output queued on an asynchronous backend client socket
+ *
+ * Pipelined requests are sent without blocking until this much output is queued,
+ * so that the client can read replies while the backend reads requests
+ * @see clicon_rpc_async_msg
+ */
+#define RPC_ASYNC_BUFSIZE 1048576
+
+/*! Min number of nodes of a tree for parallel validation
+ *
+ * Smaller trees are validated serially also if CLICON_VALIDATE_WORKERS is set, since
+ * the cost of forking workers is larger than the gain.
+ * If not set, validation is always serial
+ * @see xml_yang_validate_all_top
+ */
+#define VALIDATE_PARALLEL_MIN 10000
+
 /*! Disable top-level prefix for text syntax printing and parsing introduced in 5.8
  *
  * Note this is for showing/saving/printing, it is NOT for parsing/loading.
@@ -205,6 +279,16 @@
  */
 #undef YANG_SPEC_LINENR
 
+/*! Index children of yang nodes for argument lookups
+ *
+ * If set, yang nodes with at least this number of children get a sorted index on argument,
+ * used by yang_find, yang_find_datanode and yang_find_schemanode instead of a linear scan.
+ * The index is built after parsing (yang_parse_post) and rebuilt on demand if the children
+ * of a node change.
+ * If not set, reduces memory with 8 bytes per yang-stmt.
+ */
+#define YANG_CHILD_INDEX 16
+
 /*! Use ref origin pointer to skip as many derived yang nodes as possible
  *
  * If set, do not copy some YANG nodes to derived trees (ie augmented or grouped trees)
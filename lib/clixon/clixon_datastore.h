@@ -56,6 +56,14 @@ struct db_elmnt {
                                  */
     int            de_empty;    /* Empty on read from file, xmldb_readfile and xmldb_put sets it */
     int            de_volatile; /* Disable auto-sync of cache to disk on every update (ie xmldb_put) */
+    int            de_journal;  /* All differences to running are marked with XML_FLAG_COMMIT_DIRTY
+                                 * Set when synced with running, reset when running is modified
+                                 */
+    uint32_t       de_wal_nr;   /* Number of records in write-ahead log, see CLICON_XMLDB_WAL */
+    uint32_t       de_wal_unsynced; /* Records appended to log since last fsync */
+    int            de_wal_replay; /* Log is being replayed, do not append */
+    uint64_t       de_snapshot; /* Generation of datastore file, 0 if unknown */
+    uint64_t       de_generation; /* Changed when cache is set or modified, see xmldb_generation_get */
 };
 typedef struct db_elmnt db_elmnt;
 
@@ -76,6 +84,9 @@ int xmldb_get(clixon_handle h, const char *db, cvec *nsc, char *xpath, cxobj **x
 int xmldb_get0(clixon_handle h, const char *db, yang_bind yb,
                cvec *nsc, const char *xpath, int copy, withdefaults_type wdef,
                cxobj **xret, modstate_diff_t *msd, cxobj **xerr);
+int xmldb_get_window(clixon_handle h, const char *db, cvec *nsc, const char *xparent,
+                     yang_stmt *ylist, char *sort_by, int backwards, uint32_t offset, uint32_t limit,
+                     withdefaults_type wdef, cxobj **xret, uint32_t *total);
 /* in clixon_datastore_write.[ch]: */
 int xmldb_put(clixon_handle h, const char *db, enum operation_type op, cxobj *xt, char *username, cbuf *cbret);
 int xmldb_dump(clixon_handle h, FILE *f, cxobj *xt, enum format_enum format, int pretty, withdefaults_type wdef, int multi, const char *multidb);
@@ -100,6 +111,10 @@ int xmldb_empty_get(clixon_handle h, const char *db);
 int xmldb_empty_set(clixon_handle h, const char *db, int value);
 int xmldb_volatile_get(clixon_handle h, const char   *db);
 int xmldb_volatile_set(clixon_handle h, const char *db, int value);
+int xmldb_journal_get(clixon_handle h, const char *db);
+int xmldb_journal_reset(clixon_handle h, const char *db);
+uint64_t xmldb_generation_get(clixon_handle h, const char *db);
+int xmldb_generation_bump(clixon_handle h, const char *db);
 int xmldb_print(clixon_handle h, FILE *f);
 int xmldb_rename(clixon_handle h, const char *db, const char *newdb, const char *suffix);
 int xmldb_populate(clixon_handle h, const char *db);
@@ -43,9 +43,13 @@ struct clicon_hash {
     char       *h_key;  /* Key must be NULL-terinated string */
     size_t      h_vlen;
     void       *h_val;
+    uint32_t    h_hash; /* Hash value of key */
 };
 typedef struct clicon_hash *clicon_hash_t;
 
+/* Note: clicon_hash_t * returned by clicon_hash_init is an opaque hash table handle,
+ * not a bucket vector */
+
 clicon_hash_t *clicon_hash_init (void);
 int            clicon_hash_free (clicon_hash_t *);
 clicon_hash_t  clicon_hash_lookup (clicon_hash_t *head, const char *key);
@@ -63,6 +63,9 @@ int nacm_datanode_write(clixon_handle h, cxobj *xr, cxobj *xt,
                         enum nacm_access access,
                         char *username, cxobj *xnacm, cbuf *cbret);
 int nacm_access_pre(clixon_handle h, char *peername, char *username, cxobj **xnacmp, cbuf *cbret);
+int nacm_compiled_reset(clixon_handle h);
+int nacm_compiled_stats(uint64_t *compiles, uint64_t *hits, uint32_t *users,
+                        uint64_t *skipped, uint64_t *pruned);
 int verify_nacm_user(clixon_handle h, enum nacm_credentials_t cred, char *peername, char *nacmname, char *rpcname, cbuf *cbret);
 
 #endif /* _CLIXON_NACM_H */
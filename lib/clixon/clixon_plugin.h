@@ -224,6 +224,7 @@ typedef int (plgreset_t)(clixon_handle h, const char *db);
  * @note The system will make an xpath check and filter out non-matching trees
  * @note The system does not validate the xml, unless CLICON_VALIDATE_STATE_XML is set
  * @see clixon_pagination_cb_register for special paginated state data callback
+ * @see clixon_plugin_statedata_register to only be called for requests of given subtrees
  */
 typedef int (plgstatedata_t)(clixon_handle h, cvec *nsc, char *xpath, cxobj *xtop);
 
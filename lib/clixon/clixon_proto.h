@@ -53,6 +53,24 @@ struct clicon_msg {
     char        op_body[0]; /* rest of message, actual data */
 };
 
+/*! Output queue and reply stream of a socket, see clixon_msg_writer_new
+ */
+typedef struct clixon_msg_writer clixon_msg_writer;
+
+/*! Callback when output queue of a writer passes its bound, see clixon_msg_writer_backpressure
+ *
+ * @param[in]  mw    Message writer
+ * @param[in]  full  1: more than the bound is queued, 0: drained below the bound
+ * @param[in]  arg   Argument given when registering
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+typedef int (clixon_msg_writer_fn_t)(clixon_msg_writer *mw, int full, void *arg);
+
+/*! Input buffer of a socket, see clixon_msg_reader_new
+ */
+typedef struct clixon_msg_reader clixon_msg_reader;
+
 /*
  * Prototypes
  */
@@ -74,8 +92,30 @@ int clixon_rpc10(int sock, const char *descr, cbuf *msgin, cbuf *msgret, int *eo
 
 /* NETCONF 1.1 */
 int clixon_msg_rcv11(int s, const char *descr, int intr, cbuf **cb, int *eof);
+int clicon_rpc_send(int sock, const char *descr, struct clicon_msg *msg);
 int clicon_rpc(int sock, const char *descr, struct clicon_msg *msg, char **xret, int *eof);
 int send_msg_reply(int s, const char *descr, char *data, uint32_t datalen);
 int send_msg_notify_xml(clixon_handle h, int s, const char *descr, cxobj *xev);
 
+/* NETCONF 1.1 streaming output */
+clixon_msg_writer *clixon_msg_writer_new(int s, size_t limit);
+int clixon_msg_writer_free(clixon_msg_writer *mw);
+int clixon_msg_writer_backpressure(clixon_msg_writer *mw, clixon_msg_writer_fn_t *fn, void *arg);
+int clixon_msg_writer_full(clixon_msg_writer *mw);
+int clixon_msg_writer_blocking(clixon_msg_writer *mw);
+int clixon_msg_writer_start(clixon_msg_writer *mw, cbuf *cb);
+int clixon_msg_writer_stop(clixon_msg_writer *mw);
+int clixon_msg_writer_check(cbuf *cb);
+int clixon_msg_writer_streamed(clixon_msg_writer *mw);
+int clixon_msg_writer_end(clixon_msg_writer *mw, const char *descr, char *data, size_t datalen);
+int clixon_msg_writer_flush(clixon_msg_writer *mw);
+size_t clixon_msg_writer_queued(clixon_msg_writer *mw);
+
+/* NETCONF 1.1 buffered input */
+clixon_msg_reader *clixon_msg_reader_new(int s);
+int clixon_msg_reader_free(clixon_msg_reader *mr);
+int clixon_msg_reader_read(clixon_msg_reader *mr, int *eof);
+int clixon_msg_reader_next(clixon_msg_reader *mr, const char *descr, cbuf **cb, int *eof);
+int clixon_msg_reader_rcv(clixon_msg_reader *mr, const char *descr, cbuf **cb, int *eof);
+
 #endif  /* _CLIXON_PROTO_H_ */
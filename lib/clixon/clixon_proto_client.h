@@ -42,6 +42,23 @@
 #ifndef _CLIXON_PROTO_CLIENT_H_
 #define _CLIXON_PROTO_CLIENT_H_
 
+/*
+ * Types
+ */
+/*! Reply callback of asynchronous backend rpc
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  id    Request id, see clicon_rpc_async_msg
+ * @param[in]  xret  Reply, or NULL if the backend socket was closed. Freed by caller
+ * @param[in]  arg   Callback argument
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+typedef int (clicon_rpc_async_cb)(clixon_handle h, uint32_t id, cxobj *xret, void *arg);
+
+/*
+ * Prototypes
+ */
 int clicon_rpc_connect(clixon_handle h, int *sock0);
 int clicon_rpc_msg(clixon_handle h, struct clicon_msg *msg, cxobj **xret0);
 int clicon_rpc_msg_persistent(clixon_handle h, struct clicon_msg *msg, cxobj **xret0, int *sock0);
@@ -71,5 +88,9 @@ int clicon_rpc_debug(clixon_handle h, int level);
 int clicon_rpc_restconf_debug(clixon_handle h, int level);
 int clicon_hello_req(clixon_handle h, char *transport, char *source_host, uint32_t *id);
 int clicon_rpc_restart_plugin(clixon_handle h, char *plugin);
+int clicon_rpc_async_msg(clixon_handle h, struct clicon_msg *msg, clicon_rpc_async_cb *fn, void *arg, uint32_t *id);
+int clicon_rpc_async_wait(clixon_handle h, uint32_t id, cxobj **xret);
+int clicon_rpc_async_pending(clixon_handle h);
+int clicon_rpc_async_close(clixon_handle h);
 
 #endif  /* _CLIXON_PROTO_CLIENT_H_ */
@@ -77,6 +77,8 @@ char  *clixon_trim2(char *str, char *trims);
 int    clicon_strcmp(char *s1, char *s2);
 int    clixon_unicode2utf8(char *ucstr, char *utfstr, size_t utflen);
 int    clixon_str_subst(char *str, cvec *cvv, cbuf *cb);
+char  *clixon_str_intern(const char *str);
+int    clixon_str_unintern(char *istr);
 
 #ifndef HAVE_STRNDUP
 char *clicon_strndup (const char *, size_t);
@@ -49,6 +49,10 @@ int xml_yang_validate_add(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_list_key_only(cxobj *xt, cxobj **xret);
 int xml_yang_validate_all(clixon_handle h, cxobj *xt, cxobj **xret);
 int xml_yang_validate_all_top(clixon_handle h, cxobj *xt, cxobj **xret);
+int xml_yang_validate_all_diff(clixon_handle h, cxobj *xt, cxobj **dvec, int dlen,
+                               cxobj **avec, int alen, cxobj **tcvec, int clen, cxobj **xret);
+int validate_leafref_stats(uint64_t *builds, uint64_t *hits, uint64_t *misses);
+int validate_xpath_stats(uint64_t *evaluated, uint64_t *skipped);
 int rpc_reply_check(clixon_handle h, char *rpcname, cbuf *cbret);
 
 #endif  /* _CLIXON_VALIDATE_H_ */
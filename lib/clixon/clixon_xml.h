@@ -179,8 +179,13 @@ typedef struct xml cxobj; /* struct defined in clicon_xml.c */
  */
 typedef int (xml_applyfn_t)(cxobj *x, void *arg);
 
+/* Function applied to the children of a node as a flat vector, see xml_childvec_apply */
+typedef int (xml_childvec_fn_t)(cxobj **vec, int len, void *arg);
+
 typedef struct clixon_xml_vec clixon_xvec; /* struct defined in clicon_xml_vec.c */
 
+typedef struct xml_arena xml_arena; /* struct defined in clicon_xml.c */
+
 /* Alternative tree formats,
  * @see format_int2str, format_str2int, datastore_format in clixon-lib.yang
  */
@@ -190,7 +195,8 @@ enum format_enum{
     FORMAT_TEXT,
     FORMAT_CLI,
     FORMAT_NETCONF,
-    FORMAT_DEFAULT
+    FORMAT_DEFAULT,
+    FORMAT_BINARY
 };
 
 /*
@@ -208,6 +214,8 @@ enum format_enum{
 #define XML_FLAG_BODYKEY  0x100 /* Text parsing key to be translated from body to key */
 #define XML_FLAG_ANYDATA  0x200 /* Treat as anydata, eg mount-points before bound */
 #define XML_FLAG_CACHE_DIRTY 0x400 /* This part of XML tree is not synced to disk */
+#define XML_FLAG_COMMIT_DIRTY 0x800 /* Changed since last commit (or sync with running) */
+#define XML_FLAG_ARENA    0x1000 /* Node is allocated in an arena, internal, do not set */
 
 /*
  * Prototypes
@@ -215,6 +223,9 @@ enum format_enum{
 char     *xml_type2str(enum cxobj_type type);
 int       xml_stats_global(uint64_t *nr);
 int       xml_stats(cxobj *xt, uint64_t *nrp, size_t *szp);
+xml_arena *xml_arena_new(void);
+xml_arena *xml_arena_set(xml_arena *xa);
+int       xml_arena_free(xml_arena *xa);
 char     *xml_name(cxobj *xn);
 int       xml_name_set(cxobj *xn, char *name);
 char     *xml_prefix(cxobj *xn);
@@ -253,6 +264,7 @@ cxobj    *xml_child_each_attr(cxobj *xparent, cxobj *xprev);
 int       xml_child_insert_pos(cxobj *x, cxobj *xc, int pos);
 int       xml_childvec_set(cxobj *x, int len);
 cxobj   **xml_childvec_get(cxobj *x);
+int       xml_childvec_apply(cxobj *x, xml_childvec_fn_t *fn, void *arg);
 int       clixon_child_xvec_append(cxobj *x, clixon_xvec *xv);
 cxobj    *xml_new(char *name, cxobj *xn_parent, enum cxobj_type type);
 cxobj    *xml_new_body(char *name, cxobj *parent, char *val);
@@ -301,8 +313,10 @@ cxobj    *xml_add_attr(cxobj *xn, char *name, char *value, char *prefix, char *n
 #ifdef XML_EXPLICIT_INDEX
 int       xml_search_index_p(cxobj *x);
 int       xml_search_vector_get(cxobj *x, char *name, clixon_xvec **xvec);
+int       xml_search_vector_new(cxobj *xp, char *name, clixon_xvec **xvec);
 int       xml_search_child_insert(cxobj *xp, cxobj *x);
 int       xml_search_child_rm(cxobj *xp, cxobj *x);
+int       xml_search_index_sync(cxobj *xp, cxobj *xc, int add);
 cxobj    *xml_child_index_each(cxobj *xparent, char *name, cxobj *xprev, enum cxobj_type type);
 
 #endif
@@ -66,7 +66,13 @@ int xml_diff(cxobj *x0, cxobj *x1,
              cxobj ***first, int *firstlen,
              cxobj ***second, int *secondlen,
              cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+int xml_diff_flagged(cxobj *x0, cxobj *x1, uint16_t flag,
+                     cxobj ***first, int *firstlen,
+                     cxobj ***second, int *secondlen,
+                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
 int xml_tree_equal(cxobj *x0, cxobj *x1);
+int xml_tree_sync(cxobj *x0, cxobj *x1);
+int xml_tree_sync_flagged(cxobj *x0, cxobj *x1, uint16_t flag);
 int xml_tree_prune_flagged_sub(cxobj *xt, int flag, int test, int *upmark);
 int xml_tree_prune_flagged(cxobj *xt, int flag, int test);
 int xml_tree_prune_flags(cxobj *xt, int flags, int mask);
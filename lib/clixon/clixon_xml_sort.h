@@ -44,6 +44,7 @@
 int xml_cmp(cxobj *x1, cxobj *x2, int same, int skip1, char *expl);
 int xml_sort(cxobj *x);
 int xml_sort_by(cxobj *x, char *indexvar);
+int xml_sort_vec_by(cxobj **vec, size_t len, char *indexvar);
 int xml_sort_recurse(cxobj *xn);
 int xml_insert(cxobj *xp, cxobj *xc, enum insert_type ins, char *key_val, cvec *nsckey);
 int xml_sort_verify(cxobj *x, void *arg);
@@ -55,5 +56,6 @@ int match_base_child(cxobj *x0, cxobj *x1c, yang_stmt *yc, cxobj **x0cp);
 int clixon_xml_find_index(cxobj *xp, yang_stmt *yp, char *ns, char *name,
                           cvec *cvk, clixon_xvec *xvec);
 int clixon_xml_find_pos(cxobj *xp, yang_stmt *yc, uint32_t pos, clixon_xvec *xvec);
+int xml_search_yang_range(cxobj *xp, yang_stmt *yc, int *first, int *nr);
 
 #endif /* _CLIXON_XML_SORT_H */
@@ -135,6 +135,8 @@ xpath_tree *xpath_tree_traverse(xpath_tree *xt, ...);
 int   xpath_tree_free(xpath_tree *xs);
 int   xpath_parse(const char *xpath, xpath_tree **xptree);
 int   xpath_vec_ctx(cxobj *xcur, cvec *nsc, const char *xpath, int localonly, xp_ctx  **xrp);
+int   xpath_cache_stats(uint64_t *hits, uint64_t *misses, uint32_t *nr);
+void  xpath_cache_exit(void);
 
 int    xpath_vec_bool(cxobj *xcur, cvec *nsc, const char *xpformat, ...) __attribute__ ((format (printf, 3, 4)));
 int    xpath_vec_flag(cxobj *xcur, cvec *nsc, const char *xpformat, uint16_t flags,
@@ -153,6 +155,7 @@ int xpath2canonical(const char *xpath0, cvec *nsc0, yang_stmt *yspec,
                     char **xpath1, cvec **nsc1, cbuf **cbreason);
 int xpath2canonical1(const char *xpath0, cvec *nsc0, yang_stmt *yspec, int exprstr,
                      char **xpath1, cvec **nsc1, cbuf **cbreason);
+int xpath_deps(const char *xpath, cvec **cvvp);
 int xpath_count(cxobj *xcur, cvec *nsc, const char *xpath, uint32_t *count);
 int xml2xpath(cxobj *x, cvec *nsc, int spec, int apostrophe, char **xpath);
 int xpath2xml(char *xpath, cvec *nsc, cxobj *xtop, yang_stmt *ytop,
@@ -39,9 +39,11 @@
 #define _CLIXON_XPATH_OPTIMIZE_H
 
 
-int  xpath_list_optimize_stats(int *hits);
+int  xpath_list_optimize_stats(uint64_t *hits, uint64_t *misses);
+int  xpath_index_stats(uint64_t *hits, uint64_t *misses, uint32_t *nr);
+int  xpath_index_threshold_set(uint32_t threshold);
 int  xpath_list_optimize_set(int enable);
 void xpath_optimize_exit(void);
-int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cxobj ***xvec0, int *xlen0);
+int  xpath_optimize_check(xpath_tree *xs, cxobj *xv, cvec *nsc, cxobj ***xvec0, int *xlen0);
 
 #endif /* _CLIXON_XPATH_OPTIMIZE_H */
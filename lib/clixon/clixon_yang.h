@@ -100,6 +100,11 @@
                                       * may be different from orig, therefore do not use link to
                                       * original. May also be due to deviations of derived trees
                                       */
+#ifdef YANG_CHILD_INDEX
+#define YANG_FLAG_CHILD_INDEX 0x4000 /* Children are indexed on argument, index is rebuilt
+                                      * on demand if removed, see yang_index_build
+                                      */
+#endif
 /*! Names of top-level data YANGs
  */
 #define YANG_DATA_TOP   "data"    /* "dbspec" */
@@ -296,6 +301,10 @@ int        ys_cp(yang_stmt *nw, yang_stmt *old);
 yang_stmt *ys_dup(yang_stmt *old);
 int        yn_insert(yang_stmt *ys_parent, yang_stmt *ys_child);
 int        yn_insert1(yang_stmt *ys_parent, yang_stmt *ys_child);
+#ifdef YANG_CHILD_INDEX
+int        yang_index_build(yang_stmt *yn);
+int        yang_index_reset(yang_stmt *yn);
+#endif
 yang_stmt *yn_iter(yang_stmt *yparent, int *inext);
 char      *yang_key2str(int keyword);
 int        yang_str2key(char *str);
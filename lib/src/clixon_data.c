@@ -448,6 +448,8 @@ clicon_nacm_ext(clixon_handle h)
 
 /*! Set NACM (rfc 8341) external XML parse tree, free old if any
  *
+ * Also changes the generation of the external NACM tree, so that rules compiled from
+ * the old tree are discarded
  * @param[in]  h   Clixon handle
  * @param[in]  xn  XML Nacm tree
  * @note only used if config option CLICON_NACM_MODE is external
@@ -458,9 +460,14 @@ clicon_nacm_ext_set(clixon_handle h,
                      cxobj        *x)
 {
     cxobj *x0 = NULL;
+    int    gen;
 
     if ((x0 = clicon_nacm_ext(h)) != NULL)
         xml_free(x0);
+    if ((gen = clicon_data_int_get(h, "nacm_ext_generation")) < 0)
+        gen = 0;
+    if (clicon_data_int_set(h, "nacm_ext_generation", gen+1) < 0)
+        return -1;
     return clicon_ptr_set(h, "nacm_xml", x);
 }
 
@@ -80,10 +80,15 @@
 #include "clixon_xml_bind.h"
 #include "clixon_xml_default.h"
 #include "clixon_xml_io.h"
+#include "clixon_xml_map.h"
 #include "clixon_json.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_wal.h"
+
+/* Last generation of any datastore cache, generations are unique over all datastores */
+static uint64_t _xmldb_generation = 0;
 
 /*! Get xml database element including id, xml cache, empty on startup and dirty bit
  *
@@ -120,6 +125,7 @@ clicon_db_elmnt_set(clixon_handle h,
 {
     clicon_hash_t  *cdat = clicon_db_elmnt(h);
 
+    de->de_generation = ++_xmldb_generation;
     if (clicon_hash_add(cdat, db, de, sizeof(*de))==NULL)
         return -1;
     return 0;
@@ -271,6 +277,7 @@ xmldb_disconnect(clixon_handle h)
                 de->de_xml = NULL;
             }
         }
+    xmldb_views_free();
     retval = 0;
  done:
     if (keys)
@@ -278,6 +285,38 @@ xmldb_disconnect(clixon_handle h)
     return retval;
 }
 
+/*! Reset commit dirty flag, only descend into marked subtrees
+ *
+ * @param[in]  x    XML node
+ * @param[in]  arg  Not used
+ * @retval     2    Locally abort this subtree, continue with others
+ * @retval     0    OK, continue
+ */
+static int
+xmldb_journal_clear_fn(cxobj *x,
+                       void  *arg)
+{
+    if (xml_flag(x, XML_FLAG_COMMIT_DIRTY) == 0)
+        return 2;
+    xml_flag_reset(x, XML_FLAG_COMMIT_DIRTY);
+    return 0;
+}
+
+/*! Clear commit journal of a datastore cache, ie all XML_FLAG_COMMIT_DIRTY flags
+ *
+ * @param[in]  xt   XML cache top, may be NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmldb_journal_clear(cxobj *xt)
+{
+    if (xt == NULL)
+        return 0;
+    xml_flag_reset(xt, XML_FLAG_COMMIT_DIRTY);
+    return xml_apply(xt, CX_ELMNT, xmldb_journal_clear_fn, NULL);
+}
+
 /*! Copy datastore from db1 to db2
  *
  * May include copying datastore directory structure
@@ -304,6 +343,8 @@ xmldb_copy(clixon_handle h,
     char       *todir = NULL;
     char       *subdir = NULL;
     struct stat st = {0,};
+    int         ret;
+    uint16_t    flag = 0x0;
 
     clixon_debug(CLIXON_DBG_DATASTORE, "%s %s", from, to);
     /* XXX lock */
@@ -327,12 +368,13 @@ xmldb_copy(clixon_handle h,
         if (xml_copy(x1, x2) < 0) 
             goto done;
     }
-    else{ /* copy x1 to x2 */
-        xml_free(x2);
-        if ((x2 = xml_new(xml_name(x1), NULL, CX_ELMNT)) == NULL)
-            goto done;
-        xml_flag_set(x2, XML_FLAG_TOP);
-        if (xml_copy(x1, x2) < 0) 
+    else{ /* sync x2 with x1: only copy subtrees that differ, eg commit of small changes */
+        /* If the commit journal of the non-running datastore is valid, all differences
+         * are marked and only marked subtrees need to be traversed */
+        if ((strcmp(to, "running") == 0 && xmldb_journal_get(h, from)) ||
+            (strcmp(from, "running") == 0 && xmldb_journal_get(h, to)))
+            flag = XML_FLAG_COMMIT_DIRTY;
+        if (xml_tree_sync_flagged(x2, x1, flag) < 0)
             goto done;
     }
     /* always set cache although not strictly necessary in case 1
@@ -352,6 +394,27 @@ xmldb_copy(clixon_handle h,
         }
     }
     clicon_db_elmnt_set(h, to, &de0);
+    /* Maintain commit journals, see xmldb_journal_get */
+    if (strcmp(to, "running") == 0){
+        if (xmldb_journal_reset(h, to) < 0)
+            goto done;
+        if (xmldb_journal_clear(x2) < 0)
+            goto done;
+        if (x1 && (de1 = clicon_db_elmnt_get(h, from)) != NULL){
+            if (xmldb_journal_clear(x1) < 0)
+                goto done;
+            de1->de_journal = 1;
+        }
+    }
+    else if ((de2 = clicon_db_elmnt_get(h, to)) != NULL){
+        if (x2 && strcmp(from, "running") == 0){
+            if (xmldb_journal_clear(x2) < 0)
+                goto done;
+            de2->de_journal = 1;
+        }
+        else
+            de2->de_journal = 0;
+    }
     /* Copy the files themselves (above only in-memory cache)
      * Alt, dump the cache to file
      */
@@ -359,7 +422,13 @@ xmldb_copy(clixon_handle h,
         goto done;
     if (xmldb_db2file(h, to, &tofile) < 0)
         goto done;
-    if (clicon_file_copy(fromfile, tofile) < 0)
+    /* With write-ahead log, datastore files may be equal and only the logs differ
+     * Otherwise the whole file is copied */
+    ret = 0;
+    if (clicon_option_bool(h, "CLICON_XMLDB_WAL") &&
+        (ret = xmldb_wal_copy(h, from, to)) < 0)
+        goto done;
+    if (ret == 0 && clicon_file_copy(fromfile, tofile) < 0)
         goto done;
     if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")) {
         if (xmldb_db2subdir(h, from, &fromdir) < 0)
@@ -563,7 +632,7 @@ xmldb_clear(clixon_handle h,
             de->de_xml = NULL;
         }
     }
-    return 0;
+    return xmldb_journal_reset(h, db);
 }
 
 /*! Delete database, clear cache if any. Remove file and dir
@@ -599,6 +668,9 @@ xmldb_delete(clixon_handle h,
             clixon_err(OE_DB, errno, "truncate %s", filename);
             goto done;
         }
+    if (clicon_option_bool(h, "CLICON_XMLDB_WAL") &&
+        xmldb_wal_truncate(h, db, 0) < 0)
+        goto done;
     if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
         if (xmldb_db2subdir(h, db, &subdir) < 0)
             goto done;
@@ -665,6 +737,8 @@ xmldb_create(clixon_handle h,
             de->de_xml = NULL;
         }
     }
+    if (xmldb_journal_reset(h, db) < 0)
+        goto done;
     if (clicon_option_bool(h, "CLICON_XMLDB_MULTI")){
         if (xmldb_db2subdir(h, db, &subdir) < 0)
             goto done;
@@ -681,6 +755,9 @@ xmldb_create(clixon_handle h,
         clixon_err(OE_UNIX, errno, "open(%s)", filename);
         goto done;
     }
+    if (clicon_option_bool(h, "CLICON_XMLDB_WAL") &&
+        xmldb_wal_truncate(h, db, 0) < 0)
+        goto done;
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
@@ -868,6 +945,110 @@ xmldb_volatile_set(clixon_handle h,
     return 0;
 }
 
+/*! Get commit journal status of datastore
+ *
+ * If set, all nodes in the datastore cache that differ from running are marked with
+ * XML_FLAG_COMMIT_DIRTY (or an ancestor is marked with ADD/DEL semantics).
+ * The journal is set when a datastore is synced with running (commit or discard) and
+ * maintained by xmldb_put. It is reset if running is modified in any other way.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @retval     1     Journal is valid, a diff against running can skip unmarked subtrees
+ * @retval     0     Journal is not valid, make a full diff
+ * @see xml_diff_flagged
+ */
+int
+xmldb_journal_get(clixon_handle h,
+                  const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    if (de->de_xml == NULL)
+        return 0;
+    return de->de_journal;
+}
+
+/*! Invalidate commit journal of datastore
+ *
+ * Also changes the generation of the datastore cache
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name. If "running", invalidate journal of all datastores
+ * @retval     0     OK
+ * @retval    -1    Error
+ */
+int
+xmldb_journal_reset(clixon_handle h,
+                    const char   *db)
+{
+    int       retval = -1;
+    char    **keys = NULL;
+    size_t    klen;
+    int       i;
+    db_elmnt *de;
+
+    if (xmldb_generation_bump(h, db) < 0)
+        goto done;
+    if (strcmp(db, "running") != 0){
+        if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+            de->de_journal = 0;
+        goto ok;
+    }
+    if (clicon_hash_keys(clicon_db_elmnt(h), &keys, &klen) < 0)
+        goto done;
+    for(i = 0; i < klen; i++)
+        if ((de = clicon_hash_value(clicon_db_elmnt(h), keys[i], NULL)) != NULL)
+            de->de_journal = 0;
+ ok:
+    retval = 0;
+ done:
+    if (keys)
+        free(keys);
+    return retval;
+}
+
+/*! Get generation of datastore cache
+ *
+ * The generation changes whenever the cache is replaced, cleared or modified, ie it can be
+ * used to check if data derived from the cache, such as a sorted view, is still valid.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @retval     gen   Generation, unique over all datastores
+ * @retval     0     No such datastore
+ */
+uint64_t
+xmldb_generation_get(clixon_handle h,
+                     const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL)
+        return 0;
+    return de->de_generation;
+}
+
+/*! Change generation of datastore cache
+ *
+ * Must be called whenever the cache may have been modified in place without being set with
+ * clicon_db_elmnt_set, including partial modifications on error, since data derived from the
+ * cache may otherwise refer to removed nodes.
+ * @param[in]  h     Clixon handle
+ * @param[in]  db    Database name
+ * @retval     0     OK
+ * @see xmldb_generation_get
+ */
+int
+xmldb_generation_bump(clixon_handle h,
+                      const char   *db)
+{
+    db_elmnt *de;
+
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        de->de_generation = ++_xmldb_generation;
+    return 0;
+}
+
 /* Print the datastore meta-info to file
  */
 int
@@ -936,6 +1117,9 @@ xmldb_rename(clixon_handle h,
         clixon_err(OE_UNIX, errno, "rename: %s", strerror(errno));
         goto done;
     };
+    if (clicon_option_bool(h, "CLICON_XMLDB_WAL") &&
+        xmldb_wal_rename(h, db, old, fname) < 0)
+        goto done;
     retval = 0;
  done:
     if (cb)
@@ -977,6 +1161,10 @@ xmldb_populate(clixon_handle h,
         if (xml_default_recurse(x, 0, 0) < 0)
             goto done;
     }
+    /* Defaults may have been added to running */
+    if (strcmp(db, "running") == 0 &&
+        xmldb_journal_reset(h, db) < 0)
+        goto done;
     retval = ret;
  done:
     return retval;
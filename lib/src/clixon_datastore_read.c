@@ -75,6 +75,7 @@
 #include "clixon_nacm.h"
 #include "clixon_path.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_xml_binary.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_parse_lib.h"
 #include "clixon_xml_map.h"
@@ -83,6 +84,7 @@
 #include "clixon_xml_nsctx.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_read.h"
+#include "clixon_datastore_wal.h"
 
 #define handle(xh) (assert(text_handle_check(xh)==0),(struct text_handle *)(xh))
 
@@ -570,6 +572,7 @@ xmldb_readfile(clixon_handle    h,
     cxobj           *x;
     yang_stmt       *yspec1 = NULL;
     struct xmldb_multi_read_arg mr = {0, };
+    int              bound = 0;      /* Binary format: tree is already bound and sorted */
 
     if (yb != YB_MODULE && yb != YB_NONE){
         clixon_err(OE_XML, EINVAL, "yb is %d but should be module or none", yb);
@@ -610,6 +613,14 @@ xmldb_readfile(clixon_handle    h,
         if (clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
             goto done;
         break;
+    case FORMAT_BINARY:
+        if ((ret = clixon_binary_parse_file(fp, yb==YB_MODULE?yspec:NULL, &x0, &bound)) < 0)
+            goto done;
+        /* Not binary: import XML text file, it is written as binary on next save */
+        if (ret == 0 &&
+            clixon_xml_parse_file(fp, YB_NONE, yspec, &x0, xerr) < 0)
+            goto done;
+        break;
     default:
         clixon_err(OE_DB, 0, "Format %s not supported", formatstr);
         goto done;
@@ -725,14 +736,19 @@ xmldb_readfile(clixon_handle    h,
                 }
             }
         } /* if msdiff */
-        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT 
+        /* xml looks like: <top><config><x>... actually YB_MODULE_NEXT
+         * Binary datastores are already bound and sorted unless yang modules changed
          */
-        if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, xerr)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-        if (xml_sort_recurse(x0) < 0)
-            goto done;
+        if (!bound || yspec1 != NULL){
+            if ((ret = xml_bind_yang(h, x0, YB_MODULE, yspec1?yspec1:yspec, xerr)) < 0)
+                goto done;
+            if (ret == 0)
+                goto fail;
+            if (xml_sort_recurse(x0) < 0)
+                goto done;
+        }
+        else
+            clixon_debug(CLIXON_DBG_DATASTORE, "%s: binary datastore pre-bound, no bind and sort", db);
     }
     if (xp){
         *xp = x0;
@@ -805,6 +821,7 @@ xmldb_get_cache(clixon_handle     h,
     cxobj     *x1t = NULL;
     db_elmnt   de0 = {0,};
     int        ret;
+    xml_arena *xa0 = NULL;
 
     clixon_debug(CLIXON_DBG_DATASTORE, "db %s", db);
     if (xret == NULL){
@@ -817,6 +834,8 @@ xmldb_get_cache(clixon_handle     h,
     }
     de = clicon_db_elmnt_get(h, db);
     if (de == NULL || de->de_xml == NULL){ /* Cache miss, read XML from file */
+        /* The cache is persistent, never allocate it in an active arena */
+        xa0 = xml_arena_set(NULL);
         /* If there is no xml x0 tree (in cache), then read it from file */
         /* xml looks like: <top><config><x>... where "x" is a top-level symbol in a module */
         if ((ret = xmldb_readfile(h, db, yb, yspec, &x0t, &de0, msdiff, xerr)) < 0)
@@ -839,6 +858,13 @@ xmldb_get_cache(clixon_handle     h,
             if (xml_default_recurse(x0t, 0, 0) < 0)
                 goto done;
         }
+        /* Replay write-ahead log on cache, requires yang binding */
+        if (yb == YB_MODULE && clicon_option_bool(h, "CLICON_XMLDB_WAL")){
+            if (xmldb_wal_replay(h, db) < 0)
+                goto done;
+        }
+        xml_arena_set(xa0);
+        xa0 = NULL;
     } /* x0t == NULL */
     else
         x0t = de->de_xml;
@@ -898,6 +924,8 @@ xmldb_get_cache(clixon_handle     h,
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (xa0)
+        xml_arena_set(xa0);
     if (xvec)
         free(xvec);
     return retval;
@@ -1017,3 +1045,296 @@ xmldb_get0(clixon_handle    h,
     retval = 0;
     goto done;
 }
+
+#ifdef LIST_PAGINATION_VIEWS
+/* Cached view of list entries in a datastore cache sorted by a leaf, see xmldb_get_window
+ * Most recently used first
+ */
+struct xmldb_view{
+    qelem_t     xv_q;          /* Queue header */
+    char       *xv_db;         /* Datastore name */
+    cxobj      *xv_parent;     /* Parent of list entries in datastore cache, not dereferenced
+                                  unless generation is valid */
+    yang_stmt  *xv_ylist;      /* Yang list or leaf-list */
+    char       *xv_sort_by;    /* Sort-by leaf */
+    uint64_t    xv_generation; /* Datastore generation when view was built */
+    cxobj     **xv_vec;        /* Sorted list entries */
+    int         xv_len;        /* Length of xv_vec */
+};
+
+static struct xmldb_view *_xmldb_views = NULL;
+static int                _xmldb_views_nr = 0;
+
+static void
+xmldb_view_free(struct xmldb_view *xv)
+{
+    if (xv->xv_db)
+        free(xv->xv_db);
+    if (xv->xv_sort_by)
+        free(xv->xv_sort_by);
+    if (xv->xv_vec)
+        free(xv->xv_vec);
+    free(xv);
+}
+
+/*! Remove cached views of datastores that have changed since the views were built
+ *
+ * @param[in]  h       Clixon handle
+ */
+static void
+xmldb_views_purge(clixon_handle h)
+{
+    struct xmldb_view *xv;
+    struct xmldb_view *xn;
+    int                nr;
+    int                i;
+
+    xv = _xmldb_views;
+    nr = _xmldb_views_nr;
+    for (i=0; i<nr; i++){
+        xn = NEXTQ(struct xmldb_view *, xv);
+        if (xv->xv_generation != xmldb_generation_get(h, xv->xv_db)){
+            DELQ(xv, _xmldb_views, struct xmldb_view *);
+            xmldb_view_free(xv);
+            _xmldb_views_nr--;
+        }
+        xv = xn;
+    }
+}
+#endif /* LIST_PAGINATION_VIEWS */
+
+/*! Free all cached sorted list views
+ *
+ * @see xmldb_get_window
+ */
+void
+xmldb_views_free(void)
+{
+#ifdef LIST_PAGINATION_VIEWS
+    struct xmldb_view *xv;
+
+    while ((xv = _xmldb_views) != NULL){
+        DELQ(xv, _xmldb_views, struct xmldb_view *);
+        xmldb_view_free(xv);
+    }
+    _xmldb_views_nr = 0;
+#endif
+}
+
+/*! Get list entries in a datastore cache sorted by a leaf
+ *
+ * Reuse a cached view if the datastore has not changed since it was built.
+ * Views are kept most recently used first, views of changed datastores are removed
+ * @param[in]  h       Clixon handle
+ * @param[in]  db      Datastore name
+ * @param[in]  xp      Parent of list entries in datastore cache
+ * @param[in]  ylist   Yang list or leaf-list
+ * @param[in]  first   Position of first list entry in xp
+ * @param[in]  nr      Number of list entries
+ * @param[in]  sort_by Sort-by leaf
+ * @param[out] vecp    Sorted vector, free with free() if not cached
+ * @param[out] cached  Set if vecp is cached and should not be freed
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+xmldb_view_get(clixon_handle h,
+               const char   *db,
+               cxobj        *xp,
+               yang_stmt    *ylist,
+               int           first,
+               int           nr,
+               char         *sort_by,
+               cxobj      ***vecp,
+               int          *cached)
+{
+    int                retval = -1;
+    cxobj            **vec = NULL;
+    int                i;
+#ifdef LIST_PAGINATION_VIEWS
+    struct xmldb_view *xv;
+    uint64_t           gen;
+
+    xmldb_views_purge(h);
+    gen = xmldb_generation_get(h, db);
+    if ((xv = _xmldb_views) != NULL){
+        do {
+            if (xv->xv_parent == xp &&
+                xv->xv_ylist == ylist &&
+                xv->xv_len == nr &&
+                strcmp(xv->xv_db, db) == 0 &&
+                strcmp(xv->xv_sort_by, sort_by) == 0){
+                if (xv != _xmldb_views){ /* Move first */
+                    DELQ(xv, _xmldb_views, struct xmldb_view *);
+                    INSQ(xv, _xmldb_views);
+                }
+                *vecp = xv->xv_vec;
+                *cached = 1;
+                goto ok;
+            }
+            xv = NEXTQ(struct xmldb_view *, xv);
+        } while (xv && xv != _xmldb_views);
+    }
+#endif
+    if ((vec = malloc((nr?nr:1)*sizeof(cxobj *))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    for (i=0; i<nr; i++)
+        vec[i] = xml_child_i(xp, first+i);
+    xml_sort_vec_by(vec, nr, sort_by);
+#ifdef LIST_PAGINATION_VIEWS
+    if ((xv = malloc(sizeof(*xv))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(xv, 0, sizeof(*xv));
+    if ((xv->xv_db = strdup(db)) == NULL ||
+        (xv->xv_sort_by = strdup(sort_by)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        xmldb_view_free(xv);
+        goto done;
+    }
+    xv->xv_parent = xp;
+    xv->xv_ylist = ylist;
+    xv->xv_generation = gen;
+    xv->xv_vec = vec;
+    xv->xv_len = nr;
+    vec = NULL;
+    /* Remove least recently used, ie last, if full */
+    while (_xmldb_views_nr >= LIST_PAGINATION_VIEWS){
+        struct xmldb_view *xl = PREVQ(struct xmldb_view *, _xmldb_views);
+
+        DELQ(xl, _xmldb_views, struct xmldb_view *);
+        xmldb_view_free(xl);
+        _xmldb_views_nr--;
+    }
+    INSQ(xv, _xmldb_views);
+    _xmldb_views_nr++;
+    *vecp = xv->xv_vec;
+    *cached = 1;
+#else
+    *vecp = vec;
+    *cached = 0;
+    vec = NULL;
+#endif
+ ok:
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Get a window of list entries from datastore cache without copying the whole list
+ *
+ * Entries are accessed by position in the sorted children of the list parent, or in a
+ * cached view sorted by a leaf. Only the entries in the window are copied to the
+ * returned tree, ie the cost is in proportion to limit, not to offset or list size.
+ * @param[in]  h         Clixon handle
+ * @param[in]  db        Datastore name, eg "running"
+ * @param[in]  nsc       XML namespace context of xparent
+ * @param[in]  xparent   XPath of list parent, or NULL for top-level list
+ * @param[in]  ylist     Yang list or leaf-list
+ * @param[in]  sort_by   Sort entries by this leaf, or NULL for system/user order
+ * @param[in]  backwards Reverse order
+ * @param[in]  offset    Index of first entry in window
+ * @param[in]  limit     Max number of entries in window, 0 means unlimited
+ * @param[in]  wdef      With-defaults parameter, see RFC 6243
+ * @param[out] xret      Tree with window entries and their ancestors. Free with xml_free()
+ * @param[out] total     Total number of entries in list
+ * @retval     1         OK, xret set
+ * @retval     0         Not applicable: datastore not cached or xparent matches several nodes
+ * @retval    -1         Error
+ * @see LIST_PAGINATION_VIEWS
+ */
+int
+xmldb_get_window(clixon_handle h,
+                 const char   *db,
+                 cvec         *nsc,
+                 const char   *xparent,
+                 yang_stmt    *ylist,
+                 char         *sort_by,
+                 int           backwards,
+                 uint32_t      offset,
+                 uint32_t      limit,
+                 withdefaults_type wdef,
+                 cxobj       **xret,
+                 uint32_t     *total)
+{
+    int        retval = -1;
+    cxobj     *x0t;
+    cxobj     *xp;
+    cxobj     *x0;
+    cxobj     *x1t = NULL;
+    cxobj     *x1p = NULL;
+    cxobj     *x1;
+    cxobj    **xvec = NULL;
+    size_t     xlen;
+    cxobj    **vec = NULL;
+    int        cached = 0;
+    int        first = 0;
+    int        nr = 0;
+    uint32_t   upper;
+    uint32_t   i;
+    uint32_t   pos;
+
+    if ((x0t = xmldb_cache_get(h, db)) == NULL)
+        goto fail;
+    if (xparent == NULL || strcmp(xparent, "/") == 0)
+        xp = x0t;
+    else {
+        if (xpath_vec(x0t, nsc, "%s", &xvec, &xlen, xparent) < 0)
+            goto done;
+        if (xlen > 1)
+            goto fail;
+        xp = xlen ? xvec[0] : NULL;
+    }
+    if ((x1t = xml_new(xml_name(x0t), NULL, CX_ELMNT)) == NULL)
+        goto done;
+    xml_flag_set(x1t, XML_FLAG_TOP);
+    xml_spec_set(x1t, xml_spec(x0t));
+    if (xp != NULL){
+        if (xml_search_yang_range(xp, ylist, &first, &nr) < 0)
+            goto done;
+        if (sort_by && nr > 1 &&
+            xmldb_view_get(h, db, xp, ylist, first, nr, sort_by, &vec, &cached) < 0)
+            goto done;
+        if (limit == 0 || (upper = offset + limit) > (uint32_t)nr || upper < offset)
+            upper = nr;
+        /* Entries are distinct: copy ancestors once and append entries in window order */
+        if (offset < upper &&
+            xml_copy_bottom_recurse(x0t, xp, x1t, &x1p) < 0)
+            goto done;
+        for (i=offset; i<upper; i++){
+            pos = backwards ? nr-1-i : i;
+            x0 = vec ? vec[pos] : xml_child_i(xp, first+pos);
+            if ((x1 = xml_new(xml_name(x0), x1p, CX_ELMNT)) == NULL)
+                goto done;
+            if (xml_copy(x0, x1) < 0)
+                goto done;
+        }
+    }
+    if (clicon_option_bool(h, "CLICON_NACM_DISABLED_ON_EMPTY")){
+        if (disable_nacm_on_empty(x1t, clicon_dbspec_yang(h)) < 0)
+            goto done;
+    }
+    if (wdef == WITHDEFAULTS_EXPLICIT &&
+        xml_default_nopresence(x1t, 2, 0) < 0)
+        goto done;
+    *xret = x1t;
+    x1t = NULL;
+    *total = nr;
+    retval = 1;
+ done:
+    if (vec && !cached)
+        free(vec);
+    if (xvec)
+        free(xvec);
+    if (x1t)
+        xml_free(x1t);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
@@ -0,0 +1,615 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Datastore write-ahead log, see CLICON_XMLDB_WAL
+ *
+ * Instead of rewriting the whole datastore file on every edit, the edit (operation and
+ * edit-config tree as given to xmldb_put) is appended to a log file <dbfile>.wal.
+ * When the datastore is loaded, the log is replayed on top of the datastore file.
+ * After CLICON_XMLDB_WAL_COMPACT records the log is compacted, ie the datastore file is
+ * rewritten from the cache and the log is removed.
+ * Each record is a struct wal_header followed by a NULL-terminated XML payload:
+ *   <wal xmlns:..><config>...</config></wal>
+ * where the namespace context of the original edit is declared in the <wal> element.
+ * A truncated or corrupt record at the end of the log, eg after a crash, is dropped.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_string.h"
+#include "clixon_file.h"
+#include "clixon_options.h"
+#include "clixon_data.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_nsctx.h"
+#include "clixon_xml_bind.h"
+#include "clixon_xml_sort.h"
+#include "clixon_yang_module.h"
+#include "clixon_datastore.h"
+#include "clixon_datastore_write.h"
+#include "clixon_datastore_wal.h"
+
+/*
+ * Constants
+ */
+#define WAL_MAGIC  0x434c5731 /* "CLW1" */
+#define WAL_SUFFIX ".wal"
+#define WAL_TOP    "wal"
+
+/*
+ * Types
+ */
+/* Log record header, followed by wh_len bytes of payload */
+struct wal_header {
+    uint32_t wh_magic; /* WAL_MAGIC */
+    uint32_t wh_len;   /* Payload length including NULL */
+    uint32_t wh_op;    /* enum operation_type */
+    uint32_t wh_sum;   /* Checksum of payload */
+};
+
+/*
+ * Variables
+ */
+/* Datastore file generation, incremented when a datastore file is written from cache
+ * Two datastores with same (non-zero) generation have equal datastore files
+ */
+static uint64_t _wal_snapshot = 0;
+
+/*! Checksum of log record payload (FNV-1a)
+ *
+ * @param[in]  p    Payload
+ * @param[in]  len  Length of payload
+ * @retval     sum  Checksum
+ */
+static uint32_t
+wal_checksum(const char *p,
+             size_t      len)
+{
+    uint32_t sum = 2166136261u;
+    size_t   i;
+
+    for (i = 0; i < len; i++){
+        sum ^= (uint8_t)p[i];
+        sum *= 16777619u;
+    }
+    return sum;
+}
+
+/*! Get log filename of a datastore
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of database
+ * @param[out] filename Log filename, free after use
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+wal_db2file(clixon_handle h,
+            const char   *db,
+            char        **filename)
+{
+    int   retval = -1;
+    char *dbfile = NULL;
+    cbuf *cb = NULL;
+
+    if (xmldb_db2file(h, db, &dbfile) < 0)
+        goto done;
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb, "%s%s", dbfile, WAL_SUFFIX);
+    if ((*filename = strdup(cbuf_get(cb))) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (dbfile)
+        free(dbfile);
+    return retval;
+}
+
+/*! Create log record from an edit
+ *
+ * Must be made before the edit is applied since x1 is modified by xmldb_put
+ * @param[in]  x1   Edit tree, top-level symbol is "config"
+ * @param[in]  op   Top-level operation
+ * @param[out] cbp  Log record, free with cbuf_free
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xmldb_wal_record(cxobj              *x1,
+                 enum operation_type op,
+                 cbuf              **cbp)
+{
+    int               retval = -1;
+    cbuf             *cb = NULL;
+    cvec             *nsc = NULL;
+    cg_var           *cv = NULL;
+    struct wal_header wh = {0,};
+    char             *pf;
+    size_t            len;
+
+    if ((cb = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    /* Header is filled in below */
+    if (cbuf_append_buf(cb, &wh, sizeof(wh)) < 0){
+        clixon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    /* Namespace context of edit tree, eg declared in rpc */
+    if (xml_nsctx_node(x1, &nsc) < 0)
+        goto done;
+    cprintf(cb, "<%s", WAL_TOP);
+    while ((cv = cvec_each(nsc, cv)) != NULL){
+        if ((pf = cv_name_get(cv)) != NULL)
+            cprintf(cb, " xmlns:%s=\"", pf);
+        else
+            cprintf(cb, " xmlns=\"");
+        if (xml_chardata_cbuf_append(cb, 1, cv_string_get(cv)) < 0)
+            goto done;
+        cprintf(cb, "\"");
+    }
+    cprintf(cb, ">");
+    if (clixon_xml2cbuf(cb, x1, 0, 0, NULL, -1, 0) < 0)
+        goto done;
+    cprintf(cb, "</%s>", WAL_TOP);
+    if (cbuf_append_buf(cb, "", 1) < 0){
+        clixon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    len = cbuf_len(cb) - sizeof(wh);
+    wh.wh_magic = WAL_MAGIC;
+    wh.wh_len = len;
+    wh.wh_op = op;
+    wh.wh_sum = wal_checksum(cbuf_get(cb) + sizeof(wh), len);
+    memcpy(cbuf_get(cb), &wh, sizeof(wh));
+    *cbp = cb;
+    cb = NULL;
+    retval = 0;
+ done:
+    if (nsc)
+        xml_nsctx_free(nsc);
+    if (cb)
+        cbuf_free(cb);
+    return retval;
+}
+
+/*! Append log record to datastore log
+ *
+ * Sync the log to disk every CLICON_XMLDB_WAL_SYNC records, and compact the datastore
+ * after CLICON_XMLDB_WAL_COMPACT records.
+ * @param[in]  h    Clixon handle
+ * @param[in]  db   Name of database
+ * @param[in]  cb   Log record created by xmldb_wal_record
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xmldb_wal_append(clixon_handle h,
+                 const char   *db,
+                 cbuf         *cb)
+{
+    int       retval = -1;
+    char     *walfile = NULL;
+    int       fd = -1;
+    db_elmnt *de;
+    char     *p;
+    size_t    len;
+    ssize_t   n;
+    int       sync;
+    int       compact;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL){
+        clixon_err(OE_CFG, EFAULT, "datastore %s does not exist", db);
+        goto done;
+    }
+    sync = clicon_option_int(h, "CLICON_XMLDB_WAL_SYNC");
+    compact = clicon_option_int(h, "CLICON_XMLDB_WAL_COMPACT");
+    if (compact > 0 && de->de_wal_nr + 1 >= compact){
+        /* Compact: write whole datastore and remove log */
+        clixon_debug(CLIXON_DBG_DATASTORE, "Compacting %s after %u records", db, de->de_wal_nr);
+        if (xmldb_write_cache2file(h, db) < 0)
+            goto done;
+        goto ok;
+    }
+    if (wal_db2file(h, db, &walfile) < 0)
+        goto done;
+    if ((fd = open(walfile, O_WRONLY|O_APPEND|O_CREAT, S_IRWXU)) < 0){
+        clixon_err(OE_UNIX, errno, "open(%s)", walfile);
+        goto done;
+    }
+    p = cbuf_get(cb);
+    len = cbuf_len(cb);
+    while (len > 0){
+        if ((n = write(fd, p, len)) < 0){
+            if (errno == EINTR)
+                continue;
+            clixon_err(OE_UNIX, errno, "write(%s)", walfile);
+            goto done;
+        }
+        p += n;
+        len -= n;
+    }
+    de->de_wal_nr++;
+    de->de_wal_unsynced++;
+    if (sync > 0 && de->de_wal_unsynced >= sync){
+        if (fsync(fd) < 0){
+            clixon_err(OE_UNIX, errno, "fsync(%s)", walfile);
+            goto done;
+        }
+        de->de_wal_unsynced = 0;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (fd != -1)
+        close(fd);
+    if (walfile)
+        free(walfile);
+    return retval;
+}
+
+/*! Apply a single log record on datastore cache
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  db     Name of database
+ * @param[in]  yspec  Yang spec
+ * @param[in]  op     Top-level operation
+ * @param[in]  str    XML payload
+ * @param[in]  cbret  Return buffer for netconf errors
+ * @retval     1      OK
+ * @retval     0      Failed, error in cbret or payload
+ * @retval    -1      Error
+ */
+static int
+wal_replay_one(clixon_handle       h,
+               const char         *db,
+               yang_stmt          *yspec,
+               enum operation_type op,
+               const char         *str,
+               cbuf               *cbret)
+{
+    int    retval = -1;
+    cxobj *xt = NULL;
+    cxobj *xw;
+    cxobj *xc;
+    cxobj *xerr = NULL;
+    int    ret;
+
+    if ((ret = clixon_xml_parse_string(str, YB_NONE, yspec, &xt, NULL)) < 0)
+        goto done;
+    if ((xw = xml_find_type(xt, NULL, WAL_TOP, CX_ELMNT)) == NULL ||
+        (xc = xml_find_type(xw, NULL, NETCONF_INPUT_CONFIG, CX_ELMNT)) == NULL)
+        goto fail;
+    if ((ret = xml_bind_yang(h, xc, YB_MODULE, yspec, &xerr)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    if (xml_sort_recurse(xc) < 0)
+        goto done;
+    if ((ret = xmldb_put(h, db, op, xc, NULL, cbret)) < 0)
+        goto done;
+    if (ret == 0)
+        goto fail;
+    retval = 1;
+ done:
+    if (xerr)
+        xml_free(xerr);
+    if (xt)
+        xml_free(xt);
+    return retval;
+ fail:
+    retval = 0;
+    goto done;
+}
+
+/*! Replay datastore log on datastore cache
+ *
+ * Called when the cache has been loaded from the datastore file.
+ * A truncated or corrupt record ends the log and is removed from the log file.
+ * If a record fails to apply, eg YANG has changed, a warning is logged and the remaining
+ * records are skipped.
+ * @param[in]  h    Clixon handle
+ * @param[in]  db   Name of database
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xmldb_wal_replay(clixon_handle h,
+                 const char   *db)
+{
+    int               retval = -1;
+    char             *walfile = NULL;
+    FILE             *f = NULL;
+    struct stat       st;
+    char             *buf = NULL;
+    size_t            sz;
+    size_t            off = 0;
+    struct wal_header wh;
+    db_elmnt         *de;
+    yang_stmt        *yspec;
+    cbuf             *cbret = NULL;
+    uint32_t          nr = 0;
+    int               ret;
+
+    if ((de = clicon_db_elmnt_get(h, db)) == NULL || de->de_xml == NULL)
+        goto ok;
+    if (wal_db2file(h, db, &walfile) < 0)
+        goto done;
+    if ((f = fopen(walfile, "r")) == NULL){
+        if (errno == ENOENT)
+            goto ok;
+        clixon_err(OE_UNIX, errno, "fopen(%s)", walfile);
+        goto done;
+    }
+    if (fstat(fileno(f), &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat(%s)", walfile);
+        goto done;
+    }
+    if ((sz = st.st_size) == 0)
+        goto ok;
+    if ((buf = malloc(sz)) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    if (fread(buf, 1, sz, f) != sz){
+        clixon_err(OE_UNIX, errno, "fread(%s)", walfile);
+        goto done;
+    }
+    if ((yspec = clicon_dbspec_yang(h)) == NULL){
+        clixon_err(OE_YANG, ENOENT, "No yang spec");
+        goto done;
+    }
+    if ((cbret = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    clixon_debug(CLIXON_DBG_DATASTORE, "Replaying %s", walfile);
+    de->de_wal_replay = 1;
+    while (off + sizeof(wh) <= sz){
+        memcpy(&wh, buf + off, sizeof(wh));
+        if (wh.wh_magic != WAL_MAGIC ||
+            wh.wh_len == 0 ||
+            wh.wh_len > sz - off - sizeof(wh) ||
+            buf[off + sizeof(wh) + wh.wh_len - 1] != '\0' ||
+            wh.wh_sum != wal_checksum(buf + off + sizeof(wh), wh.wh_len))
+            break;
+        cbuf_reset(cbret);
+        if ((ret = wal_replay_one(h, db, yspec, wh.wh_op, buf + off + sizeof(wh), cbret)) < 0)
+            goto done;
+        if (ret == 0){
+            clixon_log(h, LOG_WARNING, "%s: record %u failed, skipping rest of log: %s",
+                       walfile, nr, cbuf_get(cbret));
+            break;
+        }
+        off += sizeof(wh) + wh.wh_len;
+        nr++;
+    }
+    /* de may have been reallocated by xmldb_put */
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
+        de->de_wal_replay = 0;
+        de->de_wal_nr = nr;
+    }
+    if (off < sz){
+        clixon_log(h, LOG_WARNING, "%s: truncated at offset %zu of %zu", walfile, off, sz);
+        if (truncate(walfile, off) < 0){
+            clixon_err(OE_UNIX, errno, "truncate(%s)", walfile);
+            goto done;
+        }
+    }
+ ok:
+    retval = 0;
+ done:
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL)
+        de->de_wal_replay = 0;
+    if (cbret)
+        cbuf_free(cbret);
+    if (buf)
+        free(buf);
+    if (f)
+        fclose(f);
+    if (walfile)
+        free(walfile);
+    return retval;
+}
+
+/*! Remove datastore log
+ *
+ * Called when the datastore file has been written from cache, or the datastore is
+ * created or deleted.
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of database
+ * @param[in]  written  Datastore file was written from cache, assign new generation
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+xmldb_wal_truncate(clixon_handle h,
+                   const char   *db,
+                   int           written)
+{
+    int       retval = -1;
+    char     *walfile = NULL;
+    db_elmnt *de;
+
+    if (wal_db2file(h, db, &walfile) < 0)
+        goto done;
+    if (unlink(walfile) < 0 && errno != ENOENT){
+        clixon_err(OE_UNIX, errno, "unlink(%s)", walfile);
+        goto done;
+    }
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
+        de->de_wal_nr = 0;
+        de->de_wal_unsynced = 0;
+        de->de_snapshot = written ? ++_wal_snapshot : 0;
+    }
+    retval = 0;
+ done:
+    if (walfile)
+        free(walfile);
+    return retval;
+}
+
+/*! Copy datastore log
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  from  Source datastore
+ * @param[in]  to    Destination datastore
+ * @retval     1     OK, and datastore files are equal, only the log needed to be copied
+ * @retval     0     OK, datastore file needs to be copied
+ * @retval    -1     Error
+ */
+int
+xmldb_wal_copy(clixon_handle h,
+               const char   *from,
+               const char   *to)
+{
+    int       retval = -1;
+    char     *fromfile = NULL;
+    char     *tofile = NULL;
+    db_elmnt *de1;
+    db_elmnt *de2;
+    uint64_t  snapshot = 0;
+    uint32_t  nr = 0;
+    int       equal = 0;
+
+    if ((de1 = clicon_db_elmnt_get(h, from)) != NULL){
+        snapshot = de1->de_snapshot;
+        nr = de1->de_wal_nr;
+    }
+    if ((de2 = clicon_db_elmnt_get(h, to)) != NULL)
+        equal = (snapshot != 0 && de2->de_snapshot == snapshot);
+    if (wal_db2file(h, from, &fromfile) < 0)
+        goto done;
+    if (wal_db2file(h, to, &tofile) < 0)
+        goto done;
+    if (access(fromfile, F_OK) == 0){
+        if (clicon_file_copy(fromfile, tofile) < 0)
+            goto done;
+    }
+    else if (unlink(tofile) < 0 && errno != ENOENT){
+        clixon_err(OE_UNIX, errno, "unlink(%s)", tofile);
+        goto done;
+    }
+    if (de2 != NULL){
+        de2->de_snapshot = snapshot;
+        de2->de_wal_nr = nr;
+        de2->de_wal_unsynced = 0;
+    }
+    retval = equal;
+ done:
+    if (fromfile)
+        free(fromfile);
+    if (tofile)
+        free(tofile);
+    return retval;
+}
+
+/*! Rename datastore log along with datastore file
+ *
+ * @param[in]  h        Clixon handle
+ * @param[in]  db       Name of database
+ * @param[in]  oldfile  Old datastore filename
+ * @param[in]  newfile  New datastore filename
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+int
+xmldb_wal_rename(clixon_handle h,
+                 const char   *db,
+                 const char   *oldfile,
+                 const char   *newfile)
+{
+    int       retval = -1;
+    cbuf     *cb1 = NULL;
+    cbuf     *cb2 = NULL;
+    db_elmnt *de;
+
+    if ((cb1 = cbuf_new()) == NULL ||
+        (cb2 = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cb1, "%s%s", oldfile, WAL_SUFFIX);
+    cprintf(cb2, "%s%s", newfile, WAL_SUFFIX);
+    if (rename(cbuf_get(cb1), cbuf_get(cb2)) < 0 && errno != ENOENT){
+        clixon_err(OE_UNIX, errno, "rename(%s)", cbuf_get(cb1));
+        goto done;
+    }
+    if ((de = clicon_db_elmnt_get(h, db)) != NULL){
+        de->de_wal_nr = 0;
+        de->de_wal_unsynced = 0;
+        de->de_snapshot = 0;
+    }
+    retval = 0;
+ done:
+    if (cb1)
+        cbuf_free(cb1);
+    if (cb2)
+        cbuf_free(cb2);
+    return retval;
+}
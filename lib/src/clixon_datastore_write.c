@@ -76,6 +76,7 @@
 #include "clixon_json.h"
 #include "clixon_nacm.h"
 #include "clixon_netconf_lib.h"
+#include "clixon_xml_binary.h"
 #include "clixon_yang_type.h"
 #include "clixon_yang_module.h"
 #include "clixon_yang_schema_mount.h"
@@ -86,6 +87,7 @@
 #include "clixon_xml_map.h"
 #include "clixon_datastore.h"
 #include "clixon_datastore_write.h"
+#include "clixon_datastore_wal.h"
 #include "clixon_datastore_read.h"
 
 /* Local types */
@@ -775,8 +777,17 @@ text_modify(clixon_handle       h,
                         if (ret == 0)
                             goto fail;
                     }
+#ifdef XML_EXPLICIT_INDEX
+                    /* Value of index variable changes position in search vector */
+                    if (!changed && xml_search_index_sync(x0p, x0, 0) < 0)
+                        goto done;
+#endif
                     if (xml_value_set(x0b, x1bstr) < 0)
                         goto done;
+#ifdef XML_EXPLICIT_INDEX
+                    if (!changed && xml_search_index_sync(x0p, x0, 1) < 0)
+                        goto done;
+#endif
                     xml_flag_set(x0, XML_FLAG_ADD);
                     /* If a default value ies replaced, then reset default flag */
                     if (xml_flag(x0, XML_FLAG_DEFAULT))
@@ -1303,6 +1314,36 @@ xml_mark_cache_dirty(cxobj *x,
     return 2;
 }
 
+/*! Mark changed xml with commit dirty, ie the commit journal
+ *
+ * Not reset on write to disk, only when synced with running.
+ * Only added nodes are marked with their whole subtree. Changed nodes, and nodes with
+ * removed children, are marked but their children are compared with running anyway, so
+ * that removing an entry from a large list does not mark the whole list.
+ * Default values replacing removed children are marked since they may match the
+ * removed nodes.
+ * @see xmldb_journal_get
+ */
+static int
+xml_mark_commit_dirty(cxobj *x,
+                      void  *arg)
+{
+    cxobj *xp;
+
+    if (xml_flag(x, XML_FLAG_ADD)){
+        if (xml_apply0(x, CX_ELMNT, (xml_applyfn_t*)xml_flag_set, (void*)(XML_FLAG_COMMIT_DIRTY)) < 0)
+            return -1;
+    }
+    else if (xml_flag(x, XML_FLAG_CHANGE|XML_FLAG_DEL)){
+        xml_flag_set(x, XML_FLAG_COMMIT_DIRTY);
+        return 0;
+    }
+    else if (xml_flag(x, XML_FLAG_DEFAULT) &&
+             (xp = xml_parent(x)) != NULL && xml_flag(xp, XML_FLAG_DEL))
+        xml_flag_set(x, XML_FLAG_COMMIT_DIRTY);
+    return 2;
+}
+
 /*! Modify database given an xml tree and an operation
  *
  * @param[in]  h      CLICON handle
@@ -1347,6 +1388,9 @@ xmldb_put(clixon_handle       h,
     cvec       *nsc = NULL; /* nacm namespace context */
     int         firsttime = 0;
     cxobj      *xerr = NULL;
+    int         wal;
+    cbuf       *cbwal = NULL;
+    int         modified = 0;
 
     clixon_debug(CLIXON_DBG_DATASTORE|CLIXON_DBG_DETAIL, "db %s", db);
     if (cbret == NULL){
@@ -1373,7 +1417,23 @@ xmldb_put(clixon_handle       h,
             goto done;
         if (ret == 0)
             goto fail;
+        if (clicon_option_bool(h, "CLICON_XMLDB_WAL")){
+            /* Set cache and replay log before modifying, see xmldb_get_cache */
+            if (de != NULL)
+                de0 = *de;
+            de0.de_xml = x0;
+            clicon_db_elmnt_set(h, db, &de0);
+            firsttime = 0;
+            if (xmldb_wal_replay(h, db) < 0)
+                goto done;
+            de = clicon_db_elmnt_get(h, db);
+            x0 = de->de_xml;
+        }
     }
+    /* Log edit unless log is being replayed, x1 is modified below */
+    wal = clicon_option_bool(h, "CLICON_XMLDB_WAL") && de != NULL && de->de_wal_replay == 0;
+    if (wal && x1 && xmldb_wal_record(x1, op, &cbwal) < 0)
+        goto done;
     if (strcmp(xml_name(x0), DATASTORE_TOP_SYMBOL) !=0 ||
         xml_flag(x0, XML_FLAG_TOP) == 0){
         clixon_err(OE_XML, 0, "Top-level symbol is %s, expected \"%s\"",
@@ -1381,7 +1441,9 @@ xmldb_put(clixon_handle       h,
         goto done;
     }
     /* Here x0 looks like: <config>...</config> */
-    xnacm = clicon_nacm_cache(h);
+    /* Log records were permitted when logged */
+    if (de == NULL || de->de_wal_replay == 0)
+        xnacm = clicon_nacm_cache(h);
     permit = (xnacm==NULL);
     /* Here assume if xnacm is set and !permit do NACM */
     clicon_data_del(h, "objectexisted");
@@ -1389,6 +1451,7 @@ xmldb_put(clixon_handle       h,
      * Modify base tree x with modification x1. This is where the
      * new tree is made.
      */
+    modified++;
     if ((ret = text_modify_top(h, x0, x1, yspec, op, username, xnacm, permit, cbret)) < 0)
         goto done;
     /* If xml return - ie netconf error xml tree, then stop and return OK */
@@ -1420,6 +1483,12 @@ xmldb_put(clixon_handle       h,
     /* Add default recursive values */
     if (xml_default_recurse(x0, 0, XML_FLAG_ADD|XML_FLAG_DEL) < 0)
         goto done;
+    /* Mark changed xml in commit journal, any change of running invalidates all journals */
+    if (xml_apply(x0, CX_ELMNT, xml_mark_commit_dirty, NULL) < 0)
+        goto done;
+    if (strcmp(db, "running") == 0 &&
+        xmldb_journal_reset(h, db) < 0)
+        goto done;
     /* Write back to datastore cache if first time */
     if (de != NULL)
         de0 = *de;
@@ -1427,9 +1496,13 @@ xmldb_put(clixon_handle       h,
         de0.de_xml = x0;
     de0.de_empty = (xml_child_nr(de0.de_xml) == 0);
     clicon_db_elmnt_set(h, db, &de0);
-    /* Write cache to file unless volatile (ie stop syncing to store) */
-    if (xmldb_volatile_get(h, db) == 0){
-        if (xmldb_write_cache2file(h, db) < 0)
+    /* Write cache to file unless volatile (ie stop syncing to store) or replaying log */
+    if (xmldb_volatile_get(h, db) == 0 && de0.de_wal_replay == 0){
+        if (cbwal != NULL){
+            if (xmldb_wal_append(h, db, cbwal) < 0)
+                goto done;
+        }
+        else if (xmldb_write_cache2file(h, db) < 0)
             goto done;
         /* Clear flags from previous steps + dirty */
         if (xml_apply(x0, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
@@ -1444,7 +1517,18 @@ xmldb_put(clixon_handle       h,
     }
     retval = 1;
  done:
+    /* x0 may be partly modified before an error or failed edit without changes being
+     * marked: views of the cache may refer to removed nodes, see xmldb_view_get, and the
+     * commit journal is incomplete, fall back to full diff */
+    if (retval < 1 && modified){
+        if (xmldb_generation_bump(h, db) < 0)
+            retval = -1;
+        if (xmldb_journal_reset(h, db) < 0)
+            retval = -1;
+    }
     clixon_debug(CLIXON_DBG_DATASTORE | CLIXON_DBG_DETAIL, "retval:%d", retval);
+    if (cbwal)
+        cbuf_free(cbwal);
     if (xerr)
         xml_free(xerr);
     if (nsc)
@@ -1575,7 +1659,8 @@ xmldb_dump(clixon_handle     h,
         if (xml_child_insert_pos(xt, xmodst, 0) < 0)
             goto done;
 #endif
-        xml_parent_set(xmodst, xt);
+        if (xml_parent_set(xmodst, xt) < 0)
+            goto done;
     }
     switch (format){
     case FORMAT_XML:
@@ -1599,6 +1684,14 @@ xmldb_dump(clixon_handle     h,
         if (clixon_json2file(f, xt, pretty, fprintf, 0, 0) < 0)
             goto done;
         break;
+    case FORMAT_BINARY:
+        if (multi){
+            clixon_err(OE_CFG, errno, "Binary+multi not supported");
+            goto done;
+        }
+        if (clixon_xml2binary_file(f, xt, clicon_dbspec_yang(h), wdef) < 0)
+            goto done;
+        break;
     default:
         clixon_err(OE_XML, 0, "Format %s not supported", format_int2str(format));
         goto done;
@@ -1654,6 +1747,15 @@ xmldb_write_cache2file(clixon_handle h,
     }
     if (xmldb_dump(h, f, xt, format, pretty, wdef, multi, db) < 0)
         goto done;
+    /* Datastore file is complete: compact log */
+    if (clicon_option_bool(h, "CLICON_XMLDB_WAL")){
+        if (fflush(f) < 0 || fsync(fileno(f)) < 0){
+            clixon_err(OE_UNIX, errno, "fsync(%s)", dbfile);
+            goto done;
+        }
+        if (xmldb_wal_truncate(h, db, 1) < 0)
+            goto done;
+    }
     retval = 0;
  done:
     if (dbfile)
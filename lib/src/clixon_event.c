@@ -35,6 +35,9 @@
 
  *
  * Event handling and loop
+ * File descriptors are waited on using epoll(7) if available, otherwise select(2).
+ * A fd event waits for input, or for output space if registered with clixon_event_reg_fd_write
+ * Timeouts are kept in a binary min-heap.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -48,11 +51,16 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <limits.h>
 #include <signal.h>
 #include <syslog.h>
+#include <poll.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#ifdef HAVE_EPOLL_CREATE1
+#include <sys/epoll.h>
+#endif
 
 #include <cligen/cligen.h>
 
@@ -74,6 +82,14 @@
  */
 #define EVENT_STRLEN 32
 
+#ifdef HAVE_EPOLL_CREATE1
+#define EVENT_WAIT_STR "epoll_wait"
+/* Max number of ready file descriptors returned by one epoll_wait call */
+#define EVENT_EPOLL_MAX 64
+#else
+#define EVENT_WAIT_STR "select"
+#endif
+
 /*
  * Types
  */
@@ -83,7 +99,12 @@ struct event_data{
     enum {EVENT_FD, EVENT_TIME} e_type;                 /* Type of event */
     int                         e_fd;                   /* File descriptor */
     int                         e_prio;                 /* 1: high-prio FD:s only*/
+    int                         e_write;                /* 1: wait for fd to be writable */
     struct timeval              e_time;                 /* Timeout */
+    uint64_t                    e_seq;                  /* Timeout registration order */
+#ifdef HAVE_EPOLL_CREATE1
+    struct event_data          *e_fdnext;               /* Next with same fd, see ee_fdvec */
+#endif
     void                       *e_arg;                  /* Function argument */
     char                        e_string[EVENT_STRLEN]; /* String for debugging */
 };
@@ -93,7 +114,25 @@ struct event_data{
  * XXX consider use handle variables instead of global
  */
 static struct event_data *ee = NULL;
-static struct event_data *ee_timers = NULL;
+
+/* Timeouts as binary min-heap ordered by time and registration order */
+static struct event_data **ee_timers = NULL;
+static int                 ee_timers_len = 0;
+static int                 ee_timers_max = 0;
+static uint64_t            ee_timers_seq = 0;
+
+/* Ready fd events of the current event loop iteration, see clixon_event_wait */
+static struct event_data **ee_ready = NULL;
+static int                 ee_ready_max = 0;
+
+#ifdef HAVE_EPOLL_CREATE1
+/* epoll instance, created on first fd registration */
+static int                 ee_epfd = -1;
+
+/* Fd events indexed by fd, several events on same fd are linked via e_fdnext */
+static struct event_data **ee_fdvec = NULL;
+static int                 ee_fdlen = 0;
+#endif
 
 /* Set if element in ee is deleted (clixon_event_unreg_fd). Check in ee loops */
 static int _ee_unreg = 0;
@@ -168,29 +207,140 @@ clicon_sig_ignore_get(void)
     return _clicon_sig_ignore;
 }
 
-/*! Register a callback function to be called on input on a file descriptor.
+#ifdef HAVE_EPOLL_CREATE1
+/*! Get epoll events of all registrations of an fd
  *
  * @param[in]  fd   File descriptor
- * @param[in]  fn   Function to call when input available on fd
- * @param[in]  arg  Argument to function fn
- * @param[in]  str  Describing string for logging
- * @param[in]  prio Priority (0 or 1)
- * @code
- * int fn(int fd, void *arg){
- * }
- * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
- * @endcode 
- * @see clixon_event_unreg_fd
+ * @retval     ev   EPOLLIN and/or EPOLLOUT
  */
-int
-clixon_event_reg_fd_prio(int   fd,
-                         int (*fn)(int, void*),
-                         void *arg,
-                         char *str,
-                         int   prio)
+static uint32_t
+clixon_event_epoll_mask(int fd)
 {
     struct event_data *e;
+    uint32_t           events = 0;
+
+    for (e = ee_fdvec[fd]; e; e = e->e_fdnext)
+        events |= e->e_write ? EPOLLOUT : EPOLLIN;
+    return events;
+}
 
+/*! Add fd event to epoll set and fd index
+ *
+ * @param[in]  e    Fd event
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+clixon_event_epoll_add(struct event_data *e)
+{
+    int                 retval = -1;
+    struct epoll_event  ev = {0,};
+    struct event_data **vec;
+    int                 len;
+    int                 op;
+
+    if (ee_epfd == -1 &&
+        (ee_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0){
+        clixon_err(OE_EVENTS, errno, "epoll_create1");
+        goto done;
+    }
+    if (e->e_fd >= ee_fdlen){
+        len = ee_fdlen ? ee_fdlen : 64;
+        while (len <= e->e_fd)
+            len *= 2;
+        if ((vec = realloc(ee_fdvec, len*sizeof(*vec))) == NULL){
+            clixon_err(OE_EVENTS, errno, "realloc");
+            goto done;
+        }
+        memset(&vec[ee_fdlen], 0, (len-ee_fdlen)*sizeof(*vec));
+        ee_fdvec = vec;
+        ee_fdlen = len;
+    }
+    /* Level-triggered, same semantics as select.
+     * Fd may already be added by another registration, then modify its events */
+    op = ee_fdvec[e->e_fd] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    e->e_fdnext = ee_fdvec[e->e_fd];
+    ee_fdvec[e->e_fd] = e;
+    ev.events = clixon_event_epoll_mask(e->e_fd);
+    ev.data.fd = e->e_fd;
+    if (epoll_ctl(ee_epfd, op, e->e_fd, &ev) < 0 &&
+        (op == EPOLL_CTL_MOD || errno != EEXIST)){
+        clixon_err(OE_EVENTS, errno, "epoll_ctl(%d)", e->e_fd);
+        ee_fdvec[e->e_fd] = e->e_fdnext;
+        goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Remove fd event from fd index, and from epoll set if last registration of fd
+ *
+ * @param[in]  e    Fd event
+ * @note fd must not be closed yet. Closing fd does not remove it from the epoll set if
+ *       the file is still open elsewhere, eg dup:ed or inherited by a child process
+ */
+static int
+clixon_event_epoll_rm(struct event_data *e)
+{
+    struct event_data  *e1;
+    struct event_data **e_prev;
+    struct epoll_event  ev = {0,};
+
+    if (e->e_fd >= ee_fdlen)
+        return 0;
+    e_prev = &ee_fdvec[e->e_fd];
+    for (e1 = ee_fdvec[e->e_fd]; e1; e1 = e1->e_fdnext){
+        if (e1 == e){
+            *e_prev = e->e_fdnext;
+            break;
+        }
+        e_prev = &e1->e_fdnext;
+    }
+    if (ee_fdvec[e->e_fd] == NULL){
+        if (epoll_ctl(ee_epfd, EPOLL_CTL_DEL, e->e_fd, NULL) < 0)
+            clixon_debug(CLIXON_DBG_EVENT, "epoll_ctl(%d) del: %s", e->e_fd, strerror(errno));
+    }
+    else {
+        ev.events = clixon_event_epoll_mask(e->e_fd);
+        ev.data.fd = e->e_fd;
+        (void)epoll_ctl(ee_epfd, EPOLL_CTL_MOD, e->e_fd, &ev);
+    }
+    return 0;
+}
+#endif /* HAVE_EPOLL_CREATE1 */
+
+/*! Register a callback function to be called when a file descriptor is ready
+ *
+ * @param[in]  fd    File descriptor
+ * @param[in]  fn    Function to call when fd is ready
+ * @param[in]  arg   Argument to function fn
+ * @param[in]  str   Describing string for logging
+ * @param[in]  prio  Priority (0 or 1)
+ * @param[in]  write 0: input available on fd, 1: fd is writable
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+clixon_event_reg_fd1(int   fd,
+                     int (*fn)(int, void*),
+                     void *arg,
+                     char *str,
+                     int   prio,
+                     int   write)
+{
+    struct event_data *e;
+
+    if (fd < 0){
+        clixon_err(OE_EVENTS, EBADF, "Invalid file descriptor: %d", fd);
+        return -1;
+    }
+#ifndef HAVE_EPOLL_CREATE1
+    if (fd >= FD_SETSIZE){
+        clixon_err(OE_EVENTS, EBADF, "File descriptor %d exceeds FD_SETSIZE", fd);
+        return -1;
+    }
+#endif
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clixon_err(OE_EVENTS, errno, "malloc");
         return -1;
@@ -202,19 +352,71 @@ clixon_event_reg_fd_prio(int   fd,
     e->e_arg = arg;
     e->e_type = EVENT_FD;
     e->e_prio = prio;
+    e->e_write = write;
+#ifdef HAVE_EPOLL_CREATE1
+    if (clixon_event_epoll_add(e) < 0){
+        free(e);
+        return -1;
+    }
+#endif
     e->e_next = ee;
     ee = e;
     clixon_debug(CLIXON_DBG_EVENT, "registering %s", e->e_string);
     return 0;
 }
 
+/*! Register a callback function to be called on input on a file descriptor.
+ *
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when input available on fd
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @param[in]  prio Priority (0 or 1)
+ * @code
+ * int fn(int fd, void *arg){
+ * }
+ * clixon_event_reg_fd(fd, fn, (void*)42, "call fn on input on fd");
+ * @endcode
+ * @see clixon_event_unreg_fd
+ */
+int
+clixon_event_reg_fd_prio(int   fd,
+                         int (*fn)(int, void*),
+                         void *arg,
+                         char *str,
+                         int   prio)
+{
+    return clixon_event_reg_fd1(fd, fn, arg, str, prio, 0);
+}
+
 int
 clixon_event_reg_fd(int   fd,
                     int (*fn)(int, void*),
                     void *arg,
                     char *str)
 {
-    return clixon_event_reg_fd_prio(fd, fn, arg, str, 0);
+    return clixon_event_reg_fd1(fd, fn, arg, str, 0, 0);
+}
+
+/*! Register a callback function to be called when a file descriptor is writable
+ *
+ * Used to send buffered output on non-blocking sockets without blocking the event loop.
+ * Unregister with clixon_event_unreg_fd when there is nothing more to write.
+ * @param[in]  fd   File descriptor
+ * @param[in]  fn   Function to call when fd is writable
+ * @param[in]  arg  Argument to function fn
+ * @param[in]  str  Describing string for logging
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see clixon_event_unreg_fd
+ */
+int
+clixon_event_reg_fd_write(int   fd,
+                          int (*fn)(int, void*),
+                          void *arg,
+                          char *str)
+{
+    return clixon_event_reg_fd1(fd, fn, arg, str, 0, 1);
 }
 
 /*! Deregister a file descriptor callback
@@ -224,6 +426,7 @@ clixon_event_reg_fd(int   fd,
  * @retval     0   OK
  * @retval    -1   Error
  * Note: deregister when exactly function and socket match, not argument
+ * @note Deregister before closing the file descriptor
  * @see clixon_event_reg_fd
  * @see clixon_event_unreg_timeout
  */
@@ -240,6 +443,9 @@ clixon_event_unreg_fd(int   s,
         if (fn == e->e_fn && s == e->e_fd) {
             found++;
             *e_prev = e->e_next;
+#ifdef HAVE_EPOLL_CREATE1
+            clixon_event_epoll_rm(e);
+#endif
             _ee_unreg++;
             free(e);
             break;
@@ -249,6 +455,76 @@ clixon_event_unreg_fd(int   s,
     return found?0:-1;
 }
 
+/*! Timeout heap order: time, and registration order if equal time
+ */
+static int
+clixon_event_timer_less(struct event_data *e0,
+                        struct event_data *e1)
+{
+    if (timercmp(&e0->e_time, &e1->e_time, !=))
+        return timercmp(&e0->e_time, &e1->e_time, <);
+    return e0->e_seq < e1->e_seq;
+}
+
+/*! Move timeout at position i up the heap to its right place
+ */
+static void
+clixon_event_timer_up(int i)
+{
+    struct event_data *e = ee_timers[i];
+    int                p;
+
+    while (i > 0){
+        p = (i-1)/2;
+        if (!clixon_event_timer_less(e, ee_timers[p]))
+            break;
+        ee_timers[i] = ee_timers[p];
+        i = p;
+    }
+    ee_timers[i] = e;
+}
+
+/*! Move timeout at position i down the heap to its right place
+ */
+static void
+clixon_event_timer_down(int i)
+{
+    struct event_data *e = ee_timers[i];
+    int                c;
+
+    while ((c = 2*i+1) < ee_timers_len){
+        if (c+1 < ee_timers_len &&
+            clixon_event_timer_less(ee_timers[c+1], ee_timers[c]))
+            c++;
+        if (!clixon_event_timer_less(ee_timers[c], e))
+            break;
+        ee_timers[i] = ee_timers[c];
+        i = c;
+    }
+    ee_timers[i] = e;
+}
+
+/*! Remove timeout at position i from heap
+ *
+ * @param[in]  i   Position in heap
+ * @retval     e   Removed timeout event, free with free()
+ */
+static struct event_data *
+clixon_event_timer_rm(int i)
+{
+    struct event_data *e = ee_timers[i];
+
+    ee_timers_len--;
+    if (i < ee_timers_len){
+        ee_timers[i] = ee_timers[ee_timers_len];
+        if (i > 0 && clixon_event_timer_less(ee_timers[i], ee_timers[(i-1)/2]))
+            clixon_event_timer_up(i);
+        else
+            clixon_event_timer_down(i);
+    }
+    return e;
+}
+
 /*! Call a callback function at an absolute time
  *
  * @param[in]  t   Absolute (not relative!) timestamp when callback is called
@@ -281,13 +557,22 @@ clixon_event_reg_timeout(struct timeval t,
 {
     int                 retval = -1;
     struct event_data  *e;
-    struct event_data  *e1;
-    struct event_data **e_prev;
+    struct event_data **vec;
+    int                 len;
 
     if (str == NULL || fn == NULL){
         clixon_err(OE_CFG, EINVAL, "str or fn is NULL");
         goto done;
     }
+    if (ee_timers_len >= ee_timers_max){
+        len = ee_timers_max ? 2*ee_timers_max : 16;
+        if ((vec = realloc(ee_timers, len*sizeof(*vec))) == NULL){
+            clixon_err(OE_EVENTS, errno, "realloc");
+            goto done;
+        }
+        ee_timers = vec;
+        ee_timers_max = len;
+    }
     if ((e = (struct event_data *)malloc(sizeof(struct event_data))) == NULL){
         clixon_err(OE_EVENTS, errno, "malloc");
         return -1;
@@ -298,15 +583,10 @@ clixon_event_reg_timeout(struct timeval t,
     e->e_arg = arg;
     e->e_type = EVENT_TIME;
     e->e_time = t;
-    /* Sort into right place */
-    e_prev = &ee_timers;
-    for (e1=ee_timers; e1; e1=e1->e_next){
-        if (timercmp(&e->e_time, &e1->e_time, <))
-            break;
-        e_prev = &e1->e_next;
-    }
-    e->e_next = e1;
-    *e_prev = e;
+    e->e_seq = ee_timers_seq++;
+    /* Insert into heap */
+    ee_timers[ee_timers_len++] = e;
+    clixon_event_timer_up(ee_timers_len-1);
     clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "%s", str);
     retval = 0;
  done:
@@ -330,20 +610,16 @@ clixon_event_unreg_timeout(int (*fn)(int, void*),
                            void *arg)
 {
     struct event_data  *e;
-    int                 found = 0;
-    struct event_data **e_prev;
+    int                 i;
 
-    e_prev = &ee_timers;
-    for (e = ee_timers; e; e = e->e_next){
+    for (i = 0; i < ee_timers_len; i++){
+        e = ee_timers[i];
         if (fn == e->e_fn && arg == e->e_arg) {
-            found++;
-            *e_prev = e->e_next;
-            free(e);
-            break;
+            free(clixon_event_timer_rm(i));
+            return 0;
         }
-        e_prev = &e->e_next;
     }
-    return found?0:-1;
+    return -1;
 }
 
 /*! Poll to see if there is any data available on this file descriptor.
@@ -357,16 +633,111 @@ int
 clixon_event_poll(int fd)
 {
     int            retval = -1;
-    fd_set         fdset;
-    struct timeval tnull = {0,};
+    struct pollfd  pfd = {0,};
 
-    FD_ZERO(&fdset);
-    FD_SET(fd, &fdset);
-    if ((retval = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull)) < 0)
-        clixon_err(OE_EVENTS, errno, "select");
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if ((retval = poll(&pfd, 1, 0)) < 0)
+        clixon_err(OE_EVENTS, errno, "poll");
     return retval;
 }
 
+/*! Append fd event to ready vector
+ *
+ * @param[in]     e       Fd event
+ * @param[in,out] nready  Length of ready vector
+ * @retval        0       OK
+ * @retval       -1       Error
+ */
+static int
+clixon_event_ready_add(struct event_data *e,
+                       int               *nready)
+{
+    struct event_data **vec;
+    int                 len;
+
+    if (*nready >= ee_ready_max){
+        len = ee_ready_max ? 2*ee_ready_max : 64;
+        if ((vec = realloc(ee_ready, len*sizeof(*vec))) == NULL){
+            clixon_err(OE_EVENTS, errno, "realloc");
+            return -1;
+        }
+        ee_ready = vec;
+        ee_ready_max = len;
+    }
+    ee_ready[(*nready)++] = e;
+    return 0;
+}
+
+/*! Wait for input on registered file descriptors or timeout
+ *
+ * @param[in]  t       Relative timeout, or NULL for no timeout
+ * @param[out] nready  Number of ready fd events in ee_ready
+ * @retval     n       Number of ready file descriptors, 0 on timeout
+ * @retval    -1       Error, errno set. Only set clixon_err if errno is not EINTR
+ */
+static int
+clixon_event_wait(struct timeval *t,
+                  int            *nready)
+{
+    int                n;
+    struct event_data *e;
+#ifdef HAVE_EPOLL_CREATE1
+    int                i;
+    struct epoll_event evs[EVENT_EPOLL_MAX];
+    int                ms = -1;
+    int64_t            ms64;
+
+    if (t != NULL){
+        /* Timers far in the future overflow int milliseconds, wait at most INT_MAX */
+        ms64 = (int64_t)t->tv_sec*1000 + (t->tv_usec+999)/1000;
+        if (ms64 < 0)
+            ms = 0;
+        else if (ms64 > INT_MAX)
+            ms = INT_MAX;
+        else
+            ms = (int)ms64;
+    }
+    *nready = 0;
+    if (ee_epfd == -1){ /* No fds registered */
+        if ((n = poll(NULL, 0, ms)) < 0)
+            return -1;
+        return 0;
+    }
+    if ((n = epoll_wait(ee_epfd, evs, EVENT_EPOLL_MAX, ms)) < 0)
+        return -1;
+    for (i=0; i<n; i++){
+        if (evs[i].data.fd >= ee_fdlen)
+            continue;
+        for (e = ee_fdvec[evs[i].data.fd]; e; e = e->e_fdnext){
+            /* Errors and hangups are reported to both readers and writers */
+            if ((evs[i].events & (e->e_write?EPOLLOUT:EPOLLIN)) == 0 &&
+                (evs[i].events & (EPOLLERR|EPOLLHUP)) == 0)
+                continue;
+            if (clixon_event_ready_add(e, nready) < 0)
+                return -1;
+        }
+    }
+#else /* select */
+    fd_set             fdset;
+    fd_set             wfdset;
+
+    *nready = 0;
+    FD_ZERO(&fdset);
+    FD_ZERO(&wfdset);
+    for (e=ee; e; e=e->e_next)
+        if (e->e_type == EVENT_FD)
+            FD_SET(e->e_fd, e->e_write?&wfdset:&fdset);
+    if ((n = select(FD_SETSIZE, &fdset, &wfdset, NULL, t)) <= 0)
+        return n;
+    for (e=ee; e; e=e->e_next)
+        if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, e->e_write?&wfdset:&fdset))
+            if (clixon_event_ready_add(e, nready) < 0)
+                return -1;
+#endif /* HAVE_EPOLL_CREATE1 */
+    return n;
+}
+
 /*! Dispatch file descriptor events (and timeouts) by invoking callbacks.
  *
  * @param[in] h  Clixon handle
@@ -381,34 +752,31 @@ clixon_event_loop(clixon_handle h)
 {
     struct event_data *e;
     int                n;
+    int                i;
+    int                nready = 0;
     struct timeval     t;
     struct timeval     t0;
     struct timeval     tnull = {0,};
-    fd_set             fdset;
     int                retval = -1;
-    struct event_data *e_next;
+    int                prio;
 
     while (clixon_exit_get() != 1){
-        FD_ZERO(&fdset);
         if (clicon_sig_child_get()){
             /* Go through processes and wait for child processes */
             if (clixon_process_waitpid(h) < 0)
                 goto err;
             clicon_sig_child_set(0);
         }
-        for (e=ee; e; e=e->e_next)
-            if (e->e_type == EVENT_FD)
-                FD_SET(e->e_fd, &fdset);
-        if (ee_timers != NULL){
+        if (ee_timers_len > 0){
             gettimeofday(&t0, NULL);
-            timersub(&ee_timers->e_time, &t0, &t);
+            timersub(&ee_timers[0]->e_time, &t0, &t);
             if (t.tv_sec < 0)
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &tnull);
+                n = clixon_event_wait(&tnull, &nready);
             else
-                n = select(FD_SETSIZE, &fdset, NULL, NULL, &t);
+                n = clixon_event_wait(&t, &nready);
         }
         else
-            n = select(FD_SETSIZE, &fdset, NULL, NULL, NULL);
+            n = clixon_event_wait(NULL, &nready);
         if (clixon_exit_get() == 1){
             break;
         }
@@ -424,9 +792,9 @@ clixon_event_loop(clixon_handle h)
                  *     New select loop is called
                  * (3) Other signals result in an error and return -1.
                  */
-                clixon_debug(CLIXON_DBG_EVENT, "select: %s", strerror(errno));
+                clixon_debug(CLIXON_DBG_EVENT, "%s: %s", EVENT_WAIT_STR, strerror(errno));
                 if (clixon_exit_get() == 1){
-                    clixon_err(OE_EVENTS, errno, "select");
+                    clixon_err(OE_EVENTS, errno, EVENT_WAIT_STR);
                     retval = 0;
                 }
                 else if (clicon_sig_child_get()){
@@ -441,15 +809,14 @@ clixon_event_loop(clixon_handle h)
                     continue;
                 }
                 else
-                    clixon_err(OE_EVENTS, errno, "select");
+                    clixon_err(OE_EVENTS, errno, EVENT_WAIT_STR);
             }
             else
-                clixon_err(OE_EVENTS, errno, "select");
+                clixon_err(OE_EVENTS, errno, EVENT_WAIT_STR);
             goto err;
         }
-        if (n==0){ /* Timeout */
-            e = ee_timers;
-            ee_timers = ee_timers->e_next;
+        if (n==0 && ee_timers_len > 0){ /* Timeout */
+            e = clixon_event_timer_rm(0);
             clixon_debug(CLIXON_DBG_EVENT | CLIXON_DBG_DETAIL, "timeout: %s", e->e_string);
             if ((*e->e_fn)(0, e->e_arg) < 0){
                 free(e);
@@ -457,46 +824,46 @@ clixon_event_loop(clixon_handle h)
             }
             free(e);
         }
+        /* If a callback unregisters an fd event, the rest of the ready vector may be stale.
+         * Then stop and wait again, remaining fds are still ready (level-triggered)
+         */
         _ee_unreg = 0;
-        if (clicon_option_bool(h, "CLICON_SOCK_PRIO")){
-            for (e=ee; e; e=e_next) {
+        prio = clicon_option_bool(h, "CLICON_SOCK_PRIO");
+        if (prio){
+            for (i=0; i<nready; i++){
                 if (clixon_exit_get() == 1)
                     break;
-                e_next = e->e_next;
-                if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio){
-                    clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s prio:%d", e->e_string, e->e_prio);
+                e = ee_ready[i];
+                if (e->e_prio){
+                    clixon_debug(CLIXON_DBG_EVENT, "ready: %s prio:%d", e->e_string, e->e_prio);
                     if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                         clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
                         goto err;
                     }
-                    if (_ee_unreg){
-                        _ee_unreg = 0;
+                    if (_ee_unreg)
                         break;
-                    }
                 }
             }
         }
-
         /* Unprio
          * Note that without prio, round-robin fairness is ensured, not with prio */
-        for (e=ee; e; e=e_next){
+        for (i=0; i<nready && _ee_unreg == 0; i++){
             if (clixon_exit_get() == 1)
                 break;
-            e_next = e->e_next;
-            if (e->e_type == EVENT_FD && FD_ISSET(e->e_fd, &fdset) && e->e_prio==0){
-                clixon_debug(CLIXON_DBG_EVENT, "FD_ISSET: %s", e->e_string);
+            e = ee_ready[i];
+            if (e->e_prio==0){
+                clixon_debug(CLIXON_DBG_EVENT, "ready: %s", e->e_string);
                 if ((*e->e_fn)(e->e_fd, e->e_arg) < 0){
                     clixon_debug(CLIXON_DBG_EVENT, "Error in: %s", e->e_string);
                     goto err;
                 }
-                if (_ee_unreg){
-                    _ee_unreg = 0;
+                if (_ee_unreg)
                     break;
-                }
-                if (clicon_option_bool(h, "CLICON_SOCK_PRIO"))
+                if (prio)
                     break;
             }
         }
+        _ee_unreg = 0;
         clixon_exit_decr(); /* If exit is set and > 1, decrement it (and exit when 1) */
         continue;
       err:
@@ -514,6 +881,7 @@ clixon_event_exit(void)
 {
     struct event_data *e;
     struct event_data *e_next;
+    int                i;
 
     e_next = ee;
     while ((e = e_next) != NULL){
@@ -521,11 +889,24 @@ clixon_event_exit(void)
         free(e);
     }
     ee = NULL;
-    e_next = ee_timers;
-    while ((e = e_next) != NULL){
-        e_next = e->e_next;
-        free(e);
-    }
+    for (i = 0; i < ee_timers_len; i++)
+        free(ee_timers[i]);
+    if (ee_timers)
+        free(ee_timers);
     ee_timers = NULL;
+    ee_timers_len = ee_timers_max = 0;
+    if (ee_ready)
+        free(ee_ready);
+    ee_ready = NULL;
+    ee_ready_max = 0;
+#ifdef HAVE_EPOLL_CREATE1
+    if (ee_fdvec)
+        free(ee_fdvec);
+    ee_fdvec = NULL;
+    ee_fdlen = 0;
+    if (ee_epfd != -1)
+        close(ee_epfd);
+    ee_epfd = -1;
+#endif
     return 0;
 }
@@ -101,19 +101,103 @@
 #include "clixon_xml.h"
 #include "clixon_err.h"
 
-#define HASH_SIZE       1031    /* Number of hash buckets. Should be a prime */
+#define HASH_SIZE_INIT  64      /* Initial number of hash buckets. Must be a power of 2 */
 #define align4(s) (((s)/4)*4 + 4)
 
-/*! A very simplistic algorithm to calculate a hash bucket index
+/*! Hash table header
+ *
+ * The clicon_hash_t vector returned by clicon_hash_init is opaque and points to this struct.
+ * Entries are chained in circular lists per bucket. The number of buckets is doubled when the
+ * number of entries exceeds the number of buckets.
+ */
+struct hash_table {
+    clicon_hash_t *ht_bkt;   /* Vector of buckets */
+    uint32_t       ht_size;  /* Number of buckets, power of 2 */
+    uint32_t       ht_count; /* Number of entries */
+};
+
+#define hash_table(hash) ((struct hash_table *)(hash))
+
+/*! Calculate hash value of a key string
+ *
+ * FNV-1a with a final avalanche (murmur3 fmix32) so that the low bits used as bucket
+ * index depend on all characters of the key
+ * @param[in]  str  Key string
+ * @retval     n    Hash value
  */
 static uint32_t
-hash_bucket(const char *str)
+hash_key(const char *str)
 {
-    uint32_t n = 0;
+    uint32_t n = 2166136261U;
 
-    while(*str)
-        n += (uint32_t)*str++;
-    return n % HASH_SIZE;
+    while (*str){
+        n ^= (uint8_t)*str++;
+        n *= 16777619U;
+    }
+    n ^= n >> 16;
+    n *= 0x85ebca6bU;
+    n ^= n >> 13;
+    n *= 0xc2b2ae35U;
+    n ^= n >> 16;
+    return n;
+}
+
+/*! Find hash entry given key and hash value of key
+ *
+ * @param[in] ht       Hash table
+ * @param[in] key      Variable name
+ * @param[in] hv       Hash value of key
+ * @retval    variable Hash variable structure on success
+ * @retval    NULL     Not found
+ */
+static clicon_hash_t
+hash_lookup1(struct hash_table *ht,
+             const char        *key,
+             uint32_t           hv)
+{
+    clicon_hash_t h0;
+    clicon_hash_t h;
+
+    h = h0 = ht->ht_bkt[hv & (ht->ht_size - 1)];
+    if (h) {
+        do {
+            if (h->h_hash == hv && strcmp(h->h_key, key) == 0)
+                return h;
+            h = NEXTQ(clicon_hash_t, h);
+        } while (h != h0);
+    }
+    return NULL;
+}
+
+/*! Double the number of buckets and move all entries to new buckets
+ *
+ * @param[in] ht   Hash table
+ * @retval    0    OK
+ * @retval   -1    Error
+ */
+static int
+hash_resize(struct hash_table *ht)
+{
+    clicon_hash_t *bkt;
+    clicon_hash_t  h;
+    uint32_t       size;
+    uint32_t       i;
+
+    size = ht->ht_size * 2;
+    if ((bkt = calloc(size, sizeof(clicon_hash_t))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        return -1;
+    }
+    for (i = 0; i < ht->ht_size; i++) {
+        while ((h = ht->ht_bkt[i]) != NULL) {
+            DELQ(h, ht->ht_bkt[i], clicon_hash_t);
+            INSQ(h, bkt[h->h_hash & (size - 1)]);
+        }
+    }
+    free(ht->ht_bkt);
+    ht->ht_bkt = bkt;
+    ht->ht_size = size;
+    return 0;
 }
 
 /*! Initialize hash table.
@@ -125,14 +209,20 @@ hash_bucket(const char *str)
 clicon_hash_t *
 clicon_hash_init(void)
 {
-  clicon_hash_t *hash;
+  struct hash_table *ht;
 
-  if ((hash = (clicon_hash_t *)malloc(sizeof(clicon_hash_t) * HASH_SIZE)) == NULL){
+  if ((ht = malloc(sizeof(*ht))) == NULL){
       clixon_err(OE_UNIX, errno, "malloc");
       return NULL;
   }
-  memset(hash, 0, sizeof(clicon_hash_t)*HASH_SIZE);
-  return hash;
+  memset(ht, 0, sizeof(*ht));
+  if ((ht->ht_bkt = calloc(HASH_SIZE_INIT, sizeof(clicon_hash_t))) == NULL){
+      clixon_err(OE_UNIX, errno, "calloc");
+      free(ht);
+      return NULL;
+  }
+  ht->ht_size = HASH_SIZE_INIT;
+  return (clicon_hash_t *)ht;
 }
 
 /*! Free hash table.
@@ -144,18 +234,21 @@ clicon_hash_init(void)
 int
 clicon_hash_free(clicon_hash_t *hash)
 {
-    int i;
-    clicon_hash_t tmp;
-    for (i = 0; i < HASH_SIZE; i++) {
-        while (hash[i]) {
-            tmp = hash[i];
-            DELQ(tmp, hash[i], clicon_hash_t);
+    struct hash_table *ht = hash_table(hash);
+    uint32_t           i;
+    clicon_hash_t      tmp;
+
+    for (i = 0; i < ht->ht_size; i++) {
+        while (ht->ht_bkt[i]) {
+            tmp = ht->ht_bkt[i];
+            DELQ(tmp, ht->ht_bkt[i], clicon_hash_t);
             free(tmp->h_key);
             free(tmp->h_val);
             free(tmp);
         }
     }
-    free(hash);
+    free(ht->ht_bkt);
+    free(ht);
     return 0;
 }
 
@@ -170,19 +263,7 @@ clicon_hash_t
 clicon_hash_lookup(clicon_hash_t *hash,
                    const char    *key)
 {
-    uint32_t      bkt;
-    clicon_hash_t h;
-
-    bkt = hash_bucket(key);
-    h = hash[bkt];
-    if (h) {
-        do {
-            if (!strcmp(h->h_key, key))
-                return h;
-            h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
-    }
-    return NULL;
+    return hash_lookup1(hash_table(hash), key, hash_key(key));
 }
 
 /*! Get value of hash
@@ -229,9 +310,11 @@ clicon_hash_add(clicon_hash_t *hash,
                 void          *val,
                 size_t         vlen)
 {
+    struct hash_table *ht = hash_table(hash);
     void         *newval = NULL;
     clicon_hash_t h;
     clicon_hash_t new = NULL;
+    uint32_t      hv;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
@@ -244,8 +327,13 @@ clicon_hash_add(clicon_hash_t *hash,
         goto catch;
     }
     /* If variable exist, don't allocate a new. just replace value */
-    h = clicon_hash_lookup(hash, key);
+    hv = hash_key(key);
+    h = hash_lookup1(ht, key, hv);
     if (h == NULL) {
+        /* Keep load factor <= 1 */
+        if (ht->ht_count >= ht->ht_size &&
+            hash_resize(ht) < 0)
+            goto catch;
         if ((new = (clicon_hash_t)malloc(sizeof(*new))) == NULL){
             clixon_err(OE_UNIX, errno, "malloc");
             goto catch;
@@ -256,6 +344,7 @@ clicon_hash_add(clicon_hash_t *hash,
             clixon_err(OE_UNIX, errno, "strdup");
             goto catch;
         }
+        new->h_hash = hv;
         h = new;
     }
     if (vlen){
@@ -274,9 +363,10 @@ clicon_hash_add(clicon_hash_t *hash,
     h->h_vlen =  vlen;
 
     /* Add to list only if new variable */
-    if (new)
-        INSQ(h, hash[hash_bucket(key)]);
-
+    if (new){
+        INSQ(h, ht->ht_bkt[hv & (ht->ht_size - 1)]);
+        ht->ht_count++;
+    }
     return h;
 
 catch:
@@ -300,7 +390,8 @@ int
 clicon_hash_del(clicon_hash_t *hash,
                 const char    *key)
 {
-    clicon_hash_t h;
+    struct hash_table *ht = hash_table(hash);
+    clicon_hash_t      h;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
@@ -309,7 +400,8 @@ clicon_hash_del(clicon_hash_t *hash,
     h = clicon_hash_lookup(hash, key);
     if (h == NULL)
         return -1;
-    DELQ(h, hash[hash_bucket(key)], clicon_hash_t);
+    DELQ(h, ht->ht_bkt[h->h_hash & (ht->ht_size - 1)], clicon_hash_t);
+    ht->ht_count--;
     free(h->h_key);
     free(h->h_val);
     free(h);
@@ -331,32 +423,31 @@ clicon_hash_keys(clicon_hash_t *hash,
                  char        ***vector,
                  size_t        *nkeys)
 {
-    int           retval = -1;
-    int           bkt;
-    clicon_hash_t h;
-    char        **tmp;
-    char        **keys = NULL;
+    int                retval = -1;
+    struct hash_table *ht = hash_table(hash);
+    uint32_t           bkt;
+    clicon_hash_t      h;
+    char             **keys = NULL;
 
     if (hash == NULL){
         clixon_err(OE_UNIX, EINVAL, "hash is NULL");
         return -1;
     }
     *nkeys = 0;
-    for (bkt = 0; bkt < HASH_SIZE; bkt++) {
-        h = hash[bkt];
+    if (ht->ht_count &&
+        (keys = malloc(ht->ht_count * sizeof(char *))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto catch;
+    }
+    for (bkt = 0; bkt < ht->ht_size; bkt++) {
+        h = ht->ht_bkt[bkt];
         do {
             if (h == NULL)
                 break;
-            tmp = realloc(keys, ((*nkeys)+1) * sizeof(char *));
-            if (tmp == NULL){
-                clixon_err(OE_UNIX, errno, "realloc");
-                goto catch;
-            }
-            keys = tmp;
             keys[*nkeys] = h->h_key;
             (*nkeys)++;
             h = NEXTQ(clicon_hash_t, h);
-        } while (h != hash[bkt]);
+        } while (h != ht->ht_bkt[bkt]);
     }
     if (vector){
         *vector = keys;
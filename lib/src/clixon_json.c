@@ -53,6 +53,7 @@
 #include <limits.h>
 #include <stdint.h>
 #include <syslog.h>
+#include <sys/socket.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -75,6 +76,7 @@
 #include "clixon_xml_map.h"
 #include "clixon_xml_nsctx.h" /* namespace context */
 #include "clixon_netconf_lib.h"
+#include "clixon_proto.h"
 #include "clixon_json.h"
 #include "clixon_json_parse.h"
 
@@ -210,7 +212,7 @@ array_eval(cxobj *xprev,
     }
     if (xnext &&
         xml_type(xnext)==CX_ELMNT &&
-        strcmp(xml_name(x), xml_name(xnext))==0){
+        xml_name(x) == xml_name(xnext)){ /* interned */
         ns2 = xml_find_type_value(xnext, NULL, "xmlns", CX_ATTR);
         if ((!nsx && !ns2)
             || (nsx && ns2 && strcmp(nsx,ns2)==0))
@@ -218,7 +220,7 @@ array_eval(cxobj *xprev,
     }
     if (xprev &&
         xml_type(xprev)==CX_ELMNT &&
-        strcmp(xml_name(x),xml_name(xprev))==0){
+        xml_name(x) == xml_name(xprev)){
         ns2 = xml_find_type_value(xprev, NULL, "xmlns", CX_ATTR);
         if ((!nsx && !ns2)
             || (nsx && ns2 && strcmp(nsx,ns2)==0))
@@ -967,6 +969,9 @@ xml2json1_cbuf(cbuf                   *cb,
             cprintf(cb, ",%s", pretty?"\n":"");
             --commas;
         }
+        /* Send as chunk if streaming reply */
+        if (clixon_msg_writer_check(cb) < 0)
+            goto done;
     }
     if (cbuf_len(metacbc)){
         cprintf(cb, "%s", cbuf_get(metacbc));
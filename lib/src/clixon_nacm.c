@@ -76,6 +76,7 @@
 #include "clixon_xml_io.h"
 #include "clixon_path.h"
 #include "clixon_xml_vec.h"
+#include "clixon_yang_schema_mount.h"
 #include "clixon_nacm.h"
 
 /* NACM namespace for use with xml namespace contexts and xpath */
@@ -317,94 +318,322 @@ nacm_rpc(char         *rpc,
     goto done;
 }
 
-/* Local struct for keeping preparation/compiled data in NACM data path code */
-struct prepvec{
-    qelem_t       pv_q;
-    cxobj        *pv_xrule;
-    clixon_xvec  *pv_xpathvec;
+/*---------------------------------------------------------------
+ * Compiled NACM data node rules
+ */
+
+/* NACM data node rule compiled from a rule of a user's rule-lists */
+struct nacm_crule{
+    int        cr_access;   /* Access operations as bits: (1<<NACM_READ), etc */
+    int        cr_permit;   /* Action is permit, otherwise deny */
+    char      *cr_module;   /* Module name, NULL if "*" */
+    char      *cr_path;     /* Instance-id path, NULL if module rule */
+    yang_stmt *cr_yang;     /* YANG schema node of path */
+    int        cr_instance; /* Path has predicates, evaluate on instance data */
 };
-typedef struct prepvec prepvec;
+typedef struct nacm_crule nacm_crule;
 
-/*! Delete all Upgrade callbacks
+/* Rule decision of a YANG schema node for one access operation */
+struct nacm_ydec{
+    int        yd_rule;     /* First schema rule matching the node, or -1 */
+    int        yd_inst;     /* First instance rule that may match before yd_rule, or -1 */
+    char      *yd_module;   /* Module name of the node */
+    int        yd_uniform;  /* Decision is same for whole subtree, no rule boundary below */
+};
+typedef struct nacm_ydec nacm_ydec;
+
+/* NACM data node rules of a user compiled from NACM config
+ * Rules without predicates are bound to YANG schema nodes and decided per schema node
+ * (not per XML node), the decisions are kept in nu_ydec
  */
-int
-prepvec_free(prepvec *pv_list)
+struct nacm_user{
+    qelem_t        nu_q;
+    char          *nu_name;                  /* User name */
+    size_t         nu_glen;                  /* Number of groups of user */
+    nacm_crule    *nu_rules;                 /* Rules in order of rule-lists and rules */
+    int            nu_len;                   /* Length of nu_rules */
+    clicon_hash_t *nu_ydec[NACM_DELETE+1];   /* Decision per schema node and access */
+    yang_stmt     *nu_ys[NACM_DELETE+1];     /* Schema node of last decision per access */
+    nacm_ydec      nu_yd[NACM_DELETE+1];     /* Last decision per access */
+};
+typedef struct nacm_user nacm_user;
+
+/* Number of compiled rule sets */
+static uint64_t _nacm_compiled_compiles = 0;
+
+/* Number of NACM data node checks using an existing compiled rule set */
+static uint64_t _nacm_compiled_hits = 0;
+
+/* Number of users with compiled rule sets */
+static uint32_t _nacm_compiled_users = 0;
+
+/* Number of uniformly permitted subtrees not descended */
+static uint64_t _nacm_compiled_skipped = 0;
+
+/* Number of uniformly denied subtrees removed without descending */
+static uint64_t _nacm_compiled_pruned = 0;
+
+/* Generation of NACM config that the compiled rule sets were compiled from */
+static uint64_t _nacm_compiled_generation = 0;
+
+/*! Free compiled rules of a user
+ */
+static int
+nacm_user_free(nacm_user *nu)
 {
-    prepvec *pv;
+    nacm_crule *cr;
+    int         i;
 
-    while((pv = pv_list) != NULL) {
-        DELQ(pv, pv_list, prepvec *);
-        if (pv->pv_xpathvec)
-            clixon_xvec_free(pv->pv_xpathvec);
-        free(pv);
+    for (i=0; i<nu->nu_len; i++){
+        cr = &nu->nu_rules[i];
+        if (cr->cr_module)
+            free(cr->cr_module);
+        if (cr->cr_path)
+            free(cr->cr_path);
     }
+    if (nu->nu_rules)
+        free(nu->nu_rules);
+    for (i=0; i<=NACM_DELETE; i++)
+        if (nu->nu_ydec[i])
+            clicon_hash_free(nu->nu_ydec[i]);
+    if (nu->nu_name)
+        free(nu->nu_name);
+    free(nu);
     return 0;
 }
 
-prepvec *
-prepvec_add(prepvec  **pv_listp,
-            cxobj     *xrule)
+/*! Free list of compiled rules of users
+ */
+static int
+nacm_user_free_all(nacm_user *nu_list)
 {
-    prepvec *pv;
+    nacm_user *nu;
 
-    if ((pv = malloc(sizeof(*pv))) == NULL){
-        clixon_err(OE_UNIX, errno, "malloc");
-        return NULL;
+    while ((nu = nu_list) != NULL) {
+        DELQ(nu, nu_list, nacm_user *);
+        nacm_user_free(nu);
+        _nacm_compiled_users--;
+    }
+    return 0;
+}
+
+/*! Discard all compiled NACM rule sets
+ *
+ * Rule sets are compiled again from NACM config on next access
+ * @param[in]  h   Clixon handle
+ * @retval     0   OK
+ */
+int
+nacm_compiled_reset(clixon_handle h)
+{
+    nacm_user *nu_list = NULL;
+
+    clicon_ptr_get(h, "nacm-compiled", (void**)&nu_list);
+    nacm_user_free_all(nu_list);
+    clicon_ptr_del(h, "nacm-compiled");
+    return 0;
+}
+
+/*! Get generation of NACM config
+ *
+ * Internal NACM config is in running and follows its generation, which changes on every
+ * modification of running, eg commit or copy-config.
+ * External NACM config changes generation when the NACM file is loaded.
+ * @param[in]  h    Clixon handle
+ * @retval     gen  Generation
+ * @see xmldb_generation_get
+ * @see clicon_nacm_ext_set
+ */
+static uint64_t
+nacm_generation_get(clixon_handle h)
+{
+    char *mode;
+
+    mode = clicon_option_str(h, "CLICON_NACM_MODE");
+    if (mode && strcmp(mode, "external") == 0)
+        return (uint64_t)clicon_data_int_get(h, "nacm_ext_generation");
+    return xmldb_generation_get(h, "running");
+}
+
+/*! Get statistics of compiled NACM rule sets
+ *
+ * @param[out] compiles  Number of compiled rule sets
+ * @param[out] hits      Number of data node checks using an existing rule set
+ * @param[out] users     Number of users with compiled rule sets
+ * @param[out] skipped   Number of uniformly permitted subtrees not descended
+ * @param[out] pruned    Number of uniformly denied subtrees removed without descending
+ * @retval     0         OK
+ */
+int
+nacm_compiled_stats(uint64_t *compiles,
+                    uint64_t *hits,
+                    uint32_t *users,
+                    uint64_t *skipped,
+                    uint64_t *pruned)
+{
+    *compiles = _nacm_compiled_compiles;
+    *hits = _nacm_compiled_hits;
+    *users = _nacm_compiled_users;
+    *skipped = _nacm_compiled_skipped;
+    *pruned = _nacm_compiled_pruned;
+    return 0;
+}
+
+/*! Compile a NACM data node rule
+ *
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  xrule   NACM rule
+ * @param[in]  yspec   YANG spec
+ * @retval     0       OK, rule added to nu if it can match a data node
+ * @retval    -1       Error
+ */
+static int
+nacm_crule_add(nacm_user *nu,
+               cxobj     *xrule,
+               yang_stmt *yspec)
+{
+    int          retval = -1;
+    nacm_crule  *cr;
+    nacm_crule   cr0 = {0,};
+    char        *access_operations;
+    char        *module;
+    char        *action;
+    cxobj       *pathobj;
+    char        *path;
+    clixon_path *cplist = NULL;
+    clixon_path *cp;
+    int          ret;
+
+    /* 6a) A rule without module-name never matches */
+    if ((module = xml_find_body(xrule, "module-name")) == NULL)
+        goto ok;
+    if ((action = xml_find_body(xrule, "action")) == NULL)
+        goto ok;
+    access_operations = xml_find_body(xrule, "access-operations");
+    if (match_access(access_operations, "read", NULL))
+        cr0.cr_access |= (1<<NACM_READ);
+    if (match_access(access_operations, "create", "write"))
+        cr0.cr_access |= (1<<NACM_CREATE);
+    if (match_access(access_operations, "update", "write"))
+        cr0.cr_access |= (1<<NACM_UPDATE);
+    if (match_access(access_operations, "delete", "write"))
+        cr0.cr_access |= (1<<NACM_DELETE);
+    if (cr0.cr_access == 0)
+        goto ok;
+    cr0.cr_permit = strcmp(action, "deny") != 0;
+    /*  6b) Either (1) the rule does not have a "rule-type" defined or
+        (2) the "rule-type" is "data-node" and the "path" matches the
+        requested data node, action node, or notification node. */
+    if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
+        if (xml_find_body(xrule, "rpc-name") || xml_find_body(xrule, "notification-name"))
+            goto ok;
+    }
+    else {
+        if ((path = xml_body(pathobj)) == NULL)
+            goto ok;
+        path = clixon_trim2(path, " \t\n");
+        /* Parse path and bind it to YANG, a path that does not resolve never matches */
+        if ((ret = clixon_instance_id_parse(yspec, &cplist, NULL, "%s", path)) < 0)
+            goto done;
+        if (ret == 0)
+            goto ok;
+        if ((cp = cplist) != NULL){
+            do {
+                if (cp->cp_cvk != NULL)
+                    cr0.cr_instance = 1;
+                cr0.cr_yang = cp->cp_yang;
+                cp = NEXTQ(clixon_path *, cp);
+            } while (cp && cp != cplist);
+        }
+        /* Paths into mount-points are evaluated on instance data */
+        if (cr0.cr_yang == NULL || ys_spec(cr0.cr_yang) != yspec)
+            cr0.cr_instance = 1;
+        if ((cr0.cr_path = strdup(path)) == NULL){
+            clixon_err(OE_UNIX, errno, "strdup");
+            goto done;
+        }
+    }
+    if (strcmp(module, "*") != 0 &&
+        (cr0.cr_module = strdup(module)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    if ((cr = realloc(nu->nu_rules, (nu->nu_len+1)*sizeof(*cr))) == NULL){
+        clixon_err(OE_UNIX, errno, "realloc");
+        goto done;
     }
-    memset(pv, 0, sizeof(*pv));
-    ADDQ(pv, *pv_listp);
-    pv->pv_xrule = xrule;
-    if ((pv->pv_xpathvec = clixon_xvec_new()) == NULL)
-        return NULL;
-    return pv;
+    nu->nu_rules = cr;
+    nu->nu_rules[nu->nu_len++] = cr0;
+    memset(&cr0, 0, sizeof(cr0));
+ ok:
+    retval = 0;
+ done:
+    if (cr0.cr_module)
+        free(cr0.cr_module);
+    if (cr0.cr_path)
+        free(cr0.cr_path);
+    if (cplist)
+        clixon_path_free(cplist);
+    return retval;
 }
 
-/*! Prepare datastructures before running through XML tree
+/*! Compile NACM data node rules of a user
  *
- * Save rules in a "cache"
- * These rules match:
- *  - user/group
- *  - have read access-op, etc
- * Also make instance-id lookups on top object for each rule. Assume at most one result
- * @param[in] h      Clixon handle
- * @retval    0      OK
- * @retval   -1      Error
+ * Select the rules of the rule-lists of the user's groups, in order, and parse and
+ * bind their paths to YANG.
+ * @param[in]  h         Clixon handle
+ * @param[in]  xnacm     NACM XML tree, root should be "nacm"
+ * @param[in]  username  User name of requestor
+ * @param[in]  nsc       Namespace context with NACM namespace as default
+ * @param[out] nup       Compiled rules of user, free with nacm_user_free
+ * @retval     0         OK
+ * @retval    -1         Error
  */
 static int
-nacm_datanode_prepare(clixon_handle     h,
-                      cxobj            *xt,
-                      enum nacm_access  access,
-                      cxobj           **gvec,
-                      size_t            glen,
-                      cxobj           **rlistvec,
-                      size_t            rlistlen,
-                      cvec             *nsc,
-                      prepvec         **pv_listp)
+nacm_user_compile(clixon_handle h,
+                  cxobj        *xnacm,
+                  char         *username,
+                  cvec         *nsc,
+                  nacm_user   **nup)
 {
     int        retval = -1;
-    cxobj     *rlist;
-    int        i;
-    int        j;
-    int        k;
-    char      *gname;
+    nacm_user *nu = NULL;
+    cxobj    **gvec = NULL; /* groups */
+    size_t     glen = 0;
+    cxobj    **rlistvec = NULL; /* rule-list */
+    size_t     rlistlen = 0;
     cxobj    **rvec = NULL; /* rules */
     size_t     rlen;
-    cxobj     *xrule;
-    cxobj     *pathobj;
-    char      *access_operations;
-    char      *path0;         /* Non-canonical path */
-    char      *path=NULL;     /* Canonical path */
-    cvec      *nsc0 = NULL;   /* Non-canonical namespace context */
+    cxobj     *rlist;
+    char      *gname;
     yang_stmt *yspec;
-    cxobj   **xvec = NULL;
-    int       xlen = 0;
-    int       ret;
-    prepvec *pv;
+    int        i;
+    int        j;
 
     yspec = clicon_dbspec_yang(h);
-    for (i=0; i<rlistlen; i++){         /* Loop through rule list */
+    if ((nu = malloc(sizeof(*nu))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(nu, 0, sizeof(*nu));
+    if ((nu->nu_name = strdup(username)) == NULL){
+        clixon_err(OE_UNIX, errno, "strdup");
+        goto done;
+    }
+    /* 3.   Check all the "group" entries to see if any of them contain a
+       "user-name" entry that equals the username for the session
+       making the request. */
+    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+        goto done;
+    nu->nu_glen = glen;
+    /* 5. Process all rule-list entries, in the order they appear in the
+        configuration.  If a rule-list's "group" leaf-list does not
+        match any of the user's groups, proceed to the next rule-list
+        entry. */
+    if (glen && xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+        goto done;
+    for (i=0; i<rlistlen; i++){
         rlist = rlistvec[i];
-        /* Loop through user's group to find match in this rule-list */
         for (j=0; j<glen; j++){
             gname = xml_find_body(gvec[j], "name");
             if (xpath_first(rlist, nsc, ".[group='%s']", gname)!=NULL)
@@ -412,255 +641,508 @@ nacm_datanode_prepare(clixon_handle     h,
         }
         if (j==glen) /* not found */
             continue;
-        /* 6. For each rule-list entry found, process all rules, in order,
-           until a rule that matches the requested access operation is
-           found. (see 6 sub rules in nacm_rule_datanode
-        */
+        /* 6. For each rule-list entry found, process all rules, in order */
         if (xpath_vec(rlist, nsc, "rule", &rvec, &rlen) < 0)
             goto done;
-        for (j=0; j<rlen; j++){ /* Loop through rules */
-            xrule = rvec[j];
-            /* 6c) For a "read" access operation, the rule's "access-operations"
-               leaf has the "read" bit set or has the special value "*" */
-            access_operations = xml_find_body(xrule, "access-operations");
-            switch (access){
-            case NACM_READ:
-                /* 6c) For a "read" access operation, the rule's "access-operations"
-                   leaf has the "read" bit set or has the special value "*" */
-                if (!match_access(access_operations, "read", NULL))
-                    continue;
-                break;
-            case NACM_CREATE:
-                /* 6d) For a "create" access operation, the rule's "access-operations"
-                   leaf has the "create" bit set or has the special value "*". */
-                if (!match_access(access_operations, "create", "write"))
-                    continue;
+        for (j=0; j<rlen; j++)
+            if (nacm_crule_add(nu, rvec[j], yspec) < 0)
+                goto done;
+        if (rvec){
+            free(rvec);
+            rvec = NULL;
+        }
+    }
+    clixon_debug(CLIXON_DBG_NACM, "user:%s groups:%zu rules:%d", username, glen, nu->nu_len);
+    *nup = nu;
+    nu = NULL;
+    retval = 0;
+ done:
+    if (nu)
+        nacm_user_free(nu);
+    if (gvec)
+        free(gvec);
+    if (rlistvec)
+        free(rlistvec);
+    if (rvec)
+        free(rvec);
+    return retval;
+}
+
+/*! Get compiled NACM data node rules of a user, compile them if not found
+ *
+ * Rule sets are valid until the generation of the NACM config changes
+ * @param[in]  h         Clixon handle
+ * @param[in]  xnacm     NACM XML tree, root should be "nacm"
+ * @param[in]  username  User name of requestor
+ * @param[in]  nsc       Namespace context with NACM namespace as default
+ * @param[out] nup       Compiled rules of user (direct pointer)
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+nacm_user_get(clixon_handle h,
+              cxobj        *xnacm,
+              char         *username,
+              cvec         *nsc,
+              nacm_user   **nup)
+{
+    int        retval = -1;
+    nacm_user *nu_list = NULL;
+    nacm_user *nu;
+    uint64_t   gen;
+
+    gen = nacm_generation_get(h);
+    if (gen != _nacm_compiled_generation){
+        clixon_debug(CLIXON_DBG_NACM, "NACM config changed");
+        if (nacm_compiled_reset(h) < 0)
+            goto done;
+        _nacm_compiled_generation = gen;
+    }
+    clicon_ptr_get(h, "nacm-compiled", (void**)&nu_list);
+    if ((nu = nu_list) != NULL){
+        do {
+            if (strcmp(nu->nu_name, username) == 0){
+                _nacm_compiled_hits++;
+                *nup = nu;
+                goto ok;
+            }
+            nu = NEXTQ(nacm_user *, nu);
+        } while (nu && nu != nu_list);
+    }
+    if (_nacm_compiled_users >= NACM_COMPILED_USERS){
+        nacm_user_free_all(nu_list);
+        nu_list = NULL;
+        clicon_ptr_del(h, "nacm-compiled");
+    }
+    if (nacm_user_compile(h, xnacm, username, nsc, &nu) < 0)
+        goto done;
+    _nacm_compiled_compiles++;
+    _nacm_compiled_users++;
+    ADDQ(nu, nu_list);
+    if (clicon_ptr_set(h, "nacm-compiled", nu_list) < 0)
+        goto done;
+    *nup = nu;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Check if YANG node is a schema node or a descendant of it
+ *
+ * @param[in]  ys    YANG node
+ * @param[in]  yanc  YANG schema node of a rule path
+ * @retval     1     ys is yanc or a descendant of yanc
+ * @retval     0     Not
+ */
+static int
+nacm_yang_below(yang_stmt *ys,
+                yang_stmt *yanc)
+{
+    while (ys != NULL){
+        if (ys == yanc)
+            return 1;
+        ys = yang_parent_get(ys);
+    }
+    return 0;
+}
+
+/*! Check if a YANG schema subtree has nodes that rules may decide differently
+ *
+ * That is data nodes of other modules than the top of the subtree, eg augmented,
+ * anydata whose XML may have any namespace, or mount-points
+ * @param[in]  ys    YANG schema node, top of subtree
+ * @param[in]  ymod  Module of ys
+ * @retval     1     Yes
+ * @retval     0     No
+ * @retval    -1     Error
+ */
+static int
+nacm_yang_foreign(yang_stmt *ys,
+                  yang_stmt *ymod)
+{
+    yang_stmt *yc;
+    yang_stmt *ym = NULL;
+    int        inext;
+    int        ret;
+
+    if (yang_schema_mount_point(ys))
+        return 1;
+    inext = 0;
+    while ((yc = yn_iter(ys, &inext)) != NULL) {
+        switch (yang_keyword_get(yc)){
+        case Y_ANYDATA:
+        case Y_ANYXML:
+            return 1;
+        case Y_CONTAINER:
+        case Y_LIST:
+        case Y_LEAF:
+        case Y_LEAF_LIST:
+        case Y_CHOICE:
+        case Y_CASE:
+            if (ys_real_module(yc, &ym) < 0)
+                return -1;
+            if (ym != ymod)
+                return 1;
+            if ((ret = nacm_yang_foreign(yc, ymod)) != 0)
+                return ret;
+            break;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+/*! Check if XML node is, or is a descendant of, a node of an instance rule path
+ *
+ * @param[in]  xpathvec  Instance-id path result
+ * @param[in]  xn        XML node (requested node)
+ * @retval     1         Match
+ * @retval     0         No match
+ */
+static int
+nacm_xvec_match(clixon_xvec *xpathvec,
+                cxobj       *xn)
+{
+    cxobj *xp;
+    int    i;
+
+    for (i=0; i<clixon_xvec_len(xpathvec); i++){
+        xp = clixon_xvec_i(xpathvec, i);
+        if (xn == xp || xml_isancestor(xn, xp))
+            return 1;
+    }
+    return 0;
+}
+
+/*! Get rule decision of a YANG schema node
+ *
+ * Decide the first rule without predicates that matches the schema node, and
+ * the first rule with predicates before it that may match instances of the node.
+ * Also decide if the whole schema subtree has the same decision, ie no rule with a
+ * path below the node applies, and no rule with predicates, or with a module, may
+ * apply to nodes of the subtree differently.
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  access  Access operation (not exec)
+ * @param[in]  ys      YANG schema node
+ * @param[out] yd      Decision of schema node
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+nacm_ydec_get(nacm_user       *nu,
+              enum nacm_access access,
+              yang_stmt       *ys,
+              nacm_ydec       *yd)
+{
+    int         retval = -1;
+    char        key[32];
+    nacm_ydec  *yd0;
+    nacm_crule *cr;
+    yang_stmt  *ymod = NULL;
+    int         i;
+    int         modcheck = 0;
+    int         ret;
+
+    if (nu->nu_ys[access] == ys){
+        *yd = nu->nu_yd[access];
+        goto ok;
+    }
+    if (nu->nu_ydec[access] == NULL &&
+        (nu->nu_ydec[access] = clicon_hash_init()) == NULL)
+        goto done;
+    snprintf(key, sizeof(key), "%p", ys);
+    if ((yd0 = clicon_hash_value(nu->nu_ydec[access], key, NULL)) != NULL)
+        *yd = *yd0;
+    else {
+        memset(yd, 0, sizeof(*yd));
+        yd->yd_rule = yd->yd_inst = -1;
+        if (ys_real_module(ys, &ymod) < 0)
+            goto done;
+        if (ymod)
+            yd->yd_module = yang_argument_get(ymod);
+        for (i=0; i<nu->nu_len; i++){
+            cr = &nu->nu_rules[i];
+            if ((cr->cr_access & (1<<access)) == 0)
+                continue;
+            /* 6a) The rule's "module-name" leaf is "*" or equals the name of
+             * the YANG module where the requested data node is defined.
+             * A node of unknown module only matches "*" */
+            if (cr->cr_module &&
+                (yd->yd_module == NULL || strcmp(cr->cr_module, yd->yd_module) != 0))
+                continue;
+            if (cr->cr_path == NULL)
                 break;
-            case NACM_DELETE:
-                /* 6e) For a "delete" access operation, the rule's "access-operations" 
-                   leaf has the "delete" bit set or has the  special value "*". */
-                if (!match_access(access_operations, "delete", "write"))
-                    continue;
+            if (cr->cr_instance){
+                if (yd->yd_inst == -1 &&
+                    (cr->cr_yang == NULL || nacm_yang_below(ys, cr->cr_yang)))
+                    yd->yd_inst = i;
+                continue;
+            }
+            if (nacm_yang_below(ys, cr->cr_yang))
                 break;
-            case NACM_UPDATE:
-                /* 6f) For an "update" access operation, the rule's "access-operations"
-                   leaf has the "update" bit set or has the special value "*". */ 
-                if (!match_access(access_operations, "update", "write"))
-                    continue;
+        }
+        if (i < nu->nu_len)
+            yd->yd_rule = i;
+        /* Rules after yd_rule do not apply in the subtree, unless for nodes of other modules */
+        yd->yd_uniform = (yd->yd_inst == -1);
+        for (i=0; yd->yd_uniform && i<nu->nu_len; i++){
+            cr = &nu->nu_rules[i];
+            if ((cr->cr_access & (1<<access)) == 0)
+                continue;
+            if (yd->yd_rule != -1 && i > yd->yd_rule)
                 break;
-            default:
-                clixon_err(OE_XML, EINVAL, "Access %d unupported (shouldnt happen)", access);
+            if (cr->cr_module || cr->cr_instance)
+                modcheck++;
+            if (cr->cr_yang && cr->cr_yang != ys && nacm_yang_below(cr->cr_yang, ys))
+                yd->yd_uniform = 0; /* Rule boundary below node */
+        }
+        if (yd->yd_uniform && modcheck){
+            if ((ret = nacm_yang_foreign(ys, ymod)) < 0)
                 goto done;
-                break;
-            }
-            /*  6b) Either (1) the rule does not have a "rule-type" defined or
-                (2) the "rule-type" is "data-node" and the "path" matches the
-                requested data node, action node, or notification node. */    
-            if ((pathobj = xml_find_type(xrule, NULL, "path", CX_ELMNT)) == NULL){
-                if (xml_find_body(xrule, "rpc-name") || xml_find_body(xrule, "notification-name"))
+            if (ret == 1)
+                yd->yd_uniform = 0;
+        }
+        if (clicon_hash_add(nu->nu_ydec[access], key, yd, sizeof(*yd)) == NULL)
+            goto done;
+    }
+    nu->nu_ys[access] = ys;
+    nu->nu_yd[access] = *yd;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Find first compiled rule that matches a requested XML node
+ *
+ * @param[in]  nu       Compiled rules of user
+ * @param[in]  access   Access operation (not exec)
+ * @param[in]  xvecs    Instance-id results of rules with predicates, indexed as nu_rules
+ * @param[in]  xn       XML node (requested node)
+ * @param[in]  yspec    YANG spec
+ * @param[out] crp      First matching rule, or NULL if no rule matches
+ * @param[out] uniform  Set if same rule, or no rule, matches all nodes in the subtree of xn
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+nacm_user_match(nacm_user       *nu,
+                enum nacm_access access,
+                clixon_xvec    **xvecs,
+                cxobj           *xn,
+                yang_stmt       *yspec,
+                nacm_crule     **crp,
+                int             *uniform)
+{
+    int         retval = -1;
+    nacm_ydec   yd;
+    nacm_crule *cr;
+    yang_stmt  *ys;
+    yang_stmt  *ymod = NULL;
+    cxobj      *xa;
+    int         end;
+    int         i;
+
+    *crp = NULL;
+    *uniform = 0;
+    if ((ys = xml_spec(xn)) != NULL){
+        if (nacm_ydec_get(nu, access, ys, &yd) < 0)
+            goto done;
+        *uniform = yd.yd_uniform;
+        if (yd.yd_inst != -1){
+            end = yd.yd_rule == -1 ? nu->nu_len : yd.yd_rule;
+            for (i=yd.yd_inst; i<end; i++){
+                cr = &nu->nu_rules[i];
+                if (!cr->cr_instance || (cr->cr_access & (1<<access)) == 0)
                     continue;
-                /* Here a new xrule is found, add it */
-                if (prepvec_add(pv_listp, xrule) == NULL)
-                    goto done;
-            }
-            else{
-                path0 = clixon_trim2(xml_body(pathobj), " \t\n");
-                /* Get canonical namespace context for nacm paths */
-                if ((path = strdup(path0)) == NULL){
-                    clixon_err(OE_UNIX, errno, "strdup");
-                    goto done;
-                }
-#if 0
-                /* See https://github.com/clicon/clixon/issues/129:
-                 * If this is enabled, you are back to the problem of JSON encodings
-                 */
-                /* Create namespace context for with nacm namespace as default */
-                if (xml_nsctx_node(pathobj, &nsc0) < 0)
-                    goto done;
-                /* instance-id requires canonical paths */
-                if (xpath2canonical(path0, nsc0, yspec, &path, NULL) < 0)
-                    goto done;
-#endif
-                if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", path)) < 0)
-                    goto done;
-                if (ret == 0)
+                if (cr->cr_module &&
+                    (yd.yd_module == NULL || strcmp(cr->cr_module, yd.yd_module) != 0))
                     continue;
-                /* Here a new xrule is found, add it */
-                if ((pv = prepvec_add(pv_listp, xrule)) == NULL)
-                    goto done;
-                for (k=0; k<xlen; k++){
-                    if (clixon_xvec_append(pv->pv_xpathvec, xvec[k]) < 0)
-                        goto done;
-                }
-                if (xvec){
-                    free(xvec);
-                    xvec = NULL;
-                }
-                if (nsc0){
-                    cvec_free(nsc0);
-                    nsc0 = NULL;
-                }
-                if (path){
-                    free(path);
-                    path = NULL;
+                if (xvecs && xvecs[i] && nacm_xvec_match(xvecs[i], xn)){
+                    *crp = cr;
+                    goto ok;
                 }
             }
         }
-        if (rvec){
-            free(rvec);
-            rvec=NULL;
+        if (yd.yd_rule != -1)
+            *crp = &nu->nu_rules[yd.yd_rule];
+        goto ok;
+    }
+    /* No YANG, eg top-level or anydata: match module of XML namespace and
+     * path of closest ancestor with YANG */
+    for (xa = xml_parent(xn); xa != NULL; xa = xml_parent(xa))
+        if ((ys = xml_spec(xa)) != NULL)
+            break;
+    for (i=0; i<nu->nu_len; i++){
+        cr = &nu->nu_rules[i];
+        if ((cr->cr_access & (1<<access)) == 0)
+            continue;
+        if (cr->cr_module){
+            if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+                goto done;
+            if (ymod == NULL || strcmp(yang_argument_get(ymod), cr->cr_module) != 0)
+                continue;
+        }
+        if (cr->cr_path == NULL)
+            break;
+        if (cr->cr_instance){
+            if (xvecs && xvecs[i] && nacm_xvec_match(xvecs[i], xn))
+                break;
         }
+        else if (ys && nacm_yang_below(ys, cr->cr_yang))
+            break;
     }
+    if (i < nu->nu_len)
+        *crp = cr;
+ ok:
     retval = 0;
  done:
-    if (xvec)
-        free(xvec);
-    if (path)
-        free(path);
-    if (nsc0)
-        cvec_free(nsc0);
     return retval;
 }
 
-/*---------------------------------------------------------------
- * Datanode write
+/*! Free instance-id results of compiled rules
  */
+static int
+nacm_user_xvecs_free(nacm_user    *nu,
+                     clixon_xvec **xvecs)
+{
+    int i;
 
-/*! Match specific rule to specific requested node
+    for (i=0; i<nu->nu_len; i++)
+        if (xvecs[i])
+            clixon_xvec_free(xvecs[i]);
+    free(xvecs);
+    return 0;
+}
+
+/*! Evaluate paths of compiled rules with predicates on an XML tree
  *
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  xp       Xpath match
- * @param[in]  yspec    YANG spec
- * @retval  2  OK and rule matches permit
- * @retval  1  OK and rule matches deny
- * @retval  0  OK and rule does not match
- * @retval -1  Error
+ * Rules without predicates are decided on YANG schema nodes and not evaluated here
+ * @param[in]  h       Clixon handle
+ * @param[in]  nu      Compiled rules of user
+ * @param[in]  access  Access operation (not exec)
+ * @param[in]  xt      XML root tree
+ * @param[out] xvecsp  Instance-id results indexed as nu_rules, or NULL if no such rules
+ * @retval     0       OK
+ * @retval    -1       Error
  */
 static int
-nacm_data_write_xrule_xml(cxobj       *xn,
-                          cxobj       *xrule,
-                          clixon_xvec *xpathvec,
-                          yang_stmt   *yspec)
+nacm_user_xvecs(clixon_handle    h,
+                nacm_user       *nu,
+                enum nacm_access access,
+                cxobj           *xt,
+                clixon_xvec   ***xvecsp)
 {
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    char      *action;
-    cxobj     *xp;
-    int        i;
+    int           retval = -1;
+    clixon_xvec **xvecs = NULL;
+    nacm_crule   *cr;
+    yang_stmt    *yspec;
+    cxobj       **xvec = NULL;
+    int           xlen = 0;
+    int           i;
+    int           k;
+    int           ret;
 
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
+    yspec = clicon_dbspec_yang(h);
+    for (i=0; i<nu->nu_len; i++){
+        cr = &nu->nu_rules[i];
+        if (!cr->cr_instance || (cr->cr_access & (1<<access)) == 0)
+            continue;
+        if (xvecs == NULL &&
+            (xvecs = calloc(nu->nu_len, sizeof(*xvecs))) == NULL){
+            clixon_err(OE_UNIX, errno, "calloc");
             goto done;
-        /* ymod is NULL (xn is "config") Can this breach the NACM rule? */
-        if (ymod && strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    action = xml_find_body(xrule, "action"); /* mandatory */
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        Requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (strcmp(action, "deny")==0)
-            goto deny;
-        goto permit;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (strcmp(action, "deny")==0)
-                goto deny;
-            goto permit;
+        }
+        if ((ret = clixon_xml_find_instance_id(xt, yspec, &xvec, &xlen, "%s", cr->cr_path)) < 0)
+            goto done;
+        if (ret == 0)
+            continue;
+        if ((xvecs[i] = clixon_xvec_new()) == NULL)
+            goto done;
+        for (k=0; k<xlen; k++){
+            if (clixon_xvec_append(xvecs[i], xvec[k]) < 0)
+                goto done;
+        }
+        if (xvec){
+            free(xvec);
+            xvec = NULL;
         }
     }
-    goto nomatch;
- permit:
-    retval = 2;       /* rule match and permit */
+    *xvecsp = xvecs;
+    xvecs = NULL;
+    retval = 0;
  done:
+    if (xvec)
+        free(xvec);
+    if (xvecs)
+        nacm_user_xvecs_free(nu, xvecs);
     return retval;
- nomatch :  /* rule does not match */
-    retval = 0;
-    goto done;
- deny:      /* rule match and deny */
-    retval = 1;
-    goto done;
 }
 
+/*---------------------------------------------------------------
+ * Datanode write
+ */
+
 /*! Recursive check for NACM write rules among all XML nodes
  *
  * @param[in]  h         Clixon handle
  * @param[in]  xn        XML node (requested node)
- * @param[in]  rulevec   Precomputed rules that apply to this user group
- * @param[in]  xpathvec  Precomputed xpath results that apply to this XML tree
+ * @param[in]  nu        Compiled rules of user
+ * @param[in]  access    Access operation
+ * @param[in]  xvecs     Instance-id results of rules with predicates
  * @param[in]  defpermit 0 if default deny, 1 is default permit
  * @param[in]  yspec     YANG spec
  * @param[out] cbret     Error message if retval = 0
  * @retval     1         OK and accept
  * @retval     0         Deny and cbret set
  * @retval    -1         Error
- * XXX differentiate between nomatch: default. or match deny, match accept 
- * nomatch: check write-default rules, next v
- * accept:  Hunky dory
- * deny:    Send error message
  */
 static int
-nacm_datanode_write_recurse(clixon_handle h,
-                            cxobj        *xn,
-                            prepvec      *pv_list,
-                            int           defpermit,
-                            yang_stmt    *yspec,
-                            cbuf         *cbret)
+nacm_datanode_write_recurse(clixon_handle    h,
+                            cxobj           *xn,
+                            nacm_user       *nu,
+                            enum nacm_access access,
+                            clixon_xvec    **xvecs,
+                            int              defpermit,
+                            yang_stmt       *yspec,
+                            cbuf            *cbret)
 {
-    int       retval = -1;
-    cxobj   *x;
-    int      ret = 0;
-    prepvec *pv;
+    int         retval = -1;
+    cxobj      *x;
+    int         ret = 0;
+    nacm_crule *cr;
+    int         uniform;
 
-    pv = pv_list;
-    if (pv){
-        do {
-            /* return values: -1:Error /0:no match /1: deny /2: permit
-             */
-            if ((ret = nacm_data_write_xrule_xml(xn, pv->pv_xrule, pv->pv_xpathvec, yspec)) < 0)
-                goto done;
-            switch(ret){
-            case 0: /* No match, continue with next rule */
-                break;
-            case 1: /* Match and deny: break all traversal and send error back to client */
-                if (netconf_access_denied(cbret, "application", "access denied") < 0)
-                    goto done;
-                goto deny;
-                break;
-            case 2: /* Match and permit: break rule processing but continue recursion */
-                break;
-            }
-            if (ret == 2)
-                break;
-            pv = NEXTQ(prepvec *, pv);
-        } while (pv && pv != pv_list);
+    if (nacm_user_match(nu, access, xvecs, xn, yspec, &cr, &uniform) < 0)
+        goto done;
+    if (cr != NULL && !cr->cr_permit){
+        /* Match and deny: break all traversal and send error back to client */
+        if (netconf_access_denied(cbret, "application", "access denied") < 0)
+            goto done;
+        goto deny;
     }
     /* If no rule match, check default rule: if deny then break traversal and send error */
-    if (ret == 0 && !defpermit){
+    if (cr == NULL && !defpermit){
         if (netconf_access_denied(cbret, "application", "default deny") < 0)
             goto done;
         goto deny;
     }
-    /* If node should be purged, dont recurse and defer removal to caller */
+    /* Permitted and no rule boundary below: do not check descendants */
+    if (uniform){
+        _nacm_compiled_skipped++;
+        goto ok;
+    }
     x = NULL;   /* Recursively check XML */
     while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-        if ((ret = nacm_datanode_write_recurse(h, x, pv_list,
+        if ((ret = nacm_datanode_write_recurse(h, x, nu, access, xvecs,
                                                defpermit, yspec, cbret)) < 0)
             goto done;
         if (ret == 0)
             goto deny;
     }
+ ok:
     retval = 1; /* accept */
  done:
     return retval;
@@ -696,16 +1178,12 @@ nacm_datanode_write(clixon_handle    h,
                     cxobj           *xnacm,
                     cbuf            *cbret)
 {
-    int      retval = -1;
-    cxobj  **gvec = NULL; /* groups */
-    size_t   glen;
-    cxobj  **rlistvec = NULL; /* rule-list */
-    size_t   rlistlen;
-    cxobj  **rvec = NULL; /* rules */
-    char    *write_default = NULL;
-    cvec    *nsc = NULL;
-    int      ret;
-    prepvec *pv_list = NULL;
+    int           retval = -1;
+    char         *write_default = NULL;
+    cvec         *nsc = NULL;
+    int           ret;
+    nacm_user    *nu = NULL;
+    clixon_xvec **xvecs = NULL;
 
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
@@ -724,24 +1202,17 @@ nacm_datanode_write(clixon_handle    h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
+    /* User's groups and rules of their rule-lists, compiled once per NACM config */
+    if (nacm_user_get(h, xnacm, username, nsc, &nu) < 0)
         goto done;
     /* 4. If no groups are found, continue with step 9. */
-    if (glen == 0)
+    if (nu->nu_glen == 0)
         goto step9;
-    /* 5. Process all rule-list entries, in the order they appear in the
-        configuration.  If a rule-list's "group" leaf-list does not
-        match any of the user's groups, proceed to the next rule-list
-        entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
-        goto done;
-    /* First run through rules and cache rules as well as lookup objects in xt. 
-     */
-    if (nacm_datanode_prepare(h, xt, access, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    /* First lookup objects in xt of rules with predicates. */
+    if (nacm_user_xvecs(h, nu, access, xt, &xvecs) < 0)
         goto done;
     /* Then recursivelyy traverse all requested nodes */
-    if ((ret = nacm_datanode_write_recurse(h, xreq, pv_list,
+    if ((ret = nacm_datanode_write_recurse(h, xreq, nu, access, xvecs,
                                            strcmp(write_default, "deny"),
                                            clicon_dbspec_yang(h),
                                            cbret)) < 0)
@@ -773,16 +1244,10 @@ nacm_datanode_write(clixon_handle    h,
     retval = 1;
  done:
     clixon_debug(CLIXON_DBG_NACM, "retval:%d (0:deny 1:permit)", retval);
-    if (pv_list)
-        prepvec_free(pv_list);
+    if (xvecs)
+        nacm_user_xvecs_free(nu, xvecs);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
-    if (rvec)
-        free(rvec);
     return retval;
  deny: /* Here, cbret must contain a netconf error msg */
     assert(cbuf_len(cbret));
@@ -794,145 +1259,68 @@ nacm_datanode_write(clixon_handle    h,
  * Datanode read
  */
 
-/*! Perform NACM action: mark if permit, del if deny
- *
- * @param[in] xrule    NACM rule
- * @param[in] xn       XML node (requested node)
- * @retval    0        OK
- * @retval   -1        Error
-
- */
-static int
-nacm_data_read_action(cxobj *xrule,
-                      cxobj *xn)
-{
-    int   retval = -1;
-    char *action;
-
-    if ((action = xml_find_body(xrule, "action")) != NULL){
-        if (strcmp(action, "deny")==0)
-            xml_flag_set(xn, XML_FLAG_DEL);
-        else if (strcmp(action, "permit")==0)
-            xml_flag_set(xn, XML_FLAG_MARK);
-    }
-    retval = 0;
-    //done:
-    return retval;
-}
-
-/*! Match specific rule to specific requested node
- *
- * @param[in]  xn       XML node (requested node)
- * @param[in]  xrule    NACM rule
- * @param[in]  yspec    YANG spec
- * @retval     1        OK and rule matches
- * @retval     0        OK and rule does not match
- * @retval    -1        Error
- * Two distinct cases:
- * (1) read_default is permit
- *     mark all deny rules and remove them
- * (2) read_default is deny:
- *     mark all permit rules and ancestors, remove everything else
- */
-static int
-nacm_data_read_xrule_xml(cxobj        *xn,
-                         cxobj        *xrule,
-                         clixon_xvec  *xpathvec,
-                         yang_stmt    *yspec)
-{
-    int        retval = -1;
-    yang_stmt *ymod;
-    char      *module_pattern; /* rule module name */
-    cxobj     *xp;
-    int        i;
-
-    if ((module_pattern = xml_find_body(xrule, "module-name")) == NULL)
-        goto nomatch;
-    /* 6a) The rule's "module-name" leaf is "*" or equals the name of
-     * the YANG module where the requested data node is defined. 
-     */
-    if (strcmp(module_pattern, "*") != 0){
-        if (ys_module_by_xml(yspec, xn, &ymod) < 0)
-            goto done;
-        if (strcmp(yang_argument_get(ymod), module_pattern) != 0)
-            goto nomatch;
-    }
-    /*  6b) Either (1) the rule does not have a "rule-type" defined or
-        (2) the "rule-type" is "data-node" and the "path" matches the
-        requested data node, action node, or notification node. */    
-    if (xml_find_type(xrule, NULL, "path", CX_ELMNT) == NULL){
-        if (nacm_data_read_action(xrule, xn) < 0)
-            goto done;
-        goto match;
-    }
-    for (i=0; i<clixon_xvec_len(xpathvec); i++){
-        xp = clixon_xvec_i(xpathvec, i);
-        /* Check if ancestor is xp (for every xpathvec?) */
-        if (xn == xp || xml_isancestor(xn, xp)){
-            if (nacm_data_read_action(xrule, xn) < 0)
-                goto done;
-            goto match;
-        }
-    }
- nomatch:
-    retval = 0;
- done:
-    return retval;
- match:
-    retval = 1; /* match */
-    goto done;
-}
-
 /*! Recursive check for NACM read rules among all XML nodes
  *
- * @param[in]  h        Clixon handle
- * @param[in]  xn       XML node (requested node)
- * @param[in]  pv_list  Precomputed rules + paths that apply to this user group
- * @param[in]  yspec    YANG spec
- * @retval     0        OK
- * @retval    -1        Error
+ * Mark node if first matching rule is permit, and delete it if deny.
+ * If the decision is the same for the whole subtree, do not descend: a permitted
+ * subtree is kept as is, and a subtree denied by default is deleted
+ * @param[in]  h         Clixon handle
+ * @param[in]  xn        XML node (requested node)
+ * @param[in]  nu        Compiled rules of user
+ * @param[in]  xvecs     Instance-id results of rules with predicates
+ * @param[in]  defpermit 0 if read-default deny, 1 if permit
+ * @param[in]  yspec     YANG spec
+ * @retval     0         OK
+ * @retval    -1         Error
  */
 static int
 nacm_datanode_read_recurse(clixon_handle h,
                            cxobj        *xn,
-                           prepvec      *pv_list,
+                           nacm_user    *nu,
+                           clixon_xvec **xvecs,
+                           int           defpermit,
                            yang_stmt    *yspec)
 {
-    int      retval = -1;
-    cxobj   *x;
-    cxobj   *xprev;
-    int      ret;
-    prepvec *pv;
-
-    if (xml_spec(xn)){ /* Check this node */
-        pv = pv_list;
-        if (pv){
-            do {
-                if ((ret = nacm_data_read_xrule_xml(xn,
-                                                    pv->pv_xrule,
-                                                    pv->pv_xpathvec,
-                                                    yspec)) < 0)
+    int         retval = -1;
+    cxobj      *x;
+    cxobj      *xprev;
+    nacm_crule *cr;
+    yang_stmt  *ys;
+    yang_stmt  *yp;
+    int         uniform;
+    int         iskey = 0;
+
+    if ((ys = xml_spec(xn)) != NULL){ /* Check this node */
+        if (nacm_user_match(nu, NACM_READ, xvecs, xn, yspec, &cr, &uniform) < 0)
+            goto done;
+        if (cr != NULL)
+            xml_flag_set(xn, cr->cr_permit?XML_FLAG_MARK:XML_FLAG_DEL);
+        if (uniform){
+            if (cr != NULL && !cr->cr_permit)
+                _nacm_compiled_pruned++;
+            else if (cr != NULL || defpermit){
+                _nacm_compiled_skipped++;
+                goto ok;
+            }
+            else {
+                /* Denied by default: delete unless list key, keys are pruned by caller */
+                if ((yp = yang_parent_get(ys)) != NULL && yang_keyword_get(yp) == Y_LIST &&
+                    (iskey = yang_key_match(yp, xml_name(xn), NULL)) < 0)
                     goto done;
-                if (ret == 1)
-                    break; /* stop at first match */
-                pv = NEXTQ(prepvec *, pv);
-            } while (pv && pv != pv_list);
+                if (!iskey){
+                    xml_flag_set(xn, XML_FLAG_DEL);
+                    _nacm_compiled_pruned++;
+                }
+                goto ok;
+            }
         }
-
-#if 0 /* 6(A) in algorithm
-       * If N did not match any rule R, and default rule is deny, remove that subtree */
-        if (strcmp(read_default, "deny") == 0)
-            if (xml_tree_prune_flagged_sub(xt, XML_FLAG_MARK, 1, NULL) < 0)
-                goto done;
-#endif
     }
-
     /* If node should be purged, dont recurse and defer removal to caller */
     if (xml_flag(xn, XML_FLAG_DEL) == 0){
         x = NULL;       /* Recursively check XML */
         xprev = NULL;
         while ((x = xml_child_each(xn, x, CX_ELMNT)) != NULL) {
-            if (nacm_datanode_read_recurse(h, x, pv_list, yspec) < 0)
+            if (nacm_datanode_read_recurse(h, x, nu, xvecs, defpermit, yspec) < 0)
                 goto done;
             /* check for delayed remove */
             if (xml_flag(x, XML_FLAG_DEL)){
@@ -940,8 +1328,10 @@ nacm_datanode_read_recurse(clixon_handle h,
                     goto done;
                 x = xprev;
             }
+            xprev = x;
         }
     }
+ ok:
     retval = 0;
  done:
     return retval;
@@ -1005,14 +1395,11 @@ nacm_datanode_read(clixon_handle h,
                    cxobj        *xnacm)
 {
     int             retval = -1;
-    cxobj         **gvec = NULL; /* groups */
-    size_t          glen;
-    cxobj         **rlistvec = NULL; /* rule-list */
-    size_t          rlistlen;
     int             i;
     char           *read_default = NULL;
     cvec           *nsc = NULL;
-    prepvec        *pv_list = NULL;
+    nacm_user      *nu = NULL;
+    clixon_xvec   **xvecs = NULL;
 
     /* Create namespace context for with nacm namespace as default */
     if ((nsc = xml_nsctx_init(NULL, NACM_NS)) == NULL)
@@ -1024,29 +1411,29 @@ nacm_datanode_read(clixon_handle h,
        transport layer.)               */
     if (username == NULL)
         goto step9;
-    /* User's group */
-    if (xpath_vec(xnacm, nsc, "groups/group[user-name='%s']", &gvec, &glen, username) < 0)
-        goto done;
-    /* 4. If no groups are found (glen=0), continue and check read-default 
-          in step 11. */
-    /* 5. Process all rule-list entries, in the order they appear in the
+    /* User's groups and rules of their rule-lists, compiled once per NACM config
+     * 4. If no groups are found, there are no rules, continue and check read-default
+          in step 11.
+     * 5. Process all rule-list entries, in the order they appear in the
         configuration.  If a rule-list's "group" leaf-list does not
         match any of the user's groups, proceed to the next rule-list
         entry. */
-    if (xpath_vec(xnacm, nsc, "rule-list", &rlistvec, &rlistlen) < 0)
+    if (nacm_user_get(h, xnacm, username, nsc, &nu) < 0)
         goto done;
     /* read-default has default permit so should never be NULL */
     if ((read_default = xml_find_body(xnacm, "read-default")) == NULL){
         clixon_err(OE_XML, EINVAL, "No nacm read-default rule");
         goto done;
     }
-    /* First run through rules and cache rules as well as lookup objects in xt. 
-     * DANGER: objects could be stale if they are removed?
+    /* First lookup objects in xt of rules with predicates.
+     * Rules without predicates are decided per YANG schema node
      */
-    if (nacm_datanode_prepare(h, xt, NACM_READ, gvec, glen, rlistvec, rlistlen, nsc, &pv_list) < 0)
+    if (nacm_user_xvecs(h, nu, NACM_READ, xt, &xvecs) < 0)
         goto done;
-    /* Then recursivelyy traverse all nodes */
-    if (nacm_datanode_read_recurse(h, xt, pv_list, clicon_dbspec_yang(h)) < 0)
+    /* Then traverse all nodes in a single pass */
+    if (nacm_datanode_read_recurse(h, xt, nu, xvecs,
+                                   strcmp(read_default, "deny"),
+                                   clicon_dbspec_yang(h)) < 0)
         goto done;
 #if 1
     /* Step 8(B) above:
@@ -1077,14 +1464,10 @@ nacm_datanode_read(clixon_handle h,
     retval = 0;
  done:
     clixon_debug(CLIXON_DBG_NACM, "retval:%d", retval);
-    if (pv_list)
-        prepvec_free(pv_list);
+    if (xvecs)
+        nacm_user_xvecs_free(nu, xvecs);
     if (nsc)
         xml_nsctx_free(nsc);
-    if (gvec)
-        free(gvec);
-    if (rlistvec)
-        free(rlistvec);
     return retval;
 }
 
@@ -137,6 +137,7 @@ static const map_str2int _FORMATS[] = {
     {"cli",     FORMAT_CLI},
     {"netconf", FORMAT_NETCONF},
     {"default", FORMAT_DEFAULT},
+    {"binary",  FORMAT_BINARY},
     {NULL,      -1}
 };
 
@@ -52,9 +52,11 @@
 #include <syslog.h>
 #include <signal.h>
 #include <ctype.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <sys/param.h>
 #include <netinet/in.h>
@@ -82,6 +84,10 @@
 #include "clixon_options.h"
 #include "clixon_proto.h"
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
 static int _atomicio_sig = 0;
 
 /*! Given family, addr str, port, return sockaddr and length
@@ -492,6 +498,774 @@ clixon_rpc10(int         sock,
     return retval;
 }
 
+/*================= NETCONF 1.1 Streaming output ================*/
+
+/*! Output queue and reply stream of a socket
+ *
+ * Messages are written with non-blocking sends. Data that the peer does not accept
+ * immediately is queued and sent from the event loop when the socket is writable.
+ * A reply may be streamed as several chunks while it is serialized, see
+ * clixon_msg_writer_start.
+ * Sends never block. When more than the bound is queued, the owner is notified so that it
+ * can stop reading requests from the peer until the queue is drained, see
+ * clixon_msg_writer_backpressure
+ */
+struct clixon_msg_writer{
+    int      mw_s;        /* Socket */
+    size_t   mw_limit;    /* Flush and queue bound, 0: no streaming */
+    cbuf    *mw_out;      /* Output queue, sent from mw_pos */
+    size_t   mw_pos;      /* Position of first unsent byte in mw_out */
+    int      mw_reg;      /* Write event registered */
+    int      mw_closed;   /* Peer has closed, discard output */
+    cbuf    *mw_cb;       /* Serializer buffer of ongoing stream, or NULL */
+    uint64_t mw_chunks;   /* Chunks sent of ongoing message */
+    cbuf    *mw_defer;    /* Framed messages deferred until ongoing message ends */
+    clixon_msg_writer_fn_t *mw_bpfn; /* Backpressure callback, or NULL */
+    void    *mw_bparg;    /* Argument of backpressure callback */
+    int      mw_full;     /* More than the bound is queued, owner notified */
+    int      mw_blocking; /* Wait until all output is sent, no event loop */
+};
+
+/* Writers indexed by socket */
+static clixon_msg_writer **_mw_vec = NULL;
+static int                 _mw_vec_len = 0;
+static int                 _mw_nr = 0;
+
+/* Writer with an ongoing stream */
+static clixon_msg_writer *_mw_active = NULL;
+
+/*! Get message writer of a socket
+ *
+ * @param[in]  s      Socket
+ * @retval     mw     Message writer
+ * @retval     NULL   No writer, messages are sent directly
+ */
+static clixon_msg_writer *
+clixon_msg_writer_find(int s)
+{
+    if (s < 0 || s >= _mw_vec_len)
+        return NULL;
+    return _mw_vec[s];
+}
+
+static int clixon_msg_writer_cb(int s, void *arg);
+
+/*! Send queued output of a writer
+ *
+ * Sends as much as the socket accepts without blocking, or all output in blocking mode.
+ * Then register or unregister write event depending on if output remains, and notify the
+ * owner if the queue passes the bound in either direction.
+ * The owner is only notified that the queue is drained from the event loop, since it may
+ * then handle new requests. Otherwise the write event is kept to do that.
+ * @param[in]  mw     Message writer
+ * @param[in]  evcb   Called from event loop, see clixon_msg_writer_cb
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @note mw may be freed by the backpressure callback, mw is not accessed after it is called
+ */
+static int
+clixon_msg_writer_drain(clixon_msg_writer *mw,
+                        int                evcb)
+{
+    int           retval = -1;
+    ssize_t       n;
+    size_t        len;
+    char         *buf;
+    int           full;
+    int           drained;
+    struct pollfd pfd = {0,};
+
+    while ((len = cbuf_len(mw->mw_out) - mw->mw_pos) > 0 && !mw->mw_closed){
+        buf = cbuf_get(mw->mw_out) + mw->mw_pos;
+        if ((n = send(mw->mw_s, buf, len, MSG_DONTWAIT|MSG_NOSIGNAL)) < 0){
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK){
+                if (!mw->mw_blocking)
+                    break;
+                pfd.fd = mw->mw_s;
+                pfd.events = POLLOUT;
+                if (poll(&pfd, 1, -1) < 0 && errno != EINTR){
+                    clixon_err(OE_UNIX, errno, "poll");
+                    goto done;
+                }
+                continue;
+            }
+            if (errno == EPIPE || errno == ECONNRESET || errno == EBADF){
+                clixon_debug(CLIXON_DBG_MSG, "Peer closed: %s", strerror(errno));
+                mw->mw_closed++;
+                break;
+            }
+            clixon_err(OE_UNIX, errno, "send");
+            goto done;
+        }
+        mw->mw_pos += n;
+    }
+    len = cbuf_len(mw->mw_out) - mw->mw_pos;
+    full = !mw->mw_closed && len > mw->mw_limit;
+    drained = mw->mw_bpfn && mw->mw_full && !full;
+    if (len == 0 || mw->mw_closed){
+        cbuf_reset(mw->mw_out);
+        mw->mw_pos = 0;
+    }
+    else if (mw->mw_pos > mw->mw_limit){ /* Compact queue */
+        buf = cbuf_get(mw->mw_out);
+        memmove(buf, buf + mw->mw_pos, len);
+        cbuf_trunc(mw->mw_out, len);
+        mw->mw_pos = 0;
+    }
+    if ((len && !mw->mw_closed) || (drained && !evcb)){
+        if (!mw->mw_reg){
+            if (clixon_event_reg_fd_write(mw->mw_s, clixon_msg_writer_cb, mw, "output queue") < 0)
+                goto done;
+            mw->mw_reg++;
+        }
+    }
+    else if (mw->mw_reg){
+        clixon_event_unreg_fd(mw->mw_s, clixon_msg_writer_cb);
+        mw->mw_reg = 0;
+    }
+    if (mw->mw_bpfn && full && !mw->mw_full){
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Output queue full: %zu", len);
+        mw->mw_full = 1;
+        if (mw->mw_bpfn(mw, 1, mw->mw_bparg) < 0)
+            goto done;
+    }
+    else if (drained && evcb){
+        clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Output queue drained: %zu", len);
+        mw->mw_full = 0;
+        if (mw->mw_bpfn(mw, 0, mw->mw_bparg) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Event callback when socket of output queue is writable
+ */
+static int
+clixon_msg_writer_cb(int   s,
+                     void *arg)
+{
+    clixon_msg_writer *mw = (clixon_msg_writer *)arg;
+
+    return clixon_msg_writer_drain(mw, 1);
+}
+
+/*! Write framed data to socket, queue what cannot be sent without blocking
+ *
+ * If the queue is empty, the data is sent directly without copying.
+ * @param[in]  mw      Message writer
+ * @param[in]  hdr     Framing header, or NULL
+ * @param[in]  data    Data, or NULL
+ * @param[in]  datalen Length of data
+ * @param[in]  trailer Framing trailer, or NULL
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+clixon_msg_writer_put(clixon_msg_writer *mw,
+                      char              *hdr,
+                      char              *data,
+                      size_t             datalen,
+                      char              *trailer)
+{
+    int           retval = -1;
+    struct iovec  iov[3];
+    struct msghdr msg = {0,};
+    int           i = 0;
+    int           iovcnt;
+    ssize_t       n = 0;
+
+    if (mw->mw_closed)
+        return 0;
+    if (hdr){
+        iov[i].iov_base = hdr;
+        iov[i++].iov_len = strlen(hdr);
+    }
+    if (data && datalen){
+        iov[i].iov_base = data;
+        iov[i++].iov_len = datalen;
+    }
+    if (trailer){
+        iov[i].iov_base = trailer;
+        iov[i++].iov_len = strlen(trailer);
+    }
+    iovcnt = i;
+    if (cbuf_len(mw->mw_out) == mw->mw_pos){
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+        while ((n = sendmsg(mw->mw_s, &msg, MSG_DONTWAIT|MSG_NOSIGNAL)) < 0 && errno == EINTR)
+            ;
+        if (n < 0){
+            if (errno == EPIPE || errno == ECONNRESET || errno == EBADF){
+                clixon_debug(CLIXON_DBG_MSG, "Peer closed: %s", strerror(errno));
+                mw->mw_closed++;
+                return 0;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK){
+                clixon_err(OE_UNIX, errno, "sendmsg");
+                goto done;
+            }
+            n = 0;
+        }
+    }
+    /* Queue what was not sent */
+    for (i = 0; i < iovcnt; i++){
+        if ((size_t)n >= iov[i].iov_len){
+            n -= iov[i].iov_len;
+            continue;
+        }
+        if (cbuf_append_buf(mw->mw_out, (char*)iov[i].iov_base + n, iov[i].iov_len - n) < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+            goto done;
+        }
+        n = 0;
+    }
+    if (clixon_msg_writer_drain(mw, 0) < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send a complete framed message via writer, or defer it if a message is being streamed
+ *
+ * @param[in]  mw      Message writer
+ * @param[in]  data    Message data
+ * @param[in]  datalen Length of data
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+clixon_msg_writer_msg(clixon_msg_writer *mw,
+                      char              *data,
+                      size_t             datalen)
+{
+    int  retval = -1;
+    char hdr[32];
+
+    if (datalen == 0){
+        clixon_err(OE_PROTO, EINVAL, "Empty message can not be sent with chunked framing");
+        goto done;
+    }
+    snprintf(hdr, sizeof(hdr), "\n#%zu\n", datalen);
+    if (mw->mw_chunks){
+        if (cbuf_append_str(mw->mw_defer, hdr) < 0 ||
+            cbuf_append_buf(mw->mw_defer, data, datalen) < 0 ||
+            cbuf_append_str(mw->mw_defer, "\n##\n") < 0){
+            clixon_err(OE_UNIX, errno, "cbuf_append");
+            goto done;
+        }
+    }
+    else if (clixon_msg_writer_put(mw, hdr, data, datalen, "\n##\n") < 0)
+        goto done;
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Create message writer for a socket
+ *
+ * All NETCONF 1.1 messages sent on the socket thereafter are written via the writer
+ * with non-blocking sends, and remaining output is sent from the event loop.
+ * The socket itself may be blocking.
+ * @param[in]  s      Socket
+ * @param[in]  limit  Bound of queued output and of streamed reply chunks, 0: no streaming
+ * @retval     mw     Message writer, free with clixon_msg_writer_free
+ * @retval     NULL   Error
+ * @see REPLY_STREAM_BUFSIZE
+ * @see clixon_msg_writer_backpressure
+ */
+clixon_msg_writer *
+clixon_msg_writer_new(int    s,
+                      size_t limit)
+{
+    clixon_msg_writer *mw;
+    int                len;
+
+    if (s < 0){
+        clixon_err(OE_UNIX, EINVAL, "Invalid socket %d", s);
+        return NULL;
+    }
+    if (clixon_msg_writer_find(s) != NULL){
+        clixon_err(OE_UNIX, EEXIST, "Socket %d already has a message writer", s);
+        return NULL;
+    }
+    if (s >= _mw_vec_len){
+        len = s + 16;
+        if ((_mw_vec = realloc(_mw_vec, len*sizeof(clixon_msg_writer *))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            _mw_vec_len = 0;
+            return NULL;
+        }
+        memset(&_mw_vec[_mw_vec_len], 0, (len - _mw_vec_len)*sizeof(clixon_msg_writer *));
+        _mw_vec_len = len;
+    }
+    if ((mw = malloc(sizeof(*mw))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(mw, 0, sizeof(*mw));
+    mw->mw_s = s;
+    mw->mw_limit = limit;
+    if ((mw->mw_out = cbuf_new()) == NULL ||
+        (mw->mw_defer = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        if (mw->mw_out)
+            cbuf_free(mw->mw_out);
+        free(mw);
+        return NULL;
+    }
+    _mw_vec[s] = mw;
+    _mw_nr++;
+    return mw;
+}
+
+/*! Register callback notified when the output queue of a writer passes its bound
+ *
+ * The callback is called with full set when more than the bound is queued, and with full
+ * not set when the queue is drained below the bound or the peer has closed. The owner
+ * should stop reading requests from the peer while the queue is full, since the replies
+ * are otherwise queued without bound.
+ * @param[in]  mw     Message writer
+ * @param[in]  fn     Callback, or NULL
+ * @param[in]  arg    Argument of callback
+ * @retval     0      OK
+ * @note The callback may be called from the event loop, and may free the writer
+ */
+int
+clixon_msg_writer_backpressure(clixon_msg_writer      *mw,
+                               clixon_msg_writer_fn_t *fn,
+                               void                   *arg)
+{
+    mw->mw_bpfn = fn;
+    mw->mw_bparg = arg;
+    return 0;
+}
+
+/*! Send all output of writer with blocking writes
+ *
+ * For a process that does not run the event loop, eg a forked worker that has dropped
+ * the event state of its parent. No write events are registered and the backpressure
+ * callback is not called.
+ * @param[in]  mw     Message writer
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+clixon_msg_writer_blocking(clixon_msg_writer *mw)
+{
+    mw->mw_blocking = 1;
+    mw->mw_bpfn = NULL;
+    mw->mw_bparg = NULL;
+    mw->mw_full = 0;
+    mw->mw_reg = 0; /* Registered in parent */
+    return clixon_msg_writer_drain(mw, 0);
+}
+
+/*! Get if more than the bound of a writer is queued
+ *
+ * @param[in]  mw     Message writer, or NULL
+ * @retval     1      Queue is full, see clixon_msg_writer_backpressure
+ * @retval     0      Not full
+ */
+int
+clixon_msg_writer_full(clixon_msg_writer *mw)
+{
+    return mw && mw->mw_full;
+}
+
+/*! Free message writer, discard any unsent output
+ *
+ * @param[in]  mw     Message writer
+ * @retval     0      OK
+ */
+int
+clixon_msg_writer_free(clixon_msg_writer *mw)
+{
+    if (mw == NULL)
+        return 0;
+    if (mw->mw_reg)
+        clixon_event_unreg_fd(mw->mw_s, clixon_msg_writer_cb);
+    if (_mw_active == mw)
+        _mw_active = NULL;
+    if (clixon_msg_writer_find(mw->mw_s) == mw){
+        _mw_vec[mw->mw_s] = NULL;
+        if (--_mw_nr == 0){
+            free(_mw_vec);
+            _mw_vec = NULL;
+            _mw_vec_len = 0;
+        }
+    }
+    cbuf_free(mw->mw_out);
+    cbuf_free(mw->mw_defer);
+    free(mw);
+    return 0;
+}
+
+/*! Start streaming a reply as it is serialized into a buffer
+ *
+ * Serializers call clixon_msg_writer_check on the buffer, which sends the buffer contents
+ * as a NETCONF 1.1 chunk and resets it when it exceeds the bound. Thus a large reply is sent
+ * while serialized without being assembled in memory.
+ * Only one stream may be active at a time.
+ * @param[in]  mw     Message writer
+ * @param[in]  cb     Buffer where the reply is serialized
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   clixon_msg_writer_start(mw, cbret);
+ *   clixon_xml2cbuf(cbret, xt, 0, 0, NULL, -1, 0);
+ *   clixon_msg_writer_stop(mw);
+ *   ...
+ *   clixon_msg_writer_end(mw, descr, cbuf_get(cbret), cbuf_len(cbret));
+ * @endcode
+ * @see clixon_msg_writer_stop
+ */
+int
+clixon_msg_writer_start(clixon_msg_writer *mw,
+                        cbuf              *cb)
+{
+    if (mw->mw_limit == 0)
+        return 0;
+    if (_mw_active != NULL){
+        clixon_err(OE_UNIX, EBUSY, "Reply stream already active");
+        return -1;
+    }
+    mw->mw_cb = cb;
+    _mw_active = mw;
+    return 0;
+}
+
+/*! Stop streaming serializer buffer, remaining data is sent with clixon_msg_writer_end
+ *
+ * @param[in]  mw     Message writer
+ * @retval     0      OK
+ */
+int
+clixon_msg_writer_stop(clixon_msg_writer *mw)
+{
+    if (_mw_active == mw)
+        _mw_active = NULL;
+    mw->mw_cb = NULL;
+    return 0;
+}
+
+/*! Check if serializer buffer should be sent as a chunk of an ongoing reply stream
+ *
+ * Called by serializers between elements. Cheap if no stream is active on the buffer.
+ * @param[in]  cb     Serializer buffer
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see clixon_msg_writer_start
+ */
+int
+clixon_msg_writer_check(cbuf *cb)
+{
+    int                retval = -1;
+    clixon_msg_writer *mw;
+    char               hdr[32];
+
+    if ((mw = _mw_active) == NULL ||
+        mw->mw_cb != cb ||
+        cbuf_len(cb) < mw->mw_limit)
+        return 0;
+    snprintf(hdr, sizeof(hdr), "\n#%zu\n", cbuf_len(cb));
+    clixon_debug(CLIXON_DBG_MSG | CLIXON_DBG_DETAIL, "Send chunk len=%lu", cbuf_len(cb));
+    if (clixon_msg_writer_put(mw, hdr, cbuf_get(cb), cbuf_len(cb), NULL) < 0)
+        goto done;
+    mw->mw_chunks++;
+    cbuf_reset(cb);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get if part of the ongoing reply has been sent
+ *
+ * If so, the reply can not be replaced by an error message
+ * @param[in]  mw     Message writer
+ * @retval     1      Chunks of reply sent
+ * @retval     0      No part of reply sent
+ */
+int
+clixon_msg_writer_streamed(clixon_msg_writer *mw)
+{
+    return mw && mw->mw_chunks > 0;
+}
+
+/*! End reply: send data as the last chunk, end of chunks and deferred messages
+ *
+ * If the reply has not been streamed, it is sent as a single message.
+ * A chunked message has at least one chunk of at least one byte (RFC 6242 Sec 4.2), so
+ * data may only be empty if chunks have been streamed.
+ * @param[in]  mw      Message writer
+ * @param[in]  descr   Description of peer for logging
+ * @param[in]  data    Remaining reply data
+ * @param[in]  datalen Length of data
+ * @retval     0       OK
+ * @retval    -1       Error
+ * @see send_msg_reply
+ */
+int
+clixon_msg_writer_end(clixon_msg_writer *mw,
+                      const char        *descr,
+                      char              *data,
+                      size_t             datalen)
+{
+    int     retval = -1;
+    char    hdr[32];
+    char   *hdrp = NULL;
+    cbuf   *cb;
+
+    clixon_msg_writer_stop(mw);
+    if (datalen == 0 && mw->mw_chunks == 0){
+        clixon_err(OE_PROTO, EINVAL, "Empty message can not be sent with chunked framing");
+        goto done;
+    }
+    if (descr)
+        clixon_debug(CLIXON_DBG_MSG, "Send [%s]: %s", descr, data);
+    else
+        clixon_debug(CLIXON_DBG_MSG, "Send: %s", data);
+    if (datalen){
+        snprintf(hdr, sizeof(hdr), "\n#%zu\n", datalen);
+        hdrp = hdr;
+    }
+    if (clixon_msg_writer_put(mw, hdrp, data, datalen, "\n##\n") < 0)
+        goto done;
+    mw->mw_chunks = 0;
+    if (cbuf_len(mw->mw_defer)){
+        cb = mw->mw_defer;
+        if (clixon_msg_writer_put(mw, NULL, cbuf_get(cb), cbuf_len(cb), NULL) < 0)
+            goto done;
+        cbuf_reset(cb);
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Send queued output of a writer without blocking
+ *
+ * Used by clients that wait for input without running the event loop
+ * @param[in]  mw     Message writer
+ * @retval     1      Output remains queued
+ * @retval     0      Output queue is empty
+ * @retval    -1      Error
+ */
+int
+clixon_msg_writer_flush(clixon_msg_writer *mw)
+{
+    if (clixon_msg_writer_drain(mw, 0) < 0)
+        return -1;
+    return cbuf_len(mw->mw_out) > mw->mw_pos;
+}
+
+/*! Get size of output queued on writer and not yet sent
+ *
+ * @param[in]  mw     Message writer
+ * @retval     len    Number of bytes queued
+ */
+size_t
+clixon_msg_writer_queued(clixon_msg_writer *mw)
+{
+    return cbuf_len(mw->mw_out) - mw->mw_pos;
+}
+
+/*================= NETCONF 1.1 Buffered input ================*/
+
+/*! Input buffer of a socket
+ *
+ * Data read from the socket is kept until parsed, so that a read that contains
+ * several messages, or the start of the next message, does not lose data.
+ * This makes it possible for a peer to send several requests without waiting for replies.
+ */
+struct clixon_msg_reader{
+    int      mr_s;        /* Socket */
+    cbuf    *mr_in;       /* Input data, parsed until mr_pos */
+    size_t   mr_pos;      /* Position of first unparsed byte in mr_in */
+    int      mr_state;    /* Chunked framing state */
+    size_t   mr_size;     /* Chunked framing size */
+    cbuf    *mr_msg;      /* Message being assembled */
+};
+
+/*! Create input buffer for a socket
+ *
+ * @param[in]  s      Socket
+ * @retval     mr     Message reader, free with clixon_msg_reader_free
+ * @retval     NULL   Error
+ */
+clixon_msg_reader *
+clixon_msg_reader_new(int s)
+{
+    clixon_msg_reader *mr;
+
+    if ((mr = malloc(sizeof(*mr))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        return NULL;
+    }
+    memset(mr, 0, sizeof(*mr));
+    mr->mr_s = s;
+    if ((mr->mr_in = cbuf_new()) == NULL ||
+        (mr->mr_msg = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        if (mr->mr_in)
+            cbuf_free(mr->mr_in);
+        free(mr);
+        return NULL;
+    }
+    return mr;
+}
+
+/*! Free input buffer, discard unparsed input
+ *
+ * @param[in]  mr     Message reader
+ * @retval     0      OK
+ */
+int
+clixon_msg_reader_free(clixon_msg_reader *mr)
+{
+    if (mr == NULL)
+        return 0;
+    cbuf_free(mr->mr_in);
+    cbuf_free(mr->mr_msg);
+    free(mr);
+    return 0;
+}
+
+/*! Read available data from socket into input buffer
+ *
+ * Reads once, ie blocks only if no data is available on a blocking socket
+ * @param[in]  mr     Message reader
+ * @param[out] eof    Set if eof encountered
+ * @retval     0      OK (check eof)
+ * @retval    -1      Error
+ */
+int
+clixon_msg_reader_read(clixon_msg_reader *mr,
+                       int               *eof)
+{
+    unsigned char buf[BUFSIZ];
+    ssize_t       len;
+    char         *p;
+
+    *eof = 0;
+    if (mr->mr_pos > 0){ /* Compact: remove parsed input */
+        p = cbuf_get(mr->mr_in);
+        len = cbuf_len(mr->mr_in) - mr->mr_pos;
+        memmove(p, p + mr->mr_pos, len);
+        cbuf_trunc(mr->mr_in, len);
+        mr->mr_pos = 0;
+    }
+    if ((len = netconf_input_read2(mr->mr_s, buf, sizeof(buf), eof)) < 0)
+        return -1;
+    if (len > 0 &&
+        cbuf_append_buf(mr->mr_in, (char*)buf, len) < 0){
+        clixon_err(OE_UNIX, errno, "cbuf_append_buf");
+        return -1;
+    }
+    return 0;
+}
+
+/*! Get next complete message from input buffer, do not read from socket
+ *
+ * @param[in]  mr     Message reader
+ * @param[in]  descr  Description of peer for logging
+ * @param[out] cb     Message, or NULL if no complete message is buffered. Free with cbuf_free
+ * @param[out] eof    Set on framing error, the input can not be parsed further
+ * @retval     0      OK (check cb and eof)
+ * @retval    -1      Error
+ */
+int
+clixon_msg_reader_next(clixon_msg_reader *mr,
+                       const char        *descr,
+                       cbuf             **cb,
+                       int               *eof)
+{
+    unsigned char *p;
+    size_t         len;
+    size_t         plen;
+    int            eom = 0;
+
+    *cb = NULL;
+    *eof = 0;
+    len = cbuf_len(mr->mr_in);
+    if (mr->mr_pos < len){
+        p = (unsigned char*)cbuf_get(mr->mr_in) + mr->mr_pos;
+        plen = len - mr->mr_pos;
+        if (netconf_input_msg2(&p, &plen, mr->mr_msg, NETCONF_SSH_CHUNKED,
+                               &mr->mr_state, &mr->mr_size, &eom) < 0){
+            /* Errors from input are only framing errors, non-fatal, return eof */
+            clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: framing error", descr?descr:"");
+            *eof = 1;
+            plen = 0;
+            cbuf_reset(mr->mr_msg);
+        }
+        mr->mr_pos = len - plen;
+    }
+    if (mr->mr_pos == len){
+        cbuf_reset(mr->mr_in);
+        mr->mr_pos = 0;
+    }
+    if (eom){
+        if (descr)
+            clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: %s", descr, cbuf_get(mr->mr_msg));
+        else
+            clixon_debug(CLIXON_DBG_MSG, "Recv: %s", cbuf_get(mr->mr_msg));
+        *cb = mr->mr_msg;
+        if ((mr->mr_msg = cbuf_new()) == NULL){
+            clixon_err(OE_UNIX, errno, "cbuf_new");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*! Receive next message using input buffer
+ *
+ * Return a buffered message if any, otherwise read once from socket.
+ * Call clixon_msg_reader_next thereafter to get remaining buffered messages.
+ * @param[in]  mr     Message reader
+ * @param[in]  descr  Description of peer for logging
+ * @param[out] cb     Message, or NULL if not complete. Free with cbuf_free
+ * @param[out] eof    Set if eof encountered
+ * @retval     0      OK (check cb and eof)
+ * @retval    -1      Error
+ * @code
+ *   if (clixon_msg_reader_rcv(mr, descr, &cb, &eof) < 0)
+ *      err;
+ *   while (cb != NULL){
+ *      handle(cb); cbuf_free(cb);
+ *      if (clixon_msg_reader_next(mr, descr, &cb, &eof) < 0)
+ *         err;
+ *   }
+ * @endcode
+ * @see clixon_msg_rcv11  Unbuffered, blocks until a message is received
+ */
+int
+clixon_msg_reader_rcv(clixon_msg_reader *mr,
+                      const char        *descr,
+                      cbuf             **cb,
+                      int               *eof)
+{
+    if (clixon_msg_reader_next(mr, descr, cb, eof) < 0)
+        return -1;
+    if (*cb != NULL || *eof)
+        return 0;
+    if (clixon_msg_reader_read(mr, eof) < 0)
+        return -1;
+    if (*eof){
+        if (descr)
+            clixon_debug(CLIXON_DBG_MSG, "Recv [%s]: EOF", descr);
+        else
+            clixon_debug(CLIXON_DBG_MSG, "Recv: EOF");
+        return 0;
+    }
+    return clixon_msg_reader_next(mr, descr, cb, eof);
+}
+
 /*================= NETCONF 1.1 Chunked framing ================*/
 
 /*! Send a message using NETCONF 1.1 w chunked framing
@@ -506,12 +1280,23 @@ clixon_msg_send11(int         s,
                   const char *descr,
                   cbuf       *cb)
 {
-    int retval = -1;
+    int                retval = -1;
+    clixon_msg_writer *mw;
 
-    if (netconf_output_encap(NETCONF_SSH_CHUNKED, cb) < 0)
-        goto done;
-    if (clixon_msg_send(s, descr, cb) < 0)
-        goto done;
+    if ((mw = clixon_msg_writer_find(s)) != NULL){
+        if (descr)
+            clixon_debug(CLIXON_DBG_MSG, "Send [%s]: %s", descr, cbuf_get(cb));
+        else
+            clixon_debug(CLIXON_DBG_MSG, "Send: %s", cbuf_get(cb));
+        if (clixon_msg_writer_msg(mw, cbuf_get(cb), cbuf_len(cb)) < 0)
+            goto done;
+    }
+    else {
+        if (netconf_output_encap(NETCONF_SSH_CHUNKED, cb) < 0)
+            goto done;
+        if (clixon_msg_send(s, descr, cb) < 0)
+            goto done;
+    }
     retval = 0;
   done:
     return retval;
@@ -627,6 +1412,38 @@ clixon_msg_rcv11(int         s,
     return retval;
 }
 
+/*! Send a NETCONF message without waiting for reply
+ *
+ * The reply is received with clixon_msg_rcv11 or a message reader
+ * @param[in]  sock   Socket / file descriptor
+ * @param[in]  descr  Description of peer for logging
+ * @param[in]  msg    Clixon msg data structure. It has fixed header and variable body.
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see clicon_rpc  Send and wait for reply
+ */
+int
+clicon_rpc_send(int                sock,
+                const char        *descr,
+                struct clicon_msg *msg)
+{
+    int   retval = -1;
+    cbuf *cbsend = NULL;
+
+    if ((cbsend = cbuf_new()) == NULL){
+        clixon_err(OE_UNIX, errno, "cbuf_new");
+        goto done;
+    }
+    cprintf(cbsend, "%s", msg->op_body);
+    if (clixon_msg_send11(sock, descr, cbsend) < 0)
+        goto done;
+    retval = 0;
+ done:
+    if (cbsend)
+        cbuf_free(cbsend);
+    return retval;
+}
+
 /*! Send a NETCONF message and wait for result.
  *
  * TBD: timeout, interrupt?
@@ -692,6 +1509,8 @@ clicon_rpc(int                sock,
  * @param[in]  datalen Length of returned data XXX  may be unecessary if always string?
  * @retval     0       OK
  * @retval    -1       Error
+ * If the socket has a message writer, the reply ends an ongoing reply stream, if any
+ * @see clixon_msg_writer_end
  */
 int
 send_msg_reply(int         s,
@@ -700,8 +1519,14 @@ send_msg_reply(int         s,
                uint32_t    datalen)
 {
     int                retval = -1;
-    cbuf          *cb = NULL;
+    cbuf              *cb = NULL;
+    clixon_msg_writer *mw;
 
+    if ((mw = clixon_msg_writer_find(s)) != NULL){
+        if (clixon_msg_writer_end(mw, descr, data, datalen) < 0)
+            goto done;
+        goto ok;
+    }
     if ((cb = cbuf_new()) == NULL){
         clixon_err(OE_UNIX, errno, "cbuf_new");
         goto done;
@@ -712,6 +1537,7 @@ send_msg_reply(int         s,
     }
     if (clixon_msg_send11(s, descr, cb) < 0)
         goto done;
+ ok:
     retval = 0;
  done:
     if (cb)
@@ -49,6 +49,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
@@ -1980,3 +1981,422 @@ clicon_rpc_restart_plugin(clixon_handle h,
         xml_free(xret);
     return retval;
 }
+
+/*================= Asynchronous backend client ================*/
+
+/*! Request sent on asynchronous backend socket waiting for reply
+ */
+struct rpc_async_req{
+    qelem_t              ar_q;      /* Queue header, in order sent */
+    uint32_t             ar_id;     /* Request id */
+    clicon_rpc_async_cb *ar_fn;     /* Reply callback, or NULL if reply is waited for */
+    void                *ar_arg;    /* Callback argument */
+    int                  ar_done;   /* Reply received, waiting to be collected */
+    cxobj               *ar_xret;   /* Reply if done */
+};
+
+/*! Asynchronous backend socket, see clicon_rpc_async_msg
+ *
+ * The backend handles requests on a socket in order, therefore replies are correlated with
+ * requests by order: the reply is for the first request not yet done.
+ */
+struct rpc_async{
+    int                   ra_s;       /* Socket to backend */
+    clixon_msg_reader    *ra_reader;  /* Input buffer */
+    clixon_msg_writer    *ra_writer;  /* Output queue */
+    struct rpc_async_req *ra_reqs;    /* Requests waiting for reply, in order sent */
+    int                   ra_nr;      /* Number of requests in ra_reqs */
+    uint32_t              ra_id;      /* Last request id */
+};
+
+#define RPC_ASYNC_DATA "rpc-async"
+
+static struct rpc_async *
+clicon_rpc_async_get(clixon_handle h)
+{
+    struct rpc_async *ra = NULL;
+
+    if (clicon_ptr_get(h, RPC_ASYNC_DATA, (void**)&ra) < 0)
+        return NULL;
+    return ra;
+}
+
+static int clicon_rpc_async_input(int s, void *arg);
+
+/*! Connect asynchronous backend socket if not connected
+ *
+ * @param[in]  h    Clixon handle
+ * @retval     ra   Asynchronous backend socket
+ * @retval     NULL Error
+ */
+static struct rpc_async *
+clicon_rpc_async_connect(clixon_handle h)
+{
+    struct rpc_async *ra;
+    int               s = -1;
+
+    if ((ra = clicon_rpc_async_get(h)) != NULL)
+        return ra;
+    if (clicon_rpc_connect(h, &s) < 0)
+        goto err;
+    if ((ra = malloc(sizeof(*ra))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto err;
+    }
+    memset(ra, 0, sizeof(*ra));
+    ra->ra_s = s;
+    if ((ra->ra_reader = clixon_msg_reader_new(s)) == NULL)
+        goto err;
+    if ((ra->ra_writer = clixon_msg_writer_new(s, RPC_ASYNC_BUFSIZE)) == NULL)
+        goto err;
+    if (clixon_event_reg_fd(s, clicon_rpc_async_input, h, "backend async socket") < 0)
+        goto err;
+    if (clicon_ptr_set(h, RPC_ASYNC_DATA, ra) < 0)
+        goto err;
+    return ra;
+ err:
+    if (ra){
+        clixon_event_unreg_fd(s, clicon_rpc_async_input);
+        clixon_msg_writer_free(ra->ra_writer);
+        clixon_msg_reader_free(ra->ra_reader);
+        free(ra);
+    }
+    if (s != -1)
+        close(s);
+    return NULL;
+}
+
+/*! Deliver reply to the first request not yet done
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  ra    Asynchronous backend socket
+ * @param[in]  xret  Reply, or NULL if connection closed. Consumed
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+clicon_rpc_async_deliver(clixon_handle     h,
+                         struct rpc_async *ra,
+                         cxobj            *xret)
+{
+    int                   retval = -1;
+    struct rpc_async_req *ar;
+
+    if ((ar = ra->ra_reqs) != NULL)
+        do {
+            if (!ar->ar_done)
+                break;
+            ar = NEXTQ(struct rpc_async_req *, ar);
+        } while (ar != ra->ra_reqs);
+    if (ar == NULL || ar->ar_done){
+        clixon_err(OE_PROTO, EFAULT, "Reply from backend without request");
+        goto done;
+    }
+    if (ar->ar_fn == NULL){ /* Collected by clicon_rpc_async_wait */
+        ar->ar_done = 1;
+        ar->ar_xret = xret;
+        xret = NULL;
+    }
+    else {
+        DELQ(ar, ra->ra_reqs, struct rpc_async_req *);
+        ra->ra_nr--;
+        /* May reenter, eg send new requests or close */
+        if ((*ar->ar_fn)(h, ar->ar_id, xret, ar->ar_arg) < 0){
+            free(ar);
+            goto done;
+        }
+        free(ar);
+    }
+    retval = 0;
+ done:
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Handle buffered replies on asynchronous backend socket
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  ra    Asynchronous backend socket
+ * @param[in]  rd    Read from socket first
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+clicon_rpc_async_dispatch(clixon_handle     h,
+                          struct rpc_async *ra,
+                          int               rd)
+{
+    int    retval = -1;
+    cbuf  *cb = NULL;
+    cxobj *xret = NULL;
+    int    eof = 0;
+
+    if (rd){
+        if (clixon_msg_reader_rcv(ra->ra_reader, clicon_sock_str(h), &cb, &eof) < 0)
+            goto done;
+    }
+    else if (clixon_msg_reader_next(ra->ra_reader, clicon_sock_str(h), &cb, &eof) < 0)
+        goto done;
+    while (cb != NULL){
+        if (clixon_xml_parse_string(cbuf_get(cb), YB_NONE, NULL, &xret, NULL) < 0)
+            goto done;
+        cbuf_free(cb);
+        cb = NULL;
+        if (clicon_rpc_async_deliver(h, ra, xret) < 0){
+            xret = NULL;
+            goto done;
+        }
+        xret = NULL;
+        /* Callback may have closed socket */
+        if (clicon_rpc_async_get(h) != ra)
+            goto ok;
+        if (clixon_msg_reader_next(ra->ra_reader, clicon_sock_str(h), &cb, &eof) < 0)
+            goto done;
+    }
+    if (eof){
+        clixon_err(OE_PROTO, ESHUTDOWN, "Unexpected close of CLICON_SOCK. Clixon backend daemon may have crashed.");
+        clicon_rpc_async_close(h);
+        goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    if (cb)
+        cbuf_free(cb);
+    if (xret)
+        xml_free(xret);
+    return retval;
+}
+
+/*! Serve asynchronous backend socket once without the event loop
+ *
+ * Send queued output and wait for the socket, then handle replies if any
+ * @param[in]  h     Clixon handle
+ * @param[in]  ra    Asynchronous backend socket
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @note ra may be closed by a reply callback, check with clicon_rpc_async_get
+ */
+static int
+clicon_rpc_async_poll(clixon_handle     h,
+                      struct rpc_async *ra)
+{
+    int           retval = -1;
+    struct pollfd pfd = {0,};
+    int           ret;
+
+    if ((ret = clixon_msg_writer_flush(ra->ra_writer)) < 0)
+        goto done;
+    pfd.fd = ra->ra_s;
+    pfd.events = POLLIN | (ret ? POLLOUT : 0);
+    if (poll(&pfd, 1, -1) < 0){
+        if (errno == EINTR)
+            goto ok;
+        clixon_err(OE_UNIX, errno, "poll");
+        goto done;
+    }
+    if (pfd.revents & (POLLIN|POLLERR|POLLHUP)){
+        if (clicon_rpc_async_dispatch(h, ra, 1) < 0)
+            goto done;
+    }
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Event callback when input is available on asynchronous backend socket
+ */
+static int
+clicon_rpc_async_input(int   s,
+                       void *arg)
+{
+    clixon_handle     h = (clixon_handle)arg;
+    struct rpc_async *ra;
+
+    if ((ra = clicon_rpc_async_get(h)) == NULL || ra->ra_s != s)
+        return 0;
+    if (clicon_rpc_async_dispatch(h, ra, 1) < 0)
+        clixon_log(h, LOG_WARNING, "%s: %s", __FUNCTION__, clixon_err_reason());
+    return 0;
+}
+
+/*! Send internal netconf rpc from client to backend without waiting for reply
+ *
+ * Several requests may be in flight on the same socket. Replies are delivered to fn from
+ * the event loop, or while waiting in clicon_rpc_async_wait, in the order requests were sent.
+ * The request is queued and sent from the event loop, or while waiting. If more than
+ * RPC_ASYNC_BUFSIZE is queued, replies are handled until the queue is below the bound.
+ * Requests are sent on a separate backend socket than clicon_rpc_msg, ie a separate session.
+ * The sessions do not share locks: a datastore locked with clicon_rpc_lock is also locked
+ * against edits sent with this function, and a lock taken with this function is held by the
+ * separate session until the socket is closed.
+ * @param[in]  h      Clixon handle
+ * @param[in]  msg    Encoded message. Deallocate with free
+ * @param[in]  fn     Called with reply, or NULL: collect reply with clicon_rpc_async_wait
+ * @param[in]  arg    Argument to fn
+ * @param[out] id     Request id (if not NULL)
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @code
+ *   int fn(clixon_handle h, uint32_t id, cxobj *xret, void *arg){
+ *     if (xret == NULL) # Backend closed
+ *     ...
+ *   }
+ *   clicon_rpc_async_msg(h, msg1, fn, NULL, NULL);
+ *   clicon_rpc_async_msg(h, msg2, NULL, NULL, &id);
+ *   clicon_rpc_async_wait(h, id, &xret);
+ * @endcode
+ * @note xret in fn is freed by the caller, it is not bound to yang
+ * @see clicon_rpc_msg  Synchronous version
+ */
+int
+clicon_rpc_async_msg(clixon_handle        h,
+                     struct clicon_msg   *msg,
+                     clicon_rpc_async_cb *fn,
+                     void                *arg,
+                     uint32_t            *id)
+{
+    int                   retval = -1;
+    struct rpc_async     *ra;
+    struct rpc_async_req *ar = NULL;
+
+#ifdef RPC_USERNAME_ASSERT
+    assert(strstr(msg->op_body, "username")!=NULL); /* XXX */
+#endif
+    if ((ra = clicon_rpc_async_connect(h)) == NULL)
+        goto done;
+    if ((ar = malloc(sizeof(*ar))) == NULL){
+        clixon_err(OE_UNIX, errno, "malloc");
+        goto done;
+    }
+    memset(ar, 0, sizeof(*ar));
+    ar->ar_id = ++ra->ra_id;
+    ar->ar_fn = fn;
+    ar->ar_arg = arg;
+    /* Queue before send, a reply may be delivered when sending */
+    ADDQ(ar, ra->ra_reqs);
+    ra->ra_nr++;
+    if (clixon_msg_writer_end(ra->ra_writer, clicon_sock_str(h),
+                              msg->op_body, strlen(msg->op_body)) < 0){
+        DELQ(ar, ra->ra_reqs, struct rpc_async_req *);
+        ra->ra_nr--;
+        goto done;
+    }
+    if (id)
+        *id = ar->ar_id;
+    ar = NULL;
+    /* Bound queued output, handle replies meanwhile so that the backend can proceed */
+    while (clixon_msg_writer_queued(ra->ra_writer) > RPC_ASYNC_BUFSIZE){
+        if (clicon_rpc_async_poll(h, ra) < 0)
+            goto done;
+        if (clicon_rpc_async_get(h) != ra) /* Closed by callback */
+            break;
+    }
+    retval = 0;
+ done:
+    if (ar)
+        free(ar);
+    return retval;
+}
+
+/*! Wait for reply of a request sent with clicon_rpc_async_msg without callback
+ *
+ * Replies of other requests received meanwhile are delivered to their callbacks.
+ * Does not run the event loop, only the asynchronous backend socket is served.
+ * @param[in]  h      Clixon handle
+ * @param[in]  id     Request id
+ * @param[out] xret   Reply. Free with xml_free
+ * @retval     0      OK
+ * @retval    -1      Error, eg unknown request or backend closed
+ */
+int
+clicon_rpc_async_wait(clixon_handle h,
+                      uint32_t      id,
+                      cxobj       **xret)
+{
+    int                   retval = -1;
+    struct rpc_async     *ra;
+    struct rpc_async_req *ar;
+
+    while (1){
+        if ((ra = clicon_rpc_async_get(h)) == NULL){
+            clixon_err(OE_PROTO, ESHUTDOWN, "No asynchronous backend socket");
+            goto done;
+        }
+        if ((ar = ra->ra_reqs) != NULL)
+            do {
+                if (ar->ar_id == id)
+                    break;
+                ar = NEXTQ(struct rpc_async_req *, ar);
+            } while (ar != ra->ra_reqs);
+        if (ar == NULL || ar->ar_id != id || ar->ar_fn != NULL){
+            clixon_err(OE_PROTO, EINVAL, "No request %u to wait for", id);
+            goto done;
+        }
+        if (ar->ar_done)
+            break;
+        /* Send queued output, and read input */
+        if (clicon_rpc_async_poll(h, ra) < 0)
+            goto done;
+    }
+    DELQ(ar, ra->ra_reqs, struct rpc_async_req *);
+    ra->ra_nr--;
+    if (xret){
+        *xret = ar->ar_xret;
+        ar->ar_xret = NULL;
+    }
+    if (ar->ar_xret)
+        xml_free(ar->ar_xret);
+    free(ar);
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get number of requests on asynchronous backend socket waiting for reply
+ *
+ * @param[in]  h      Clixon handle
+ * @retval     nr     Number of requests not yet replied or collected
+ */
+int
+clicon_rpc_async_pending(clixon_handle h)
+{
+    struct rpc_async *ra;
+
+    if ((ra = clicon_rpc_async_get(h)) == NULL)
+        return 0;
+    return ra->ra_nr;
+}
+
+/*! Close asynchronous backend socket
+ *
+ * Callbacks of requests without reply are called with xret set to NULL
+ * @param[in]  h      Clixon handle
+ * @retval     0      OK
+ */
+int
+clicon_rpc_async_close(clixon_handle h)
+{
+    struct rpc_async     *ra;
+    struct rpc_async_req *ar;
+
+    if ((ra = clicon_rpc_async_get(h)) == NULL)
+        return 0;
+    clicon_ptr_del(h, RPC_ASYNC_DATA);
+    clixon_event_unreg_fd(ra->ra_s, clicon_rpc_async_input);
+    clixon_msg_writer_free(ra->ra_writer);
+    clixon_msg_reader_free(ra->ra_reader);
+    close(ra->ra_s);
+    while ((ar = ra->ra_reqs) != NULL){
+        DELQ(ar, ra->ra_reqs, struct rpc_async_req *);
+        if (ar->ar_fn && !ar->ar_done)
+            (*ar->ar_fn)(h, ar->ar_id, NULL, ar->ar_arg);
+        if (ar->ar_xret)
+            xml_free(ar->ar_xret);
+        free(ar);
+    }
+    free(ra);
+    return 0;
+}
@@ -1199,6 +1199,64 @@ clixon_str_subst(char *str,
     return retval;
 }
 
+/* Table of interned strings with reference counts as values
+ * @see clixon_str_intern
+ */
+static clicon_hash_t *_str_intern = NULL;
+
+/*! Get interned (shared) copy of a string
+ *
+ * Equal strings get the same pointer, so that interned strings can be compared with ==.
+ * Each call increments a reference count, release the string with clixon_str_unintern
+ * @param[in]  str   String
+ * @retval     istr  Interned string, do not modify or free
+ * @retval     NULL  Error
+ * @code
+ *   char *s;
+ *   if ((s = clixon_str_intern("y")) == NULL)
+ *     err;
+ *   ...
+ *   clixon_str_unintern(s);
+ * @endcode
+ */
+char *
+clixon_str_intern(const char *str)
+{
+    clicon_hash_t h;
+    uint32_t      refcnt = 1;
+
+    if (_str_intern == NULL &&
+        (_str_intern = clicon_hash_init()) == NULL)
+        return NULL;
+    if ((h = clicon_hash_lookup(_str_intern, str)) != NULL)
+        (*(uint32_t *)h->h_val)++;
+    else if ((h = clicon_hash_add(_str_intern, str, &refcnt, sizeof(refcnt))) == NULL)
+        return NULL;
+    return h->h_key;
+}
+
+/*! Release interned string, free it when no longer referenced
+ *
+ * @param[in]  istr  String returned by clixon_str_intern
+ * @retval     0     OK
+ * @retval    -1     Error: not an interned string
+ */
+int
+clixon_str_unintern(char *istr)
+{
+    clicon_hash_t h;
+
+    if (_str_intern == NULL ||
+        (h = clicon_hash_lookup(_str_intern, istr)) == NULL ||
+        h->h_key != istr){
+        clixon_err(OE_UNIX, EINVAL, "%s is not interned", istr);
+        return -1;
+    }
+    if (--(*(uint32_t *)h->h_val) == 0)
+        clicon_hash_del(_str_intern, istr);
+    return 0;
+}
+
 /*! strndup() for systems without it, such as xBSD
  */
 #ifndef HAVE_STRNDUP
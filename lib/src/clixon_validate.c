@@ -50,6 +50,7 @@
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <sys/param.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 
 /* cligen */
@@ -82,6 +83,173 @@
 #include "clixon_validate_minmax.h"
 #include "clixon_validate.h"
 
+/*
+ * Leafref target index
+ * Set of values of leafref targets, keyed by leafref path, module of referring leaf and the
+ * node where the path is evaluated. Active during validation of a whole tree, when the tree
+ * does not change, see xml_yang_validate_all_top.
+ * The values are collected on the second reference with the same key, so that a path
+ * evaluated only once, eg relative to a list entry, does not build an index.
+ */
+static clicon_hash_t *_leafref_index = NULL;
+
+/* Leafref index statistics */
+static uint64_t _leafref_index_builds = 0;
+static uint64_t _leafref_index_hits = 0;
+static uint64_t _leafref_index_misses = 0;
+
+/* Leafref index entry */
+struct leafref_index{
+    uint32_t       li_count;  /* Number of references */
+    clicon_hash_t *li_values; /* Set of target values, or NULL if not built */
+};
+
+/*
+ * Names of nodes changed by a transaction
+ * Active while validating a whole tree with xml_yang_validate_all_diff. The value is 1 if nodes
+ * with the name are added or deleted, 0 if only the value of nodes with the name is changed.
+ * must and when statements of unchanged nodes are evaluated only if they depend on a changed
+ * name, see validate_xpath_affected.
+ */
+static clicon_hash_t *_validate_changed = NULL;
+
+/* must/when statistics of incremental validation */
+static uint64_t _validate_xpath_evaluated = 0;
+static uint64_t _validate_xpath_skipped = 0;
+
+/*! Get leafref index statistics
+ *
+ * @param[out] builds  Number of indexes built
+ * @param[out] hits    Number of leafref values found or not found in an index
+ * @param[out] misses  Number of leafref values checked by XPath evaluation
+ * @retval     0       OK
+ */
+int
+validate_leafref_stats(uint64_t *builds,
+                       uint64_t *hits,
+                       uint64_t *misses)
+{
+    *builds = _leafref_index_builds;
+    *hits = _leafref_index_hits;
+    *misses = _leafref_index_misses;
+    return 0;
+}
+
+/*! Free leafref index
+ */
+static int
+leafref_index_free(void)
+{
+    char                **keys = NULL;
+    size_t                nkeys = 0;
+    size_t                i;
+    struct leafref_index *li;
+
+    if (_leafref_index == NULL)
+        return 0;
+    if (clicon_hash_keys(_leafref_index, &keys, &nkeys) < 0)
+        return -1;
+    for (i=0; i<nkeys; i++){
+        if ((li = clicon_hash_value(_leafref_index, keys[i], NULL)) != NULL &&
+            li->li_values)
+            clicon_hash_free(li->li_values);
+    }
+    if (keys)
+        free(keys);
+    clicon_hash_free(_leafref_index);
+    _leafref_index = NULL;
+    return 0;
+}
+
+/*! Look up leafref value in leafref index
+ *
+ * Only paths that do not depend on the referring node, ie absolute paths and relative
+ * paths starting with "../" and without current() or deref().
+ * @param[in]  xt        XML leaf node of type leafref
+ * @param[in]  ys        Yang spec of leaf
+ * @param[in]  ypath     Yang path statement of leafref type
+ * @param[in]  nsc       Namespace context of path
+ * @param[in]  value     Leafref value
+ * @retval     2         No index, evaluate path
+ * @retval     1         Value found
+ * @retval     0         Value not found
+ * @retval    -1         Error
+ */
+static int
+leafref_index_lookup(cxobj     *xt,
+                     yang_stmt *ys,
+                     yang_stmt *ypath,
+                     cvec      *nsc,
+                     char      *value)
+{
+    int                   retval = -1;
+    char                 *path;
+    char                 *rest;
+    cxobj                *xa;
+    cxobj               **xvec = NULL;
+    size_t                xlen = 0;
+    size_t                i;
+    char                 *body;
+    char                  key[64];
+    struct leafref_index  li0 = {0,};
+    struct leafref_index *li;
+
+    if (_leafref_index == NULL)
+        goto noindex;
+    path = yang_argument_get(ypath);
+    if (strstr(path, "current()") != NULL || strstr(path, "deref(") != NULL)
+        goto noindex;
+    /* Node where path is evaluated */
+    xa = xt;
+    rest = path;
+    if (*path == '/'){
+        while (xml_parent(xa) != NULL)
+            xa = xml_parent(xa);
+    }
+    else {
+        while (strncmp(rest, "../", 3) == 0){
+            if ((xa = xml_parent(xa)) == NULL)
+                goto noindex;
+            rest += 3;
+        }
+        if (rest == path || *rest == '\0' || *rest == '.')
+            goto noindex;
+    }
+    snprintf(key, sizeof(key), "%p:%p:%p", ypath, ys_module(ys), xa);
+    if ((li = clicon_hash_value(_leafref_index, key, NULL)) == NULL){
+        if (clicon_hash_add(_leafref_index, key, &li0, sizeof(li0)) == NULL)
+            goto done;
+        if ((li = clicon_hash_value(_leafref_index, key, NULL)) == NULL){
+            clixon_err(OE_UNIX, ENOENT, "leafref index entry not found");
+            goto done;
+        }
+    }
+    if (li->li_values == NULL){
+        if (li->li_count++ == 0)
+            goto noindex;
+        if ((li->li_values = clicon_hash_init()) == NULL)
+            goto done;
+        if (xpath_vec(xa, nsc, "%s", &xvec, &xlen, rest) < 0)
+            goto done;
+        for (i=0; i<xlen; i++){
+            if ((body = xml_body(xvec[i])) != NULL &&
+                clicon_hash_add(li->li_values, body, NULL, 0) == NULL)
+                goto done;
+        }
+        _leafref_index_builds++;
+    }
+    _leafref_index_hits++;
+    retval = clicon_hash_lookup(li->li_values, value) != NULL;
+ done:
+    if (xvec)
+        free(xvec);
+    return retval;
+ noindex:
+    _leafref_index_misses++;
+    retval = 2;
+    goto done;
+}
+
 /*! Validate xml node of type leafref, ensure the value is one of that path's reference
  *
  * @param[in]  xt    XML leaf node of type leafref
@@ -135,6 +303,7 @@ validate_leafref(cxobj     *xt,
     char        *path_arg;
     cg_var      *cv;
     int          require_instance = 1;
+    int          ret;
 
     /* require instance */
     if ((yreqi = yang_find(ytype, Y_REQUIRE_INSTANCE, NULL)) != NULL){
@@ -164,16 +333,21 @@ validate_leafref(cxobj     *xt,
         goto ok;
     if (xml_nsctx_yang(ys, &nsc) < 0)
         goto done;
-    if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0)
+    if ((ret = leafref_index_lookup(xt, ys, ypath, nsc, leafrefbody)) < 0)
         goto done;
-    for (i = 0; i < xlen; i++) {
-        x = xvec[i];
-        if ((leafbody = xml_body(x)) == NULL)
-            continue;
-        if (strcmp(leafbody, leafrefbody) == 0)
-            break;
+    if (ret == 2){ /* No index */
+        if (xpath_vec(xt, nsc, "%s", &xvec, &xlen, path_arg) < 0)
+            goto done;
+        for (i = 0; i < xlen; i++) {
+            x = xvec[i];
+            if ((leafbody = xml_body(x)) == NULL)
+                continue;
+            if (strcmp(leafbody, leafrefbody) == 0)
+                break;
+        }
+        ret = i < xlen;
     }
-    if (i==xlen){
+    if (ret == 0){
         if ((cberr = cbuf_new()) == NULL){
             clixon_err(OE_UNIX, errno, "cbuf_new");
             goto done;
@@ -1209,30 +1383,108 @@ xml_yang_validate_leaf_union(clixon_handle h,
     goto done;
 }
 
-/*! Validate a single XML node with yang specification for all (not only added) entries
+/*! Get must/when statistics of incremental validation
  *
- * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
- * @param[in]  xt  XML node to be validated
+ * @param[out] evaluated  Number of must/when statements evaluated
+ * @param[out] skipped    Number of must/when statements not affected by a transaction
+ * @retval     0          OK
+ */
+int
+validate_xpath_stats(uint64_t *evaluated,
+                     uint64_t *skipped)
+{
+    *evaluated = _validate_xpath_evaluated;
+    *skipped = _validate_xpath_skipped;
+    return 0;
+}
+
+/*! Check if a must or when statement may evaluate differently after a transaction
+ *
+ * The names that the xpath depends on are computed on first use and cached in the statement.
+ * @param[in]  x    XML context node
+ * @param[in]  ys   Yang must or when statement
+ * @retval     1    Affected, or no incremental validation: evaluate the statement
+ * @retval     0    Not affected, the statement evaluates as before the transaction
+ * @retval    -1    Error
+ * @see xpath_deps
+ */
+static int
+validate_xpath_affected(cxobj     *x,
+                        yang_stmt *ys)
+{
+    cvec   *cvv;
+    cg_var *cv = NULL;
+    int    *exists;
+
+    if (_validate_changed == NULL)
+        return 1;
+    if (xml_flag(x, XML_FLAG_ADD|XML_FLAG_CHANGE) != 0x0)
+        goto affected;
+    if ((cvv = yang_cvec_get(ys)) == NULL){
+        if (xpath_deps(yang_argument_get(ys), &cvv) < 0)
+            return -1;
+        yang_cvec_set(ys, cvv);
+    }
+    while ((cv = cvec_each(cvv, cv)) != NULL){
+        if (strcmp(cv_name_get(cv), "*") == 0)
+            goto affected;
+        /* Value of context node: names of ancestors of changed nodes are also marked */
+        if (strcmp(cv_name_get(cv), ".") == 0){
+            if (clicon_hash_value(_validate_changed, xml_name(x), NULL) != NULL)
+                goto affected;
+            continue;
+        }
+        if ((exists = clicon_hash_value(_validate_changed, cv_name_get(cv), NULL)) != NULL &&
+            (*exists || cv_bool_get(cv)))
+            goto affected;
+    }
+    _validate_xpath_skipped++;
+    return 0;
+ affected:
+    _validate_xpath_evaluated++;
+    return 1;
+}
+
+/*! Check if the when statement of a node may evaluate differently after a transaction
+ *
+ * @param[in]  xt   XML node
+ * @param[in]  yt   Yang node of xt
+ * @retval     1    Affected, or no when statement: check when
+ * @retval     0    Not affected
+ * @retval    -1    Error
+ * @see yang_check_when_xpath
+ */
+static int
+validate_when_affected(cxobj     *xt,
+                       yang_stmt *yt)
+{
+    yang_stmt *ywhen;
+
+    if (_validate_changed == NULL)
+        return 1;
+    /* when of augment/uses is evaluated in the context of the parent */
+    if ((ywhen = yang_when_get(NULL, yt)) != NULL)
+        return validate_xpath_affected(xml_parent(xt), ywhen);
+    if ((ywhen = yang_find(yt, Y_WHEN, NULL)) != NULL)
+        return validate_xpath_affected(xt, ywhen);
+    return 1;
+}
+
+/*! Validate a single XML node for all entries, not its children
+ *
+ * @param[in]  h     Clixon handle
+ * @param[in]  xt    XML node to be validated
  * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     2     Validation OK, do not validate children
  * @retval     1     Validation OK
- * @retval     0     Validation failed (cbret set)
+ * @retval     0     Validation failed (xret set)
  * @retval    -1     Error
- * @code
- *   cxobj *x;
- *   cbuf *xret = NULL;
- *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
- *      err;
- *   if (ret == 0)
- *      fail;
- *   xml_free(xret);
- * @endcode
- * @see xml_yang_validate_add
- * @see xml_yang_validate_rpc
+ * @see xml_yang_validate_all
  */
-int
-xml_yang_validate_all(clixon_handle h,
-                      cxobj        *xt,
-                      cxobj       **xret)
+static int
+xml_yang_validate_all_node(clixon_handle h,
+                           cxobj        *xt,
+                           cxobj       **xret)
 {
     int        retval = -1;
     yang_stmt *yt;  /* yang node associated with xt */
@@ -1242,7 +1494,6 @@ xml_yang_validate_all(clixon_handle h,
     char      *xpath1 = NULL;
     int        nr;
     int        ret;
-    cxobj     *x;
     cxobj     *xp;
     char      *ns = NULL;
     cbuf      *cb = NULL;
@@ -1257,7 +1508,7 @@ xml_yang_validate_all(clixon_handle h,
             goto done;
         /* Check if validate beyond mountpoints */
         if (ret == 1 && vl == VL_NONE)
-            goto ok;
+            goto skip;
     }
     /* if not given by argument (overide) use default link 
        and !Node has a config sub-statement and it is false */
@@ -1266,7 +1517,7 @@ xml_yang_validate_all(clixon_handle h,
             clixon_log(h, LOG_WARNING,
                        "%s: %d: No YANG spec for %s, validation skipped",
                        __FUNCTION__, __LINE__, xml_name(xt));
-            goto ok;
+            goto skip;
         }
         if ((cb = cbuf_new()) == NULL){
             clixon_err(OE_UNIX, errno, "cbuf_new");
@@ -1284,11 +1535,14 @@ xml_yang_validate_all(clixon_handle h,
         goto fail;
     }
     if (yang_config(yt) != 0){
-        ret = yang_check_when_xpath(xt, xml_parent(xt), yt, &hit, &nr, &xpath1);
-        clixon_debug(CLIXON_DBG_XPATH|CLIXON_DBG_DETAIL, "nr:%d xpath:%s return:%d", nr, xpath1, ret);
-        if (ret < 0)
+        if ((ret = validate_when_affected(xt, yt)) < 0)
             goto done;
-
+        if (ret == 1){
+            ret = yang_check_when_xpath(xt, xml_parent(xt), yt, &hit, &nr, &xpath1);
+            clixon_debug(CLIXON_DBG_XPATH|CLIXON_DBG_DETAIL, "nr:%d xpath:%s return:%d", nr, xpath1, ret);
+            if (ret < 0)
+                goto done;
+        }
         if (hit && nr == 0){
             if ((cb = cbuf_new()) == NULL){
                 clixon_err(OE_UNIX, errno, "cbuf_new");
@@ -1311,7 +1565,7 @@ xml_yang_validate_all(clixon_handle h,
         switch (yang_keyword_get(yt)){
         case Y_ANYXML:
         case Y_ANYDATA:
-            goto ok;
+            goto skip;
             break;
         case Y_LEAF:
             /* fall thru */
@@ -1350,6 +1604,10 @@ xml_yang_validate_all(clixon_handle h,
         while ((yc = yn_iter(yt, &inext)) != NULL) {
             if (yang_keyword_get(yc) != Y_MUST)
                 continue;
+            if ((ret = validate_xpath_affected(xt, yc)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
             if (!saw_node)
                 clixon_debug_xml(CLIXON_DBG_XPATH, xt, "");
             saw_node = 1;
@@ -1386,22 +1644,6 @@ xml_yang_validate_all(clixon_handle h,
             }
         }
     }
-    x = NULL;
-    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
-        if ((ret = xml_yang_validate_all(h, x, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
-    /* Check unique and min-max after choice test for example*/
-    if (yang_config(yt) != 0){
-        /* Checks if next level contains any unique list constraints */
-        if ((ret = xml_yang_validate_minmax(xt, 1, xret)) < 0)
-            goto done;
-        if (ret == 0)
-            goto fail;
-    }
- ok:
     retval = 1;
  done:
     if (xpath1)
@@ -1411,27 +1653,353 @@ xml_yang_validate_all(clixon_handle h,
     if (nsc)
         xml_nsctx_free(nsc);
     return retval;
+ skip:
+    retval = 2;
+    goto done;
  fail:
     retval = 0;
     goto done;
 }
 
-/*! Validate a single XML node with yang specification
+/*! Validate unique and min/max-elements of children of a node, after its children
  *
- * @param[in]  h     Clixon handle
- * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
+ * @param[in]  xt    XML node, validated with xml_yang_validate_all_node
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (xret set)
+ * @retval    -1     Error
+ */
+static int
+xml_yang_validate_all_post(cxobj  *xt,
+                           cxobj **xret)
+{
+    /* Check unique and min-max after choice test for example*/
+    if (yang_config(xml_spec(xt)) != 0)
+        /* Checks if next level contains any unique list constraints */
+        return xml_yang_validate_minmax(xt, 1, xret);
+    return 1;
+}
+
+/*! Validate a single XML node with yang specification for all (not only added) entries
+ *
+ * 1. Check leafrefs. Eg you delete a leaf and a leafref references it.
+ * @param[in]  xt  XML node to be validated
+ * @param[out] xret  Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1     Validation OK
+ * @retval     0     Validation failed (cbret set)
+ * @retval    -1     Error
+ * @code
+ *   cxobj *x;
+ *   cbuf *xret = NULL;
+ *   if ((ret = xml_yang_validate_all(h, x, &xret)) < 0)
+ *      err;
+ *   if (ret == 0)
+ *      fail;
+ *   xml_free(xret);
+ * @endcode
+ * @see xml_yang_validate_add
+ * @see xml_yang_validate_rpc
+ */
+int
+xml_yang_validate_all(clixon_handle h,
+                      cxobj        *xt,
+                      cxobj       **xret)
+{
+    int    ret;
+    cxobj *x;
+
+    if ((ret = xml_yang_validate_all_node(h, xt, xret)) < 1)
+        return ret;
+    if (ret == 2)
+        return 1;
+    x = NULL;
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
+        if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
+            return ret;
+    }
+    return xml_yang_validate_all_post(xt, xret);
+}
+
+#ifdef VALIDATE_PARALLEL_MIN
+/*
+ * Parallel validation of a whole tree, see CLICON_VALIDATE_WORKERS
+ * The tree is partitioned in items in serial validation order. Items are validated by worker
+ * processes, each reporting its first failing item. The first failing item of all is then
+ * validated again in the calling process, so that the error is the same as in serial validation.
+ */
+
+/* Type of validation item */
+enum validate_item_type{
+    VI_NODE, /* Node without children, xml_yang_validate_all_node */
+    VI_ALL,  /* Node and its children, xml_yang_validate_all */
+    VI_POST, /* Unique and min/max of children after them, xml_yang_validate_all_post */
+    VI_TOP,  /* Unique and min/max of top-level, xml_yang_validate_minmax */
+};
+
+/* Validation item of a partitioned tree */
+struct validate_item{
+    enum validate_item_type vi_type;
+    cxobj                  *vi_x;
+    size_t                  vi_size; /* Number of nodes, estimate of cost */
+};
+
+/*! Number of element nodes in a tree
+ */
+static size_t
+xml_yang_validate_size(cxobj *xt)
+{
+    size_t n = 1;
+    cxobj *x = NULL;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL)
+        n += xml_yang_validate_size(x);
+    return n;
+}
+
+/*! Append validation item
+ */
+static int
+validate_item_add(struct validate_item  **vecp,
+                  int                    *lenp,
+                  enum validate_item_type type,
+                  cxobj                  *x,
+                  size_t                  size)
+{
+    struct validate_item *vec = *vecp;
+
+    if ((*lenp & (*lenp - 1)) == 0){ /* Grow at power of 2 */
+        if ((vec = realloc(vec, (*lenp ? 2 * *lenp : 1) * sizeof(*vec))) == NULL){
+            clixon_err(OE_UNIX, errno, "realloc");
+            return -1;
+        }
+        *vecp = vec;
+    }
+    vec[*lenp].vi_type = type;
+    vec[*lenp].vi_x = x;
+    vec[*lenp].vi_size = size;
+    (*lenp)++;
+    return 0;
+}
+
+/*! Partition children of a node in validation items, split children larger than grain
+ *
+ * @param[in]     h      Clixon handle
+ * @param[in]     xt     XML node
+ * @param[in]     grain  Children with more nodes than this are split
+ * @param[in,out] vecp   Vector of validation items
+ * @param[in,out] lenp   Length of vector
+ * @retval        0      OK
+ * @retval       -1      Error
+ */
+static int
+validate_items_split(clixon_handle          h,
+                     cxobj                 *xt,
+                     size_t                 grain,
+                     struct validate_item **vecp,
+                     int                   *lenp)
+{
+    cxobj     *x = NULL;
+    yang_stmt *y;
+    size_t     size;
+
+    while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL){
+        size = xml_yang_validate_size(x);
+        /* Only split plain config nodes, not mount-points, anydata or nodes without yang */
+        if (size > grain &&
+            (y = xml_spec(x)) != NULL &&
+            (yang_keyword_get(y) == Y_CONTAINER || yang_keyword_get(y) == Y_LIST) &&
+            !clicon_option_bool(h, "CLICON_YANG_SCHEMA_MOUNT")){
+            if (validate_item_add(vecp, lenp, VI_NODE, x, 1) < 0)
+                return -1;
+            if (validate_items_split(h, x, grain, vecp, lenp) < 0)
+                return -1;
+            if (validate_item_add(vecp, lenp, VI_POST, x, 1) < 0)
+                return -1;
+        }
+        else if (validate_item_add(vecp, lenp, VI_ALL, x, size) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/*! Validate a range of validation items in order
+ *
+ * @param[in]  h      Clixon handle
+ * @param[in]  vec    Vector of validation items
+ * @param[in]  first  First item
+ * @param[in]  last   Item after last item
+ * @param[out] failed Index of first item that failed, or -1
+ * @param[out] xret   Error XML tree (if retval=0). Free with xml_free after use
  * @retval     1      Validation OK
  * @retval     0      Validation failed (xret set)
  * @retval    -1      Error
  */
-int
-xml_yang_validate_all_top(clixon_handle h,
-                          cxobj        *xt,
-                          cxobj       **xret)
+static int
+validate_items_run(clixon_handle         h,
+                   struct validate_item *vec,
+                   int                   first,
+                   int                   last,
+                   int                  *failed,
+                   cxobj               **xret)
+{
+    int                   ret = 1;
+    int                   i;
+    struct validate_item *vi;
+
+    *failed = -1;
+    for (i=first; i<last; i++){
+        vi = &vec[i];
+        switch (vi->vi_type){
+        case VI_NODE:
+            ret = xml_yang_validate_all_node(h, vi->vi_x, xret);
+            break;
+        case VI_ALL:
+            ret = xml_yang_validate_all(h, vi->vi_x, xret);
+            break;
+        case VI_POST:
+            ret = xml_yang_validate_all_post(vi->vi_x, xret);
+            break;
+        case VI_TOP:
+            ret = xml_yang_validate_minmax(vi->vi_x, 0, xret);
+            break;
+        }
+        if (ret < 1){
+            *failed = i;
+            return ret;
+        }
+    }
+    return 1;
+}
+
+/*! Validate whole tree in parallel by worker processes
+ *
+ * Workers are forked and read a copy-on-write snapshot of the tree. Each worker validates a
+ * contiguous range of items and reports the index of its first failing item. The first failing
+ * item of all ranges and the items following it are then validated in this process.
+ * @param[in]  h       Clixon handle
+ * @param[in]  xt      Top-level XML tree
+ * @param[in]  size    Number of nodes in xt
+ * @param[in]  workers Number of worker processes
+ * @param[out] xret    Error XML tree (if retval=0). Free with xml_free after use
+ * @retval     1       Validation OK
+ * @retval     0       Validation failed (xret set)
+ * @retval    -1       Error
+ * @see xml_yang_validate_all_top  Serial validation with same result
+ */
+static int
+xml_yang_validate_parallel(clixon_handle h,
+                           cxobj        *xt,
+                           size_t        size,
+                           int           workers,
+                           cxobj       **xret)
+{
+    int                   retval = -1;
+    struct validate_item *vec = NULL;
+    int                   len = 0;
+    int                  *fds = NULL;
+    pid_t                *pids = NULL;
+    int                  *firsts = NULL;
+    int                   nw = 0;
+    int                   w;
+    int                   i;
+    int                   first;
+    int                   failed;
+    size_t                acc;
+    int                   fd[2];
+    pid_t                 pid;
+    int                   idx;
+    ssize_t               n;
+    cxobj                *xerr = NULL;
+
+    if (validate_items_split(h, xt, size / (4*workers), &vec, &len) < 0)
+        goto done;
+    if (validate_item_add(&vec, &len, VI_TOP, xt, 1) < 0)
+        goto done;
+    if (workers > len)
+        workers = len;
+    if ((fds = calloc(workers, sizeof(*fds))) == NULL ||
+        (pids = calloc(workers, sizeof(*pids))) == NULL ||
+        (firsts = calloc(workers, sizeof(*firsts))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    /* Contiguous ranges of items with about the same number of nodes */
+    i = 0;
+    acc = 0;
+    first = len; /* First item to validate in this process */
+    for (w=0; w<workers && i<len; w++){
+        firsts[w] = i;
+        do {
+            acc += vec[i++].vi_size;
+        } while (i < len && (w == workers-1 || acc < (w+1)*size/workers));
+        if (pipe(fd) < 0){
+            first = firsts[w];
+            break;
+        }
+        if ((pid = fork()) < 0){
+            close(fd[0]);
+            close(fd[1]);
+            first = firsts[w];
+            break;
+        }
+        if (pid == 0){ /* Worker */
+            close(fd[0]);
+            validate_items_run(h, vec, firsts[w], i, &idx, &xerr);
+            n = write(fd[1], &idx, sizeof(idx));
+            _exit(n == sizeof(idx) ? 0 : 1);
+        }
+        close(fd[1]);
+        fds[w] = fd[0];
+        pids[w] = pid;
+        nw++;
+    }
+    /* Collect first failing item of all workers */
+    for (w=0; w<nw; w++){
+        while ((n = read(fds[w], &idx, sizeof(idx))) < 0 && errno == EINTR)
+            ;
+        if (n != sizeof(idx)) /* Worker failed, validate its range here */
+            idx = firsts[w];
+        close(fds[w]);
+        while (waitpid(pids[w], NULL, 0) < 0 && errno == EINTR)
+            ;
+        if (idx >= 0 && idx < first)
+            first = idx;
+    }
+    clixon_debug(CLIXON_DBG_DEFAULT | CLIXON_DBG_DETAIL, "items:%d workers:%d first:%d", len, nw, first);
+    if ((retval = validate_items_run(h, vec, first, len, &failed, xret)) < 0)
+        goto done;
+ done:
+    if (vec)
+        free(vec);
+    if (fds)
+        free(fds);
+    if (pids)
+        free(pids);
+    if (firsts)
+        free(firsts);
+    return retval;
+}
+#endif /* VALIDATE_PARALLEL_MIN */
+
+/*! Validate whole tree, serially or in parallel
+ *
+ * @see xml_yang_validate_all_top
+ */
+static int
+xml_yang_validate_all_top1(clixon_handle h,
+                           cxobj        *xt,
+                           cxobj       **xret)
 {
     int    ret;
     cxobj *x;
+#ifdef VALIDATE_PARALLEL_MIN
+    int    workers;
+    size_t size;
 
+    if ((workers = clicon_option_int(h, "CLICON_VALIDATE_WORKERS")) > 1 &&
+        (size = xml_yang_validate_size(xt)) >= VALIDATE_PARALLEL_MIN)
+        return xml_yang_validate_parallel(h, xt, size, workers, xret);
+#endif
     x = NULL;
     while ((x = xml_child_each(xt, x, CX_ELMNT)) != NULL) {
         if ((ret = xml_yang_validate_all(h, x, xret)) < 1)
@@ -1442,6 +2010,147 @@ xml_yang_validate_all_top(clixon_handle h,
     return 1;
 }
 
+/*! Validate a single XML node with yang specification
+ *
+ * Leafref targets are indexed while validating, see leafref_index_lookup.
+ * If CLICON_VALIDATE_WORKERS is larger than one and the tree has at least VALIDATE_PARALLEL_MIN
+ * nodes, the tree is validated in parallel with the same result
+ * @param[in]  h     Clixon handle
+ * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1      Validation OK
+ * @retval     0      Validation failed (xret set)
+ * @retval    -1      Error
+ */
+int
+xml_yang_validate_all_top(clixon_handle h,
+                          cxobj        *xt,
+                          cxobj       **xret)
+{
+    int retval;
+    int index = 0;
+
+    if (_leafref_index == NULL){
+        if ((_leafref_index = clicon_hash_init()) == NULL)
+            return -1;
+        index++;
+    }
+    retval = xml_yang_validate_all_top1(h, xt, xret);
+    if (index && leafref_index_free() < 0)
+        retval = -1;
+    return retval;
+}
+
+/*! Add name of node to changed names
+ *
+ * @param[in]  name    Name of node
+ * @param[in]  exists  1: node is added or deleted, 0: value of node is changed
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+validate_changed_name(char *name,
+                      int   exists)
+{
+    int *v;
+
+    if ((v = clicon_hash_value(_validate_changed, name, NULL)) != NULL){
+        if (exists)
+            *v = 1;
+    }
+    else if (clicon_hash_add(_validate_changed, name, &exists, sizeof(exists)) == NULL)
+        return -1;
+    return 0;
+}
+
+/*! Add names of changed node, of its subtree if added or deleted, and of its ancestors
+ *
+ * The value of ancestors also change, eg the string-value of a container
+ * @param[in]  x       XML node in source or target tree
+ * @param[in]  exists  1: node is added or deleted, 0: value of node is changed
+ * @retval     0       OK
+ * @retval    -1       Error
+ */
+static int
+validate_changed_add(cxobj *x,
+                     int    exists)
+{
+    cxobj *xc;
+
+    if (validate_changed_name(xml_name(x), exists) < 0)
+        return -1;
+    if (exists){
+        xc = NULL;
+        while ((xc = xml_child_each(x, xc, CX_ELMNT)) != NULL)
+            if (validate_changed_add(xc, 1) < 0)
+                return -1;
+    }
+    return 0;
+}
+
+/*! Validate whole tree after a transaction, re-evaluating only affected must/when
+ *
+ * A must or when statement of a node which is not added or changed is evaluated only if its
+ * xpath depends on the name of a node that is added, deleted or changed, see xpath_deps.
+ * Other statements evaluate as in the source tree, which is assumed to be valid.
+ * @param[in]  h      Clixon handle
+ * @param[in]  xt     Target XML tree with XML_FLAG_ADD and XML_FLAG_CHANGE set
+ * @param[in]  dvec   Deleted nodes of source tree
+ * @param[in]  dlen   Length of dvec
+ * @param[in]  avec   Added nodes of target tree
+ * @param[in]  alen   Length of avec
+ * @param[in]  tcvec  Changed nodes of target tree
+ * @param[in]  clen   Length of tcvec
+ * @param[out] xret   Error XML tree (if ret == 0). Free with xml_free after use
+ * @retval     1      Validation OK
+ * @retval     0      Validation failed (xret set)
+ * @retval    -1      Error
+ * @see xml_yang_validate_all_top  Validate all must/when
+ */
+int
+xml_yang_validate_all_diff(clixon_handle h,
+                           cxobj        *xt,
+                           cxobj       **dvec,
+                           int           dlen,
+                           cxobj       **avec,
+                           int           alen,
+                           cxobj       **tcvec,
+                           int           clen,
+                           cxobj       **xret)
+{
+    int    retval = -1;
+    int    i;
+    cxobj *x;
+
+    if ((_validate_changed = clicon_hash_init()) == NULL)
+        goto done;
+    for (i=0; i<dlen; i++){
+        if (validate_changed_add(dvec[i], 1) < 0)
+            goto done;
+        for (x = xml_parent(dvec[i]); x != NULL; x = xml_parent(x))
+            if (validate_changed_name(xml_name(x), 0) < 0)
+                goto done;
+    }
+    for (i=0; i<alen; i++){
+        if (validate_changed_add(avec[i], 1) < 0)
+            goto done;
+        for (x = xml_parent(avec[i]); x != NULL; x = xml_parent(x))
+            if (validate_changed_name(xml_name(x), 0) < 0)
+                goto done;
+    }
+    for (i=0; i<clen; i++){
+        for (x = tcvec[i]; x != NULL; x = xml_parent(x))
+            if (validate_changed_name(xml_name(x), 0) < 0)
+                goto done;
+    }
+    retval = xml_yang_validate_all_top(h, xt, xret);
+ done:
+    if (_validate_changed){
+        clicon_hash_free(_validate_changed);
+        _validate_changed = NULL;
+    }
+    return retval;
+}
+
 /*! Check validity of outgoing RPC
  *
  * Rewrite return message if errors
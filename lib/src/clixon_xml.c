@@ -59,6 +59,7 @@
 
 /* clixon */
 #include "clixon_map.h"
+#include "clixon_string.h"
 #include "clixon_queue.h"
 #include "clixon_hash.h"
 #include "clixon_handle.h"
@@ -89,6 +90,16 @@
 #define XML_CHILDVEC_SIZE_START_ELMNT 16
 #define XML_CHILDVEC_SIZE_THRESHOLD 65536
 
+#ifdef XML_CHILD_CHUNKS
+/* Number of children of a list parent above which a mid-vector insert or remove converts
+ * the flat child vector into chunks, see xml_chunks_new
+ */
+#define XML_CHILDVEC_CHUNK_THRESHOLD 4096
+
+/* Max number of children per chunk */
+#define XML_CHILDVEC_CHUNK_SIZE 512
+#endif
+
 /* Intention of these macros is to guard against access of type-specific fields 
  * As debug they can contain an assert.
  */
@@ -100,8 +111,6 @@
  */
 
 #ifdef XML_EXPLICIT_INDEX
-static int xml_search_index_free(cxobj *x);
-
 /* A search index pair consisting of a name of an (index) variable and a vector of xml children
  * the variable should be a potential child of the XML node
  * The vector should have the same elements as the regular XML childvec, but in different order
@@ -165,9 +174,9 @@ struct search_index{
  */
 struct xml{
     enum cxobj_type   x_type;       /* type of node: element, attribute, body */
-    char             *x_name;       /* name of node */
-    char             *x_prefix;     /* namespace localname N, called prefix */
     uint16_t          x_flags;      /* Flags according to XML_FLAG_* */
+    char             *x_name;       /* name of node (interned) */
+    char             *x_prefix;     /* namespace localname N, called prefix (interned) */
     struct xml       *x_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *x_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -175,31 +184,73 @@ struct xml{
     int              _x_vector_i;   /* internal use: xml_child_each */
     int              _x_i;          /* internal use for stable sorting:
                                        see xml_enumerate and xml_cmp */
-    /*----- next is body/attribute only */
-    cbuf             *x_value_cb;  /* attribute and body nodes have values (XXX: this consumes 
-                                       memory) cv? */
     /*----- up to here is common to all next is element only */
-    struct xml      **x_childvec;   /* vector of children nodes (XXX: use clixon_vec ) */
+    struct xml      **x_childvec;   /* vector of children nodes, NULL if chunked, see xml_chunks */
     int               x_childvec_len;/* Number of children */
     int               x_childvec_max;/* Length of allocated vector */
-
-    cvec             *x_ns_cache;   /* Cached vector of namespaces (set by bind-yang) */
     yang_stmt        *x_spec;       /* Pointer to specification, eg yang, 
                                        by reference, dont free */
-    cg_var           *x_cv;         /* Cached value as cligen variable (set by xml_cmp) */
+    struct xml_extra *x_extra;      /* Uncommon fields, allocated when needed */
+};
+
+/* Uncommon fields of XML elements, allocated on first use
+ * @see xml_extra_get
+ */
+struct xml_extra{
+    cvec             *xe_ns_cache;  /* Cached vector of namespaces (set by bind-yang) */
+    cg_var           *xe_cv;        /* Cached value as cligen variable (set by xml_cmp) */
 #ifdef XML_EXPLICIT_INDEX
-    struct search_index *x_search_index; /* explicit search index vectors */
+    struct search_index *xe_search_index; /* explicit search index vectors */
+#endif
+#ifdef XML_CHILD_CHUNKS
+    struct xml_chunks *xe_chunks;   /* Chunked children, replaces x_childvec if set */
 #endif
+    struct xml_extra *xe_next;      /* Arena nodes: next in arena list */
+};
+
+#ifdef XML_CHILD_CHUNKS
+/* One chunk of children
+ */
+struct xml_chunk{
+    int               ck_len;       /* Number of children in chunk, never 0 */
+    struct xml       *ck_vec[XML_CHILDVEC_CHUNK_SIZE];
+};
+
+/* Chunked child vector used for large lists instead of a flat x_childvec
+ * The children are in order: first all of chunk 0, then chunk 1, etc.
+ * x_childvec_len of the parent is the total number of children.
+ * The index of the first child of a chunk is the sum of the lengths of the chunks before it,
+ * kept in a Fenwick tree so that an insert or remove updates it in O(log nr of chunks)
+ *
+ *                 xk_vec:   |  0  |  1  |  2  |
+ *                 start:    |  0  | 300 | 812 |
+ *                              |     |     |
+ *                              v     v     v
+ *                            a..c  d..m  n..z
+ */
+struct xml_chunks{
+    struct xml_chunk **xk_vec;      /* Vector of chunks */
+    int               *xk_tree;     /* Fenwick tree of chunk lengths, 1-based */
+    int                xk_nr;       /* Number of chunks */
+    int                xk_max;      /* Allocated length of xk_vec, xk_tree has one more */
+    int                xk_cur;      /* Cursor: last accessed chunk */
+    int                xk_curstart; /* Index of first child of cursor chunk */
 };
+#endif
+
+/* Max size of body/attribute values stored inline in the node (including NULL) 
+ * Longer values are allocated separately
+ */
+#define XML_VALUE_INLINE 16
 
 /* Variant of struct xml for use by non-elements to save space
  * @see struct xml  For XML elements
  */
 struct xmlbody{
     enum cxobj_type   xb_type;       /* type of node: element, attribute, body */
-    char             *xb_name;       /* name of node */
-    char             *xb_prefix;     /* namespace localname N, called prefix */
     uint16_t          xb_flags;      /* Flags according to XML_FLAG_* */
+    char             *xb_name;       /* name of node (interned) */
+    char             *xb_prefix;     /* namespace localname N, called prefix (interned) */
     struct xml       *xb_up;         /* parent node in hierarchy if any */
 #ifdef XML_PARENT_CANDIDATE
     struct xml       *xb_up_candidate; /* Candidate parent node for special cases (when+xpath) */
@@ -207,9 +258,18 @@ struct xmlbody{
     int              _xb_vector_i;   /* internal use: xml_child_each */
     int              _xb_i;          /* internal use for sorting: 
                                        see xml_enumerate and xml_cmp */
-    cbuf             *xb_value_cb;  /* attribute and body nodes have values */
+    uint32_t          xb_value_len;  /* Length of value (excluding NULL) */
+    uint32_t          xb_value_max;  /* Size of value buffer: 0 if no value, 
+                                        XML_VALUE_INLINE if inline, otherwise allocated */
+    union {
+        char         *xv_heap;       /* Allocated value */
+        char          xv_inline[XML_VALUE_INLINE]; /* Short value */
+    } xb_value;                      /* attribute and body nodes have values */
 };
 
+#define xml2body(x) ((struct xmlbody *)(x))
+#define xmlbody_value(xb) ((xb)->xb_value_max > XML_VALUE_INLINE ? (xb)->xb_value.xv_heap : (xb)->xb_value.xv_inline)
+
 /*
  * Variables
  */
@@ -249,47 +309,830 @@ xml_stats_global(uint64_t *nr)
     return 0;
 }
 
+/* Size of arena blocks, must be a power of 2. Blocks are aligned to their size, so that the
+ * arena of a node can be found from the node address
+ */
+#define XML_ARENA_BLOCK (64*1024)
+
+/* Arena allocations larger than this are allocated separately (not nodes) */
+#define XML_ARENA_LARGE (XML_ARENA_BLOCK/4)
+
+/* Header of an arena block or large allocation */
+struct xml_arena_block{
+    struct xml_arena       *ab_arena; /* Arena of block */
+    struct xml_arena_block *ab_next;  /* Next block in arena */
+    size_t                  ab_used;  /* Used bytes of block (including header) */
+};
+
+#define XML_ARENA_HDR ((sizeof(struct xml_arena_block)+7) & ~(size_t)7)
+
+/*! Arena for bulk allocation of transient XML trees
+ *
+ * XML nodes, child vectors and long values are allocated from large blocks and freed together
+ * with xml_arena_free, instead of one by one with xml_free.
+ * Nodes whose parent is an arena node are allocated in the same arena. Top nodes are allocated
+ * in the active arena, if any.
+ * @see xml_arena_new
+ */
+struct xml_arena{
+    struct xml_arena_block *xa_block;  /* List of blocks, first is current */
+    struct xml_arena_block *xa_large;  /* List of large allocations */
+    clicon_hash_t          *xa_names;  /* Interned names referenced by arena nodes */
+    struct xml_extra       *xa_extra;  /* List of extra fields of arena nodes */
+    uint64_t                xa_nr;     /* Number of nodes allocated */
+    int                     xa_mixed;  /* Non-arena nodes have been added to arena nodes */
+};
+
+/* Get arena of an arena XML node */
+#define xml_arena_get(x) (((struct xml_arena_block *)((uintptr_t)(x) & ~(uintptr_t)(XML_ARENA_BLOCK-1)))->ab_arena)
+
+#define is_arena(x) (xml_flag((x), XML_FLAG_ARENA) != 0)
+
+/* Active arena used for new top nodes, see xml_arena_set */
+static struct xml_arena *_xml_arena = NULL;
+
+/*! Allocate memory from an arena
+ *
+ * @param[in]  xa   XML arena
+ * @param[in]  sz   Size of allocation
+ * @retval     p    Allocated memory, not initialized
+ * @retval     NULL Error
+ */
+static void *
+xml_arena_alloc(struct xml_arena *xa,
+                size_t            sz)
+{
+    struct xml_arena_block *ab;
+    void                   *p;
+
+    sz = (sz + 7) & ~(size_t)7;
+    if (sz > XML_ARENA_LARGE){
+        if ((ab = malloc(XML_ARENA_HDR + sz)) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        ab->ab_arena = xa;
+        ab->ab_used = XML_ARENA_HDR + sz;
+        ab->ab_next = xa->xa_large;
+        xa->xa_large = ab;
+        return (char*)ab + XML_ARENA_HDR;
+    }
+    if ((ab = xa->xa_block) == NULL || ab->ab_used + sz > XML_ARENA_BLOCK){
+        if ((errno = posix_memalign((void**)&ab, XML_ARENA_BLOCK, XML_ARENA_BLOCK)) != 0){
+            clixon_err(OE_XML, errno, "posix_memalign");
+            return NULL;
+        }
+        ab->ab_arena = xa;
+        ab->ab_used = XML_ARENA_HDR;
+        ab->ab_next = xa->xa_block;
+        xa->xa_block = ab;
+    }
+    p = (char*)ab + ab->ab_used;
+    ab->ab_used += sz;
+    return p;
+}
+
+/*! Free the fields of extra struct, but not the struct itself
+ *
+ * @param[in]  xe   Extra fields of XML element
+ */
+static void
+xml_extra_free_fields(struct xml_extra *xe)
+{
+#ifdef XML_EXPLICIT_INDEX
+    struct search_index *si;
+#endif
+
+    if (xe->xe_cv){
+        cv_free(xe->xe_cv);
+        xe->xe_cv = NULL;
+    }
+    if (xe->xe_ns_cache){
+        xml_nsctx_free(xe->xe_ns_cache);
+        xe->xe_ns_cache = NULL;
+    }
+#ifdef XML_EXPLICIT_INDEX
+    while ((si = xe->xe_search_index) != NULL) {
+        DELQ(si, xe->xe_search_index, struct search_index *);
+        if (si->si_name)
+            free(si->si_name);
+        if (si->si_xvec)
+            clixon_xvec_free(si->si_xvec);
+        free(si);
+    }
+#endif
+}
+
+/*! Create an XML arena
+ *
+ * @retval     xa   XML arena, free with xml_arena_free
+ * @retval     NULL Error
+ * @code
+ *   xml_arena *xa;
+ *   xml_arena *xa0;
+ *
+ *   if ((xa = xml_arena_new()) == NULL)
+ *      err;
+ *   xa0 = xml_arena_set(xa);
+ *   ... create transient XML trees
+ *   xml_arena_set(xa0);
+ *   ... use trees
+ *   xml_free(xt);
+ *   xml_arena_free(xa);
+ * @endcode
+ * @note Nodes of arena trees may not be added to non-arena trees
+ */
+xml_arena *
+xml_arena_new(void)
+{
+    struct xml_arena *xa;
+
+    if ((xa = malloc(sizeof(*xa))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return NULL;
+    }
+    memset(xa, 0, sizeof(*xa));
+    if ((xa->xa_names = clicon_hash_init()) == NULL){
+        free(xa);
+        return NULL;
+    }
+    return xa;
+}
+
+/*! Set active arena used for new XML top nodes (without parent)
+ *
+ * @param[in]  xa   XML arena, or NULL for regular allocation
+ * @retval     xa0  Previous active arena
+ */
+xml_arena *
+xml_arena_set(xml_arena *xa)
+{
+    struct xml_arena *xa0 = _xml_arena;
+
+    _xml_arena = xa;
+    return xa0;
+}
+
+/*! Free an XML arena and all XML nodes allocated in it
+ *
+ * Arena trees with non-arena nodes added should be freed with xml_free before, otherwise only
+ * the arena memory is freed
+ * @param[in]  xa   XML arena
+ * @retval     0    OK
+ */
+int
+xml_arena_free(xml_arena *xa)
+{
+    struct xml_arena_block *ab;
+    struct xml_extra       *xe;
+    char                  **keys = NULL;
+    size_t                  nkeys = 0;
+    size_t                  i;
+    char                  **iname;
+
+    if (xa == NULL)
+        return 0;
+    if (_xml_arena == xa)
+        _xml_arena = NULL;
+    for (xe = xa->xa_extra; xe != NULL; xe = xe->xe_next)
+        xml_extra_free_fields(xe);
+    if (clicon_hash_keys(xa->xa_names, &keys, &nkeys) == 0){
+        for (i=0; i<nkeys; i++)
+            if ((iname = clicon_hash_value(xa->xa_names, keys[i], NULL)) != NULL)
+                clixon_str_unintern(*iname);
+        if (keys)
+            free(keys);
+    }
+    clicon_hash_free(xa->xa_names);
+    while ((ab = xa->xa_block) != NULL){
+        xa->xa_block = ab->ab_next;
+        free(ab);
+    }
+    while ((ab = xa->xa_large) != NULL){
+        xa->xa_large = ab->ab_next;
+        free(ab);
+    }
+    _stats_xml_nr -= xa->xa_nr;
+    free(xa);
+    return 0;
+}
+
+/*! Get interned name for an arena node
+ *
+ * The arena holds one reference to each interned name used by its nodes
+ * @param[in]  xa    XML arena
+ * @param[in]  name  Name
+ * @retval     iname Interned name
+ * @retval     NULL  Error
+ */
+static char *
+xml_arena_intern(struct xml_arena *xa,
+                 char             *name)
+{
+    char **iname;
+    char  *in;
+
+    if ((iname = clicon_hash_value(xa->xa_names, name, NULL)) != NULL)
+        return *iname;
+    if ((in = clixon_str_intern(name)) == NULL)
+        return NULL;
+    if (clicon_hash_add(xa->xa_names, name, &in, sizeof(in)) == NULL){
+        clixon_str_unintern(in);
+        return NULL;
+    }
+    return in;
+}
+
+/*! Grow child vector of arena node
+ *
+ * @param[in]  xp   XML arena element
+ * @param[in]  max  New size of child vector (larger than old)
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_arena_childvec_grow(cxobj *xp,
+                        int    max)
+{
+    cxobj **vec;
+
+    if ((vec = xml_arena_alloc(xml_arena_get(xp), max*sizeof(cxobj*))) == NULL)
+        return -1;
+    if (xp->x_childvec_len > 0)
+        memcpy(vec, xp->x_childvec, xp->x_childvec_len*sizeof(cxobj*));
+    xp->x_childvec = vec;
+    return 0;
+}
+
+/*! Get uncommon fields of XML element, allocate if not present
+ *
+ * @param[in]  x    XML element
+ * @retval     xe   Extra fields
+ * @retval     NULL Error
+ */
+static struct xml_extra *
+xml_extra_get(cxobj *x)
+{
+    struct xml_arena *xa;
+
+    if (x->x_extra == NULL){
+        if (is_arena(x)){
+            xa = xml_arena_get(x);
+            if ((x->x_extra = xml_arena_alloc(xa, sizeof(struct xml_extra))) == NULL)
+                return NULL;
+            memset(x->x_extra, 0, sizeof(struct xml_extra));
+            x->x_extra->xe_next = xa->xa_extra; /* Freed by xml_arena_free */
+            xa->xa_extra = x->x_extra;
+        }
+        else {
+            if ((x->x_extra = malloc(sizeof(struct xml_extra))) == NULL){
+                clixon_err(OE_XML, errno, "malloc");
+                return NULL;
+            }
+            memset(x->x_extra, 0, sizeof(struct xml_extra));
+        }
+    }
+    return x->x_extra;
+}
+
+/*! Free uncommon fields of XML element if all are empty
+ *
+ * @param[in]  x    XML element
+ */
+static void
+xml_extra_gc(cxobj *x)
+{
+    struct xml_extra *xe = x->x_extra;
+
+    if (xe == NULL || xe->xe_ns_cache != NULL || xe->xe_cv != NULL || is_arena(x))
+        return;
+#ifdef XML_EXPLICIT_INDEX
+    if (xe->xe_search_index != NULL)
+        return;
+#endif
+#ifdef XML_CHILD_CHUNKS
+    if (xe->xe_chunks != NULL)
+        return;
+#endif
+    free(xe);
+    x->x_extra = NULL;
+}
+
+#ifdef XML_CHILD_CHUNKS
+#define is_chunked(x) ((x)->x_extra != NULL && (x)->x_extra->xe_chunks != NULL)
+
+/*! Rebuild Fenwick tree of chunk lengths, after chunks are added or removed
+ *
+ * Resets the cursor
+ * @param[in]  xk   Chunked child vector
+ */
+static void
+xml_chunks_build(struct xml_chunks *xk)
+{
+    int k;
+    int j;
+
+    for (k=1; k<=xk->xk_nr; k++)
+        xk->xk_tree[k] = xk->xk_vec[k-1]->ck_len;
+    for (k=1; k<=xk->xk_nr; k++)
+        if ((j = k + (k & -k)) <= xk->xk_nr)
+            xk->xk_tree[j] += xk->xk_tree[k];
+    xk->xk_cur = 0;
+    xk->xk_curstart = 0;
+}
+
+/*! Update Fenwick tree when the length of chunk k changes
+ *
+ * @param[in]  xk    Chunked child vector
+ * @param[in]  k     Chunk index
+ * @param[in]  delta Change of length of chunk k
+ */
+static void
+xml_chunks_update(struct xml_chunks *xk,
+                  int                k,
+                  int                delta)
+{
+    for (k++; k<=xk->xk_nr; k += k & -k)
+        xk->xk_tree[k] += delta;
+}
+
+/*! Get index of first child of chunk k, ie the sum of lengths of chunks before k
+ *
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  k    Chunk index, 0 <= k <= xk_nr. If xk_nr, the number of children
+ * @retval     i    Index of first child
+ */
+static int
+xml_chunks_start(struct xml_chunks *xk,
+                 int                k)
+{
+    int i = 0;
+
+    for (; k>0; k -= k & -k)
+        i += xk->xk_tree[k];
+    return i;
+}
+
+/*! Find chunk holding child i
+ *
+ * Checks the cursor chunk and the next chunk first, so that sequential iteration is constant
+ * time, otherwise descends the Fenwick tree.
+ * @param[in]  xk     Chunked child vector
+ * @param[in]  i      Child index, 0 <= i < number of children
+ * @param[out] startp Index of first child of the chunk
+ * @retval     k      Chunk index
+ */
+static int
+xml_chunks_find(struct xml_chunks *xk,
+                int                i,
+                int               *startp)
+{
+    int k;
+    int start;
+    int step;
+    int rem;
+
+    k = xk->xk_cur;
+    start = xk->xk_curstart;
+    if (k < xk->xk_nr && start <= i){
+        if (i < start + xk->xk_vec[k]->ck_len){
+            *startp = start;
+            return k;
+        }
+        start += xk->xk_vec[k]->ck_len;
+        k++;
+        if (k < xk->xk_nr && i < start + xk->xk_vec[k]->ck_len){
+            xk->xk_cur = k;
+            xk->xk_curstart = start;
+            *startp = start;
+            return k;
+        }
+    }
+    /* Largest k such that the sum of the lengths of chunks before k is <= i */
+    for (step=1; 2*step<=xk->xk_nr; step*=2);
+    k = 0;
+    rem = i;
+    for (; step>0; step/=2)
+        if (k + step <= xk->xk_nr && xk->xk_tree[k+step] <= rem){
+            k += step;
+            rem -= xk->xk_tree[k];
+        }
+    xk->xk_cur = k;
+    xk->xk_curstart = i - rem;
+    *startp = i - rem;
+    return k;
+}
+
+/*! Get address of child i in chunked child vector
+ *
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  i    Child index, 0 <= i < number of children
+ * @retval     xp   Pointer to child slot
+ */
+static cxobj **
+xml_chunks_slot(struct xml_chunks *xk,
+                int                i)
+{
+    int k;
+    int start;
+
+    k = xml_chunks_find(xk, i, &start);
+    return &xk->xk_vec[k]->ck_vec[i - start];
+}
+
+/* Get child i of element x regardless of child storage */
+#define xml_childvec_i(x, i) (is_chunked(x) ? *xml_chunks_slot((x)->x_extra->xe_chunks, (i)) : (x)->x_childvec[(i)])
+
+/*! Add a new empty chunk at position k
+ *
+ * The Fenwick tree is not updated, call xml_chunks_build when the chunks are filled
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  k    Position of new chunk, 0 <= k <= xk_nr
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_chunks_add(struct xml_chunks *xk,
+               int                k)
+{
+    struct xml_chunk *ck;
+
+    if (xk->xk_nr == xk->xk_max){
+        xk->xk_max = xk->xk_max ? 2*xk->xk_max : 16;
+        if ((xk->xk_vec = realloc(xk->xk_vec, xk->xk_max*sizeof(struct xml_chunk *))) == NULL ||
+            (xk->xk_tree = realloc(xk->xk_tree, (xk->xk_max+1)*sizeof(int))) == NULL){
+            clixon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+    }
+    if ((ck = malloc(sizeof(*ck))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    ck->ck_len = 0;
+    memmove(&xk->xk_vec[k+1], &xk->xk_vec[k], (xk->xk_nr-k)*sizeof(struct xml_chunk *));
+    xk->xk_vec[k] = ck;
+    xk->xk_nr++;
+    return 0;
+}
+
+/*! Remove and free chunk k
+ *
+ * The Fenwick tree is not updated, call xml_chunks_build
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  k    Chunk index
+ */
+static void
+xml_chunks_del(struct xml_chunks *xk,
+               int                k)
+{
+    free(xk->xk_vec[k]);
+    xk->xk_nr--;
+    memmove(&xk->xk_vec[k], &xk->xk_vec[k+1], (xk->xk_nr-k)*sizeof(struct xml_chunk *));
+}
+
+/*! Free chunked child vector, not the children
+ *
+ * @param[in]  xk   Chunked child vector
+ */
+static void
+xml_chunks_free(struct xml_chunks *xk)
+{
+    int k;
+
+    for (k=0; k<xk->xk_nr; k++)
+        free(xk->xk_vec[k]);
+    if (xk->xk_vec)
+        free(xk->xk_vec);
+    if (xk->xk_tree)
+        free(xk->xk_tree);
+    free(xk);
+}
+
+/*! Insert child at position pos in chunked child vector
+ *
+ * A full chunk is split in two halves, except when appending at the end where a new
+ * chunk is started instead, so that bulk loads leave full chunks.
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  xc   Child XML node
+ * @param[in]  pos  Position, 0 <= pos <= number of children
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_chunks_insert(struct xml_chunks *xk,
+                  cxobj             *xc,
+                  int                pos)
+{
+    struct xml_chunk *ck;
+    struct xml_chunk *ck1;
+    int               k;
+    int               j;
+    int               half;
+    int               start;
+    int               split = 0;
+
+    if (xk->xk_nr == 0){
+        if (xml_chunks_add(xk, 0) < 0)
+            return -1;
+        k = 0;
+        start = 0;
+        split++;
+    }
+    else if (pos == xml_chunks_start(xk, xk->xk_nr)){ /* Append */
+        k = xk->xk_nr - 1;
+        start = pos - xk->xk_vec[k]->ck_len;
+    }
+    else
+        k = xml_chunks_find(xk, pos, &start);
+    ck = xk->xk_vec[k];
+    if (ck->ck_len == XML_CHILDVEC_CHUNK_SIZE){
+        if (xml_chunks_add(xk, k+1) < 0)
+            return -1;
+        ck1 = xk->xk_vec[k+1];
+        if (pos == start + ck->ck_len) /* Append: start new chunk */
+            half = ck->ck_len;
+        else{ /* Split in two halves */
+            half = XML_CHILDVEC_CHUNK_SIZE/2;
+            ck1->ck_len = XML_CHILDVEC_CHUNK_SIZE - half;
+            memcpy(ck1->ck_vec, &ck->ck_vec[half], ck1->ck_len*sizeof(cxobj *));
+            ck->ck_len = half;
+        }
+        if (pos - start >= half){
+            ck = xk->xk_vec[++k];
+            start += half;
+        }
+        split++;
+    }
+    j = pos - start;
+    memmove(&ck->ck_vec[j+1], &ck->ck_vec[j], (ck->ck_len-j)*sizeof(cxobj *));
+    ck->ck_vec[j] = xc;
+    ck->ck_len++;
+    if (split)
+        xml_chunks_build(xk);
+    else
+        xml_chunks_update(xk, k, 1);
+    /* Start of chunk k is not changed by an insert in k */
+    xk->xk_cur = k;
+    xk->xk_curstart = start;
+    return 0;
+}
+
+/*! Remove child at position i from chunked child vector
+ *
+ * Empty chunks are freed, and a small chunk is merged with its successor if they fit in
+ * half a chunk, so that mass deletes do not leave many small chunks.
+ * @param[in]  xk   Chunked child vector
+ * @param[in]  i    Child index, 0 <= i < number of children
+ */
+static void
+xml_chunks_rm(struct xml_chunks *xk,
+              int                i)
+{
+    struct xml_chunk *ck;
+    struct xml_chunk *ck1;
+    int               k;
+    int               j;
+    int               start;
+
+    k = xml_chunks_find(xk, i, &start);
+    ck = xk->xk_vec[k];
+    j = i - start;
+    ck->ck_len--;
+    memmove(&ck->ck_vec[j], &ck->ck_vec[j+1], (ck->ck_len-j)*sizeof(cxobj *));
+    if (ck->ck_len == 0){
+        xml_chunks_del(xk, k);
+        xml_chunks_build(xk);
+    }
+    else if (k+1 < xk->xk_nr &&
+             ck->ck_len + (ck1 = xk->xk_vec[k+1])->ck_len <= XML_CHILDVEC_CHUNK_SIZE/2){
+        memcpy(&ck->ck_vec[ck->ck_len], ck1->ck_vec, ck1->ck_len*sizeof(cxobj *));
+        ck->ck_len += ck1->ck_len;
+        xml_chunks_del(xk, k+1);
+        xml_chunks_build(xk);
+        xk->xk_cur = k;
+        xk->xk_curstart = start;
+    }
+    else
+        xml_chunks_update(xk, k, -1);
+}
+
+/*! Check if child vector of xp should be converted to chunks before insert or remove at pos
+ *
+ * Only for large ordered-by system lists and leaf-lists, and not at the end of the vector
+ * @param[in]  xp   XML parent
+ * @param[in]  xc   XML child to insert or remove
+ * @param[in]  pos  Position of insert or remove
+ * @retval     1    Yes, convert
+ * @retval     0    No
+ */
+static int
+xml_chunks_want(cxobj *xp,
+                cxobj *xc,
+                int    pos)
+{
+    yang_stmt *y;
+
+    if (is_chunked(xp) || is_arena(xp) ||
+        xp->x_childvec_len < XML_CHILDVEC_CHUNK_THRESHOLD ||
+        pos + 1 >= xp->x_childvec_len)
+        return 0;
+    if ((y = xml_spec(xc)) == NULL)
+        return 0;
+    if (yang_keyword_get(y) != Y_LIST && yang_keyword_get(y) != Y_LEAF_LIST)
+        return 0;
+    return yang_find(y, Y_ORDERED_BY, "user") == NULL;
+}
+
+/*! Convert flat child vector of XML element to chunks
+ *
+ * Chunks are filled to three quarters to leave room for inserts
+ * @param[in]  xp   XML element, not arena
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_chunks_new(cxobj *xp)
+{
+    int                retval = -1;
+    struct xml_extra  *xe;
+    struct xml_chunks *xk = NULL;
+    struct xml_chunk  *ck;
+    int                fill;
+    int                i;
+
+    if ((xe = xml_extra_get(xp)) == NULL)
+        goto done;
+    if ((xk = calloc(1, sizeof(*xk))) == NULL){
+        clixon_err(OE_XML, errno, "calloc");
+        goto done;
+    }
+    fill = XML_CHILDVEC_CHUNK_SIZE*3/4;
+    for (i=0; i<xp->x_childvec_len; i+=fill){
+        if (xml_chunks_add(xk, xk->xk_nr) < 0)
+            goto done;
+        ck = xk->xk_vec[xk->xk_nr-1];
+        ck->ck_len = xp->x_childvec_len - i < fill ? xp->x_childvec_len - i : fill;
+        memcpy(ck->ck_vec, &xp->x_childvec[i], ck->ck_len*sizeof(cxobj *));
+    }
+    xml_chunks_build(xk);
+    free(xp->x_childvec);
+    xp->x_childvec = NULL;
+    xp->x_childvec_max = 0;
+    xe->xe_chunks = xk;
+    xk = NULL;
+    retval = 0;
+ done:
+    if (xk)
+        xml_chunks_free(xk);
+    return retval;
+}
+
+/*! Convert chunked children of XML element back to a flat child vector
+ *
+ * @param[in]  xp   XML element with chunked children
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see xml_childvec_get which needs a flat vector
+ */
+static int
+xml_chunks_flatten(cxobj *xp)
+{
+    struct xml_chunks *xk = xp->x_extra->xe_chunks;
+    struct xml_chunk  *ck;
+    cxobj            **vec;
+    int                k;
+    int                i;
+
+    if ((vec = malloc((xp->x_childvec_len ? xp->x_childvec_len : 1)*sizeof(cxobj *))) == NULL){
+        clixon_err(OE_XML, errno, "malloc");
+        return -1;
+    }
+    for (k=0, i=0; k<xk->xk_nr; k++){
+        ck = xk->xk_vec[k];
+        memcpy(&vec[i], ck->ck_vec, ck->ck_len*sizeof(cxobj *));
+        i += ck->ck_len;
+    }
+    xml_chunks_free(xk);
+    xp->x_extra->xe_chunks = NULL;
+    xml_extra_gc(xp);
+    xp->x_childvec = vec;
+    xp->x_childvec_max = xp->x_childvec_len ? xp->x_childvec_len : 1;
+    return 0;
+}
+#else
+#define xml_childvec_i(x, i) ((x)->x_childvec[(i)])
+#endif /* XML_CHILD_CHUNKS */
+
+/*! Ensure value buffer of body/attribute node can hold sz bytes, keep existing value
+ *
+ * @param[in]  xb   XML body or attribute node
+ * @param[in]  sz   Required size including NULL
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xmlbody_value_alloc(struct xmlbody *xb,
+                    size_t          sz)
+{
+    size_t max;
+    char  *p;
+
+    if (sz <= XML_VALUE_INLINE){
+        if (xb->xb_value_max == 0){
+            xb->xb_value_max = XML_VALUE_INLINE;
+            xb->xb_value.xv_inline[0] = '\0';
+        }
+        return 0;
+    }
+    if (sz <= xb->xb_value_max)
+        return 0;
+    if (sz > UINT32_MAX){
+        clixon_err(OE_XML, EINVAL, "value too large");
+        return -1;
+    }
+    max = sz;
+    if (xb->xb_value_max > XML_VALUE_INLINE){ /* Grow existing, double for repeated appends */
+        if (max < (size_t)xb->xb_value_max*2 && (size_t)xb->xb_value_max*2 <= UINT32_MAX)
+            max = (size_t)xb->xb_value_max*2;
+    }
+    if (is_arena((cxobj *)xb)){
+        if ((p = xml_arena_alloc(xml_arena_get(xb), max)) == NULL)
+            return -1;
+        if (xb->xb_value_max != 0)
+            memcpy(p, xmlbody_value(xb), xb->xb_value_len+1);
+        else
+            p[0] = '\0';
+    }
+    else if (xb->xb_value_max > XML_VALUE_INLINE){
+        if ((p = realloc(xb->xb_value.xv_heap, max)) == NULL){
+            clixon_err(OE_XML, errno, "realloc");
+            return -1;
+        }
+    }
+    else {
+        if ((p = malloc(max)) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        if (xb->xb_value_max != 0) /* Move inline value */
+            memcpy(p, xb->xb_value.xv_inline, xb->xb_value_len+1);
+        else
+            p[0] = '\0';
+    }
+    xb->xb_value.xv_heap = p;
+    xb->xb_value_max = max;
+    return 0;
+}
+
 /*! Return the alloced memory of a single XML obj 
  *
  * @param[in]   x    XML object
  * @param[out]  szp  Size of this XML obj
  * @retval      0    OK
- * (baseline: 96 bytes per object on x86-64)
+ * (baseline: 96 bytes per object on x86-64, now 72 bytes per element and 64 per body)
  */
 static int
 xml_stats_one(cxobj    *x,
               size_t   *szp)
 {
-    size_t sz = 0;
+    size_t            sz = 0;
+    struct xml_extra *xe;
 
-    if (x->x_name)
-        sz += strlen(x->x_name) + 1;
-    if (x->x_prefix)
-        sz += strlen(x->x_prefix) + 1;
+    /* Names and prefixes are interned and shared, not counted */
     switch (xml_type(x)){
     case CX_ELMNT:
         sz += sizeof(struct xml);
         sz += x->x_childvec_max*sizeof(struct xml*);
-        if (x->x_ns_cache)
-            sz += cvec_size(x->x_ns_cache);
-        if (x->x_cv)
-            sz += cv_size(x->x_cv);
+        if ((xe = x->x_extra) == NULL)
+            break;
+        sz += sizeof(struct xml_extra);
+#ifdef XML_CHILD_CHUNKS
+        if (xe->xe_chunks)
+            sz += sizeof(struct xml_chunks) +
+                xe->xe_chunks->xk_max*(sizeof(struct xml_chunk *) + sizeof(int)) + sizeof(int) +
+                xe->xe_chunks->xk_nr*sizeof(struct xml_chunk);
+#endif
+        if (xe->xe_ns_cache)
+            sz += cvec_size(xe->xe_ns_cache);
+        if (xe->xe_cv)
+            sz += cv_size(xe->xe_cv);
 #ifdef XML_EXPLICIT_INDEX
-        if (x->x_search_index){
+        if (xe->xe_search_index){
             /* XXX: only one */
             sz += sizeof(struct search_index);
-            if (x->x_search_index->si_name)
-                sz += strlen(x->x_search_index->si_name)+1;
-            if (x->x_search_index->si_xvec)
-                sz += clixon_xvec_len(x->x_search_index->si_xvec)*sizeof(struct cxobj*);
+            if (xe->xe_search_index->si_name)
+                sz += strlen(xe->xe_search_index->si_name)+1;
+            if (xe->xe_search_index->si_xvec)
+                sz += clixon_xvec_len(xe->xe_search_index->si_xvec)*sizeof(struct cxobj*);
         }
 #endif
         break;
     case CX_BODY:
     case CX_ATTR:
         sz += sizeof(struct xmlbody);
-        if (x->x_value_cb)
-            sz += cbuf_buflen(x->x_value_cb);
+        if (xml2body(x)->xb_value_max > XML_VALUE_INLINE)
+            sz += xml2body(x)->xb_value_max;
         break;
     default:
         break;
@@ -359,21 +1202,26 @@ xml_name(cxobj *xn)
  * @param[in]  name  new name, null-terminated string, copied by function
  * @retval     0     OK
  * @retval    -1     On error with clicon-err set
+ * @note name is interned, equal names of different nodes have the same pointer
  */
 int
 xml_name_set(cxobj *xn,
              char  *name)
 {
-    if (xn->x_name){
-        free(xn->x_name);
-        xn->x_name = NULL;
-    }
-    if (name){
-        if ((xn->x_name = strdup(name)) == NULL){
-            clixon_err(OE_XML, errno, "strdup");
+    char *iname = NULL;
+
+    if (is_arena(xn)){ /* Arena holds reference */
+        if (name && (iname = xml_arena_intern(xml_arena_get(xn), name)) == NULL)
             return -1;
-        }
+        xn->x_name = iname;
+        return 0;
     }
+    /* Intern new before release of old, name may be the old name */
+    if (name && (iname = clixon_str_intern(name)) == NULL)
+        return -1;
+    if (xn->x_name)
+        clixon_str_unintern(xn->x_name);
+    xn->x_name = iname;
     return 0;
 }
 
@@ -394,21 +1242,25 @@ xml_prefix(cxobj *xn)
  * @param[in]  prefix  New prefix, null-terminated string, copied by function
  * @retval     0       OK
  * @retval    -1       Error with clicon-err set
+ * @note prefix is interned
  */
 int
 xml_prefix_set(cxobj *xn,
                char  *prefix)
 {
-    if (xn->x_prefix){
-        free(xn->x_prefix);
-        xn->x_prefix = NULL;
-    }
-    if (prefix){
-        if ((xn->x_prefix = strdup(prefix)) == NULL){
-            clixon_err(OE_XML, errno, "strdup");
+    char *iprefix = NULL;
+
+    if (is_arena(xn)){ /* Arena holds reference */
+        if (prefix && (iprefix = xml_arena_intern(xml_arena_get(xn), prefix)) == NULL)
             return -1;
-        }
+        xn->x_prefix = iprefix;
+        return 0;
     }
+    if (prefix && (iprefix = clixon_str_intern(prefix)) == NULL)
+        return -1;
+    if (xn->x_prefix)
+        clixon_str_unintern(xn->x_prefix);
+    xn->x_prefix = iprefix;
     return 0;
 }
 
@@ -426,8 +1278,8 @@ nscache_get(cxobj *x,
 {
     if (!is_element(x))
         return NULL;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get(x->x_ns_cache, prefix);
+    if (x->x_extra != NULL && x->x_extra->xe_ns_cache != NULL)
+        return xml_nsctx_get(x->x_extra->xe_ns_cache, prefix);
     return NULL;
 }
 
@@ -446,8 +1298,8 @@ nscache_get_prefix(cxobj *x,
 {
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL)
-        return xml_nsctx_get_prefix(x->x_ns_cache, namespace, prefix);
+    if (x->x_extra != NULL && x->x_extra->xe_ns_cache != NULL)
+        return xml_nsctx_get_prefix(x->x_extra->xe_ns_cache, namespace, prefix);
     return 0;
 }
 
@@ -461,9 +1313,9 @@ nscache_get_prefix(cxobj *x,
 cvec *
 nscache_get_all(cxobj *x)
 {
-    if (!is_element(x))
+    if (!is_element(x) || x->x_extra == NULL)
         return NULL;
-    return x->x_ns_cache;
+    return x->x_extra->xe_ns_cache;
 }
 
 /*! Set cached namespace for specific namespace. Replace if necessary
@@ -480,16 +1332,19 @@ nscache_set(cxobj *x,
             char  *prefix,
             char  *namespace)
 {
-    int     retval = -1;
+    int               retval = -1;
+    struct xml_extra *xe;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache == NULL){
-        if ((x->x_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
+    if ((xe = xml_extra_get(x)) == NULL)
+        goto done;
+    if (xe->xe_ns_cache == NULL){
+        if ((xe->xe_ns_cache = xml_nsctx_init(prefix, namespace)) == NULL)
             goto done;
     }
     else
-        return xml_nsctx_add(x->x_ns_cache, prefix, namespace);
+        return xml_nsctx_add(xe->xe_ns_cache, prefix, namespace);
     retval = 0;
  done:
     return retval;
@@ -507,17 +1362,25 @@ int
 nscache_replace(cxobj *x,
                 cvec  *nsc)
 {
-    int     retval = -1;
+    int               retval = -1;
+    struct xml_extra *xe;
 
     if (!is_element(x))
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (nsc == NULL){
+        nscache_clear(x);
+        goto ok;
     }
-    x->x_ns_cache = nsc;
+    if ((xe = xml_extra_get(x)) == NULL)
+        goto done;
+    if (xe->xe_ns_cache != NULL){
+        xml_nsctx_free(xe->xe_ns_cache);
+        xe->xe_ns_cache = NULL;
+    }
+    xe->xe_ns_cache = nsc;
+ ok:
     retval = 0;
-    // done:
+ done:
     return retval;
 }
 
@@ -532,13 +1395,15 @@ nscache_replace(cxobj *x,
 int
 nscache_clear(cxobj *x)
 {
+    struct xml_extra *xe;
 
-    if (!is_element(x))
+    if (!is_element(x) || (xe = x->x_extra) == NULL)
         return 0;
-    if (x->x_ns_cache != NULL){
-        xml_nsctx_free(x->x_ns_cache);
-        x->x_ns_cache = NULL;
+    if (xe->xe_ns_cache != NULL){
+        xml_nsctx_free(xe->xe_ns_cache);
+        xe->xe_ns_cache = NULL;
     }
+    xml_extra_gc(x);
     return 0;
 }
 
@@ -556,17 +1421,43 @@ xml_parent(cxobj *xn)
     return xn->x_up;
 }
 
+/*! Check that an xml node can be added to a parent with respect to arenas
+ *
+ * @param[in]  xn      xml node
+ * @param[in]  parent  New parent xml node, or NULL
+ * @retval     0       OK
+ * @retval    -1       Error: arena node added to non-arena parent or other arena
+ */
+static int
+xml_parent_check(cxobj *xn,
+                 cxobj *parent)
+{
+    if (parent != NULL && is_arena(xn) &&
+        (!is_arena(parent) || xml_arena_get(parent) != xml_arena_get(xn))){
+        clixon_err(OE_XML, EINVAL, "Arena node %s added to non-arena parent %s",
+                   xml_name(xn), xml_name(parent));
+        return -1;
+    }
+    return 0;
+}
+
 /*! Set parent of xml node.
  *
  * @param[in]  xn      xml node
  * @param[in]  parent  pointer to new parent xml node
  * @retval     0       OK
+ * @retval    -1       Error: arena node added to non-arena parent or other arena, parent not set
  * @see xml_child_rm  remove child from parent
  */
 int
 xml_parent_set(cxobj *xn,
                cxobj *parent)
 {
+    if (xml_parent_check(xn, parent) < 0)
+        return -1;
+    /* Non-arena nodes in an arena tree must be freed separately */
+    if (parent != NULL && !is_arena(xn) && is_arena(parent))
+        xml_arena_get(parent)->xa_mixed = 1;
     xn->x_up = parent;
     return 0;
 }
@@ -647,9 +1538,11 @@ xml_flag_reset(cxobj   *xn,
 char*
 xml_value(cxobj *xn)
 {
-    if (!is_bodyattr(xn))
+    struct xmlbody *xb = xml2body(xn);
+
+    if (!is_bodyattr(xn) || xb->xb_value_max == 0)
         return NULL;
-    return xn->x_value_cb?cbuf_get(xn->x_value_cb):NULL;
+    return xmlbody_value(xb);
 }
 
 /*! Set value of xml node, value is copied
@@ -663,8 +1556,9 @@ int
 xml_value_set(cxobj *xn,
               char  *val)
 {
-    int    retval = -1;
-    size_t sz;
+    int             retval = -1;
+    struct xmlbody *xb = xml2body(xn);
+    size_t          sz;
 
     if (!is_bodyattr(xn))
         return 0;
@@ -673,15 +1567,10 @@ xml_value_set(cxobj *xn,
         goto done;
     }
     sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clixon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    else
-        cbuf_reset(xn->x_value_cb);
-    cbuf_append_str(xn->x_value_cb, val);
+    if (xmlbody_value_alloc(xb, sz) < 0)
+        goto done;
+    memmove(xmlbody_value(xb), val, sz);
+    xb->xb_value_len = sz - 1;
     retval = 0;
  done:
     return retval;
@@ -698,8 +1587,9 @@ int
 xml_value_append(cxobj *xn,
                  char  *val)
 {
-    int    retval = -1;
-    size_t sz;
+    int             retval = -1;
+    struct xmlbody *xb = xml2body(xn);
+    size_t          sz;
 
     if (!is_bodyattr(xn))
         return 0;
@@ -708,16 +1598,10 @@ xml_value_append(cxobj *xn,
         goto done;
     }
     sz = strlen(val)+1;
-    if (xn->x_value_cb == NULL){
-        if ((xn->x_value_cb = cbuf_new_alloc(sz)) == NULL){
-            clixon_err(OE_XML, errno, "cbuf_new");
-            goto done;
-        }
-    }
-    if (cbuf_append_str(xn->x_value_cb, val) < 0){
-        clixon_err(OE_XML, errno, "cprintf");
+    if (xmlbody_value_alloc(xb, xb->xb_value_len + sz) < 0)
         goto done;
-    }
+    memcpy(xmlbody_value(xb) + xb->xb_value_len, val, sz);
+    xb->xb_value_len += sz - 1;
     retval = 0;
  done:
     return retval;
@@ -836,7 +1720,7 @@ xml_child_i(cxobj *xn,
     if (!is_element(xn))
         return NULL;
     if (i < xn->x_childvec_len)
-        return xn->x_childvec[i];
+        return xml_childvec_i(xn, i);
     return NULL;
 }
 
@@ -879,8 +1763,14 @@ xml_child_i_set(cxobj *xt,
 {
     if (!is_element(xt))
         return NULL;
-    if (i < xt->x_childvec_len)
+    if (i < xt->x_childvec_len){
+#ifdef XML_CHILD_CHUNKS
+        if (is_chunked(xt))
+            *xml_chunks_slot(xt->x_extra->xe_chunks, i) = xc;
+        else
+#endif
         xt->x_childvec[i] = xc;
+    }
     return 0;
 }
 
@@ -956,7 +1846,7 @@ xml_child_each(cxobj           *xparent,
     if (!is_element(xparent))
         return NULL;
     for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
-        xn = xparent->x_childvec[i];
+        xn = xml_childvec_i(xparent, i);
         if (xn == NULL)
             continue;
         if (type != CX_ERROR && xml_type(xn) != type)
@@ -993,7 +1883,7 @@ xml_child_each_attr(cxobj  *xparent,
     if (!is_element(xparent))
         return NULL;
     for (i=xprev?xprev->_x_vector_i+1:0; i<xparent->x_childvec_len; i++){
-        xn = xparent->x_childvec[i];
+        xn = xml_childvec_i(xparent, i);
         if (xn == NULL)
             continue;
         if (xml_type(xn) != CX_ATTR){
@@ -1028,14 +1918,25 @@ xml_child_append(cxobj *xp,
      */
     if (xml_type(xc) == CX_ELMNT)
         start = XML_CHILDVEC_SIZE_START_ELMNT;
+#ifdef XML_CHILD_CHUNKS
+    if (is_chunked(xp)){
+        if (xml_chunks_insert(xp->x_extra->xe_chunks, xc, xp->x_childvec_len) < 0)
+            return -1;
+        xp->x_childvec_len++;
+        return 0;
+    }
+#endif
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
             xp->x_childvec_max = xp->x_childvec_max?2*xp->x_childvec_max:start;
         else
             xp->x_childvec_max += XML_CHILDVEC_SIZE_THRESHOLD;
-        xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*));
-        if (xp->x_childvec == NULL){
+        if (is_arena(xp)){
+            if (xml_arena_childvec_grow(xp, xp->x_childvec_max) < 0)
+                return -1;
+        }
+        else if ((xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*))) == NULL){
             clixon_err(OE_XML, errno, "realloc");
             return -1;
         }
@@ -1063,14 +1964,27 @@ xml_child_insert_pos(cxobj *xp,
 
     if (!is_element(xp))
         return 0;
+#ifdef XML_CHILD_CHUNKS
+    if (xml_chunks_want(xp, xc, pos) && xml_chunks_new(xp) < 0)
+        return -1;
+    if (is_chunked(xp)){
+        if (xml_chunks_insert(xp->x_extra->xe_chunks, xc, pos) < 0)
+            return -1;
+        xp->x_childvec_len++;
+        return 0;
+    }
+#endif
     xp->x_childvec_len++;
     if (xp->x_childvec_len > xp->x_childvec_max){
         if (xp->x_childvec_len < XML_CHILDVEC_SIZE_THRESHOLD)
             xp->x_childvec_max = xp->x_childvec_max?2*xp->x_childvec_max:XML_CHILDVEC_SIZE_START;
         else
             xp->x_childvec_max += XML_CHILDVEC_SIZE_THRESHOLD;
-        xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*));
-        if (xp->x_childvec == NULL){
+        if (is_arena(xp)){
+            if (xml_arena_childvec_grow(xp, xp->x_childvec_max) < 0)
+                return -1;
+        }
+        else if ((xp->x_childvec = realloc(xp->x_childvec, xp->x_childvec_max*sizeof(cxobj*))) == NULL){
             clixon_err(OE_XML, errno, "realloc");
             return -1;
         }
@@ -1095,6 +2009,22 @@ xml_childvec_set(cxobj *x,
 {
     if (!is_element(x))
         return 0;
+#ifdef XML_CHILD_CHUNKS
+    if (is_chunked(x)){
+        xml_chunks_free(x->x_extra->xe_chunks);
+        x->x_extra->xe_chunks = NULL;
+        xml_extra_gc(x);
+    }
+#endif
+    if (is_arena(x)){
+        x->x_childvec_len = 0;
+        if (xml_arena_childvec_grow(x, len) < 0)
+            return -1;
+        memset(x->x_childvec, 0, len*sizeof(cxobj*));
+        x->x_childvec_len = len;
+        x->x_childvec_max = len;
+        return 0;
+    }
     x->x_childvec_len = len;
     x->x_childvec_max = len;
     if (x->x_childvec)
@@ -1107,15 +2037,94 @@ xml_childvec_set(cxobj *x,
 }
 
 /*! Get the children of an XML node as an XML vector
+ *
+ * Compatibility function, slow for large lists: chunked children are converted back to a
+ * flat vector, and re-chunked on the next insert or remove. Do not use in code that
+ * traverses or modifies large trees.
+ * @see xml_child_each      to iterate over children
+ * @see xml_child_i         to get a child by position
+ * @see xml_childvec_apply  to reorder children, eg sort, keeping chunks
  */
 cxobj **
 xml_childvec_get(cxobj *x)
 {
     if (!is_element(x))
         return NULL;
+#ifdef XML_CHILD_CHUNKS
+    if (is_chunked(x) && xml_chunks_flatten(x) < 0)
+        return NULL;
+#endif
     return x->x_childvec;
 }
 
+/*! Apply a function to the children of an XML node as a flat vector, eg to sort them
+ *
+ * Chunked children of large lists are copied to a temporary vector and written back,
+ * ie the chunks are kept and the next insert or remove does not need to re-chunk.
+ * @param[in]  x    XML node
+ * @param[in]  fn   Function, may reorder but not add or remove children of the vector
+ * @param[in]  arg  Argument to fn
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @code
+ *   static int sortfn(cxobj **vec, int len, void *arg) {
+ *     qsort_r(vec, len, sizeof(cxobj *), cmp, arg);
+ *     return 0;
+ *   }
+ *   if (xml_childvec_apply(x, sortfn, NULL) < 0)
+ *     err;
+ * @endcode
+ */
+int
+xml_childvec_apply(cxobj             *x,
+                   xml_childvec_fn_t *fn,
+                   void              *arg)
+{
+    int                retval = -1;
+#ifdef XML_CHILD_CHUNKS
+    struct xml_chunks *xk;
+    struct xml_chunk  *ck;
+    cxobj            **vec = NULL;
+    int                k;
+    int                i;
+#endif
+
+    if (!is_element(x) || x->x_childvec_len == 0)
+        goto ok;
+#ifdef XML_CHILD_CHUNKS
+    if (is_chunked(x)){
+        xk = x->x_extra->xe_chunks;
+        if ((vec = malloc(x->x_childvec_len*sizeof(cxobj *))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        for (k=0, i=0; k<xk->xk_nr; k++){
+            ck = xk->xk_vec[k];
+            memcpy(&vec[i], ck->ck_vec, ck->ck_len*sizeof(cxobj *));
+            i += ck->ck_len;
+        }
+        if (fn(vec, x->x_childvec_len, arg) < 0)
+            goto done;
+        for (k=0, i=0; k<xk->xk_nr; k++){
+            ck = xk->xk_vec[k];
+            memcpy(ck->ck_vec, &vec[i], ck->ck_len*sizeof(cxobj *));
+            i += ck->ck_len;
+        }
+        goto ok;
+    }
+#endif
+    if (fn(x->x_childvec, x->x_childvec_len, arg) < 0)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+#ifdef XML_CHILD_CHUNKS
+    if (vec)
+        free(vec);
+#endif
+    return retval;
+}
+
 /*! Given an XML object and a vector of children xvec, append the children to the object
  *
  * @param[in]  x   XML node
@@ -1164,8 +2173,9 @@ xml_new(char           *name,
         cxobj          *xp,
         enum cxobj_type type)
 {
-    struct xml *x = NULL;
-    size_t      sz;
+    struct xml       *x = NULL;
+    size_t            sz;
+    struct xml_arena *xa;
 
     switch (type){
     case CX_ELMNT:
@@ -1180,16 +2190,34 @@ xml_new(char           *name,
         return NULL;
         break;
     }
-    if ((x = malloc(sz)) == NULL){
-        clixon_err(OE_XML, errno, "malloc");
-        return NULL;
+    /* Allocate in arena of parent, or in active arena if top node */
+    if (xp != NULL)
+        xa = is_arena(xp) ? xml_arena_get(xp) : NULL;
+    else
+        xa = _xml_arena;
+    if (xa != NULL){
+        if ((x = xml_arena_alloc(xa, sz)) == NULL)
+            return NULL;
+        memset(x, 0, sz);
+        x->x_flags = XML_FLAG_ARENA;
+        xa->xa_nr++;
+    }
+    else {
+        if ((x = malloc(sz)) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return NULL;
+        }
+        memset(x, 0, sz);
     }
-    memset(x, 0, sz);
     xml_type_set(x, type);
     if (name && (xml_name_set(x, name)) < 0)
         return NULL;
     if (xp){
-        xml_parent_set(x, xp);
+        /* x is allocated in the arena of xp, if any */
+        if (xml_parent_set(x, xp) < 0){
+            xml_free(x);
+            return NULL;
+        }
         if (xml_child_append(xp, x) < 0)
             return NULL;
         x->_x_i = xml_child_nr(xp)-1;
@@ -1268,16 +2296,17 @@ xml_spec_set(cxobj     *x,
 cg_var *
 xml_cv(cxobj *x)
 {
-    if (!is_element(x))
+    if (!is_element(x) || x->x_extra == NULL)
         return NULL;
-    return x->x_cv;
+    return x->x_extra->xe_cv;
 }
 
 /*! Set (cached) cligen variable value of xml node
  *
  * @param[in]  x   XML node (body and leaf/leaf-list)
- * @param[in]  cv  CLIgen variable containing value of x body
+ * @param[in]  cv  CLIgen variable containing value of x body (consumed)
  * @retval     0   OK
+ * @retval    -1   Error
  * Only applicable if x is body and has yang-spec and is leaf or leaf-list
  * Only accessed by xml_cv_cache as part of sorting in xml_cmp
  * @see xml_cv_cache
@@ -1286,11 +2315,25 @@ int
 xml_cv_set(cxobj  *x,
            cg_var *cv)
 {
+    struct xml_extra *xe;
+
     if (!is_element(x))
         return 0;
-    if (x->x_cv)
-        cv_free(x->x_cv);
-    x->x_cv = cv;
+    if (cv == NULL){
+        if ((xe = x->x_extra) != NULL && xe->xe_cv != NULL){
+            cv_free(xe->xe_cv);
+            xe->xe_cv = NULL;
+            xml_extra_gc(x);
+        }
+        return 0;
+    }
+    if ((xe = xml_extra_get(x)) == NULL){
+        cv_free(cv);
+        return -1;
+    }
+    if (xe->xe_cv)
+        cv_free(xe->xe_cv);
+    xe->xe_cv = cv;
     return 0;
 }
 
@@ -1323,7 +2366,7 @@ xml_find(cxobj *xp,
     if (!is_element(xp))
         return NULL;
     while ((x = xml_child_each(xp, x, -1)) != NULL)
-        if (strcmp(name, xml_name(x)) == 0)
+        if (name == xml_name(x) || strcmp(name, xml_name(x)) == 0)
             break; /* x is set */
     return x;
 }
@@ -1350,6 +2393,9 @@ xml_addsub(cxobj *xp,
     char  *cns = NULL; /* child namespace */
     cxobj *xa;
 
+    /* Check before xc is removed from old parent */
+    if (xp && xml_parent_check(xc, xp) < 0)
+        goto done;
     if ((oldp = xml_parent(xc)) != NULL){
         /* Find child order i in old parent*/
         for (i=0; i<xml_child_nr(oldp); i++)
@@ -1361,10 +2407,11 @@ xml_addsub(cxobj *xp,
     }
     /* Add xc to new parent */
     if (xp){
+        /* Set new parent in child */
+        if (xml_parent_set(xc, xp) < 0)
+            goto done;
         if (xml_child_append(xp, xc) < 0)
             goto done;
-        /* Set new parent in child */
-        xml_parent_set(xc, xp);
         /* Ensure default namespace is not duplicated
          * here only remove duplicate default namespace, there may be more */
         /* 1. Get parent default namespace */
@@ -1382,8 +2429,8 @@ xml_addsub(cxobj *xp,
         /* clear namespace context cache of child */
         nscache_clear(xc);
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_search_index_p(xc))
-            xml_search_child_insert(xp, xc);
+        if (xml_search_index_sync(xp, xc, 1) < 0)
+            goto done;
 #endif
     }
     retval = 0;
@@ -1504,18 +2551,22 @@ xml_child_rm(cxobj *xp,
         clixon_err(OE_XML, 0, "Child not found");
         goto done;
     }
-    xml_parent_set(xc, NULL);
-    xp->x_childvec[i] = NULL;
-    xp->x_childvec_len--;
-    if (i<xp->x_childvec_len)
-        memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i)*sizeof(cxobj*));
 #ifdef XML_EXPLICIT_INDEX
-    if (xml_type(xc) == CX_ELMNT){
-        if (xml_search_index_p(xc))
-            xml_search_child_rm(xp, xc);
-
-    }
+    if (xml_search_index_sync(xp, xc, 0) < 0)
+        goto done;
+#endif
+    if (xml_parent_set(xc, NULL) < 0)
+        goto done;
+#ifdef XML_CHILD_CHUNKS
+    if (xml_chunks_want(xp, xc, i) && xml_chunks_new(xp) < 0)
+        goto done;
+    if (is_chunked(xp))
+        xml_chunks_rm(xp->x_extra->xe_chunks, i);
+    else
 #endif
+    if (i < xp->x_childvec_len-1)
+        memmove(&xp->x_childvec[i], &xp->x_childvec[i+1], (xp->x_childvec_len-i-1)*sizeof(cxobj*));
+    xp->x_childvec_len--;
     retval = 0;
  done:
     return retval;
@@ -1949,12 +3000,30 @@ xml_free(cxobj *x)
     if (x == NULL){
         return 0;
     }
+    if (is_arena(x)){
+        /* Memory is freed by xml_arena_free, only free non-arena nodes added to arena tree */
+        if (xml_arena_get(x)->xa_mixed && xml_type(x) == CX_ELMNT)
+            for (i=0; i<x->x_childvec_len; i++)
+                if ((xc = x->x_childvec[i]) != NULL)
+                    xml_free(xc);
+        return 0;
+    }
     if (x->x_name)
-        free(x->x_name);
+        clixon_str_unintern(x->x_name);
     if (x->x_prefix)
-        free(x->x_prefix);
+        clixon_str_unintern(x->x_prefix);
     switch (xml_type(x)){
     case CX_ELMNT:
+#ifdef XML_CHILD_CHUNKS
+        if (is_chunked(x)){
+            for (i=0; i<x->x_childvec_len; i++)
+                if ((xc = xml_childvec_i(x, i)) != NULL)
+                    xml_free(xc);
+            xml_chunks_free(x->x_extra->xe_chunks);
+            x->x_extra->xe_chunks = NULL;
+            x->x_childvec_len = 0;
+        }
+#endif
         for (i=0; i<x->x_childvec_len; i++){
             if ((xc = x->x_childvec[i]) != NULL){
                 xml_free(xc);
@@ -1963,18 +3032,15 @@ xml_free(cxobj *x)
         }
         if (x->x_childvec)
             free(x->x_childvec);
-        if (x->x_cv)
-            cv_free(x->x_cv);
-        if (x->x_ns_cache)
-            xml_nsctx_free(x->x_ns_cache);
-#ifdef XML_EXPLICIT_INDEX
-        xml_search_index_free(x);
-#endif
+        if (x->x_extra){
+            xml_extra_free_fields(x->x_extra);
+            free(x->x_extra);
+        }
         break;
     case CX_BODY:
     case CX_ATTR:
-        if (x->x_value_cb)
-            cbuf_free(x->x_value_cb);
+        if (xml2body(x)->xb_value_max > XML_VALUE_INLINE)
+            free(xml2body(x)->xb_value.xv_heap);
         break;
     default:
         break;
@@ -2024,7 +3090,7 @@ xml_copy_one(cxobj *x0,
     default:
         break;
     }
-    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP | XML_FLAG_ANYDATA | XML_FLAG_CACHE_DIRTY)); /* Maybe more flags */
+    xml_flag_set(x1, xml_flag(x0, XML_FLAG_DEFAULT | XML_FLAG_TOP | XML_FLAG_ANYDATA | XML_FLAG_CACHE_DIRTY | XML_FLAG_COMMIT_DIRTY)); /* Maybe more flags */
     retval = 0;
  done:
     return retval;
@@ -2519,28 +3585,6 @@ xml_search_index_p(cxobj *x)
     return 1;
 }
 
-/*! Free all search vector pairs of this XML node
- *
- * @param[in]  x    XML object
- * @retval     0    OK
- * @retval    -1    Error
- */
-static int
-xml_search_index_free(cxobj *x)
-{
-    struct search_index *si;
-
-    while ((si = x->x_search_index) != NULL) {
-        DELQ(si, x->x_search_index, struct search_index *);
-        if (si->si_name)
-            free(si->si_name);
-        if (si->si_xvec)
-            clixon_xvec_free(si->si_xvec);
-        free(si);
-    }
-    return 0;
-}
-
 /*! Add single search vector pair to this XML node
  *
  * @param[in]  x     XML object
@@ -2553,7 +3597,10 @@ xml_search_index_add(cxobj *x,
                      char  *name)
 {
     struct search_index *si = NULL;
+    struct xml_extra    *xe;
 
+    if ((xe = xml_extra_get(x)) == NULL)
+        goto done;
     if ((si = malloc(sizeof(struct search_index))) == NULL){
         clixon_err(OE_XML, errno, "malloc");
         goto done;
@@ -2571,7 +3618,7 @@ xml_search_index_add(cxobj *x,
         si = NULL;
         goto done;
     }
-    ADDQ(si, x->x_search_index);
+    ADDQ(si, xe->xe_search_index);
  done:
     return si;
 }
@@ -2589,14 +3636,14 @@ xml_search_index_get(cxobj *x,
 {
     struct search_index *si = NULL;
 
-    if ((si = x->x_search_index) != NULL) {
+    if (x->x_extra != NULL && (si = x->x_extra->xe_search_index) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 goto done;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != x->x_search_index);
+        } while (si && si != x->x_extra->xe_search_index);
     }
  done:
     return si;
@@ -2619,20 +3666,92 @@ xml_search_vector_get(cxobj        *xp,
     struct search_index *si;
 
     *xvec = NULL;
-    if ((si = xp->x_search_index) != NULL) {
+    if (xp->x_extra != NULL && (si = xp->x_extra->xe_search_index) != NULL) {
         do {
             if (strcmp(si->si_name, name) == 0){
                 *xvec = si->si_xvec;
                 break;
             }
             si = NEXTQ(struct search_index *, si);
-        } while (si && si != xp->x_search_index);
+        } while (si && si != xp->x_extra->xe_search_index);
+    }
+    return 0;
+}
+
+/*! Create an empty search index vector for variable "name"
+ *
+ * Search vectors are built when first searched, and are then maintained by inserts and
+ * removes, so that a vector always contains all list entries with the index variable.
+ * @param[in]  xp    XML parent object (parent of list entries)
+ * @param[in]  name  Name of index variable
+ * @param[out] xvec  New empty search vector
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xml_search_vector_get
+ */
+int
+xml_search_vector_new(cxobj        *xp,
+                      char         *name,
+                      clixon_xvec **xvec)
+{
+    struct search_index *si;
+
+    if ((si = xml_search_index_get(xp, name)) == NULL &&
+        (si = xml_search_index_add(xp, name)) == NULL)
+        return -1;
+    *xvec = si->si_xvec;
+    return 0;
+}
+
+/*! Find position of list entry in search index vector
+ *
+ * Several entries may have equal index values, look for the entry itself among them
+ * @param[in]  si    Search index
+ * @param[in]  xp    XML list entry
+ * @param[out] pos   Position of xp if found, otherwise where to insert xp
+ * @retval     1     Found
+ * @retval     0     Not found
+ * @retval    -1     Error
+ */
+static int
+xml_search_index_pos(struct search_index *si,
+                     cxobj               *xp,
+                     int                 *pos)
+{
+    int    len;
+    int    i;
+    int    j;
+    int    eq = 0;
+    cxobj *xj;
+
+    len = clixon_xvec_len(si->si_xvec);
+    if ((i = xml_search_indexvar_binary_pos(xp, si->si_name, si->si_xvec, 0, len, len, &eq)) < 0)
+        return -1;
+    *pos = i;
+    if (!eq)
+        return 0;
+    for (j=i; j>=0; j--){
+        if ((xj = clixon_xvec_i(si->si_xvec, j)) == xp){
+            *pos = j;
+            return 1;
+        }
+        if (xml_cmp(xp, xj, 0, 0, si->si_name) != 0)
+            break;
+    }
+    for (j=i+1; j<len; j++){
+        if ((xj = clixon_xvec_i(si->si_xvec, j)) == xp){
+            *pos = j;
+            return 1;
+        }
+        if (xml_cmp(xp, xj, 0, 0, si->si_name) != 0)
+            break;
     }
     return 0;
 }
 
 /*! Insert a new cxobj into search index vector for list for variable "name"
  *
+ * Only if the search vector exists, otherwise it is built when first searched
  * @param[in] xp  XML parent object (the list element)
  * @param[in] xi  XML index object (that should be added)
  * @retval    0   OK
@@ -2643,27 +3762,20 @@ xml_search_child_insert(cxobj *xp,
                         cxobj *xi)
 {
     int                  retval = -1;
-    char                *indexvar;
     struct search_index *si;
     cxobj               *xpp;
     int                  i;
-    int                  len;
+    int                  ret;
 
-    indexvar = xml_name(xi);
     if ((xpp = xml_parent(xp)) == NULL)
         goto ok;
     /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL){
-        /* If not found add base vector in grand-parent */
-        if ((si = xml_search_index_add(xpp, indexvar)) == NULL)
-            goto done;
-    }
-    /* Find element position using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, NULL)) < 0)
+    if ((si = xml_search_index_get(xpp, xml_name(xi))) == NULL)
+        goto ok;
+    /* Find element position using binary search and then insert, unless already there */
+    if ((ret = xml_search_index_pos(si, xp, &i)) < 0)
         goto done;
-    assert(clixon_xvec_i(si->si_xvec, i) != xp);
-    if (clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
+    if (ret == 0 && clixon_xvec_insert_pos(si->si_xvec, xp, i) < 0)
         goto done;
  ok:
     retval = 0;
@@ -2671,7 +3783,7 @@ xml_search_child_insert(cxobj *xp,
     return retval;
 }
 
-/*! Remove a single cxobj from search vector 
+/*! Remove a single cxobj from search vector
  *
  * @param[in] xp    XML parent object (the list element)
  * @param[in] xi    XML index object (that should be added)
@@ -2682,35 +3794,61 @@ int
 xml_search_child_rm(cxobj *xp,
                     cxobj *xi)
 {
-    int                 retval = -1;
-    cxobj              *xpp;
-    char               *indexvar;
-    int                 i;
-    int                 len;
+    int                  retval = -1;
+    cxobj               *xpp;
+    int                  i;
+    int                  ret;
     struct search_index *si;
-    int                  eq = 0;
 
-    indexvar = xml_name(xi);
     if ((xpp = xml_parent(xp)) == NULL)
         goto ok;
     /* Find base vector in grandparent */
-    if ((si = xml_search_index_get(xpp, indexvar)) == NULL)
+    if ((si = xml_search_index_get(xpp, xml_name(xi))) == NULL)
         goto ok;
-
     /* Find element using binary search and then remove */
-    len = clixon_xvec_len(si->si_xvec);
-    if ((i = xml_search_indexvar_binary_pos(xp, indexvar, si->si_xvec, 0, len, len, &eq)) < 0)
+    if ((ret = xml_search_index_pos(si, xp, &i)) < 0)
+        goto done;
+    if (ret == 1 && clixon_xvec_rm_pos(si->si_xvec, i) < 0)
         goto done;
-        //    if (clixon_xvec_i(si->si_xvec, i) == xp)
-    if (eq)
-        if (clixon_xvec_rm_pos(si->si_xvec, i) < 0)
-            goto done;
  ok:
     retval = 0;
  done:
     return retval;
 }
 
+/*! Add or remove child and its index variables from search index vectors
+ *
+ * Either xc is an index variable of list entry xp, or xc is a list entry of xp whose
+ * index variables are added or removed.
+ * @param[in]  xp   Parent XML node
+ * @param[in]  xc   Child XML node, with parent xp
+ * @param[in]  add  1: insert into search vector, 0: remove from search vector
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+int
+xml_search_index_sync(cxobj *xp,
+                      cxobj *xc,
+                      int    add)
+{
+    cxobj *xi;
+
+    if (xml_type(xc) != CX_ELMNT)
+        return 0;
+    if (xml_search_index_p(xc))
+        return add ? xml_search_child_insert(xp, xc) : xml_search_child_rm(xp, xc);
+    /* No search vectors in parent */
+    if (xp->x_extra == NULL || xp->x_extra->xe_search_index == NULL)
+        return 0;
+    xi = NULL;
+    while ((xi = xml_child_each(xc, xi, CX_ELMNT)) != NULL)
+        if (xml_search_index_p(xi)){
+            if ((add ? xml_search_child_insert(xc, xi) : xml_search_child_rm(xc, xi)) < 0)
+                return -1;
+        }
+    return 0;
+}
+
 /*! Iterator over xml children objects using (explicit) index variable
  *
  * @param[in] xparent xml tree node whose children should be iterated
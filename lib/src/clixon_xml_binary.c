@@ -0,0 +1,694 @@
+/*
+ *
+  ***** BEGIN LICENSE BLOCK *****
+
+  Copyright (C) 2024 Olof Hagsand
+
+  This file is part of CLIXON.
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  Alternatively, the contents of this file may be used under the terms of
+  the GNU General Public License Version 3 or later (the "GPL"),
+  in which case the provisions of the GPL are applicable instead
+  of those above. If you wish to allow use of your version of this file only
+  under the terms of the GPL, and not to allow others to
+  use your version of this file under the terms of Apache License version 2,
+  indicate your decision by deleting the provisions above and replace them with
+  the  notice and other provisions required by the GPL. If you do not delete
+  the provisions above, a recipient may use your version of this file under
+  the terms of any one of the Apache License version 2 or the GPL.
+
+  ***** END LICENSE BLOCK *****
+
+ * Binary datastore format: pre-bound and pre-sorted XML tree snapshot
+ *
+ * The file is written from a (sorted and yang-bound) datastore cache and is read by
+ * mapping it into memory and materializing the XML tree directly, ie without the XML
+ * lexer, xml_bind_yang() or xml_sort_recurse().
+ * Layout, all integers in host byte order:
+ *   +----------------+
+ *   | header         |  struct xb_header
+ *   +----------------+
+ *   | nodes          |  struct xb_node[xh_nodes] in pre-order
+ *   +----------------+
+ *   | yang specs     |  struct xb_yang[xh_yangs]
+ *   +----------------+
+ *   | string table   |  xh_strlen bytes of NULL-terminated strings
+ *   +----------------+
+ * Children of node i are i+1, xn_end(i+1), ... up to xn_end(i)
+ * Yang specs are stored as (parent, namespace, name) and resolved once per distinct yang node when
+ * loading. The header contains a fingerprint of the yang modules, revisions and features.
+ * If the fingerprint differs or a yang spec cannot be resolved, eg the YANG has changed, the
+ * tree is returned unbound and the caller falls back to regular binding and sorting.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "clixon_config.h" /* generated by config & autoconf */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/* cligen */
+#include <cligen/cligen.h>
+
+/* clixon */
+#include "clixon_queue.h"
+#include "clixon_string.h"
+#include "clixon_hash.h"
+#include "clixon_handle.h"
+#include "clixon_yang.h"
+#include "clixon_xml.h"
+#include "clixon_err.h"
+#include "clixon_log.h"
+#include "clixon_debug.h"
+#include "clixon_netconf_lib.h"
+#include "clixon_yang_module.h"
+#include "clixon_xml_io.h"
+#include "clixon_xml_binary.h"
+
+/*
+ * Constants
+ */
+#define XML_BINARY_MAGIC     "CLXB"
+#define XML_BINARY_VERSION   2
+#define XML_BINARY_BYTEORDER 0x01020304
+
+/* Index or string offset not set */
+#define XB_NONE              0xffffffff
+
+/* Header flags */
+#define XB_FLAG_BOUND        0x01 /* All elements were yang-bound when written */
+
+/*
+ * Types
+ */
+/* File header */
+struct xb_header {
+    char     xh_magic[4];  /* XML_BINARY_MAGIC */
+    uint32_t xh_version;   /* XML_BINARY_VERSION */
+    uint32_t xh_byteorder; /* XML_BINARY_BYTEORDER in writer byte order */
+    uint32_t xh_flags;     /* See XB_FLAG_* */
+    uint32_t xh_nodes;     /* Number of node records */
+    uint32_t xh_yangs;     /* Number of yang records */
+    uint32_t xh_strlen;    /* Length of string table */
+    uint32_t xh_pad;
+    uint64_t xh_yangfp;    /* Yang fingerprint, see binary_yang_fingerprint */
+};
+
+/* XML node record */
+struct xb_node {
+    uint8_t  xn_type;      /* enum cxobj_type */
+    uint8_t  xn_pad[3];
+    uint32_t xn_name;      /* Name, string offset */
+    uint32_t xn_prefix;    /* Prefix, string offset or XB_NONE */
+    uint32_t xn_value;     /* Body or attribute value, string offset or XB_NONE */
+    uint32_t xn_yang;      /* Yang record index or XB_NONE */
+    uint32_t xn_end;       /* Node index after this subtree */
+};
+
+/* Yang spec record */
+struct xb_yang {
+    uint32_t xy_parent;    /* Yang record of XML parent, or XB_NONE if top-level */
+    uint32_t xy_ns;        /* Module namespace, string offset */
+    uint32_t xy_name;      /* Yang argument, string offset */
+    uint32_t xy_keyword;   /* enum rfc_6020 */
+};
+
+/* Write state */
+struct xb_writer {
+    cbuf              *xw_nodes;   /* Node records */
+    cbuf              *xw_yangs;   /* Yang records */
+    cbuf              *xw_strs;    /* String table */
+    clicon_hash_t     *xw_strhash; /* Name -> string offset */
+    clicon_hash_t     *xw_yanghash;/* Yang pointer -> yang record index */
+    uint32_t           xw_nnodes;
+    uint32_t           xw_nyangs;
+    int                xw_bound;   /* All elements are yang-bound */
+    withdefaults_type  xw_wdef;
+};
+
+/* Read state of a mapped file */
+struct xb_reader {
+    struct xb_node    *xr_nodes;
+    uint32_t           xr_nnodes;
+    char              *xr_strs;
+    uint32_t           xr_strlen;
+    uint32_t           xr_nyangs;
+    yang_stmt        **xr_yvec;    /* Resolved yang specs, or NULL if not bound */
+};
+
+/*! Add string to FNV-1a hash
+ *
+ * @param[in]  h    Hash value
+ * @param[in]  str  String, or NULL
+ * @retval     h    New hash value
+ */
+static uint64_t
+binary_fnv_str(uint64_t    h,
+               const char *str)
+{
+    if (str != NULL)
+        while (*str)
+            h = (h ^ (uint8_t)*str++) * 0x100000001b3ULL;
+    return (h ^ 0xff) * 0x100000001b3ULL; /* Separator */
+}
+
+/*! Compute fingerprint of a yang spec
+ *
+ * The fingerprint covers the names and revisions of all modules and submodules, and the
+ * enabled features. Sorting and binding of a stored tree is valid if it is unchanged.
+ * @param[in]  yspec  Top-level yang spec
+ * @retval     fp     Fingerprint
+ */
+static uint64_t
+binary_yang_fingerprint(yang_stmt *yspec)
+{
+    uint64_t   h = 0xcbf29ce484222325ULL;
+    yang_stmt *ym;
+    yang_stmt *ys;
+    yang_stmt *yrev;
+    cg_var    *cv;
+    int        inext;
+    int        inext1;
+
+    inext = 0;
+    while ((ym = yn_iter(yspec, &inext)) != NULL) {
+        if (yang_keyword_get(ym) != Y_MODULE && yang_keyword_get(ym) != Y_SUBMODULE)
+            continue;
+        h = binary_fnv_str(h, yang_argument_get(ym));
+        yrev = yang_find(ym, Y_REVISION, NULL);
+        h = binary_fnv_str(h, yrev ? yang_argument_get(yrev) : NULL);
+        inext1 = 0;
+        while ((ys = yn_iter(ym, &inext1)) != NULL) {
+            if (yang_keyword_get(ys) != Y_FEATURE)
+                continue;
+            cv = yang_cv_get(ys);
+            h = binary_fnv_str(h, yang_argument_get(ys));
+            h = binary_fnv_str(h, (cv && cv_bool_get(cv)) ? "1" : "0");
+        }
+    }
+    return h;
+}
+
+/*! Add string to string table
+ *
+ * @param[in]  xw     Write state
+ * @param[in]  str    String, or NULL
+ * @param[in]  dedup  Share equal strings, use for names and prefixes
+ * @param[out] offp   String offset or XB_NONE if str is NULL
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+binary_str_add(struct xb_writer *xw,
+               const char       *str,
+               int               dedup,
+               uint32_t         *offp)
+{
+    int      retval = -1;
+    void    *v;
+    size_t   len;
+    size_t   off;
+    uint32_t off32;
+
+    if (str == NULL){
+        *offp = XB_NONE;
+        goto ok;
+    }
+    if (dedup && (v = clicon_hash_value(xw->xw_strhash, str, NULL)) != NULL){
+        memcpy(offp, v, sizeof(*offp));
+        goto ok;
+    }
+    off = cbuf_len(xw->xw_strs);
+    len = strlen(str) + 1;
+    if (off + len >= XB_NONE){
+        clixon_err(OE_XML, EFBIG, "Binary string table too large");
+        goto done;
+    }
+    if (cbuf_append_buf(xw->xw_strs, (void*)str, len) < 0){
+        clixon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    off32 = off;
+    if (dedup && clicon_hash_add(xw->xw_strhash, str, &off32, sizeof(off32)) == NULL)
+        goto done;
+    *offp = off32;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Get yang record of an element, add it if not present
+ *
+ * @param[in]  xw     Write state
+ * @param[in]  x      XML element
+ * @param[out] idxp   Yang record index or XB_NONE if not bound
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+binary_yang_add(struct xb_writer *xw,
+                cxobj            *x,
+                uint32_t         *idxp)
+{
+    int            retval = -1;
+    yang_stmt     *y;
+    cxobj         *xp;
+    char           key[32];
+    void          *v;
+    struct xb_yang xy;
+
+    if ((y = xml_spec(x)) == NULL){
+        xw->xw_bound = 0;
+        *idxp = XB_NONE;
+        goto ok;
+    }
+    snprintf(key, sizeof(key), "%p", y);
+    if ((v = clicon_hash_value(xw->xw_yanghash, key, NULL)) != NULL){
+        memcpy(idxp, v, sizeof(*idxp));
+        goto ok;
+    }
+    memset(&xy, 0, sizeof(xy));
+    xy.xy_parent = XB_NONE;
+    /* Parent is written before its children, ie already added */
+    if ((xp = xml_parent(x)) != NULL && xml_spec(xp) != NULL &&
+        binary_yang_add(xw, xp, &xy.xy_parent) < 0)
+        goto done;
+    if (binary_str_add(xw, yang_find_mynamespace(y), 1, &xy.xy_ns) < 0)
+        goto done;
+    if (binary_str_add(xw, yang_argument_get(y), 1, &xy.xy_name) < 0)
+        goto done;
+    xy.xy_keyword = yang_keyword_get(y);
+    if (cbuf_append_buf(xw->xw_yangs, &xy, sizeof(xy)) < 0){
+        clixon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    *idxp = xw->xw_nyangs++;
+    if (clicon_hash_add(xw->xw_yanghash, key, idxp, sizeof(*idxp)) == NULL)
+        goto done;
+ ok:
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Write XML node and its children as node records
+ *
+ * @param[in]  xw     Write state
+ * @param[in]  x      XML node
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xml2binary_recurse(struct xb_writer *xw,
+                   cxobj            *x)
+{
+    int            retval = -1;
+    struct xb_node xn;
+    size_t         pos;
+    cxobj         *xc;
+    int            ret;
+
+    memset(&xn, 0, sizeof(xn));
+    xn.xn_type = xml_type(x);
+    xn.xn_yang = XB_NONE;
+    if (binary_str_add(xw, xml_name(x), 1, &xn.xn_name) < 0)
+        goto done;
+    if (binary_str_add(xw, xml_prefix(x), 1, &xn.xn_prefix) < 0)
+        goto done;
+    switch (xml_type(x)){
+    case CX_ELMNT:
+        xn.xn_value = XB_NONE;
+        /* Top node, eg <config>, is never bound, only its descendants */
+        if (xw->xw_nnodes > 0 &&
+            binary_yang_add(xw, x, &xn.xn_yang) < 0)
+            goto done;
+        break;
+    case CX_ATTR:
+        if (binary_str_add(xw, xml_value(x), 1, &xn.xn_value) < 0)
+            goto done;
+        break;
+    case CX_BODY:
+        if (binary_str_add(xw, xml_value(x), 0, &xn.xn_value) < 0)
+            goto done;
+        break;
+    default:
+        break;
+    }
+    if (xw->xw_nnodes == XB_NONE - 1){
+        clixon_err(OE_XML, EFBIG, "Binary tree too large");
+        goto done;
+    }
+    xw->xw_nnodes++;
+    pos = cbuf_len(xw->xw_nodes);
+    if (cbuf_append_buf(xw->xw_nodes, &xn, sizeof(xn)) < 0){
+        clixon_err(OE_XML, errno, "cbuf_append_buf");
+        goto done;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(x, xc, -1)) != NULL) {
+        if (xml_type(xc) == CX_ELMNT){
+            if ((ret = xml2output_wdef(xc, xw->xw_wdef, NULL)) < 0)
+                goto done;
+            if (ret == 0)
+                continue;
+        }
+        if (xml2binary_recurse(xw, xc) < 0)
+            goto done;
+    }
+    /* Patch subtree end when all children are written */
+    xn.xn_end = xw->xw_nnodes;
+    memcpy(cbuf_get(xw->xw_nodes) + pos, &xn, sizeof(xn));
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Write an XML tree to file in binary datastore format
+ *
+ * The tree is assumed to be sorted. Yang bindings are stored if all elements below the top
+ * node are bound.
+ * @param[in]  f     Output file
+ * @param[in]  xn    Top of XML tree, eg datastore cache
+ * @param[in]  yspec Yang spec the tree is bound to, or NULL
+ * @param[in]  wdef  With-defaults parameter
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see clixon_binary_parse_file
+ */
+int
+clixon_xml2binary_file(FILE             *f,
+                       cxobj            *xn,
+                       yang_stmt        *yspec,
+                       withdefaults_type wdef)
+{
+    int              retval = -1;
+    struct xb_writer xw = {0,};
+    struct xb_header xh = {{0,},};
+
+    if ((xw.xw_nodes = cbuf_new()) == NULL ||
+        (xw.xw_yangs = cbuf_new()) == NULL ||
+        (xw.xw_strs = cbuf_new()) == NULL){
+        clixon_err(OE_XML, errno, "cbuf_new");
+        goto done;
+    }
+    if ((xw.xw_strhash = clicon_hash_init()) == NULL ||
+        (xw.xw_yanghash = clicon_hash_init()) == NULL)
+        goto done;
+    xw.xw_bound = 1;
+    xw.xw_wdef = wdef;
+    if (xml2binary_recurse(&xw, xn) < 0)
+        goto done;
+    memcpy(xh.xh_magic, XML_BINARY_MAGIC, sizeof(xh.xh_magic));
+    xh.xh_version = XML_BINARY_VERSION;
+    xh.xh_byteorder = XML_BINARY_BYTEORDER;
+    xh.xh_flags = (xw.xw_bound && yspec) ? XB_FLAG_BOUND : 0;
+    if (yspec)
+        xh.xh_yangfp = binary_yang_fingerprint(yspec);
+    xh.xh_nodes = xw.xw_nnodes;
+    xh.xh_yangs = xw.xw_nyangs;
+    xh.xh_strlen = cbuf_len(xw.xw_strs);
+    if (fwrite(&xh, sizeof(xh), 1, f) != 1 ||
+        fwrite(cbuf_get(xw.xw_nodes), 1, cbuf_len(xw.xw_nodes), f) != cbuf_len(xw.xw_nodes) ||
+        fwrite(cbuf_get(xw.xw_yangs), 1, cbuf_len(xw.xw_yangs), f) != cbuf_len(xw.xw_yangs) ||
+        fwrite(cbuf_get(xw.xw_strs), 1, cbuf_len(xw.xw_strs), f) != cbuf_len(xw.xw_strs)){
+        clixon_err(OE_UNIX, errno, "fwrite");
+        goto done;
+    }
+    retval = 0;
+ done:
+    if (xw.xw_nodes)
+        cbuf_free(xw.xw_nodes);
+    if (xw.xw_yangs)
+        cbuf_free(xw.xw_yangs);
+    if (xw.xw_strs)
+        cbuf_free(xw.xw_strs);
+    if (xw.xw_strhash)
+        clicon_hash_free(xw.xw_strhash);
+    if (xw.xw_yanghash)
+        clicon_hash_free(xw.xw_yanghash);
+    return retval;
+}
+
+/*! Get string from string table
+ *
+ * @param[in]  xr   Read state
+ * @param[in]  off  String offset or XB_NONE
+ * @param[out] strp String or NULL if XB_NONE
+ * @retval     0    OK
+ * @retval    -1    Error: offset out of range
+ */
+static int
+binary_str_get(struct xb_reader *xr,
+               uint32_t          off,
+               char            **strp)
+{
+    if (off == XB_NONE)
+        *strp = NULL;
+    else if (off < xr->xr_strlen)
+        *strp = xr->xr_strs + off;
+    else {
+        clixon_err(OE_XML, EFAULT, "Binary datastore: string offset %u out of range", off);
+        return -1;
+    }
+    return 0;
+}
+
+/*! Resolve yang records to yang statements of the current yang spec
+ *
+ * @param[in]  xr     Read state
+ * @param[in]  yangs  Yang records
+ * @param[in]  nyangs Number of yang records
+ * @param[in]  yspec  Top-level yang spec
+ * @retval     1      OK, all yang records resolved
+ * @retval     0      Some yang record not found, tree can not be pre-bound
+ * @retval    -1      Error
+ */
+static int
+binary_yang_resolve(struct xb_reader *xr,
+                    struct xb_yang   *yangs,
+                    uint32_t          nyangs,
+                    yang_stmt        *yspec)
+{
+    int             retval = -1;
+    struct xb_yang *xy;
+    yang_stmt      *yp;
+    yang_stmt      *y;
+    char           *ns;
+    char           *yns;
+    char           *name;
+    uint32_t        k;
+
+    if ((xr->xr_yvec = calloc(nyangs + 1, sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    for (k = 0; k < nyangs; k++){
+        xy = &yangs[k];
+        if (binary_str_get(xr, xy->xy_name, &name) < 0 ||
+            binary_str_get(xr, xy->xy_ns, &ns) < 0)
+            goto done;
+        if (name == NULL || ns == NULL)
+            goto fail;
+        if (xy->xy_parent == XB_NONE){
+            if ((yp = yang_find_module_by_namespace(yspec, ns)) == NULL)
+                goto fail;
+        }
+        else if (xy->xy_parent < k)
+            yp = xr->xr_yvec[xy->xy_parent];
+        else {
+            clixon_err(OE_XML, EFAULT, "Binary datastore: yang parent %u out of range", xy->xy_parent);
+            goto done;
+        }
+        /* Namespace check since augmented nodes may have same name */
+        if ((y = yang_find_datanode(yp, name)) == NULL ||
+            yang_keyword_get(y) != xy->xy_keyword ||
+            (yns = yang_find_mynamespace(y)) == NULL ||
+            strcmp(yns, ns) != 0)
+            goto fail;
+        xr->xr_yvec[k] = y;
+    }
+    retval = 1;
+ done:
+    return retval;
+ fail:
+    clixon_debug(CLIXON_DBG_DATASTORE, "Binary datastore yang not resolved, rebind");
+    free(xr->xr_yvec);
+    xr->xr_yvec = NULL;
+    retval = 0;
+    goto done;
+}
+
+/*! Materialize node record and its children as XML
+ *
+ * @param[in]  xr     Read state
+ * @param[in]  i      Node index
+ * @param[in]  xp     XML parent
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+binary2xml_recurse(struct xb_reader *xr,
+                   uint32_t          i,
+                   cxobj            *xp)
+{
+    int             retval = -1;
+    struct xb_node *xn = &xr->xr_nodes[i];
+    cxobj          *x;
+    char           *name;
+    char           *prefix;
+    char           *value;
+    uint32_t        j;
+
+    if (xn->xn_type != CX_ELMNT && xn->xn_type != CX_ATTR && xn->xn_type != CX_BODY){
+        clixon_err(OE_XML, EFAULT, "Binary datastore: node %u invalid type %u", i, xn->xn_type);
+        goto done;
+    }
+    if (binary_str_get(xr, xn->xn_name, &name) < 0 ||
+        binary_str_get(xr, xn->xn_prefix, &prefix) < 0 ||
+        binary_str_get(xr, xn->xn_value, &value) < 0)
+        goto done;
+    if (name == NULL){
+        clixon_err(OE_XML, EFAULT, "Binary datastore: node %u has no name", i);
+        goto done;
+    }
+    if ((x = xml_new(name, xp, xn->xn_type)) == NULL)
+        goto done;
+    if (prefix && xml_prefix_set(x, prefix) < 0)
+        goto done;
+    if (value && xml_value_set(x, value) < 0)
+        goto done;
+    if (xr->xr_yvec && xn->xn_yang != XB_NONE){
+        if (xn->xn_yang >= xr->xr_nyangs){
+            clixon_err(OE_XML, EFAULT, "Binary datastore: yang %u out of range", xn->xn_yang);
+            goto done;
+        }
+        xml_spec_set(x, xr->xr_yvec[xn->xn_yang]);
+    }
+    for (j = i + 1; j < xn->xn_end; j = xr->xr_nodes[j].xn_end){
+        if (xr->xr_nodes[j].xn_end <= j || xr->xr_nodes[j].xn_end > xn->xn_end){
+            clixon_err(OE_XML, EFAULT, "Binary datastore: node %u out of range", j);
+            goto done;
+        }
+        if (binary2xml_recurse(xr, j, x) < 0)
+            goto done;
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
+/*! Read an XML tree from a file in binary datastore format
+ *
+ * The file is memory-mapped and the XML tree is created directly from the node records.
+ * The returned tree has the same shape as clixon_xml_parse_file, ie <top><config>...
+ * The tree is only returned bound if the yang fingerprint of the file is equal to that of
+ * yspec, otherwise the caller binds and sorts it.
+ * @param[in]  fp     File descriptor to the binary file
+ * @param[in]  yspec  Yang spec to bind to, or NULL for no binding
+ * @param[out] xt     Pointer to (new) XML tree. Free with xml_free()
+ * @param[out] bound  If set, tree is yang-bound and sorted
+ * @retval     1      OK
+ * @retval     0      Not a binary file, eg XML text, file position is rewound
+ * @retval    -1      Error
+ * @see clixon_xml2binary_file
+ */
+int
+clixon_binary_parse_file(FILE       *fp,
+                         yang_stmt  *yspec,
+                         cxobj     **xt,
+                         int        *bound)
+{
+    int               retval = -1;
+    struct stat       st;
+    char             *p = MAP_FAILED;
+    size_t            sz = 0;
+    struct xb_header *xh;
+    struct xb_reader  xr = {0,};
+    struct xb_yang   *yangs;
+    uint64_t          len;
+    int               ret;
+
+    *bound = 0;
+    if (fstat(fileno(fp), &st) < 0){
+        clixon_err(OE_UNIX, errno, "fstat");
+        goto done;
+    }
+    sz = st.st_size;
+    if (sz < sizeof(*xh))
+        goto fail;
+    if ((p = mmap(NULL, sz, PROT_READ, MAP_PRIVATE, fileno(fp), 0)) == MAP_FAILED){
+        clixon_err(OE_UNIX, errno, "mmap");
+        goto done;
+    }
+    xh = (struct xb_header *)p;
+    if (memcmp(xh->xh_magic, XML_BINARY_MAGIC, sizeof(xh->xh_magic)) != 0)
+        goto fail;
+    if (xh->xh_version != XML_BINARY_VERSION ||
+        xh->xh_byteorder != XML_BINARY_BYTEORDER){
+        clixon_err(OE_XML, 0, "Binary datastore: unsupported version or byte order");
+        goto done;
+    }
+    len = sizeof(*xh) + (uint64_t)xh->xh_nodes*sizeof(struct xb_node) +
+        (uint64_t)xh->xh_yangs*sizeof(struct xb_yang) + xh->xh_strlen;
+    if (len != sz || xh->xh_nodes == 0 ||
+        (xh->xh_strlen && p[sz-1] != '\0')){
+        clixon_err(OE_XML, 0, "Binary datastore: truncated or corrupt file");
+        goto done;
+    }
+    xr.xr_nodes = (struct xb_node *)(p + sizeof(*xh));
+    xr.xr_nnodes = xh->xh_nodes;
+    yangs = (struct xb_yang *)(xr.xr_nodes + xh->xh_nodes);
+    xr.xr_strs = (char*)(yangs + xh->xh_yangs);
+    xr.xr_strlen = xh->xh_strlen;
+    xr.xr_nyangs = xh->xh_yangs;
+    if (xr.xr_nodes[0].xn_end != xr.xr_nnodes){
+        clixon_err(OE_XML, 0, "Binary datastore: corrupt file");
+        goto done;
+    }
+    if (yspec && (xh->xh_flags & XB_FLAG_BOUND) &&
+        xh->xh_yangfp == binary_yang_fingerprint(yspec)){
+        if ((ret = binary_yang_resolve(&xr, yangs, xh->xh_yangs, yspec)) < 0)
+            goto done;
+        if (ret == 1)
+            *bound = 1;
+    }
+    if ((*xt = xml_new(XML_TOP_SYMBOL, NULL, CX_ELMNT)) == NULL)
+        goto done;
+    if (binary2xml_recurse(&xr, 0, *xt) < 0){
+        xml_free(*xt);
+        *xt = NULL;
+        goto done;
+    }
+    retval = 1;
+ done:
+    if (xr.xr_yvec)
+        free(xr.xr_yvec);
+    if (p != MAP_FAILED)
+        munmap(p, sz);
+    return retval;
+ fail:
+    rewind(fp);
+    retval = 0;
+    goto done;
+}
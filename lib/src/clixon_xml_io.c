@@ -55,6 +55,7 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
 
 /* cligen */
 #include <cligen/cligen.h>
@@ -84,6 +85,7 @@
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_datastore.h"
+#include "clixon_proto.h"
 #include "clixon_xml_io.h"
 
 /*
@@ -108,7 +110,7 @@ static int xml_diff2cbuf(cbuf *cb, cxobj *x0, cxobj *x1, int level, int skiptop)
  * @retval      0    Remove it
  * @retval     -1    Error
  */
-static int
+int
 xml2output_wdef(cxobj            *x,
                 withdefaults_type wdef,
                 int              *tag)
@@ -663,6 +665,9 @@ xml2cbuf_recurse(cbuf             *cb,
                         if (xml_purge(xa) < 0)
                             goto done;
                     }
+                    /* Send as chunk if streaming reply */
+                    if (clixon_msg_writer_check(cb) < 0)
+                        goto done;
                 }
             if (pretty && hasbody == 0){
                 if (prefix)
@@ -96,7 +96,8 @@ typedef struct  {
 /* Forward declaration */
 static int xml_diff1(cxobj *x0, cxobj *x1, cxobj ***x0vec, int *x0veclen,
                      cxobj ***x1vec, int *x1veclen,
-                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen);
+                     cxobj ***changed_x0, cxobj ***changed_x1, int *changedlen,
+                     uint16_t flag);
 
 /*! Is attribute and is either of form xmlns="", or xmlns:x="" */
 int
@@ -264,7 +265,10 @@ cvec2xml_1(cvec   *cvv,
             continue;
         if ((xn = xml_new(cv_name_get(cv), NULL, CX_ELMNT)) == NULL) /* this leaks */
             goto err;
-        xml_parent_set(xn, xt);
+        if (xml_parent_set(xn, xt) < 0){
+            xml_free(xn);
+            goto err;
+        }
         xml_child_i_set(xt, i++, xn);
         if ((xb = xml_new("body", xn, CX_BODY)) == NULL) /* this leaks */
             goto err;
@@ -331,6 +335,7 @@ xml_diff_ordered_by_user(cxobj     *x0,
  * @param[out] changed_x0 Pointervector to XML nodes changed orig value
  * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
  * @param[out] changedlen Length of changed vector
+ * @param[in]  flag       If set, skip equal non-leaf x1 subtrees not marked with flag
  * @retval     0          Ok
  * @retval    -1          Error
  * Algorithm to compare two sorted lists A, B:
@@ -359,7 +364,8 @@ xml_diff1(cxobj     *x0,
           int       *x1veclen,
           cxobj   ***changed_x0,
           cxobj   ***changed_x1,
-          int       *changedlen)
+          int       *changedlen,
+          uint16_t   flag)
 {
     int        retval = -1;
     cxobj     *x0c = NULL; /* x0 child */
@@ -489,10 +495,12 @@ xml_diff1(cxobj     *x0,
                         goto done;
                 }
             }
+            else if (flag && xml_flag(x1c, flag) == 0)
+                ; /* Unmarked subtree is assumed equal */
             else if (xml_diff1(x0c, x1c,
                                x0vec, x0veclen,
                                x1vec, x1veclen,
-                               changed_x0, changed_x1, changedlen)< 0)
+                               changed_x0, changed_x1, changedlen, flag)< 0)
                 goto done;
         }
         x0c = xml_child_each(x0, x0c, CX_ELMNT);
@@ -520,6 +528,7 @@ xml_diff1(cxobj     *x0,
  * All xml vectors should be freed after use.
  * @see xml_tree_equal  same algorithm but do not bother with what has changed
  * @see clixon_xml_diff_print  same algorithm but print in +/- diff format
+ * @see xml_diff_flagged  Only traverse marked subtrees
  */
 int
 xml_diff(cxobj     *x0,
@@ -531,6 +540,45 @@ xml_diff(cxobj     *x0,
          cxobj   ***changed_x0,
          cxobj   ***changed_x1,
          int       *changedlen)
+{
+    return xml_diff_flagged(x0, x1, 0x0,
+                            first, firstlen,
+                            second, secondlen,
+                            changed_x0, changed_x1, changedlen);
+}
+
+/*! Compute differences between two xml trees, only traverse subtrees marked with flag
+ *
+ * Same as xml_diff but if two (non-leaf) nodes match and the node in x1 is not marked
+ * with flag, the subtrees are assumed equal and not traversed.
+ * This relies on the caller to guarantee that all differences are marked in x1, such as
+ * XML_FLAG_COMMIT_DIRTY in a datastore with a valid commit journal
+ * @param[in]  x0         First XML tree
+ * @param[in]  x1         Second XML tree
+ * @param[in]  flag       Only traverse marked subtrees. If 0, same as xml_diff
+ * @param[out] first      Pointervector to XML nodes existing in only first tree
+ * @param[out] firstlen   Length of first vector
+ * @param[out] second     Pointervector to XML nodes existing in only second tree
+ * @param[out] secondlen  Length of second vector
+ * @param[out] changed_x0 Pointervector to XML nodes changed orig value
+ * @param[out] changed_x1 Pointervector to XML nodes changed wanted value
+ * @param[out] changedlen Length of changed vector
+ * @retval     0          OK
+ * @retval    -1          Error
+ * @see xml_diff
+ * @see xmldb_journal_get
+ */
+int
+xml_diff_flagged(cxobj     *x0,
+                 cxobj     *x1,
+                 uint16_t   flag,
+                 cxobj   ***first,
+                 int       *firstlen,
+                 cxobj   ***second,
+                 int       *secondlen,
+                 cxobj   ***changed_x0,
+                 cxobj   ***changed_x1,
+                 int       *changedlen)
 {
     int retval = -1;
 
@@ -552,7 +600,7 @@ xml_diff(cxobj     *x0,
     if (xml_diff1(x0, x1,
                   first, firstlen,
                   second, secondlen,
-                  changed_x0, changed_x1, changedlen) < 0)
+                  changed_x0, changed_x1, changedlen, flag) < 0)
         goto done;
  ok:
     retval = 0;
@@ -661,6 +709,413 @@ xml_tree_equal(cxobj *x0,
     return retval;
 }
 
+/*! Check if two XML nodes are equal including names, attributes, bodies and all descendants
+ *
+ * Stricter than xml_tree_equal: no yang-equality, all node types and values are compared
+ * @param[in]  x0   First XML tree
+ * @param[in]  x1   Second XML tree
+ * @retval     1    Equal
+ * @retval     0    Not equal
+ * @see xml_tree_sync
+ */
+static int
+xml_sync_equal(cxobj *x0,
+               cxobj *x1)
+{
+    int i;
+
+    if (xml_type(x0) != xml_type(x1))
+        return 0;
+    /* Names and prefixes are interned */
+    if (xml_name(x0) != xml_name(x1) ||
+        xml_prefix(x0) != xml_prefix(x1))
+        return 0;
+    if (xml_type(x0) != CX_ELMNT)
+        return clicon_strcmp(xml_value(x0), xml_value(x1)) == 0;
+    if (xml_spec(x0) != xml_spec(x1))
+        return 0;
+    if (xml_child_nr(x0) != xml_child_nr(x1))
+        return 0;
+    for (i=0; i<xml_child_nr(x0); i++)
+        if (!xml_sync_equal(xml_child_i(x0, i), xml_child_i(x1, i)))
+            return 0;
+    return 1;
+}
+
+/*! Check if attribute and body children of two XML nodes are equal and in same order
+ *
+ * @param[in]  x0   First XML node
+ * @param[in]  x1   Second XML node
+ * @retval     1    Equal
+ * @retval     0    Not equal
+ */
+static int
+xml_sync_nonelmnt_equal(cxobj *x0,
+                        cxobj *x1)
+{
+    int    i0 = 0;
+    int    i1 = 0;
+    cxobj *x0c;
+    cxobj *x1c;
+
+    for (;;){
+        x0c = NULL;
+        while (i0 < xml_child_nr(x0) &&
+               xml_type(x0c = xml_child_i(x0, i0++)) == CX_ELMNT)
+            x0c = NULL;
+        x1c = NULL;
+        while (i1 < xml_child_nr(x1) &&
+               xml_type(x1c = xml_child_i(x1, i1++)) == CX_ELMNT)
+            x1c = NULL;
+        if (x0c == NULL && x1c == NULL)
+            return 1;
+        if (x0c == NULL || x1c == NULL)
+            return 0;
+        if (!xml_sync_equal(x0c, x1c))
+            return 0;
+    }
+    return 1;
+}
+
+/*! Ordering between two children in a lock-step traversal of xml_tree_sync
+ *
+ * @param[in]  x0c  Child of tree to be modified
+ * @param[in]  x1c  Child of source tree
+ * @retval     0    Match: x0c can be reused and synced with x1c
+ * @retval    <0    x0c precedes x1c, or no match
+ * @retval    >0    x1c precedes x0c
+ * Attributes before bodies before elements. Elements are compared using xml_cmp,
+ * ie the same ordering as used by xml_sort.
+ * The result only affects how many nodes are reused, not the resulting tree
+ */
+static int
+xml_sync_cmp(cxobj *x0c,
+             cxobj *x1c)
+{
+    enum cxobj_type t0 = xml_type(x0c);
+    enum cxobj_type t1 = xml_type(x1c);
+    int             eq;
+
+    if (t0 != t1)
+        return (t0==CX_ATTR?0:t0==CX_BODY?1:2) - (t1==CX_ATTR?0:t1==CX_BODY?1:2);
+    if (t0 != CX_ELMNT)
+        return xml_sync_equal(x0c, x1c) ? 0 : -1;
+    if ((eq = xml_cmp(x0c, x1c, 0, 0, NULL)) != 0)
+        return eq;
+    /* Yang-equal but may still differ, eg choice or no yang */
+    if (xml_spec(x0c) != xml_spec(x1c) ||
+        xml_name(x0c) != xml_name(x1c) ||
+        xml_prefix(x0c) != xml_prefix(x1c))
+        return -1;
+    return 0;
+}
+
+/*! Remove and free all children of a parent being synced
+ *
+ * @param[in]  x0   Parent XML node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_sync_rm_all(cxobj *x0)
+{
+    int    n;
+    cxobj *xc;
+
+    while ((n = xml_child_nr(x0)) > 0){
+        xc = xml_child_i(x0, n-1);
+        if (xml_child_rm(x0, n-1) < 0)
+            return -1;
+        xml_free(xc);
+    }
+    return 0;
+}
+
+/*! Make a copy of a source child to be added to a parent being synced
+ *
+ * The commit journal of the source is not copied, it only applies to the source datastore
+ * @param[in]  x0   Parent XML node
+ * @param[in]  x1c  Source child
+ * @retval     xc   New copy of x1c with parent x0 (not yet in childvec of x0)
+ * @retval     NULL Error
+ * @see xmldb_journal_get
+ */
+static cxobj *
+xml_sync_dup(cxobj *x0,
+             cxobj *x1c)
+{
+    cxobj *xc;
+
+    if ((xc = xml_dup(x1c)) == NULL)
+        return NULL;
+    if (xml_apply0(xc, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset, (void*)XML_FLAG_COMMIT_DIRTY) < 0){
+        xml_free(xc);
+        return NULL;
+    }
+    if (xml_parent_set(xc, x0) < 0){
+        xml_free(xc);
+        return NULL;
+    }
+    return xc;
+}
+
+static int xml_tree_sync_children(cxobj *x0, cxobj *x1, uint16_t flag);
+
+/*! Sync a single node x0 with a yang-equal node x1, or signal that x0 must be replaced
+ *
+ * @param[in]  x0       XML node to modify
+ * @param[in]  x1       Source XML node
+ * @param[in]  flag     If set, x0 and x1 are assumed equal if neither is marked with flag
+ * @param[out] replace  Set to 1 if x0 cannot be synced and needs to be replaced by copy of x1
+ * @retval     0        OK
+ * @retval    -1        Error
+ */
+static int
+xml_tree_sync1(cxobj   *x0,
+               cxobj   *x1,
+               uint16_t flag,
+               int     *replace)
+{
+    yang_stmt *y;
+    int        flags = XML_FLAG_DEFAULT | XML_FLAG_ANYDATA;
+
+    *replace = 0;
+    if (flag && xml_flag(x0, flag) == 0 && xml_flag(x1, flag) == 0)
+        return 0; /* Unmarked subtree is assumed equal */
+    if ((y = xml_spec(x1)) == NULL ||
+        (yang_keyword_get(y) != Y_CONTAINER && yang_keyword_get(y) != Y_LIST)){
+        /* Leafs, leaf-lists, anydata: small or without structure, compare all */
+        if (!xml_sync_equal(x0, x1)){
+            *replace = 1;
+            return 0;
+        }
+    }
+    else {
+        /* Namespace caches of descendants may depend on attributes: replace if changed */
+        if (!xml_sync_nonelmnt_equal(x0, x1)){
+            *replace = 1;
+            return 0;
+        }
+        if (xml_tree_sync_children(x0, x1, flag) < 0)
+            return -1;
+    }
+    if (xml_flag(x0, flags) != xml_flag(x1, flags)){
+        xml_flag_reset(x0, flags);
+        xml_flag_set(x0, xml_flag(x1, flags));
+    }
+    return 0;
+}
+
+/*! Sync children of x0 with children of x1
+ *
+ * Fast path if both have same number of children which all match pair-wise, then no
+ * child vector is rebuilt.
+ * Otherwise merge children in lock-step and rebuild the child vector of x0 in x1 order.
+ * @param[in]  x0   XML node to modify
+ * @param[in]  x1   Source XML node
+ * @param[in]  flag If set, do not descend into children where neither is marked with flag
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+xml_tree_sync_children(cxobj   *x0,
+                       cxobj   *x1,
+                       uint16_t flag)
+{
+    int     retval = -1;
+    int     n0;
+    int     n1;
+    int     i0;
+    int     i1;
+    cxobj  *x0c;
+    cxobj  *x1c;
+    cxobj  *xc;
+    cxobj **vec = NULL;
+    cxobj **rmvec = NULL;
+    int     rmlen = 0;
+    int     eq;
+    int     replace;
+
+    n0 = xml_child_nr(x0);
+    n1 = xml_child_nr(x1);
+    if (n0 == n1){
+        for (i0=0; i0<n0; i0++)
+            if (xml_sync_cmp(xml_child_i(x0, i0), xml_child_i(x1, i0)) != 0)
+                break;
+        if (i0 == n0){ /* Fast path: all children match in same order */
+            for (i0=0; i0<n0; i0++){
+                x0c = xml_child_i(x0, i0);
+                x1c = xml_child_i(x1, i0);
+                if (xml_type(x0c) != CX_ELMNT)
+                    continue;
+                if (xml_tree_sync1(x0c, x1c, flag, &replace) < 0)
+                    goto done;
+                if (replace){
+                    if ((xc = xml_sync_dup(x0, x1c)) == NULL)
+                        goto done;
+#ifdef XML_EXPLICIT_INDEX
+                    if (xml_search_index_sync(x0, x0c, 0) < 0)
+                        goto done;
+#endif
+                    xml_child_i_set(x0, i0, xc);
+                    xml_free(x0c);
+#ifdef XML_EXPLICIT_INDEX
+                    if (xml_search_index_sync(x0, xc, 1) < 0)
+                        goto done;
+#endif
+                }
+            }
+            goto ok;
+        }
+    }
+    if (n1 == 0){
+        if (xml_sync_rm_all(x0) < 0)
+            goto done;
+        goto ok;
+    }
+    /* Slow path: merge in lock-step, new vector follows x1 order
+     * Removed children are freed after the new vector is set */
+    if ((vec = calloc(n1, sizeof(cxobj *))) == NULL ||
+        (n0 && (rmvec = calloc(n0, sizeof(cxobj *))) == NULL)){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    i0 = i1 = 0;
+    while (i1 < n1){
+        x1c = xml_child_i(x1, i1);
+        x0c = i0 < n0 ? xml_child_i(x0, i0) : NULL;
+        eq = x0c ? xml_sync_cmp(x0c, x1c) : 1;
+        if (eq < 0){ /* Only in x0 */
+            rmvec[rmlen++] = x0c;
+            i0++;
+            continue;
+        }
+        if (eq == 0){
+            replace = 0;
+            if (xml_type(x0c) == CX_ELMNT &&
+                xml_tree_sync1(x0c, x1c, flag, &replace) < 0)
+                goto done;
+            i0++;
+            if (!replace){
+                vec[i1++] = x0c;
+                continue;
+            }
+            rmvec[rmlen++] = x0c;
+        }
+        if ((vec[i1] = xml_sync_dup(x0, x1c)) == NULL)
+            goto done;
+#ifdef XML_EXPLICIT_INDEX
+        xml_flag_set(vec[i1], XML_FLAG_TRANSIENT); /* New: add to search index below */
+#endif
+        i1++;
+    }
+    for (; i0<n0; i0++)
+        rmvec[rmlen++] = xml_child_i(x0, i0);
+    if (xml_childvec_set(x0, n1) < 0)
+        goto done;
+    for (i1=0; i1<n1; i1++)
+        xml_child_i_set(x0, i1, vec[i1]);
+    for (i0=0; i0<rmlen; i0++){
+#ifdef XML_EXPLICIT_INDEX
+        if (xml_search_index_sync(x0, rmvec[i0], 0) < 0)
+            goto done;
+#endif
+        xml_free(rmvec[i0]);
+    }
+#ifdef XML_EXPLICIT_INDEX
+    for (i1=0; i1<n1; i1++)
+        if (xml_flag(vec[i1], XML_FLAG_TRANSIENT)){
+            xml_flag_reset(vec[i1], XML_FLAG_TRANSIENT);
+            if (xml_search_index_sync(x0, vec[i1], 1) < 0)
+                goto done;
+        }
+#endif
+ ok:
+    retval = 0;
+ done:
+    if (rmvec)
+        free(rmvec);
+    if (vec)
+        free(vec);
+    return retval;
+}
+
+/*! Modify XML tree x0 so that it becomes equal to x1, reusing unchanged nodes of x0
+ *
+ * Alternative to freeing x0 and making a full copy of x1 with xml_copy.
+ * Both trees are traversed in lock-step, and only subtrees that differ are removed from x0
+ * or copied from x1. Unchanged nodes, their names, values and child vectors are kept.
+ * This means that memory allocation is proportional to the difference between the trees.
+ * @param[in]  x0   XML tree to modify, eg a datastore cache
+ * @param[in]  x1   Source XML tree, not modified
+ * @retval     0    OK, x0 is equal to x1
+ * @retval    -1    Error
+ * @note Both trees are assumed to be yang-bound and sorted. If not, the result is still
+ *       equal to x1 but fewer nodes may be reused
+ * @note Nodes in x0 that are removed or replaced are freed, pointers into x0 may be invalid
+ * @see xml_diff  which computes the same lock-step differences without modifying
+ * @see xml_tree_sync_flagged  Only traverse marked subtrees
+ */
+int
+xml_tree_sync(cxobj *x0,
+              cxobj *x1)
+{
+    return xml_tree_sync_flagged(x0, x1, 0x0);
+}
+
+/*! Modify XML tree x0 so that it becomes equal to x1, only traverse marked subtrees
+ *
+ * Same as xml_tree_sync but if two children match and neither is marked with flag, the
+ * subtrees are assumed equal and not traversed. The children of marked nodes are still
+ * compared in lock-step, ie the cost is proportional to the number of children along the
+ * changed paths, not to the size of the trees.
+ * This relies on the caller to guarantee that all differences are marked in x0 or x1, such
+ * as XML_FLAG_COMMIT_DIRTY in a datastore with a valid commit journal
+ * @param[in]  x0   XML tree to modify, eg a datastore cache
+ * @param[in]  x1   Source XML tree, not modified
+ * @param[in]  flag Only traverse marked subtrees. If 0, same as xml_tree_sync
+ * @retval     0    OK, x0 is equal to x1
+ * @retval    -1    Error
+ * @see xml_diff_flagged
+ * @see xmldb_journal_get
+ */
+int
+xml_tree_sync_flagged(cxobj   *x0,
+                      cxobj   *x1,
+                      uint16_t flag)
+{
+    int    retval = -1;
+    cxobj *x1c;
+    cxobj *xc;
+
+    if (x0 == NULL || x1 == NULL){
+        clixon_err(OE_XML, EINVAL, "x0 or x1 is NULL");
+        goto done;
+    }
+    if (xml_sync_nonelmnt_equal(x0, x1)){
+        if (xml_tree_sync_children(x0, x1, flag) < 0)
+            goto done;
+    }
+    else { /* Top-level cannot be replaced, replace its children instead */
+        if (xml_sync_rm_all(x0) < 0)
+            goto done;
+        x1c = NULL;
+        while ((x1c = xml_child_each(x1, x1c, -1)) != NULL){
+            if ((xc = xml_dup(x1c)) == NULL)
+                goto done;
+            if (xml_apply0(xc, CX_ELMNT, (xml_applyfn_t*)xml_flag_reset,
+                           (void*)XML_FLAG_COMMIT_DIRTY) < 0 ||
+                xml_addsub(x0, xc) < 0){
+                xml_free(xc);
+                goto done;
+            }
+        }
+    }
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Prune everything that does not pass test or have at least a child* does not
  *
  * @param[in]   xt      XML tree with some node marked
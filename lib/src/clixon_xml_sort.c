@@ -423,18 +423,57 @@ xml_cmp_qsort(const void *arg1,
     return xml_cmp(*(struct xml**)arg1, *(struct xml**)arg2, 1, 0, indexvar);
 }
 
+/*! Sort a vector of children, callback of xml_childvec_apply
+ *
+ * @param[in] vec      Vector of children
+ * @param[in] len      Length of vec
+ * @param[in] indexvar Descendant-schema-nodeid, or NULL
+ * @retval    0        OK
+ */
+static int
+xml_sort_childvec(cxobj **vec,
+                  int     len,
+                  void   *indexvar)
+{
+    qsort_r(vec, len, sizeof(cxobj *), xml_cmp_qsort, indexvar);
+    return 0;
+}
+
 /*! Sort children of an XML node using an index
  *
  * @param[in] x        XML node
  * @param[in] indexvar Descendant-schema-nodeid
  * @retval    0        OK, all nodes traversed (subparts may have been skipped)
+ * @retval   -1        Error
  */
 int
 xml_sort_by(cxobj *x,
             char  *indexvar)
 {
     xml_enumerate_children(x); /* This is to make sorting "stable", ie not change existing order */
-    qsort_r(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp_qsort, indexvar);
+    if (xml_childvec_apply(x, xml_sort_childvec, indexvar) < 0)
+        return -1;
+    return 0;
+}
+
+/*! Sort a vector of XML siblings using an index, without changing the parent
+ *
+ * Sort is stable, equal nodes keep their order in the parent
+ * @param[in] vec      Vector of children of the same XML node
+ * @param[in] len      Length of vec
+ * @param[in] indexvar Descendant-schema-nodeid
+ * @retval    0        OK
+ * @see xml_sort_by  which sorts the children of the parent
+ */
+int
+xml_sort_vec_by(cxobj **vec,
+                size_t  len,
+                char   *indexvar)
+{
+    if (len == 0)
+        return 0;
+    xml_enumerate_children(xml_parent(vec[0]));
+    qsort_r(vec, len, sizeof(cxobj *), xml_cmp_qsort, indexvar);
     return 0;
 }
 
@@ -459,7 +498,8 @@ xml_sort(cxobj *x)
         return 1;
 #endif
     xml_enumerate_children(x); /* This is to make sorting "stable", ie not change existing order */
-    qsort_r(xml_childvec_get(x), xml_child_nr(x), sizeof(cxobj *), xml_cmp_qsort, NULL);
+    if (xml_childvec_apply(x, xml_sort_childvec, NULL) < 0)
+        return -1;
     return 0;
 }
 
@@ -558,8 +598,7 @@ xml_find_keys_notsorted(cxobj   *xp,
 
 /*! Find more equal objects in a vector up and down in the array of the present
  *
- * @param[in]  childvec  Vector of children of parent
- * @param[in]  childlen  Length of child vector
+ * @param[in]  xp        XML parent
  * @param[in]  x1        XML node to match
  * @param[in]  yangi     Yang order number (according to spec)
  * @param[in]  mid       Where to start from (may be in middle of interval)
@@ -568,8 +607,7 @@ xml_find_keys_notsorted(cxobj   *xp,
  * @retval    -1         Error
  */
 static int
-search_multi_equals(cxobj  **childvec,
-                    size_t   childlen,
+search_multi_equals(cxobj   *xp,
                     cxobj   *x1,
                     int      yangi,
                     int      mid,
@@ -583,7 +621,7 @@ search_multi_equals(cxobj  **childvec,
     int        yi;
 
     for (i=mid-1; i>=0; i--){ /* First decrement */
-        xc = childvec[i];
+        xc = xml_child_i(xp, i);
         yc = xml_spec(xc);
         if ((yi = yang_order(yc)) < -1)
             goto done;
@@ -594,8 +632,8 @@ search_multi_equals(cxobj  **childvec,
         if (clixon_xvec_prepend(xvec, xc) < 0)
             goto done;
     }
-    for (i=mid+1; i<childlen; i++){ /* Then increment */
-        xc = childvec[i];
+    for (i=mid+1; i<xml_child_nr(xp); i++){ /* Then increment */
+        xc = xml_child_i(xp, i);
         yc = xml_spec(xc);
         if ((yi = yang_order(yc)) < -1)
             goto done;
@@ -727,6 +765,49 @@ xml_search_indexvar_binary_pos(cxobj       *x1,
     return retval;
 }
 
+/*! Build search index vector of all list entries of xp with index variable
+ *
+ * @param[in]  xp        XML parent node
+ * @param[in]  x1        List entry with the yang spec of the list
+ * @param[in]  indexvar  Name of index variable
+ * @param[out] ivec      Sorted search vector
+ * @retval     0         OK
+ * @retval    -1         Error
+ */
+static int
+xml_search_indexvar_build(cxobj        *xp,
+                          cxobj        *x1,
+                          char         *indexvar,
+                          clixon_xvec **ivec)
+{
+    int     retval = -1;
+    cxobj **vec = NULL;
+    int     len = 0;
+    cxobj  *xc;
+    int     i;
+
+    if ((vec = calloc(xml_child_nr(xp)+1, sizeof(cxobj *))) == NULL){
+        clixon_err(OE_UNIX, errno, "calloc");
+        goto done;
+    }
+    xc = NULL;
+    while ((xc = xml_child_each(xp, xc, CX_ELMNT)) != NULL)
+        if (xml_spec(xc) == xml_spec(x1) &&
+            xml_find_type(xc, NULL, indexvar, CX_ELMNT) != NULL)
+            vec[len++] = xc;
+    qsort_r(vec, len, sizeof(cxobj *), xml_cmp_qsort, indexvar);
+    if (xml_search_vector_new(xp, indexvar, ivec) < 0)
+        goto done;
+    for (i=0; i<len; i++)
+        if (clixon_xvec_append(*ivec, vec[i]) < 0)
+            goto done;
+    retval = 0;
+ done:
+    if (vec)
+        free(vec);
+    return retval;
+}
+
 static int
 xml_search_indexvar(cxobj   *xp,
                     cxobj   *x1,
@@ -746,6 +827,10 @@ xml_search_indexvar(cxobj   *xp,
     /* Check if (exactly one) explicit indexes in cvk */
     if (xml_search_vector_get(xp, indexvar, &ivec) < 0)
         goto done;
+    /* Not yet searched: build it, then it is maintained by inserts and removes */
+    if (ivec == NULL &&
+        xml_search_indexvar_build(xp, x1, indexvar, &ivec) < 0)
+        goto done;
     if (ivec){
         ilen = clixon_xvec_len(ivec);
         if ((pos = xml_search_indexvar_binary_pos(x1, indexvar,
@@ -831,8 +916,7 @@ xml_search_binary(cxobj   *xp,
         if (clixon_xvec_append(xvec, xc) < 0)
             goto done;
         /* there may be more? */
-        if (search_multi_equals(xml_childvec_get(xp), xml_child_nr(xp),
-                                x1, yangi, mid, skip1, xvec) < 0)
+        if (search_multi_equals(xp, x1, yangi, mid, skip1, xvec) < 0)
             goto done;
     }
     else if (cmp < 0)
@@ -903,6 +987,75 @@ xml_search_yang(cxobj       *xp,
     return retval;
 }
 
+/*! Find first child with yang order not less than yangi in a sorted child vector
+ *
+ * Attributes and children without yang spec are sorted first
+ */
+static int
+xml_search_yang_lower(cxobj *xp,
+                      int    yangi,
+                      int   *pos)
+{
+    int        low = 0;
+    int        upper = xml_child_nr(xp);
+    int        mid;
+    cxobj     *xc;
+    yang_stmt *y;
+    int        yi;
+
+    while (low < upper){
+        mid = (low + upper) / 2;
+        xc = xml_child_i(xp, mid);
+        if (xml_type(xc) == CX_ATTR || (y = xml_spec(xc)) == NULL)
+            yi = -2;
+        else if ((yi = yang_order(y)) < -1)
+            return -1;
+        if (yi < yangi)
+            low = mid + 1;
+        else
+            upper = mid;
+    }
+    *pos = low;
+    return 0;
+}
+
+/*! Get the range of list or leaf-list entries in a sorted child vector
+ *
+ * Entries of a list are adjacent in yang order, in key order or user order.
+ * Use xml_child_i() to access entries by position, eg for pagination.
+ * @param[in]  xp     Parent XML node with sorted children
+ * @param[in]  yc     Yang spec of list or leaf-list
+ * @param[out] first  Position of first entry
+ * @param[out] nr     Number of entries
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+int
+xml_search_yang_range(cxobj     *xp,
+                      yang_stmt *yc,
+                      int       *first,
+                      int       *nr)
+{
+    int retval = -1;
+    int yangi;
+    int last;
+
+    if (xp == NULL || yc == NULL){
+        clixon_err(OE_XML, EINVAL, "xp or yc is NULL");
+        goto done;
+    }
+    if ((yangi = yang_order(yc)) < -1)
+        goto done;
+    if (xml_search_yang_lower(xp, yangi, first) < 0)
+        goto done;
+    if (xml_search_yang_lower(xp, yangi+1, &last) < 0)
+        goto done;
+    *nr = last - *first;
+    retval = 0;
+ done:
+    return retval;
+}
+
 /*! Insert xn in xp:s sorted child list (special case of ordered-by user)
  *
  * @param[in] xp      Parent xml node. If NULL just remove from old parent.
@@ -1147,11 +1300,18 @@ xml_insert(cxobj           *xp,
                          userorder, ins, key_val, nsc_key,
                          low, upper)) < 0)
         goto done;
-    if (xml_child_insert_pos(xp, xi, i) < 0)
+    if (xml_parent_set(xi, xp) < 0)
+        goto done;
+    if (xml_child_insert_pos(xp, xi, i) < 0){
+        xml_parent_set(xi, NULL);
         goto done;
-    xml_parent_set(xi, xp);
+    }
     /* clear namespace context cache of child */
     nscache_clear(xi);
+#ifdef XML_EXPLICIT_INDEX
+    if (xml_search_index_sync(xp, xi, 1) < 0)
+        goto done;
+#endif
 
     retval = 0;
  done:
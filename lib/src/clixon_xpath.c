@@ -99,6 +99,7 @@
 #include "clixon_xpath.h"
 #include "clixon_xpath_parse.h"
 #include "clixon_xpath_eval.h"
+#include "clixon_xpath_function.h"
 
 /* Use apostrophe(') in xpath literals, eg a/[x='foo'], not double-quotes(")
  * If not set, use ": a/[x="foo"]
@@ -602,10 +603,178 @@ xpath_parse(const char  *xpath,
     return retval;
 }
 
+#ifdef XPATH_CACHE_SIZE
+/* Cached parsed xpath-tree
+ * The LRU queue has the most recently used entry first.
+ * An entry evicted while in use is removed from the cache and freed when released.
+ */
+struct xpath_cache_entry{
+    qelem_t     xe_q;        /* LRU queue header */
+    char       *xe_xpath;    /* XPath string, hash key */
+    xpath_tree *xe_tree;     /* Parsed xpath-tree, read-only */
+    int         xe_refs;     /* Number of ongoing evaluations using tree */
+    int         xe_evicted;  /* Not in cache, free when not referenced */
+};
+
+static clicon_hash_t            *_xpath_cache_hash = NULL;
+static struct xpath_cache_entry *_xpath_cache_lru = NULL;
+static uint32_t                  _xpath_cache_nr = 0;
+static uint64_t                  _xpath_cache_hits = 0;
+static uint64_t                  _xpath_cache_misses = 0;
+
+static void
+xpath_cache_entry_free(struct xpath_cache_entry *xe)
+{
+    if (xe->xe_xpath)
+        free(xe->xe_xpath);
+    if (xe->xe_tree)
+        xpath_tree_free(xe->xe_tree);
+    free(xe);
+}
+
+/*! Remove least recently used entry from xpath cache
+ *
+ * @retval     0     OK
+ * @retval    -1     Error
+ */
+static int
+xpath_cache_evict(void)
+{
+    struct xpath_cache_entry *xe;
+
+    if ((xe = _xpath_cache_lru) == NULL)
+        return 0;
+    xe = PREVQ(struct xpath_cache_entry *, xe);
+    DELQ(xe, _xpath_cache_lru, struct xpath_cache_entry *);
+    if (clicon_hash_del(_xpath_cache_hash, xe->xe_xpath) < 0)
+        return -1;
+    _xpath_cache_nr--;
+    if (xe->xe_refs)
+        xe->xe_evicted = 1;
+    else
+        xpath_cache_entry_free(xe);
+    return 0;
+}
+
+/*! Get parsed xpath-tree from cache, parse and add to cache if not found
+ *
+ * The parse tree does not depend on namespace context, prefixes are resolved on evaluation,
+ * therefore the xpath string is the cache key.
+ * @param[in]  xpath  String with XPath 1.0 syntax
+ * @param[out] xep    Cache entry, release with xpath_cache_release
+ * @retval     0      OK
+ * @retval    -1      Error, eg parse error
+ */
+static int
+xpath_cache_get(const char                *xpath,
+                struct xpath_cache_entry **xep)
+{
+    int                       retval = -1;
+    struct xpath_cache_entry *xe = NULL;
+    void                     *p;
+
+    if (xpath == NULL){
+        clixon_err(OE_XML, EINVAL, "XPath is NULL");
+        goto done;
+    }
+    if (_xpath_cache_hash == NULL &&
+        (_xpath_cache_hash = clicon_hash_init()) == NULL)
+        goto done;
+    if ((p = clicon_hash_value(_xpath_cache_hash, xpath, NULL)) != NULL){
+        xe = *(struct xpath_cache_entry **)p;
+        if (xe != _xpath_cache_lru){ /* Move first */
+            DELQ(xe, _xpath_cache_lru, struct xpath_cache_entry *);
+            INSQ(xe, _xpath_cache_lru);
+        }
+        _xpath_cache_hits++;
+    }
+    else {
+        _xpath_cache_misses++;
+        if ((xe = malloc(sizeof(*xe))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            goto done;
+        }
+        memset(xe, 0, sizeof(*xe));
+        if (xpath_parse(xpath, &xe->xe_tree) < 0)
+            goto done;
+        if ((xe->xe_xpath = strdup(xpath)) == NULL){
+            clixon_err(OE_XML, errno, "strdup");
+            goto done;
+        }
+        if (_xpath_cache_nr >= XPATH_CACHE_SIZE &&
+            xpath_cache_evict() < 0)
+            goto done;
+        if (clicon_hash_add(_xpath_cache_hash, xpath, &xe, sizeof(xe)) == NULL)
+            goto done;
+        INSQ(xe, _xpath_cache_lru);
+        _xpath_cache_nr++;
+    }
+    xe->xe_refs++;
+    *xep = xe;
+    xe = NULL;
+    retval = 0;
+ done:
+    if (retval < 0 && xe)
+        xpath_cache_entry_free(xe);
+    return retval;
+}
+
+/*! Release xpath cache entry after evaluation
+ *
+ * @param[in]  xe     Cache entry from xpath_cache_get
+ */
+static void
+xpath_cache_release(struct xpath_cache_entry *xe)
+{
+    if (--xe->xe_refs == 0 && xe->xe_evicted)
+        xpath_cache_entry_free(xe);
+}
+#endif /* XPATH_CACHE_SIZE */
+
+/*! Get statistics of parsed xpath-tree cache
+ *
+ * @param[out] hits    Number of xpaths found in cache
+ * @param[out] misses  Number of xpaths parsed
+ * @param[out] nr      Number of cached xpath-trees
+ * @retval     0       OK
+ * @see XPATH_CACHE_SIZE
+ */
+int
+xpath_cache_stats(uint64_t *hits,
+                  uint64_t *misses,
+                  uint32_t *nr)
+{
+#ifdef XPATH_CACHE_SIZE
+    *hits = _xpath_cache_hits;
+    *misses = _xpath_cache_misses;
+    *nr = _xpath_cache_nr;
+#endif
+    return 0;
+}
+
+/*! Free all cached xpath-trees
+ *
+ * Call on exit
+ */
+void
+xpath_cache_exit(void)
+{
+#ifdef XPATH_CACHE_SIZE
+    while (_xpath_cache_lru != NULL)
+        if (xpath_cache_evict() < 0)
+            break;
+    if (_xpath_cache_hash){
+        clicon_hash_free(_xpath_cache_hash);
+        _xpath_cache_hash = NULL;
+    }
+#endif
+}
+
 /*! Given XML tree and xpath, parse xpath, eval it and return xpath context, 
  *
  * This is a raw form of xpath where you can do type conversion of the return
  * value, etc, not just a nodeset.
+ * Parsed xpath-trees are cached, see XPATH_CACHE_SIZE
  * @param[in]  xcur   XML-tree where to search
  * @param[in]  nsc    External XML namespace context, or NULL
  * @param[in]  xpath  String with XPath 1.0 syntax
@@ -631,10 +800,19 @@ xpath_vec_ctx(cxobj      *xcur,
     int         retval = -1;
     xpath_tree *xptree = NULL;
     xp_ctx      xc = {0,};
-    
+#ifdef XPATH_CACHE_SIZE
+    struct xpath_cache_entry *xe = NULL;
+#endif
+
     clixon_debug(CLIXON_DBG_XPATH | CLIXON_DBG_DETAIL, "%s", xpath);
+#ifdef XPATH_CACHE_SIZE
+    if (xpath_cache_get(xpath, &xe) < 0)
+        goto done;
+    xptree = xe->xe_tree;
+#else
     if (xpath_parse(xpath, &xptree) < 0)
         goto done;
+#endif
     xc.xc_type = XT_NODESET;
     xc.xc_node = xcur;
     xc.xc_initial = xcur;
@@ -648,8 +826,13 @@ xpath_vec_ctx(cxobj      *xcur,
         free(xc.xc_nodeset);
         xc.xc_nodeset = NULL;
     }
+#ifdef XPATH_CACHE_SIZE
+    if (xe)
+        xpath_cache_release(xe);
+#else
     if (xptree)
         xpath_tree_free(xptree);
+#endif
     return retval;
 }
 
@@ -1252,6 +1435,199 @@ xpath2canonical(const char *xpath0,
    return xpath2canonical1(xpath0, nsc0, yspec, 0, xpath1, nsc1p, cbreason);
 }
 
+/*! Add a node name that an xpath expression depends on
+ *
+ * @param[in]  cvv    Dependencies, see xpath_deps
+ * @param[in]  name   Local name of node, or "*" for any node
+ * @param[in]  value  1: value of node is used, 0: only its existence
+ * @retval     0      OK
+ * @retval    -1      Error
+ */
+static int
+xpath_deps_add(cvec *cvv,
+               char *name,
+               int   value)
+{
+    cg_var *cv;
+
+    if ((cv = cvec_find(cvv, name)) == NULL){
+        if ((cv = cvec_add(cvv, CGV_BOOL)) == NULL){
+            clixon_err(OE_UNIX, errno, "cvec_add");
+            return -1;
+        }
+        if (cv_name_set(cv, name) == NULL){
+            clixon_err(OE_UNIX, errno, "cv_name_set");
+            return -1;
+        }
+        cv_bool_set(cv, 0);
+    }
+    if (value)
+        cv_bool_set(cv, 1);
+    return 0;
+}
+
+/*! Check if xpath expression is a single number, such as a positional predicate
+ *
+ * @param[in]  xs   XPath parse tree
+ * @retval     1    Number
+ * @retval     0    Not a number
+ */
+static int
+xpath_tree_number(xpath_tree *xs)
+{
+    while (xs != NULL && xs->xs_c1 == NULL){
+        switch (xs->xs_type){
+        case XP_PRIME_NR:
+            return 1;
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+        case XP_FILTEREXPR:
+        case XP_PRI0:
+            xs = xs->xs_c0;
+            break;
+        default:
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/*! Traverse xpath parse tree and collect node names it depends on
+ *
+ * @param[in]  xs    XPath parse tree
+ * @param[in]  last  Last step of location path: value of node is used
+ * @param[in]  cvv   Dependencies
+ * @retval     0     OK
+ * @retval    -1     Error
+ * @see xpath_deps
+ */
+static int
+xpath_deps_traverse(xpath_tree *xs,
+                    int         last,
+                    cvec       *cvv)
+{
+    xpath_tree *xn;
+
+    if (xs == NULL)
+        return 0;
+    switch (xs->xs_type){
+    case XP_ABSPATH:
+        if (xs->xs_int == A_DESCENDANT_OR_SELF) /* "//" */
+            return xpath_deps_add(cvv, "*", 1);
+        return xpath_deps_traverse(xs->xs_c0, last, cvv);
+    case XP_RELLOCPATH:
+        if (xs->xs_int == A_DESCENDANT_OR_SELF)
+            return xpath_deps_add(cvv, "*", 1);
+        if ((xn = xs->xs_c1) == NULL)
+            return xpath_deps_traverse(xs->xs_c0, last, cvv);
+        /* Trailing "." refers to the step before */
+        if (xn->xs_c0 == NULL && xn->xs_int == A_SELF){
+            if (xpath_deps_traverse(xn, 0, cvv) < 0)
+                return -1;
+            return xpath_deps_traverse(xs->xs_c0, last, cvv);
+        }
+        if (xpath_deps_traverse(xs->xs_c0, 0, cvv) < 0)
+            return -1;
+        return xpath_deps_traverse(xn, last, cvv);
+    case XP_PATHEXPR:
+        if (xs->xs_c1 == NULL)
+            return xpath_deps_traverse(xs->xs_c0, last, cvv);
+        if (xpath_deps_traverse(xs->xs_c0, 0, cvv) < 0)
+            return -1;
+        return xpath_deps_traverse(xs->xs_c1, last, cvv);
+    case XP_STEP:
+        switch (xs->xs_int){
+        case A_ATTRIBUTE:
+        case A_FOLLOWING:
+        case A_FOLLOWING_SIBLING:
+        case A_NAMESPACE:
+        case A_PRECEDING:
+        case A_PRECEDING_SIBLING:
+            return xpath_deps_add(cvv, "*", 1);
+        default:
+            break;
+        }
+        if (xs->xs_c0 == NULL){ /* Abbreviated "." or ".." */
+            if (last && xs->xs_int != A_SELF)
+                return xpath_deps_add(cvv, "*", 1);
+            /* Value of context node, eg string(.) of a container */
+            if (last && xpath_deps_add(cvv, ".", 1) < 0)
+                return -1;
+        }
+        /* "." in predicates refers to the value of the step */
+        else if (xpath_deps_traverse(xs->xs_c0, last || xs->xs_c1 != NULL, cvv) < 0)
+            return -1;
+        return xpath_deps_traverse(xs->xs_c1, 1, cvv);
+    case XP_NODE:
+        if (xs->xs_s1 == NULL || strcmp(xs->xs_s1, "*") == 0)
+            return xpath_deps_add(cvv, "*", 1);
+        return xpath_deps_add(cvv, xs->xs_s1, last);
+    case XP_NODE_FN:  /* node(), text() */
+        return xpath_deps_add(cvv, "*", 1);
+    case XP_PRED:
+        if (xpath_tree_number(xs->xs_c1))
+            return xpath_deps_add(cvv, "*", 1);
+        break;
+    case XP_PRIME_FN:
+        if (xs->xs_int == XPATHFN_DEREF || xs->xs_int == XPATHFN_POSITION)
+            return xpath_deps_add(cvv, "*", 1);
+        break;
+    default:
+        break;
+    }
+    if (xpath_deps_traverse(xs->xs_c0, 1, cvv) < 0)
+        return -1;
+    return xpath_deps_traverse(xs->xs_c1, 1, cvv);
+}
+
+/*! Get names of nodes that the value of an xpath expression depends on
+ *
+ * If no node with any of the names is added, deleted or changed, the expression evaluates
+ * to the same value. Names are local, ie without prefix, which may give false dependencies
+ * but not missing ones.
+ * A name with value true is the last step of a location path: the value of the node is used,
+ * otherwise only the existence of the node.
+ * The name "*" means that the expression may depend on any node, eg wildcards, "//", 
+ * deref() and positions.
+ * The name "." means that the value of the context node is used, which for a non-leaf
+ * depends on its descendants.
+ * @param[in]  xpath  XPath expression
+ * @param[out] cvvp   Vector of boolean variables named by node name. Free with cvec_free
+ * @retval     0      OK
+ * @retval    -1      Error
+ * @see xml_yang_validate_all_diff  where it is used
+ */
+int
+xpath_deps(const char *xpath,
+           cvec      **cvvp)
+{
+    int         retval = -1;
+    xpath_tree *xs = NULL;
+    cvec       *cvv = NULL;
+
+    if (xpath_parse(xpath, &xs) < 0)
+        goto done;
+    if ((cvv = cvec_new(0)) == NULL){
+        clixon_err(OE_UNIX, errno, "cvec_new");
+        goto done;
+    }
+    if (xpath_deps_traverse(xs, 1, cvv) < 0)
+        goto done;
+    *cvvp = cvv;
+    cvv = NULL;
+    retval = 0;
+ done:
+    if (cvv)
+        cvec_free(cvv);
+    if (xs)
+        xpath_tree_free(xs);
+    return retval;
+}
+
 /*! Return a count(xpath)
  *
  * @param[in]  xcur     xml-tree where to search
@@ -138,7 +138,7 @@ nodetest_eval_node(cxobj      *x,
     prefix2 = xs->xs_s0;
     name2 = xs->xs_s1;
     /* Before going into namespaces, check name equality and filter out noteq  */
-    if (strcmp(name1, name2) != 0){
+    if (name1 != name2 && strcmp(name1, name2) != 0){
         retval = 0; /* no match */
         goto done;
     }
@@ -356,7 +356,7 @@ xp_eval_step(xp_ctx     *xc0,
             for (i=0; i<xc->xc_size; i++){
                 xv = xc->xc_nodeset[i];
                 x = NULL;
-                if ((ret = xpath_optimize_check(xs, xv, &vec, &veclen)) < 0)
+                if ((ret = xpath_optimize_check(xs, xv, nsc, &vec, &veclen)) < 0)
                     goto done;
                 if (ret == 0){/* regular code, no optimization made */
                     while ((x = xml_child_each(xv, x, CX_ELMNT)) != NULL) {
@@ -66,25 +66,79 @@
 #include "clixon_debug.h"
 #include "clixon_xml_vec.h"
 #include "clixon_xml_sort.h"
+#include "clixon_xml_nsctx.h"
 #include "clixon_xpath_ctx.h"
 #include "clixon_xpath.h"
 #include "clixon_xpath_optimize.h"
 
 #ifdef XPATH_LIST_OPTIMIZE
-static xpath_tree *_xmtop = NULL; /* pattern match tree top */
-static xpath_tree *_xm = NULL;
-static xpath_tree *_xe = NULL;
 static int _optimize_enable = 1;
-static int _optimize_hits = 0;
+static uint64_t _optimize_hits = 0;   /* List steps evaluated with binary search */
+static uint64_t _optimize_misses = 0; /* List steps with predicates evaluated with linear scan */
+
+/* Non-key list leaf used in xpath predicates, candidate for an adaptive search index
+ * @see CLICON_XPATH_INDEX_THRESHOLD
+ */
+struct xpath_index_cand{
+    qelem_t     xc_q;        /* Queue header */
+    yang_stmt  *xc_yang;     /* Yang leaf in list */
+    uint32_t    xc_count;    /* Number of predicate lookups on leaf */
+};
+static struct xpath_index_cand *_index_cands = NULL;
+static uint32_t _index_threshold = 0; /* 0: no adaptive indexes */
+static uint64_t _index_hits = 0;      /* Predicate lookups using search index */
+static uint64_t _index_misses = 0;    /* Predicate lookups using linear scan */
+static uint32_t _index_nr = 0;        /* Number of adaptive search indexes */
 #endif /* XPATH_LIST_OPTIMIZE */
 
-/* XXX development in clixon_xpath_eval */
+/*! Get statistics of list steps with predicates in xpath evaluation
+ *
+ * @param[out] hits    Number of list steps evaluated using binary search
+ * @param[out] misses  Number of list steps with predicates evaluated using linear scan
+ * @retval     0       OK
+ */
 int
-xpath_list_optimize_stats(int *hits)
+xpath_list_optimize_stats(uint64_t *hits,
+                          uint64_t *misses)
 {
 #ifdef XPATH_LIST_OPTIMIZE
     *hits = _optimize_hits;
-    _optimize_hits = 0;
+    *misses = _optimize_misses;
+#endif
+    return 0;
+}
+
+/*! Get statistics of search indexes used by xpath predicates on non-key leaves
+ *
+ * @param[out] hits    Number of predicate lookups using search index
+ * @param[out] misses  Number of predicate lookups using linear scan
+ * @param[out] nr      Number of adaptive search indexes created
+ * @retval     0       OK
+ */
+int
+xpath_index_stats(uint64_t *hits,
+                  uint64_t *misses,
+                  uint32_t *nr)
+{
+#ifdef XPATH_LIST_OPTIMIZE
+    *hits = _index_hits;
+    *misses = _index_misses;
+    *nr = _index_nr;
+#endif
+    return 0;
+}
+
+/*! Set number of lookups on a non-key leaf before it becomes a search index
+ *
+ * @param[in]  threshold  Number of lookups, 0 means no adaptive indexes
+ * @retval     0          OK
+ * @see CLICON_XPATH_INDEX_THRESHOLD
+ */
+int
+xpath_index_threshold_set(uint32_t threshold)
+{
+#ifdef XPATH_LIST_OPTIMIZE
+    _index_threshold = threshold;
 #endif
     return 0;
 }
@@ -106,213 +160,457 @@ void
 xpath_optimize_exit(void)
 {
 #ifdef XPATH_LIST_OPTIMIZE
-    if (_xmtop)
-        xpath_tree_free(_xmtop);
+    struct xpath_index_cand *xc;
+
+    while ((xc = _index_cands) != NULL){
+        DELQ(xc, _index_cands, struct xpath_index_cand *);
+        free(xc);
+    }
 #endif
 }
 
 #ifdef XPATH_LIST_OPTIMIZE
-/*! Initialize xpath module
+/*! Skip xpath-tree nodes that only wrap a single child
  *
- * XXX move to clixon_xpath.c 
- * @see loop_preds
+ * The XPath grammar wraps an operand in several levels, eg expr, andexpr, relexpr, addexpr,
+ * unionexpr, pathexpr, etc, that have no operator of their own.
+ * @param[in]  xs    XPath tree
+ * @retval     xs    First node with an operator or that is not a wrapper
  */
-int
-xpath_optimize_init(xpath_tree **xm,
-                    xpath_tree **xe)
+static xpath_tree *
+xpath_optimize_unwrap(xpath_tree *xs)
 {
-    int         retval = -1;
-    xpath_tree *xs;
+    while (xs && xs->xs_c0 && xs->xs_c1 == NULL && xs->xs_int == A_NAN){
+        switch (xs->xs_type){
+        case XP_EXP:
+        case XP_AND:
+        case XP_RELEX:
+        case XP_ADD:
+        case XP_UNION:
+        case XP_PATHEXPR:
+        case XP_FILTEREXPR:
+        case XP_LOCPATH:
+        case XP_RELLOCPATH:
+        case XP_PRI0:
+            xs = xs->xs_c0;
+            break;
+        default:
+            return xs;
+        }
+    }
+    return xs;
+}
 
-    if (_xm == NULL){
-        /* Initialize xpath-tree */
-        if (xpath_parse("_x[_y='_z']", &_xmtop) < 0)
-            goto done;
-        /* Go down two steps */
-        if ((_xm = xpath_tree_traverse(_xmtop, 0, 0, -1)) == NULL)
-            goto done;
-        /* get nodetest tree (_x) */
-        if ((xs = xpath_tree_traverse(_xm, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++;
-        /* get predicates [_y=_z][z=2] */
-        if ((xs = xpath_tree_traverse(_xm, 1, -1)) == NULL)
-            goto done;
-        xs->xs_match++;
-        /* get expression [_y=_z] */
-        if ((_xe = xpath_tree_traverse(xs, 1, -1)) == NULL)
-            goto done;
-        /* get keyname (_y) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++; /* in loop_preds get name in xs_s1 XXX: leaf-list is different */
-        /* get keyval (_z) */
-        if ((xs = xpath_tree_traverse(_xe, 0, 0, 1, 0, 0, 0, 0, -1)) == NULL)
-            goto done;
-        xs->xs_match++; /* in loop_preds get value in xs_s0 or xs_strnr */
+/*! Check if the prefix of an XPath name test is the namespace of a yang node
+ *
+ * Same as nodetest_eval_node, but the prefix must be resolved in nsc. Without nsc, only
+ * names without prefix match.
+ * @param[in]  xn    XPath tree of type NODE
+ * @param[in]  ys    Yang node
+ * @param[in]  nsc   XML Namespace context
+ * @retval     1     Yes
+ * @retval     0     No, or unknown
+ */
+static int
+xpath_optimize_ns(xpath_tree *xn,
+                  yang_stmt  *ys,
+                  cvec       *nsc)
+{
+    char *ns;
+    char *yns;
+
+    if (nsc == NULL)
+        return xn->xs_s0 == NULL;
+    if ((ns = xml_nsctx_get(nsc, xn->xs_s0)) == NULL ||
+        (yns = yang_find_mynamespace(ys)) == NULL)
+        return 0;
+    return strcmp(ns, yns) == 0;
+}
+
+/*! Get name of predicate operand if it is a child node or the context node
+ *
+ * A child that is a leaf of yc must have the namespace of the leaf. Otherwise it may be
+ * another node with the same name, eg augmented, which the search would not find.
+ * @param[in]  xs    XPath tree of operand
+ * @param[in]  yc    Yang list or leaf-list of step
+ * @param[in]  nsc   XML Namespace context
+ * @retval     name  Name of child, or "." for the context node
+ * @retval     NULL  Operand is something else
+ */
+static char *
+xpath_optimize_name(xpath_tree *xs,
+                    yang_stmt  *yc,
+                    cvec       *nsc)
+{
+    xpath_tree *xn;
+    yang_stmt  *yl;
+
+    if ((xs = xpath_optimize_unwrap(xs)) == NULL ||
+        xs->xs_type != XP_STEP)
+        return NULL;
+    /* No predicates on operand */
+    if (xs->xs_c1 && (xs->xs_c1->xs_c0 || xs->xs_c1->xs_c1))
+        return NULL;
+    if (xs->xs_int == A_SELF && xs->xs_c0 == NULL)
+        return ".";
+    if (xs->xs_int == A_CHILD &&
+        (xn = xs->xs_c0) != NULL &&
+        xn->xs_type == XP_NODE &&
+        xn->xs_s1 != NULL &&
+        strcmp(xn->xs_s1, "*") != 0){
+        if ((yl = yang_find(yc, Y_LEAF, xn->xs_s1)) != NULL &&
+            !xpath_optimize_ns(xn, yl, nsc))
+            return NULL;
+        return xn->xs_s1;
     }
-    *xm = _xm;
-    *xe = _xe;
-    retval = 0;
- done:
-    return retval;
+    return NULL;
 }
 
+/*! Get value of predicate operand if it is a literal or a number
+ *
+ * The search compares values using the yang type of the leaf. A value is only used if it
+ * can be parsed as that type, otherwise the search would fail.
+ * A number is compared numerically in XPath, eg [k=1] matches "01" and "1.0". It is only
+ * used for integer and decimal64 leafs, where the search also compares numerically, and
+ * not eg [k=5.0] for an integer leaf.
+ * @param[in]  xs    XPath tree of operand
+ * @param[in]  yc    Yang list or leaf-list of step
+ * @param[in]  name  Name of leaf in yc, or "." for a leaf-list
+ * @retval     val   Value as string
+ * @retval     NULL  Operand is something else, or can not be used in search
+ */
+static char *
+xpath_optimize_value(xpath_tree *xs,
+                     yang_stmt  *yc,
+                     char       *name)
+{
+    char        *val;
+    int          isnr;
+    yang_stmt   *yl;
+    cg_var      *cv0;
+    cg_var      *cv = NULL;
+    enum cv_type cvtype;
+    char        *reason = NULL;
+    int          ret;
+
+    if ((xs = xpath_optimize_unwrap(xs)) == NULL)
+        return NULL;
+    if (xs->xs_type == XP_PRIME_STR)
+        val = xs->xs_s0;
+    else if (xs->xs_type == XP_PRIME_NR)
+        val = xs->xs_strnr;
+    else
+        return NULL;
+    if (val == NULL)
+        return NULL;
+    isnr = xs->xs_type == XP_PRIME_NR;
+    if (strcmp(name, ".") == 0)
+        yl = yc;
+    else
+        yl = yang_find(yc, Y_LEAF, name);
+    if (yl == NULL || (cv0 = yang_cv_get(yl)) == NULL)
+        return isnr ? NULL : val;
+    cvtype = cv_type_get(cv0);
+    if (isnr && !cv_isint(cvtype) && cvtype != CGV_DEC64)
+        return NULL;
+    if (cvtype == CGV_STRING)
+        return val;
+    if ((cv = cv_dup(cv0)) == NULL)
+        return NULL;
+    ret = cv_parse1(val, cv, &reason);
+    cv_free(cv);
+    if (reason)
+        free(reason);
+    return ret == 1 ? val : NULL;
+}
 
-/*! Recursive function to loop over all EXPR and pattern match them
+/*! Collect equalities of a predicate expression, eg [k1='a' and k2='b']
  *
- * @param[in]  xt    XPath tree of type PRED
- * @param[in]  xepat Pattern matching XPath tree of type EXPR
- * @param[out] cvk   Vector of <keyname>:<keyval> pairs
- * @retval     1     Match
- * @retval     0     No match
+ * @param[in]  xe    XPath tree of predicate expression
+ * @param[in]  yc    Yang list or leaf-list of step
+ * @param[in]  nsc   XML Namespace context
+ * @param[out] cvk   Vector of <name>:<value> pairs
+ * @retval     1     Expression is one or several equalities joined with "and"
+ * @retval     0     Expression is something else
  * @retval    -1     Error
- * @see xpath_optimize_init
  */
 static int
-loop_preds(xpath_tree *xt,
-           xpath_tree *xepat,
-           cvec       *cvk)
+xpath_optimize_equalities(xpath_tree *xe,
+                          yang_stmt  *yc,
+                          cvec       *nsc,
+                          cvec       *cvk)
 {
-    int          retval = -1;
-    int          ret;
-    xpath_tree  *xe;
-    xpath_tree **vec = NULL;
-    size_t       veclen = 0;
-    cg_var      *cvi;
+    int     ret;
+    char   *name;
+    char   *val = NULL;
+    cg_var *cvi;
 
-    if (xt->xs_type == XP_PRED && xt->xs_c0){
-        if ((ret = loop_preds(xt->xs_c0, xepat, cvk)) < 0)
-            goto done;
-        if (ret == 0)
-            goto ok;
+    if ((xe = xpath_optimize_unwrap(xe)) == NULL)
+        return 0;
+    if (xe->xs_type == XP_AND && xe->xs_c1 != NULL){
+        if (xe->xs_int != XO_AND)
+            return 0;
+        if ((ret = xpath_optimize_equalities(xe->xs_c0, yc, nsc, cvk)) <= 0)
+            return ret;
+        return xpath_optimize_equalities(xe->xs_c1, yc, nsc, cvk);
     }
-    if ((xe = xt->xs_c1) && (xe->xs_type == XP_EXP)){
-        if ((ret = xpath_tree_eq(xepat, xe, &vec, &veclen)) < 0)
-            goto done;
-        if (ret == 0)
-            goto ok;
-        if (veclen != 2)
-            goto ok;
-        if ((cvi = cvec_add(cvk, CGV_STRING)) == NULL){
-            clixon_err(OE_XML, errno, "cvec_add");
+    if (xe->xs_type != XP_RELEX || xe->xs_int != XO_EQ || xe->xs_c1 == NULL)
+        return 0;
+    /* Either <name>=<value> or <value>=<name> */
+    if ((name = xpath_optimize_name(xe->xs_c0, yc, nsc)) != NULL)
+        val = xpath_optimize_value(xe->xs_c1, yc, name);
+    else if ((name = xpath_optimize_name(xe->xs_c1, yc, nsc)) != NULL)
+        val = xpath_optimize_value(xe->xs_c0, yc, name);
+    if (name == NULL || val == NULL)
+        return 0;
+    if ((cvi = cvec_add(cvk, CGV_STRING)) == NULL){
+        clixon_err(OE_XML, errno, "cvec_add");
+        return -1;
+    }
+    cv_name_set(cvi, name);
+    cv_string_set(cvi, val);
+    return 1;
+}
+
+/*! Collect equalities of all predicates of a step, eg [k1='a'][k2='b']
+ *
+ * @param[in]  xp    XPath tree of type PRED
+ * @param[in]  yc    Yang list or leaf-list of step
+ * @param[in]  nsc   XML Namespace context
+ * @param[out] cvk   Vector of <name>:<value> pairs
+ * @retval     1     All predicates are equalities
+ * @retval     0     Some predicate is something else, eg a position
+ * @retval    -1     Error
+ */
+static int
+xpath_optimize_preds(xpath_tree *xp,
+                     yang_stmt  *yc,
+                     cvec       *nsc,
+                     cvec       *cvk)
+{
+    int ret;
+
+    if (xp->xs_type != XP_PRED)
+        return 0;
+    if (xp->xs_c0 && (ret = xpath_optimize_preds(xp->xs_c0, yc, nsc, cvk)) <= 0)
+        return ret;
+    if (xp->xs_c1 && (ret = xpath_optimize_equalities(xp->xs_c1, yc, nsc, cvk)) <= 0)
+        return ret;
+    return 1;
+}
+
+/*! Get equalities on all list keys in the order the keys are declared
+ *
+ * Predicates may be given in any order and there may be equalities on other leafs as well.
+ * Those are not used in the search but are checked when the predicates are evaluated.
+ * @param[in]  yc    Yang list
+ * @param[in]  cvk   Vector of <name>:<value> pairs
+ * @param[out] cvkp  Vector of <keyname>:<keyval> pairs in key order, free with cvec_free
+ * @retval     1     All keys given, see cvkp
+ * @retval     0     Not all keys given
+ * @retval    -1     Error
+ */
+static int
+xpath_optimize_keys(yang_stmt *yc,
+                    cvec      *cvk,
+                    cvec     **cvkp)
+{
+    int     retval = -1;
+    cvec   *cvv;
+    cvec   *cvk1 = NULL;
+    cg_var *cvy = NULL;
+    cg_var *cvi;
+
+    if ((cvv = yang_cvec_get(yc)) == NULL || cvec_len(cvk) < cvec_len(cvv))
+        goto nokeys;
+    if ((cvk1 = cvec_new(0)) == NULL){
+        clixon_err(OE_XML, errno, "cvec_new");
+        goto done;
+    }
+    while ((cvy = cvec_each(cvv, cvy)) != NULL) {
+        if ((cvi = cvec_find(cvk, cv_string_get(cvy))) == NULL)
+            goto nokeys;
+        if (cvec_append_var(cvk1, cvi) == NULL){
+            clixon_err(OE_XML, errno, "cvec_append_var");
             goto done;
         }
-        cv_name_set(cvi, vec[0]->xs_s1);
-        if (vec[1]->xs_type == XP_PRIME_NR)
-            cv_string_set(cvi, vec[1]->xs_strnr);
-        else
-            cv_string_set(cvi, vec[1]->xs_s0);
     }
+    *cvkp = cvk1;
+    cvk1 = NULL;
     retval = 1;
  done:
-    if (vec)
-        free(vec);
+    if (cvk1)
+        cvec_free(cvk1);
     return retval;
- ok: /* no match, not special case */
+ nokeys:
     retval = 0;
     goto done;
 }
 
-/*! Pattern matching to find fastpath
+/*! Check if a predicate on a single non-key leaf can use a search index
  *
- * @param[in]  xt     XPath tree
+ * Lookups on non-index leaves are counted, and a leaf is made a search index when the
+ * count reaches the threshold.
+ * @param[in]  yc    Yang list
+ * @param[in]  cvk   Vector of <keyname>:<keyval> pairs
+ * @retval     1     Yes, leaf is a search index
+ * @retval     0     No, use linear scan
+ * @retval    -1     Error
+ * @see CLICON_XPATH_INDEX_THRESHOLD
+ */
+static int
+xpath_index_check(yang_stmt *yc,
+                  cvec      *cvk)
+{
+#ifdef XML_EXPLICIT_INDEX
+    yang_stmt               *yi;
+    struct xpath_index_cand *xc;
+    cvec                    *cvv;
+    cg_var                  *cvi = NULL;
+
+    if (cvec_len(cvk) != 1 ||
+        (yi = yang_find(yc, Y_LEAF, cv_name_get(cvec_i(cvk, 0)))) == NULL)
+        return 0;
+    /* Not on a subset of the keys */
+    if ((cvv = yang_cvec_get(yc)) != NULL)
+        while ((cvi = cvec_each(cvv, cvi)) != NULL)
+            if (strcmp(cv_string_get(cvi), yang_argument_get(yi)) == 0)
+                return 0;
+    if (yang_flag_get(yi, YANG_FLAG_INDEX)){
+        _index_hits++;
+        return 1;
+    }
+    _index_misses++;
+    if (_index_threshold == 0)
+        return 0;
+    if ((xc = _index_cands) != NULL){
+        do {
+            if (xc->xc_yang == yi)
+                break;
+            xc = NEXTQ(struct xpath_index_cand *, xc);
+        } while (xc != _index_cands);
+        if (xc->xc_yang != yi)
+            xc = NULL;
+    }
+    if (xc == NULL){
+        if ((xc = malloc(sizeof(*xc))) == NULL){
+            clixon_err(OE_XML, errno, "malloc");
+            return -1;
+        }
+        memset(xc, 0, sizeof(*xc));
+        xc->xc_yang = yi;
+        ADDQ(xc, _index_cands);
+    }
+    if (++xc->xc_count < _index_threshold)
+        return 0;
+    DELQ(xc, _index_cands, struct xpath_index_cand *);
+    free(xc);
+    clixon_debug(CLIXON_DBG_XPATH, "Adaptive search index: %s/%s",
+                 yang_argument_get(yc), yang_argument_get(yi));
+    yang_flag_set(yi, YANG_FLAG_INDEX);
+    _index_nr++;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/*! Plan a list step with equality predicates as a binary search
+ *
+ * A step qualifies if it is a child step of a list or leaf-list with predicates that are
+ * all equalities with literals and either:
+ * - cover all list keys, in any order, eg y[k2='b'][k1='a'] or y[k1='a' and k2='b']
+ * - is a single leaf with a search index, see xpath_index_check
+ * - is a leaf-list value, eg y[.='a']
+ * The list may be nested in other lists, the search is made for each context node xv.
+ * The step and the names in the equalities must have the namespaces of the list and its
+ * leafs.
+ * The step predicates are evaluated on the result as usual, so the search only needs to
+ * narrow down the candidates.
+ * @param[in]  xt     XPath tree of type STEP
  * @param[in]  xv     XML base node
+ * @param[in]  nsc    XML Namespace context
  * @param[out] xvec   Array of found nodes
- * @param[out] xlen   Len of xvec
- * @param[out] key
- * @param[out] keyval
  * @retval     1      Match
  * @retval     0      No match - use non-optimized lookup
  * @retval    -1      Error
- *  XPath:
- *  y[k=3] # corresponds to: <name>[<keyname>=<keyval>]
  */
 static int
 xpath_list_optimize_fn(xpath_tree  *xt,
                        cxobj       *xv,
+                       cvec        *nsc,
                        clixon_xvec *xvec)
 {
     int          retval = -1;
-    xpath_tree  *xm = NULL;
-    xpath_tree  *xem = NULL;
+    xpath_tree  *xn;
+    xpath_tree  *xp;
     char        *name;
     yang_stmt   *yp;
     yang_stmt   *yc;
-    cvec        *cvv = NULL;
-    xpath_tree **vec = NULL;
-    size_t       veclen = 0;
-    xpath_tree  *xtp;
     int          ret;
-    cvec        *cvk = NULL; /* vector of index keys */
-    cg_var      *cvi;
-    int          i;
-    yang_stmt   *ypp;
+    cvec        *cvk = NULL; /* vector of predicate equalities */
+    cvec        *cvk1 = NULL; /* vector of index keys */
 
+    /* Child step with name test and predicates */
+    if (xt->xs_type != XP_STEP ||
+        xt->xs_int != A_CHILD ||
+        (xn = xt->xs_c0) == NULL ||
+        xn->xs_type != XP_NODE ||
+        (name = xn->xs_s1) == NULL ||
+        strcmp(name, "*") == 0 ||
+        (xp = xt->xs_c1) == NULL ||
+        xp->xs_c1 == NULL)
+        goto ok;
     /* revert to non-optimized if no yang */
     if ((yp = xml_spec(xv)) == NULL)
-        goto ok;
+        goto miss;
     /* or if not config data (state data should not be ordered) */
     if (yang_config_ancestor(yp) == 0)
-        goto ok;
-    /* Check that there is no "outer" list. */
-    ypp = yp;
-    do {
-        if (yang_keyword_get(ypp) == Y_LIST)
-            goto ok;
-    } while((ypp = yang_parent_get(ypp)) != NULL);
-    /* Check yang and that only a list with key as index is a special case can do bin search 
-     * That is, ONLY check optimize cases of this type:_x[_y='_z']
-     * Should we extend this simple example and have more cases (all cases?)
-     */
-    xpath_optimize_init(&xm, &xem);
-    /* Here is where pattern is checked for equality and where variable binding is made (if
-     * equal) */
-    if ((ret = xpath_tree_eq(xm, xt, &vec, &veclen)) < 0)
-        goto done;
-    if (ret == 0)
-        goto ok; /* no match */
-    if (veclen != 2)
-        goto ok;
-    name = vec[0]->xs_s1;
-    /* Extract variables */
-    if ((yc = yang_find(yp, Y_LIST, name)) == NULL)
-#ifdef NOTYET /* leaf-list is not detected by xpath optimize detection */
-        if ((yc = yang_find(yp, Y_LEAF_LIST, name)) == NULL) /* XXX */
-#endif
-            goto ok;
-    /* Validate keys */
-    if ((cvv = yang_cvec_get(yc)) == NULL)
-        goto ok;
-    xtp = vec[1];
+        goto miss;
+    if ((yc = yang_find_datanode(yp, name)) == NULL ||
+        !xpath_optimize_ns(xn, yc, nsc))
+        goto miss;
     if ((cvk = cvec_new(0)) == NULL){
         clixon_err(OE_YANG, errno, "cvec_new");
         goto done;
     }
-    if ((ret = loop_preds(xtp, xem, cvk)) < 0)
+    if ((ret = xpath_optimize_preds(xp, yc, nsc, cvk)) < 0)
         goto done;
     if (ret == 0)
-        goto ok;
-
-    if (cvec_len(cvv) != cvec_len(cvk))
-        goto ok;
-    i = 0;
-    cvi = NULL;
-    while ((cvi = cvec_each(cvk, cvi)) != NULL) {
-        if (strcmp(cv_name_get(cvi), cv_string_get(cvec_i(cvv,i))))
-            goto ok;
-        i++;
+        goto miss;
+    switch (yang_keyword_get(yc)){
+    case Y_LIST:
+        /* Either list keys, or a single leaf with search index */
+        if ((ret = xpath_optimize_keys(yc, cvk, &cvk1)) < 0)
+            goto done;
+        if (ret == 0){
+            if ((ret = xpath_index_check(yc, cvk)) < 0)
+                goto done;
+            if (ret == 0)
+                goto miss;
+        }
+        break;
+    case Y_LEAF_LIST:
+        if (cvec_len(cvk) != 1 || strcmp(cv_name_get(cvec_i(cvk, 0)), ".") != 0)
+            goto miss;
+        break;
+    default:
+        goto miss;
+        break;
     }
     /* Use 2a form since yc allready given to compute cvk */
-    if (clixon_xml_find_index(xv, yp, NULL, name, cvk, xvec) < 0)
+    if (clixon_xml_find_index(xv, yp, NULL, name, cvk1?cvk1:cvk, xvec) < 0)
         goto done;
+    _optimize_hits++;
     retval = 1; /* match */
  done:
-    if (vec)
-        free(vec);
     if (cvk)
         cvec_free(cvk);
+    if (cvk1)
+        cvec_free(cvk1);
     return retval;
+ miss: /* list step with predicates that could not be optimized */
+    _optimize_misses++;
  ok: /* no match, not special case */
     retval = 0;
     goto done;
@@ -321,20 +619,27 @@ xpath_list_optimize_fn(xpath_tree  *xt,
 
 /*! Identify XPath special cases and if match, use binary search.
  *
- * @retval  1  Optimization made, special case, use x (found if != NULL)
- * @retval  0  Dont optimize: not special case, do normal processing
- * @retval -1  Error
- * XXX Contains glue code between cxobj ** and clixon_xvec code 
+ * @param[in]  xs     XPath tree of type STEP
+ * @param[in]  xv     XML base node
+ * @param[in]  nsc    XML Namespace context
+ * @param[in,out] xvec0  Array of found nodes, appended to
+ * @param[in,out] xlen0  Length of xvec0
+ * @retval     1      Optimization made, special case, use xvec0
+ * @retval     0      Dont optimize: not special case, do normal processing
+ * @retval    -1      Error
+ * @see xpath_list_optimize_fn
  */
 int
 xpath_optimize_check(xpath_tree *xs,
                      cxobj      *xv,
+                     cvec       *nsc,
                      cxobj    ***xvec0,
                      int        *xlen0)
 {
 #ifdef XPATH_LIST_OPTIMIZE
     int          retval = -1;
     int          ret;
+    int          i;
     clixon_xvec *xvec = NULL;
 
     if (!_optimize_enable)
@@ -342,17 +647,13 @@ xpath_optimize_check(xpath_tree *xs,
     else if ((xvec = clixon_xvec_new()) == NULL)
         goto done;
     /* Glue code since xpath code uses (old) cxobj ** and search code uses (new) clixon_xvec */
-    else if ((ret = xpath_list_optimize_fn(xs, xv, xvec)) < 0)
+    else if ((ret = xpath_list_optimize_fn(xs, xv, nsc, xvec)) < 0)
         goto done;
     else if (ret == 1){
-        if (xvec0 && *xvec0){
-            free(*xvec0);
-            *xvec0 = NULL;
-        }
-        if (clixon_xvec_extract(xvec, xvec0, xlen0, NULL) < 0){
-            goto done;
-        }
-        _optimize_hits++;
+        /* Append since xvec0 may have nodes found from previous context nodes */
+        for (i=0; i<clixon_xvec_len(xvec); i++)
+            if (cxvec_append(clixon_xvec_i(xvec, i), xvec0, xlen0) < 0)
+                goto done;
         retval = 1; /* Optimized */
         goto done;
     }
@@ -366,4 +667,3 @@ xpath_optimize_check(xpath_tree *xs,
     return 0; /* use regular code */
 #endif
 }
-
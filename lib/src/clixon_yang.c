@@ -250,6 +250,9 @@ yang_argument_set(yang_stmt *ys,
                   char      *arg)
 {
     ys->ys_argument = arg; /* not strdup/copied */
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(ys->ys_parent);
+#endif
     return 0;
 }
 
@@ -269,6 +272,9 @@ yang_argument_dup(yang_stmt *ys,
         return -1;
     }
     ys->ys_argument = dup; /* not strdup/copied */
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(ys->ys_parent);
+#endif
     return 0;
 }
 
@@ -928,6 +934,9 @@ ys_free1(yang_stmt *ys,
     }
     if (ys->ys_stmt)
         free(ys->ys_stmt);
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(ys);
+#endif
     switch (ys->ys_keyword) {     /* type-specifi union fields */
     case Y_ACTION:
         while((rc = ys->ys_action_cb) != NULL) {
@@ -979,6 +988,9 @@ ys_prune(yang_stmt *yp,
 
     if (i >= yp->ys_len)
         goto done;
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(yp);
+#endif
     yc = yp->ys_stmt[i];
     if (i < yp->ys_len - 1){
         size = (yp->ys_len - i - 1)*sizeof(struct yang_stmt *);
@@ -1043,6 +1055,9 @@ ys_freechildren(yang_stmt *ys)
         if ((yc = ys->ys_stmt[i]) != NULL)
             ys_free(yc);
     }
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(ys);
+#endif
     ys->ys_len = 0;
     if (ys->ys_stmt){
         free(ys->ys_stmt);
@@ -1071,6 +1086,9 @@ ys_free(yang_stmt *ys)
 static int
 yn_realloc(yang_stmt *yn)
 {
+#ifdef YANG_CHILD_INDEX
+    yang_index_reset(yn);
+#endif
     yn->ys_len++;
 
     if ((yn->ys_stmt = realloc(yn->ys_stmt, (yn->ys_len)*sizeof(yang_stmt *))) == 0){
@@ -1163,6 +1181,10 @@ ys_cp_one(yang_stmt *ynew,
     sz = sizeof(*yold);
     memcpy(ynew, yold, sz);
     yang_flag_reset(ynew, YANG_FLAG_WHEN); /* Dont inherit WHENs */
+#ifdef YANG_CHILD_INDEX
+    yang_flag_reset(ynew, YANG_FLAG_CHILD_INDEX); /* Dont share index */
+    ynew->ys_index = NULL;
+#endif
     ynew->ys_parent = NULL;
     if (yold->ys_stmt)
         if ((ynew->ys_stmt = calloc(yold->ys_len, sizeof(yang_stmt *))) == NULL){
@@ -1300,6 +1322,12 @@ ys_replace(yang_stmt *yorig,
     if (ys_cp(yorig, yfrom) < 0)
         goto done;
     yorig->ys_parent = yp;
+#ifdef YANG_CHILD_INDEX
+    /* Argument may have changed, and children are new */
+    yang_index_reset(yp);
+    if (yorig->ys_len >= YANG_CHILD_INDEX)
+        yang_flag_set(yorig, YANG_FLAG_CHILD_INDEX);
+#endif
     retval = 0;
  done:
     return retval;
@@ -1372,6 +1400,203 @@ yn_iter(yang_stmt *yparent,
     return yc;
 }
 
+#ifdef YANG_CHILD_INDEX
+/*! Child and its order, for stable sort of child index
+ */
+struct yang_index_sort{
+    yang_stmt *yx_child;
+    int        yx_order;
+};
+
+/*! Sort child index on argument, then order
+ */
+static int
+yang_index_cmp(const void *a,
+               const void *b)
+{
+    const struct yang_index_sort *ya = a;
+    const struct yang_index_sort *yb = b;
+    int                           eq;
+
+    if ((eq = strcmp(ya->yx_child->ys_argument, yb->yx_child->ys_argument)) != 0)
+        return eq;
+    return ya->yx_order - yb->yx_order;
+}
+
+/*! Build child index of a single yang node
+ *
+ * @param[in]  yn   Yang node
+ * @retval     0    OK
+ * @retval    -1    Error
+ */
+static int
+yang_index_build1(yang_stmt *yn)
+{
+    int                     retval = -1;
+    yang_index             *yi = NULL;
+    struct yang_index_sort *yxvec = NULL;
+    yang_stmt              *ys;
+    enum rfc_6020           keyw;
+    int                     len = 0;
+    int                     i;
+
+    if ((yi = malloc(sizeof(*yi) + 2*yn->ys_len*sizeof(yang_stmt *))) == NULL){
+        clixon_err(OE_YANG, errno, "malloc");
+        goto done;
+    }
+    memset(yi, 0, sizeof(*yi));
+    yi->yi_vec = (yang_stmt **)(yi + 1);
+    yi->yi_spec = yi->yi_vec + yn->ys_len;
+    if ((yxvec = calloc(yn->ys_len, sizeof(*yxvec))) == NULL){
+        clixon_err(OE_YANG, errno, "calloc");
+        goto done;
+    }
+    for (i=0; i<yn->ys_len; i++){
+        if ((ys = yn->ys_stmt[i]) == NULL)
+            continue;
+        if (ys->ys_argument != NULL){
+            yxvec[len].yx_child = ys;
+            yxvec[len].yx_order = i;
+            len++;
+        }
+        keyw = ys->ys_keyword;
+        if (keyw == Y_CHOICE || keyw == Y_INPUT || keyw == Y_OUTPUT || keyw == Y_INCLUDE)
+            yi->yi_spec[yi->yi_speclen++] = ys;
+    }
+    qsort(yxvec, len, sizeof(*yxvec), yang_index_cmp);
+    for (i=0; i<len; i++)
+        yi->yi_vec[i] = yxvec[i].yx_child;
+    yi->yi_len = len;
+    yn->ys_index = yi;
+    yi = NULL;
+    retval = 0;
+ done:
+    if (yxvec)
+        free(yxvec);
+    if (yi)
+        free(yi);
+    return retval;
+}
+
+/*! Build child indexes recursively for nodes with many children
+ *
+ * Nodes with at least YANG_CHILD_INDEX children are indexed and marked with
+ * YANG_FLAG_CHILD_INDEX. If the children of such a node change, the index is removed and
+ * rebuilt on next lookup.
+ * @param[in]  yn   Yang node, eg module
+ * @retval     0    OK
+ * @retval    -1    Error
+ * @see yang_parse_post
+ */
+int
+yang_index_build(yang_stmt *yn)
+{
+    int i;
+
+    if (yn->ys_len >= YANG_CHILD_INDEX){
+        yang_flag_set(yn, YANG_FLAG_CHILD_INDEX);
+        if (yn->ys_index == NULL &&
+            yang_index_build1(yn) < 0)
+            return -1;
+    }
+    for (i=0; i<yn->ys_len; i++)
+        if (yn->ys_stmt[i] != NULL &&
+            yang_index_build(yn->ys_stmt[i]) < 0)
+            return -1;
+    return 0;
+}
+
+/*! Remove child index of yang node, call when children are changed
+ *
+ * @param[in]  yn   Yang node, or NULL
+ * @retval     0    OK
+ */
+int
+yang_index_reset(yang_stmt *yn)
+{
+    if (yn != NULL && yn->ys_index != NULL){
+        free(yn->ys_index);
+        yn->ys_index = NULL;
+    }
+    return 0;
+}
+
+/*! Get child index of yang node, rebuild if removed
+ *
+ * @param[in]  yn   Yang node
+ * @retval     yi   Child index
+ * @retval     NULL No index, make linear search
+ */
+static yang_index *
+yang_index_get(yang_stmt *yn)
+{
+    if (yn->ys_index == NULL &&
+        yang_flag_get(yn, YANG_FLAG_CHILD_INDEX) &&
+        yn->ys_len >= YANG_CHILD_INDEX)
+        yang_index_build1(yn); /* On error fall back to linear search */
+    return yn->ys_index;
+}
+
+/*! Find first position in child index with argument
+ *
+ * @param[in]  yi        Child index
+ * @param[in]  argument  Argument
+ * @retval     i         First position in yi_vec with argument, or where it would be inserted
+ */
+static int
+yang_index_lower(yang_index *yi,
+                 const char *argument)
+{
+    int low = 0;
+    int high = yi->yi_len;
+    int mid;
+
+    while (low < high){
+        mid = (low + high)/2;
+        if (strcmp(yi->yi_vec[mid]->ys_argument, argument) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/*! Find child with index, see yang_find
+ */
+static yang_stmt *
+yang_find_index(yang_stmt  *yn,
+                yang_index *yi,
+                int         keyword,
+                const char *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *ym;
+    yang_stmt *yret;
+    int        i;
+
+    for (i = yang_index_lower(yi, argument);
+         i < yi->yi_len && strcmp(yi->yi_vec[i]->ys_argument, argument) == 0;
+         i++){
+        ys = yi->yi_vec[i];
+        if (keyword == 0 || ys->ys_keyword == keyword)
+            return ys;
+    }
+    /* Special case: extend search to include submodules */
+    if (keyword != Y_NAMESPACE &&
+        (yang_keyword_get(yn) == Y_MODULE ||
+         yang_keyword_get(yn) == Y_SUBMODULE)){
+        for (i=0; i<yi->yi_speclen; i++){
+            ys = yi->yi_spec[i];
+            if (yang_keyword_get(ys) == Y_INCLUDE &&
+                (ym = yang_find_module_by_name(ys_spec(yn), yang_argument_get(ys))) != NULL &&
+                (yret = yang_find(ym, keyword, argument)) != NULL)
+                return yret;
+        }
+    }
+    return NULL;
+}
+#endif /* YANG_CHILD_INDEX */
+
 /*! Find first child yang_stmt with matching keyword and argument
  *
  * Find child given keyword and argument.
@@ -1396,6 +1621,9 @@ yang_find(yang_stmt  *yn,
     char      *name;
     yang_stmt *yspec;
     yang_stmt *ym;
+#ifdef YANG_CHILD_INDEX
+    yang_index *yi;
+#endif
 #ifdef YANG_ORIG_PTR_SKIP
     yang_stmt *yorig;
 
@@ -1403,6 +1631,10 @@ yang_find(yang_stmt  *yn,
         if (uses_orig_ptr(keyword))
             return yang_find(yorig, keyword, argument);
     }
+#endif
+#ifdef YANG_CHILD_INDEX
+    if (argument != NULL && (yi = yang_index_get(yn)) != NULL)
+        return yang_find_index(yn, yi, keyword, argument);
 #endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
@@ -1431,6 +1663,119 @@ yang_find(yang_stmt  *yn,
     return yret?yret:yretsub;
 }
 
+#ifdef YANG_CHILD_INDEX
+/*! Find child data node with index, see yang_find_datanode
+ */
+static yang_stmt *
+yang_find_datanode_index(yang_stmt  *yn,
+                         yang_index *yi,
+                         char       *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    yang_stmt *ym;
+    yang_stmt *ysmatch;
+    int        i;
+    int        inext;
+
+    for (i = yang_index_lower(yi, argument);
+         i < yi->yi_len && strcmp(yi->yi_vec[i]->ys_argument, argument) == 0;
+         i++){
+        if (yang_datanode(yi->yi_vec[i]))
+            return yi->yi_vec[i];
+    }
+    /* Look for children of choice, input and output */
+    for (i=0; i<yi->yi_speclen; i++){
+        ys = yi->yi_spec[i];
+        switch (yang_keyword_get(ys)){
+        case Y_CHOICE:
+            inext = 0;
+            while ((yc = yn_iter(ys, &inext)) != NULL){
+                if (yang_keyword_get(yc) == Y_CASE){
+                    if ((ysmatch = yang_find_datanode(yc, argument)) != NULL)
+                        return ysmatch;
+                }
+                else if (yang_datanode(yc) &&
+                         yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
+                    return yc;
+            }
+            break;
+        case Y_INPUT:
+        case Y_OUTPUT:
+            if ((ysmatch = yang_find_datanode(ys, argument)) != NULL)
+                return ysmatch;
+            break;
+        default:
+            break;
+        }
+    }
+    /* Special case: extend search to include submodules */
+    if (yang_keyword_get(yn) == Y_MODULE ||
+        yang_keyword_get(yn) == Y_SUBMODULE){
+        for (i=0; i<yi->yi_speclen; i++){
+            ys = yi->yi_spec[i];
+            if (yang_keyword_get(ys) == Y_INCLUDE &&
+                (ym = yang_find_module_by_name(ys_spec(yn), yang_argument_get(ys))) != NULL &&
+                (ysmatch = yang_find_datanode(ym, argument)) != NULL)
+                return ysmatch;
+        }
+    }
+    return NULL;
+}
+
+/*! Find child schema node with index, see yang_find_schemanode
+ *
+ * @note input and output are not indexed (no argument), use linear search for those
+ */
+static yang_stmt *
+yang_find_schemanode_index(yang_stmt  *yn,
+                           yang_index *yi,
+                           char       *argument)
+{
+    yang_stmt *ys;
+    yang_stmt *yc;
+    yang_stmt *ym;
+    yang_stmt *ysmatch;
+    int        i;
+    int        j;
+
+    for (i = yang_index_lower(yi, argument);
+         i < yi->yi_len && strcmp(yi->yi_vec[i]->ys_argument, argument) == 0;
+         i++){
+        if (yang_schemanode(yi->yi_vec[i]))
+            return yi->yi_vec[i];
+    }
+    /* Look for children of choice (case) */
+    for (i=0; i<yi->yi_speclen; i++){
+        ys = yi->yi_spec[i];
+        if (yang_keyword_get(ys) != Y_CHOICE)
+            continue;
+        for (j=0; j<ys->ys_len; j++){
+            yc = ys->ys_stmt[j];
+            if (yang_keyword_get(yc) == Y_CASE){
+                if ((ysmatch = yang_find_schemanode(yc, argument)) != NULL)
+                    return ysmatch;
+            }
+            else if (yang_schemanode(yc) &&
+                     yc->ys_argument && strcmp(argument, yc->ys_argument) == 0)
+                return yc;
+        }
+    }
+    /* Special case: extend search to include submodules */
+    if (yang_keyword_get(yn) == Y_MODULE ||
+        yang_keyword_get(yn) == Y_SUBMODULE){
+        for (i=0; i<yi->yi_speclen; i++){
+            ys = yi->yi_spec[i];
+            if (yang_keyword_get(ys) == Y_INCLUDE &&
+                (ym = yang_find_module_by_name(ys_spec(yn), yang_argument_get(ys))) != NULL &&
+                (ysmatch = yang_find_schemanode(ym, argument)) != NULL)
+                return ysmatch;
+        }
+    }
+    return NULL;
+}
+#endif /* YANG_CHILD_INDEX */
+
 /*! Find child data node with matching argument (container, leaf, list, leaf-list)
  *
  * @param[in]  yn         Yang node, current context node.
@@ -1453,7 +1798,12 @@ yang_find_datanode(yang_stmt *yn,
     char      *name;
     int        inext;
     int        inext2;
+#ifdef YANG_CHILD_INDEX
+    yang_index *yi;
 
+    if (argument != NULL && (yi = yang_index_get(yn)) != NULL)
+        return yang_find_datanode_index(yn, yi, argument);
+#endif
     inext = 0;
     while ((ys = yn_iter(yn, &inext)) != NULL){
         if (yang_keyword_get(ys) == Y_CHOICE){ /* Look for its children */
@@ -1523,7 +1873,15 @@ yang_find_schemanode(yang_stmt *yn,
     yang_stmt *ysmatch = NULL;
     char      *name;
     int        i, j;
-
+#ifdef YANG_CHILD_INDEX
+    yang_index *yi;
+
+    if (argument != NULL &&
+        strcmp(argument, "input") != 0 &&
+        strcmp(argument, "output") != 0 &&
+        (yi = yang_index_get(yn)) != NULL)
+        return yang_find_schemanode_index(yn, yi, argument);
+#endif
     for (i=0; i<yn->ys_len; i++){
         ys = yn->ys_stmt[i];
         if (yang_keyword_get(ys) == Y_CHOICE){
@@ -3482,6 +3840,9 @@ yang_features(clixon_handle h,
                         yang_flag_set(ys, YANG_FLAG_DISABLED);
                         break;
                     }
+#ifdef YANG_CHILD_INDEX
+                    yang_index_reset(yt);
+#endif
                     for (j=i+1; j<yt->ys_len; j++)
                         yt->ys_stmt[j-1] = yt->ys_stmt[j];
                     yt->ys_len--;
@@ -60,6 +60,21 @@ struct yang_type_cache{
 };
 typedef struct yang_type_cache yang_type_cache;
 
+#ifdef YANG_CHILD_INDEX
+/*! Yang child index. Children sorted on argument for binary search
+ *
+ * Allocated as one chunk including the vectors
+ * @see YANG_CHILD_INDEX
+ */
+struct yang_index{
+    int                yi_len;     /* Length of yi_vec */
+    struct yang_stmt **yi_vec;     /* Children with argument, sorted on argument then order */
+    int                yi_speclen; /* Length of yi_spec */
+    struct yang_stmt **yi_spec;    /* Choice, input, output and include children, in order */
+};
+typedef struct yang_index yang_index;
+#endif
+
 /*! yang statement 
  *
  * This is an internal type, not exposed in the API
@@ -109,6 +124,9 @@ struct yang_stmt {
                                         Y_UNKNOWN: app-dep: yang-mount-points
                                      */
     yang_stmt         *ys_orig;      /* Pointer to original (for uses/augment copies) */
+#ifdef YANG_CHILD_INDEX
+    yang_index        *ys_index;     /* Child index, see YANG_FLAG_CHILD_INDEX */
+#endif
     union {                          /* Depends on ys_keyword */
         rpc_callback_t  *ysu_action_cb; /* Y_ACTION: Action callback list*/
         char            *ysu_filename;  /* Y_MODULE/Y_SUBMODULE: For debug/errors: filename */
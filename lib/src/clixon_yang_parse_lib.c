@@ -681,6 +681,9 @@ yang_expand_uses_node(clixon_handle h,
      */
     if (glen > 0){
         int oldbuflen = yn->ys_len;
+#ifdef YANG_CHILD_INDEX
+        yang_index_reset(yn);
+#endif
         /* size of existing elements up from i+1 (not uses-stmt) */
         size = (yang_len_get(yn) - i - 1)*sizeof(struct yang_stmt *);
         yn->ys_len += glen;
@@ -766,6 +769,10 @@ yang_expand_uses_node(clixon_handle h,
         yang_flag_set(yg, YANG_FLAG_GROUPING);
         k++;
     }
+#ifdef YANG_CHILD_INDEX
+    /* Index may have been rebuilt by lookups in refine before children were set */
+    yang_index_reset(yn);
+#endif
     /* Remove the grouping copy */
     ygrouping2->ys_len = 0; /* Cant do with get access function */
     ys_free(ygrouping2);
@@ -1633,6 +1640,12 @@ yang_parse_post(clixon_handle h,
     for (i=0; i<ylen; i++)
         if (yang_cardinality(h, ylist[i], yang_argument_get(ylist[i])) < 0)
             goto done;
+#ifdef YANG_CHILD_INDEX
+    /* 12. Index children of nodes with many children for faster lookups */
+    for (i=0; i<ylen; i++)
+        if (yang_index_build(ylist[i]) < 0)
+            goto done;
+#endif
     retval = 0;
  done:
     if (ylist)
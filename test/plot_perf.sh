@@ -145,7 +145,7 @@ function genstate()
 
 # Run netconf function
 # args:
-# 1: <op>    put, get, commit, delete
+# 1: <op>    put, get, commit, delete, insert
 # 2: <nr>    Number of entries
 # 3: <reqs> =0 means all in one go
 # 4: <st>  true: Also generate/get state data
@@ -213,6 +213,17 @@ function runnetconf()
             done | $clixon_netconf -qf $cfg; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
             fi
             ;;
+        insert)
+            # New entries with negative keys are sorted first in the list, ie worst case
+            # for a flat child vector where all existing entries are moved
+            { time -p for (( i=0; i<$reqs; i++ )); do
+                rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>-$((i+1))</a><b>$i</b></y></x></config></edit-config></rpc>")
+                if [ $i == 0 ]; then
+                    echo -n "$DEFAULTHELLO";
+                fi
+                echo "$rpc"
+            done | $clixon_netconf -qf $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
+            ;;
         commit)
             rpc=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
             { time -p  echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qf $cfg > /dev/null ; } 2>&1 | awk '/real/ {print $2}' | tr , . >> $file
@@ -471,6 +482,10 @@ if $run; then
         genplot delete $pr $step $step $to $reqs running false
     done
 
+    # Insert new entries first in a large list (see XML_CHILD_CHUNKS)
+    new "netconf insert $reqs at head of full database"
+    genplot insert netconf $step $step $to $reqs running false
+
     new "Kill restconf daemon"
     stop_restconf
 
@@ -639,6 +654,25 @@ set output "$resdir/clixon-delete-100.$term"
 plot $gplot
 EOF
 
+# 8. Insert single entry at head of list
+
+gplot=""
+for a in $archs; do
+    gplot="$gplot \"$resdir/insert-netconf-100-false-$a\" using 1:(\$2/$reqs0) title \"nc-$a\","
+done
+
+gnuplot -persist <<EOF
+set title "Clixon insert single entry at head of list"
+set style data linespoint
+set xlabel "Entries"
+set ylabel "Time[s]"
+set grid
+set terminal $term
+set yrange [*:*]
+set output "$resdir/clixon-insert-100.$term"
+plot $gplot
+EOF
+
 fi # if plot
 
 unset to
@@ -0,0 +1,141 @@
+#!/usr/bin/env bash
+# Pipelined requests on one backend socket
+# Several requests are written to the backend socket at once without waiting for replies.
+# The backend keeps unparsed input per client and replies to all requests in order.
+# See clixon_msg_reader_new and clicon_rpc_async_msg
+# Uses socat to write directly to the backend socket
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+if [ -z "$(type socat 2> /dev/null)" ]; then
+    echo "...skipped: socat not installed"
+    rm -rf $dir
+    if [ "$s" = $0 ]; then exit 0; else return 0; fi
+fi
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+sock=/usr/local/var/run/$APPNAME.sock
+
+: ${socat:=socat}
+if [ -n "$CLICON_GROUP" ]; then
+    socat="sudo -g ${CLICON_GROUP} $socat"
+fi
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>$sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <x xmlns="urn:example:clixon">
+      <y><a>1</a></y>
+      <y><a>2</a></y>
+      <y><a>3</a></y>
+      <y><a>4</a></y>
+      <y><a>5</a></y>
+   </x>
+</${DATASTORE_TOP}>
+EOF
+
+# Send framed requests in one write to backend socket and return replies
+# 1..n: rpc bodies
+function pipeline()
+{
+    msgs=$(chunked_framing "<hello $DEFAULTONLY/>")
+    for rpc in "$@"; do
+        msgs="$msgs$(chunked_framing "<rpc $DEFAULTNS>$rpc</rpc>")"
+    done
+    # Command substitution strips the final newline of the last frame
+    echo "$msgs" | $socat -t 2 - UNIX-CONNECT:$sock
+}
+
+# get-config filter of single y entry
+# 1: key
+function gety()
+{
+    echo -n "<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$1]\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "five pipelined get-config"
+ret=$(pipeline "$(gety 1)" "$(gety 2)" "$(gety 3)" "$(gety 4)" "$(gety 5)")
+count=$(echo "$ret" | grep -o "<rpc-reply" | wc -l)
+if [ $count -ne 5 ]; then
+    err "5 replies" "$ret"
+fi
+
+new "replies in request order"
+order=$(echo "$ret" | grep -o "<a>[0-9]*</a>" | tr -d '\n')
+if [ "$order" != "<a>1</a><a>2</a><a>3</a><a>4</a><a>5</a>" ]; then
+    err "<a>1</a><a>2</a><a>3</a><a>4</a><a>5</a>" "$order"
+fi
+
+new "pipelined edit-config, commit and get-config"
+ret=$(pipeline "<edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>6</a></y></x></config></edit-config>" "<commit/>" "$(gety 6)")
+count=$(echo "$ret" | grep -o "<ok/></rpc-reply>" | wc -l)
+if [ $count -ne 2 ]; then
+    err "2 ok replies" "$ret"
+fi
+match=$(echo "$ret" | grep -o "<x xmlns=\"urn:example:clixon\"><y><a>6</a></y></x>")
+if [ -z "$match" ]; then
+    err "<a>6</a>" "$ret"
+fi
+
+new "netconf get-config after pipeline"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a></y><y><a>2</a></y><y><a>3</a></y><y><a>4</a></y><y><a>5</a></y><y><a>6</a></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
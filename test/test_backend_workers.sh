@@ -0,0 +1,166 @@
+#!/usr/bin/env bash
+# Get requests of the whole running datastore served by read workers
+# A large get-config is served by a forked worker while the backend serves small gets
+# and commits of other clients. Latency of small gets is shown while the large get is in flight.
+# See CLICON_BACKEND_READ_WORKERS
+# Set nr to eg 800000 for a reply of about 100 MB
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${nr:=50000}
+
+# Number of small gets during large get
+: ${perfreq:=100}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_BACKEND_READ_WORKERS>2</CLICON_BACKEND_READ_WORKERS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf c {
+                type string;
+            }
+        }
+    }
+    container z {
+        leaf v {
+            type int32;
+        }
+    }
+}
+EOF
+
+pad="abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz"
+
+new "generate config with $nr list entries"
+echo -n "<${DATASTORE_TOP}><z xmlns=\"urn:example:clixon\"><v>0</v></z><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><c>$pad</c></y>"
+done >> $dir/startup_db
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+# Framed rpc of a netconf session
+# 1: rpc body
+function rpc()
+{
+    chunked_framing "<rpc $DEFAULTNS>$1</rpc>"
+}
+
+getall="<get-config><source><running/></source></get-config>"
+getz="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:z\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "get-config of all and small get-config in same session"
+ret=$(echo "$DEFAULTHELLO$(rpc "$getall")$(rpc "$getz")" | $clixon_netconf -qf $cfg)
+count=$(echo "$ret" | grep -o "<y>" | wc -l)
+if [ $count -ne $nr ]; then
+    err "$nr entries" "$count"
+fi
+match=$(echo "$ret" | grep -o "<data><z xmlns=\"urn:example:clixon\"><v>0</v></z></data>")
+if [ -z "$match" ]; then
+    err "<data><z xmlns=\"urn:example:clixon\"><v>0</v></z></data>" "$ret"
+fi
+
+new "start large get-config in background"
+echo "$DEFAULTHELLO$(rpc "$getall")" | $clixon_netconf -qf $cfg > $dir/large.xml &
+pid=$!
+
+new "$perfreq small get-config during large get-config"
+rm -f $dir/latency
+for (( i=0; i<$perfreq; i++ )); do
+    t0=$(date +%s%N)
+    ret=$(echo "$DEFAULTHELLO$(rpc "$getz")" | $clixon_netconf -qf $cfg)
+    t1=$(date +%s%N)
+    echo $(( (t1-t0)/1000 )) >> $dir/latency
+    if [ -z "$(echo "$ret" | grep "<v>0</v>")" ]; then
+        err "<v>0</v>" "$ret"
+    fi
+    if [ $i -eq 0 ]; then
+        if kill -0 $pid 2> /dev/null; then
+            inflight=true
+        else
+            inflight=false
+        fi
+    fi
+done
+
+p50=$(sort -n $dir/latency | awk '{v[NR]=$1} END {print v[int((NR+1)/2)]}')
+p99=$(sort -n $dir/latency | awk '{v[NR]=$1} END {i=int(NR*0.99+0.99); print v[i]}')
+echo "small get latency during large get (in flight: $inflight): p50 ${p50}us p99 ${p99}us"
+
+new "commit during large get-config"
+echo "$DEFAULTHELLO$(rpc "<edit-config><target><candidate/></target><config><z xmlns=\"urn:example:clixon\"><v>1</v></z></config></edit-config>")$(rpc "<commit/>")" | $clixon_netconf -qf $cfg > $dir/commit.xml
+count=$(grep -o "<ok/>" $dir/commit.xml | wc -l)
+if [ $count -ne 2 ]; then
+    err "2 ok" "$(cat $dir/commit.xml)"
+fi
+
+new "wait for large get-config"
+wait $pid
+count=$(grep -o "<y>" $dir/large.xml | wc -l)
+if [ $count -ne $nr ]; then
+    err "$nr entries" "$count"
+fi
+
+new "large get-config reads snapshot before commit"
+if [ -z "$(grep "<z xmlns=\"urn:example:clixon\"><v>0</v></z>" $dir/large.xml)" ]; then
+    err "<v>0</v>" "$(head -c 200 $dir/large.xml)"
+fi
+
+new "get-config after commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getz</rpc>" "" "<rpc-reply $DEFAULTNS><data><z xmlns=\"urn:example:clixon\"><v>1</v></z></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -153,6 +153,7 @@ load("Load configuration from XML file") <filename:string>("Filename (local file
 }
 
 rpc("example rpc") <a:string>("routing instance"), example_client_rpc("");
+rpcs("pipelined example rpcs") <a:string>("routing instance"), example_client_rpc_pipeline("3");
 
 # Special cli bug with choice+dbexpand, part1 set db symbol
 choicebug {
@@ -260,6 +261,16 @@ new "cli rpc"
 # We dont know which message-id the cli app uses
 expectpart "$($clixon_cli -1 -f $cfg -l o rpc ipv4)" 0 "<rpc-reply $DEFAULTONLY message-id=" "><x xmlns=\"urn:example:clixon\">ipv4</x><y xmlns=\"urn:example:clixon\">42</y></rpc-reply>"
 
+new "cli pipelined rpcs, replies in request order"
+ret=$($clixon_cli -1 -f $cfg -l o rpcs ipv4)
+if [ $? -ne 0 ]; then
+    err "0" "$?"
+fi
+order=$(echo "$ret" | tr '\n' ' ')
+if [ "$order" != "1 1 ipv4-1 2 2 ipv4-2 3 3 ipv4-3 " ]; then
+    err "1 1 ipv4-1 2 2 ipv4-2 3 3 ipv4-3 " "$order"
+fi
+
 new "cli bug with choice+dbexpand, part1 set db symbol"
 expectpart "$($clixon_cli -1 -f $cfg set table parameter foobar)" 0 "^$"
 
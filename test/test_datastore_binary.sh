@@ -0,0 +1,218 @@
+#!/usr/bin/env bash
+# Binary datastore format, see CLICON_XMLDB_FORMAT=binary
+# 1. Start from an XML startup file (text import)
+# 2. Edit and commit, check that running is written in binary format
+# 3. Restart from binary running and check content, including augmented nodes
+#    Check in the debug log that the tree was loaded pre-bound, without bind and sort
+# 4. Restart with a new YANG revision changing ordering, check the tree is sorted again
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fyang1=$dir/augment.yang
+log=$dir/backend.log
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_FORMAT>binary</CLICON_XMLDB_FORMAT>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+            leaf-list array1{
+                type string;
+            }
+            leaf-list array2{
+                type string;
+                ordered-by user;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $fyang1
+module augment {
+    yang-version 1.1;
+    namespace "urn:example:augment";
+    prefix aug;
+    import example {
+       prefix ex;
+    }
+    augment "/ex:table/ex:parameter" {
+        leaf extra{
+            type string;
+        }
+    }
+}
+EOF
+
+# XML text startup, imported and then saved as binary
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <table xmlns="urn:example:clixon">
+      <parameter>
+         <name>b</name>
+         <value>42</value>
+      </parameter>
+   </table>
+</${DATASTORE_TOP}>
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "get-config imported xml startup"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>b</name><value>42</value></parameter></table></data></rpc-reply>"
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><array1>z</array1><array1>y</array1><array2>z</array2><array2>y</array2><extra xmlns=\"urn:example:augment\">x</extra></parameter><parameter><name>a</name><value>a long value that is not stored inline</value></parameter></table></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check running is binary"
+ret=$(sudo head -c 4 $dir/running_db)
+if [ "$ret" != "CLXB" ]; then
+    err "CLXB" "$ret"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+
+    new "start backend -s running -f $cfg"
+    start_backend -s running -f $cfg -l f$log -D datastore
+fi
+
+new "wait backend"
+wait_backend
+
+new "get-config from binary running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>a</name><value>a long value that is not stored inline</value></parameter><parameter><name>b</name><value>42</value></parameter><parameter><name>c</name><array1>y</array1><array1>z</array1><array2>z</array2><array2>y</array2><extra xmlns=\"urn:example:augment\">x</extra></parameter></table></data></rpc-reply>"
+
+new "get-config xpath on augmented node"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='c']/aug:extra\" xmlns:ex=\"urn:example:clixon\" xmlns:aug=\"urn:example:augment\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><extra xmlns=\"urn:example:augment\">x</extra></parameter></table></data></rpc-reply>"
+
+new "validate binary running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><running/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "check datastore loaded pre-bound"
+    if ! grep -q "binary datastore pre-bound" $log; then
+        err "binary datastore pre-bound" "$(cat $log)"
+    fi
+
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+# New revision: same names and keywords but array2 is ordered-by system
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    revision 2024-01-01;
+    container table{
+        list parameter{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf value{
+                type string;
+            }
+            leaf-list array1{
+                type string;
+            }
+            leaf-list array2{
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+if [ $BE -ne 0 ]; then
+    new "start backend with new yang revision -s running -f $cfg"
+    sudo rm -f $log
+    start_backend -s running -f $cfg -l f$log -D datastore
+fi
+
+new "wait backend"
+wait_backend
+
+if [ $BE -ne 0 ]; then
+    new "check datastore not loaded pre-bound since yang changed"
+    if grep -q "binary datastore pre-bound" $log; then
+        err "no pre-bound" "$(cat $log)"
+    fi
+fi
+
+new "get-config from binary running, yang fingerprint changed, array2 sorted"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='c']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><array1>y</array1><array1>z</array1><array2>y</array2><array2>z</array2><extra xmlns=\"urn:example:augment\">x</extra></parameter></table></data></rpc-reply>"
+
+new "get-config array2 entry y, binary search in sorted leaf-list"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:table/ex:parameter[ex:name='c']/ex:array2[.='y']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><table xmlns=\"urn:example:clixon\"><parameter><name>c</name><array2>y</array2></parameter></table></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
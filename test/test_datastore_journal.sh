@@ -0,0 +1,153 @@
+#!/usr/bin/env bash
+# Commit journal, see xmldb_journal_get
+# Nodes changed since a datastore was synced with running are marked, and the
+# number of marked nodes is shown as journal in datastore stats.
+# 1. Load a list and commit, neither running nor candidate has journal marks
+# 2. Delete one entry, only a few nodes are marked, not the whole list
+# 3. Commit, add entries and commit again, running never has journal marks
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${nr:=100}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key k;
+            leaf k {
+                type uint32;
+            }
+            container z {
+                leaf v {
+                    type string;
+                }
+            }
+        }
+    }
+}
+EOF
+
+# Journal stats of datastore
+# 1: datastore
+function journal()
+{
+    db=$1
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<datastore><name>$db<\/name><nr>[0-9]*<\/nr><size>[0-9]*<\/size><journal>\([0-9]*\)<\/journal>.*/\1/p"
+}
+
+# Check number of journal marks of datastore
+# 1: datastore
+# 2: max number of marks
+function checkjournal()
+{
+    db=$1
+    max=$2
+    n=$(journal $db)
+    if [ -z "$n" ] || [ $n -gt $max ]; then
+        err "$db journal <= $max" "$n"
+    fi
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+for (( i=0; i<$nr; i++ )); do
+    rpc+="<y><k>$i</k><z><v>v$i</v></z></y>"
+done
+rpc+="</x></config></edit-config></rpc>"
+
+new "load $nr entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "$rpc" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "candidate journal marks all entries"
+n=$(journal candidate)
+if [ -z "$n" ] || [ $n -lt $nr ]; then
+    err "candidate journal >= $nr" "$n"
+fi
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running journal is empty"
+checkjournal running 0
+
+new "candidate journal is empty"
+checkjournal candidate 0
+
+new "delete one entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><y nc:operation=\"delete\"><k>17</k></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "candidate journal does not mark the whole list"
+checkjournal candidate 2
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running journal is empty after delete"
+checkjournal running 0
+
+new "add entries"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><k>17</k><z><v>w17</v></z></y><y><k>$nr</k><z><v>w$nr</v></z></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "running journal is empty after add"
+checkjournal running 0
+
+new "candidate journal is empty after add"
+checkjournal candidate 0
+
+new "check added entries in running"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:k=17 or ex:k=$nr]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><k>17</k><z><v>w17</v></z></y><y><k>$nr</k><z><v>w$nr</v></z></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,151 @@
+#!/usr/bin/env bash
+# Leafref target index used when validating a whole datastore
+# Many leafrefs with absolute and relative paths referring to one list.
+# Check valid and invalid references and index counters in stats rpc
+# See validate_leafref_stats
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of referred and referring list entries
+: ${nr:=1000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list z {
+            key name;
+            leaf name {
+                type string;
+            }
+            leaf alias {
+                type string;
+            }
+        }
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf rel {
+                description "Relative path";
+                type leafref {
+                    path "../../z/name";
+                }
+            }
+            leaf abs {
+                description "Absolute path";
+                type leafref {
+                    path "/ex:x/ex:z/ex:name";
+                }
+            }
+            leaf cur {
+                description "Path with current(), not indexed";
+                type leafref {
+                    path "/ex:x/ex:z[ex:name=current()/../ex:rel]/ex:alias";
+                }
+            }
+        }
+    }
+}
+EOF
+
+new "generate config with $nr entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<z><name>z$i</name><alias>a$i</alias></z>"
+done >> $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><rel>z$i</rel><abs>z$(( (i+1)%nr ))</abs></y>"
+done >> $dir/startup_db
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "stats leafref-index builds and hits after startup"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+builds=$(echo "$ret" | sed -n 's/.*<leafref-index[^>]*><builds>\([0-9]*\)<\/builds><hits>\([0-9]*\)<\/hits>.*/\1/p')
+hits=$(echo "$ret" | sed -n 's/.*<leafref-index[^>]*><builds>\([0-9]*\)<\/builds><hits>\([0-9]*\)<\/hits>.*/\2/p')
+if [ -z "$builds" ] || [ $builds -lt 2 ]; then
+    err "builds >= 2" "$ret"
+fi
+if [ -z "$hits" ] || [ $hits -lt $nr ]; then
+    err "hits >= $nr" "$ret"
+fi
+
+new "add valid references"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$nr</a><rel>z3</rel><abs>z4</abs><cur>a3</cur></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "invalid relative reference"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$((nr+1))</a><rel>nosuch</rel></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate invalid relative reference"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag><error-app-tag>instance-required</error-app-tag><error-path>../../z/name</error-path><error-info>nosuch</error-info><error-severity>error</error-severity></rpc-error></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "delete referred entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><z nc:operation=\"delete\"><name>z$((nr-1))</name></z></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate invalid absolute reference"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag><error-app-tag>instance-required</error-app-tag><error-path>/ex:x/ex:z/ex:name</error-path><error-info>z$((nr-1))</error-info><error-severity>error</error-severity></rpc-error></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "invalid reference with current()"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$nr</a><cur>a4</cur></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "validate invalid reference with current()"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>data-missing</error-tag><error-app-tag>instance-required</error-app-tag><error-path>/ex:x/ex:z[ex:name=current()/../ex:rel]/ex:alias</error-path><error-info>a4</error-info><error-severity>error</error-severity></rpc-error></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,225 @@
+#!/usr/bin/env bash
+# NACM data node rules compiled per user
+# Rules with and without instance predicates are compiled once per user and
+# kept until the generation of the NACM config, ie running, changes.
+# Check read and write access and nacm-compiled counters in stats rpc
+# Nodes of unknown module, eg in anydata, only match rules with module-name "*"
+# See nacm_user_get
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Common NACM scripts
+. ./nacm.sh
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import ietf-netconf-acm {
+        prefix nacm;
+    }
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf c {
+                type string;
+            }
+        }
+    }
+    container z {
+        leaf v {
+            type int32;
+        }
+    }
+    container w {
+        anydata d;
+    }
+}
+EOF
+
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <nacm xmlns="urn:ietf:params:xml:ns:yang:ietf-netconf-acm">
+     <enable-nacm>true</enable-nacm>
+     <read-default>permit</read-default>
+     <write-default>permit</write-default>
+     <exec-default>permit</exec-default>
+
+     $NGROUPS
+
+     <rule-list>
+       <name>limited-acl</name>
+       <group>limited</group>
+       <rule>
+         <name>deny-y2</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:x/ex:y[ex:a='2']</path>
+         <action>deny</action>
+       </rule>
+       <rule>
+         <name>permit-x</name>
+         <module-name>*</module-name>
+         <access-operations>*</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:x</path>
+         <action>permit</action>
+       </rule>
+       <rule>
+         <name>deny-z</name>
+         <module-name>example</module-name>
+         <access-operations>*</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:z</path>
+         <action>deny</action>
+       </rule>
+       <rule>
+         <name>permit-w</name>
+         <module-name>example</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:w</path>
+         <action>permit</action>
+       </rule>
+     </rule-list>
+
+     $NADMIN
+
+   </nacm>
+   <x xmlns="urn:example:clixon">
+     <y><a>1</a><c>one</c></y>
+     <y><a>2</a><c>two</c></y>
+     <y><a>3</a><c>three</c></y>
+   </x>
+   <z xmlns="urn:example:clixon"><v>42</v></z>
+   <w xmlns="urn:example:clixon"><d><u xmlns="urn:example:unknown">17</u><e>18</e></d></w>
+</${DATASTORE_TOP}>
+EOF
+
+# Get nacm-compiled stats counter
+# 1: compiles, hits or users
+function nacmstats()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<nacm-compiled[^>]*>.*<$1>\([0-9]*\)<\/$1>.*<\/nacm-compiled>.*/\1/p"
+}
+
+getx="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+getw="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:w\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+getz="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:z\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "admin read x"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getx</rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a><c>one</c></y><y><a>2</a><c>two</c></y><y><a>3</a><c>three</c></y></x></data></rpc-reply>"
+
+new "limited read x, instance rule denies y 2"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getx</rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a><c>one</c></y><y><a>3</a><c>three</c></y></x></data></rpc-reply>"
+
+new "limited read z denied"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getz</rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "limited write z denied"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><z xmlns=\"urn:example:clixon\"><v>43</v></z></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><rpc-error><error-type>application</error-type><error-tag>access-denied</error-tag><error-severity>error</error-severity><error-message>access denied</error-message></rpc-error></rpc-reply>"
+
+new "limited write x permitted"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>4</a><c>four</c></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "discard-changes"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "stats: rule sets compiled and reused"
+compiles=$(nacmstats compiles)
+hits=$(nacmstats hits)
+if [ -z "$compiles" ] || [ $compiles -lt 2 ]; then
+    err "compiles >= 2" "$compiles"
+fi
+if [ -z "$hits" ] || [ $hits -lt 2 ]; then
+    err "hits >= 2" "$hits"
+fi
+
+new "limited read z again, no new compile"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getz</rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+if [ "$(nacmstats compiles)" != "$compiles" ]; then
+    err "$compiles" "$(nacmstats compiles)"
+fi
+
+new "admin removes deny-z rule"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><rule-list><name>limited-acl</name><rule nc:operation=\"delete\"><name>deny-z</name></rule></rule-list></nacm></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "limited read z permitted after NACM commit"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getz</rpc>" "" "<rpc-reply $DEFAULTNS><data><z xmlns=\"urn:example:clixon\"><v>42</v></z></data></rpc-reply>"
+
+new "stats: rule set compiled again"
+if [ $(nacmstats compiles) -le $compiles ]; then
+    err "compiles > $compiles" "$(nacmstats compiles)"
+fi
+
+new "admin sets read-default deny"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><nacm xmlns=\"urn:ietf:params:xml:ns:yang:ietf-netconf-acm\"><read-default>deny</read-default></nacm></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "limited read z denied by default"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getz</rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "limited read x permitted, except y 2"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getx</rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a><c>one</c></y><y><a>3</a><c>three</c></y></x></data></rpc-reply>"
+
+new "guest read x denied by default"
+expecteof_netconf "$clixon_netconf -U guest -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getx</rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "limited read w, module rule does not permit anydata node of unknown module"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getw</rpc>" "" "<rpc-reply $DEFAULTNS><data><w xmlns=\"urn:example:clixon\"><d><e>18</e></d></w></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,236 @@
+#!/usr/bin/env bash
+# NACM read of subtrees decided as a whole on YANG schema nodes
+# Subtrees with no rule boundary below are not descended: permitted ones are kept as is,
+# and denied ones are removed. Augmented nodes of other modules, and rules with
+# instance predicates are evaluated further down.
+# Check replies and skipped and pruned nacm-compiled counters in stats rpc
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${nr:=1000}
+
+APPNAME=example
+
+# Common NACM scripts
+. ./nacm.sh
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fyang2=$dir/example2.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_NACM_MODE>internal</CLICON_NACM_MODE>
+  <CLICON_NACM_CREDENTIALS>none</CLICON_NACM_CREDENTIALS>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import ietf-netconf-acm {
+        prefix nacm;
+    }
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf c {
+                type string;
+            }
+            leaf secret {
+                type string;
+            }
+        }
+    }
+    container z {
+        leaf v {
+            type int32;
+        }
+    }
+    container q {
+        list r {
+            key k;
+            leaf k {
+                type int32;
+            }
+            leaf d {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $fyang2
+module example2 {
+    yang-version 1.1;
+    namespace "urn:example:clixon2";
+    prefix ex2;
+    import example {
+        prefix ex;
+    }
+    augment "/ex:z" {
+        leaf w {
+            type string;
+        }
+    }
+}
+EOF
+
+new "generate config with $nr list entries"
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <nacm xmlns="urn:ietf:params:xml:ns:yang:ietf-netconf-acm">
+     <enable-nacm>true</enable-nacm>
+     <read-default>deny</read-default>
+     <write-default>permit</write-default>
+     <exec-default>permit</exec-default>
+     $NGROUPS
+     <rule-list>
+       <name>limited-acl</name>
+       <group>limited</group>
+       <rule>
+         <name>deny-secret</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:x/ex:y/ex:secret</path>
+         <action>deny</action>
+       </rule>
+       <rule>
+         <name>deny-r7</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:q/ex:r[ex:k='7']</path>
+         <action>deny</action>
+       </rule>
+       <rule>
+         <name>permit-x</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:x</path>
+         <action>permit</action>
+       </rule>
+       <rule>
+         <name>permit-q</name>
+         <module-name>*</module-name>
+         <access-operations>read</access-operations>
+         <path xmlns:ex="urn:example:clixon">/ex:q</path>
+         <action>permit</action>
+       </rule>
+       <rule>
+         <name>permit-example2</name>
+         <module-name>example2</module-name>
+         <access-operations>read</access-operations>
+         <action>permit</action>
+       </rule>
+     </rule-list>
+     $NADMIN
+   </nacm>
+EOF
+echo -n "<x xmlns=\"urn:example:clixon\">" >> $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><c>c$i</c><secret>s$i</secret></y>"
+done >> $dir/startup_db
+echo "</x>" >> $dir/startup_db
+echo "<z xmlns=\"urn:example:clixon\"><v>42</v><w xmlns=\"urn:example:clixon2\">hello</w></z>" >> $dir/startup_db
+echo -n "<q xmlns=\"urn:example:clixon\">" >> $dir/startup_db
+for (( i=0; i<10; i++ )); do
+    echo -n "<r><k>$i</k><d>d$i</d></r>"
+done >> $dir/startup_db
+echo "</q>" >> $dir/startup_db
+echo "</${DATASTORE_TOP}>" >> $dir/startup_db
+
+# Get nacm-compiled stats counter
+# 1: skipped or pruned
+function nacmstats()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<nacm-compiled[^>]*>.*<$1>\([0-9]*\)<\/$1>.*<\/nacm-compiled>.*/\1/p"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+skipped0=$(nacmstats skipped)
+pruned0=$(nacmstats pruned)
+
+new "limited read x: no secret"
+ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")" | $clixon_netconf -U wilma -qf $cfg)
+count=$(echo "$ret" | grep -o "<y>" | wc -l)
+if [ $count -ne $nr ]; then
+    err "$nr entries" "$count"
+fi
+if [ -n "$(echo "$ret" | grep -o "<secret>")" ]; then
+    err "no secret" "$ret"
+fi
+match=$(echo "$ret" | grep -o "<y><a>8</a><c>c8</c></y>")
+if [ -z "$match" ]; then
+    err "<y><a>8</a><c>c8</c></y>" "$ret"
+fi
+
+new "stats: leafs skipped and pruned without descending"
+skipped=$(nacmstats skipped)
+pruned=$(nacmstats pruned)
+if [ -z "$skipped" ] || [ $((skipped-skipped0)) -lt $((2*nr)) ]; then
+    err "skipped >= $((2*nr))" "$skipped"
+fi
+if [ -z "$pruned" ] || [ $((pruned-pruned0)) -lt $nr ]; then
+    err "pruned >= $nr" "$pruned"
+fi
+
+new "limited read q: instance rule denies r 7"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:q\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><q xmlns=\"urn:example:clixon\"><r><k>0</k><d>d0</d></r><r><k>1</k><d>d1</d></r><r><k>2</k><d>d2</d></r><r><k>3</k><d>d3</d></r><r><k>4</k><d>d4</d></r><r><k>5</k><d>d5</d></r><r><k>6</k><d>d6</d></r><r><k>8</k><d>d8</d></r><r><k>9</k><d>d9</d></r></q></data></rpc-reply>"
+
+new "limited read z: only augmented leaf of permitted module"
+expecteof_netconf "$clixon_netconf -U wilma -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:z\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><z xmlns=\"urn:example:clixon\"><w xmlns=\"urn:example:clixon2\">hello</w></z></data></rpc-reply>"
+
+new "guest read x: denied by default"
+expecteof_netconf "$clixon_netconf -U guest -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "admin read r 7"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:q/ex:r[ex:k=7]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><q xmlns=\"urn:example:clixon\"><r><k>7</k><d>d7</d></r></q></data></rpc-reply>"
+
+new "admin read y 7"
+expecteof_netconf "$clixon_netconf -U andy -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=7]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>7</a><c>c7</c><secret>s7</secret></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,165 @@
+#!/usr/bin/env bash
+# List pagination of config lists read directly from the datastore cache
+# See xmldb_get_window and LIST_PAGINATION_VIEWS
+# 1. offset and limit in key order, also past the end
+# 2. direction backwards
+# 3. sort-by a non-key leaf, repeated to use a cached view
+# 4. sort-by after edit of running, view is not stale
+# 5. top-level list
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${nr:=1000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$IETFRFC</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        leaf name {
+            type string;
+        }
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf c {
+                type string;
+            }
+        }
+    }
+    list z {
+        key a;
+        leaf a {
+            type int32;
+        }
+    }
+}
+EOF
+
+# Leaf c sorts in reverse order of key a
+new "generate config with $nr list entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><name>x</name>" > $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><c>$(printf "%05d" $((nr-1-i)))</c></y>" >> $dir/startup_db
+done
+echo -n "</x>" >> $dir/startup_db
+for (( i=0; i<10; i++ )); do
+    echo -n "<z xmlns=\"urn:example:clixon\"><a>$i</a></z>" >> $dir/startup_db
+done
+echo "</${DATASTORE_TOP}>" >> $dir/startup_db
+
+# Get-config list-pagination of /x/y
+# 1: list-pagination parameters
+# 2: expected y entries, or empty
+function testwin()
+{
+    params=$1
+    list=$2
+
+    if [ -z "$list" ]; then
+        reply="<data/>"
+    else
+        reply="<data><x xmlns=\"urn:example:clixon\">$list</x></data>"
+    fi
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y\" xmlns:ex=\"urn:example:clixon\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\">$params</list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$reply</rpc-reply>"
+}
+
+# y entry
+# 1: key
+function y()
+{
+    echo -n "<y><a>$1</a><c>$(printf "%05d" $((nr-1-$1)))</c></y>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Read running once to populate the datastore cache
+new "get-config to fill cache"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:name\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><name>x</name></x></data></rpc-reply>"
+
+new "offset 10 limit 3"
+testwin "<offset>10</offset><limit>3</limit>" "$(y 10)$(y 11)$(y 12)"
+
+new "offset at end"
+testwin "<offset>$((nr-2))</offset><limit>5</limit>" "$(y $((nr-2)))$(y $((nr-1)))"
+
+new "offset past end"
+testwin "<offset>$nr</offset><limit>5</limit>" ""
+
+new "backwards limit 2"
+testwin "<direction>backwards</direction><limit>2</limit>" "$(y $((nr-1)))$(y $((nr-2)))"
+
+new "sort-by c offset 1 limit 2"
+testwin "<sort-by>c</sort-by><offset>1</offset><limit>2</limit>" "$(y $((nr-2)))$(y $((nr-3)))"
+
+new "sort-by c again, cached view"
+testwin "<sort-by>c</sort-by><offset>1</offset><limit>2</limit>" "$(y $((nr-2)))$(y $((nr-3)))"
+
+new "sort-by c backwards"
+testwin "<sort-by>c</sort-by><direction>backwards</direction><limit>2</limit>" "$(y 0)$(y 1)"
+
+# Same number of entries after edit: delete one and add one sorted first
+new "edit-config delete and add entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><y nc:operation=\"delete\"><a>$((nr-2))</a></y><y><a>$nr</a><c>-</c></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "sort-by c after edit"
+testwin "<sort-by>c</sort-by><limit>3</limit>" "<y><a>$nr</a><c>-</c></y>$(y $((nr-1)))$(y $((nr-3)))"
+
+new "offset after edit"
+testwin "<offset>$((nr-2))</offset><limit>5</limit>" "$(y $((nr-1)))<y><a>$nr</a><c>-</c></y>"
+
+new "top-level list offset 8"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:z\" xmlns:ex=\"urn:example:clixon\"/><list-pagination xmlns=\"urn:ietf:params:xml:ns:yang:ietf-list-pagination-nc\"><offset>8</offset></list-pagination></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><z xmlns=\"urn:example:clixon\"><a>8</a></z><z xmlns=\"urn:example:clixon\"><a>9</a></z></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
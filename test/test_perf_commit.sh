@@ -0,0 +1,162 @@
+#!/usr/bin/env bash
+# Commit performance tests
+# Load a large config, then measure commit latency of small changes for
+# different datastore sizes.
+# Small commits should not scale with datastore size since the running cache is
+# synced (not copied) and the diff only traverses changed subtrees (commit journal)
+# Check that small-commit latency of the largest size is at most perfmaxratio times
+# the latency of the smallest size.
+# The write-ahead log is enabled so that edits and commits do not rewrite datastore files
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Datastore sizes (number of list entries)
+: ${perfsizes:="1000 10000 100000"}
+
+# Number of small commits made for each size
+: ${perfreq:=10}
+
+# Max latency ratio between largest and smallest size
+: ${perfmaxratio:=10}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+APPNAME=example
+
+cfg=$dir/perf-commit-conf.xml
+fyang=$dir/scaling.yang
+fconfig=$dir/large.xml
+
+# Each list entry has a sub-container to make unchanged subtrees non-trivial
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+      container z {
+        leaf c {
+          type string;
+        }
+        leaf d {
+          type string;
+        }
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_XMLDB_WAL>true</CLICON_XMLDB_WAL>
+  <CLICON_CLI_MODE>example</CLICON_CLI_MODE>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_LINESCROLLING>0</CLICON_CLI_LINESCROLLING>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+
+for perfnr in $perfsizes; do
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "generate config with $perfnr list entries"
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$perfnr; i++ )); do
+        rpc+="<y><a>$i</a><b>$i</b><z><c>c$i</c><d>d$i</d></z></y>"
+    done
+    rpc+="</x></config></edit-config></rpc>"
+    echo -n "$DEFAULTHELLO" > $fconfig
+    echo "$(chunked_framing "$rpc")" >> $fconfig
+
+    new "netconf write $perfnr entries"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+    new "netconf commit $perfnr entries"
+    expecteof_netconf "time -p $clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" 2>&1 | awk '/real/ {print $2}'
+
+    new "netconf $perfreq small edit+commit with $perfnr entries"
+    for (( i=0; i<$perfreq; i++ )); do
+        rnd=$(( ( RANDOM % $perfnr ) ))
+        rpc=$(chunked_framing "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$rnd</a><z><c>$i</c></z></y></x></config></edit-config></rpc>")
+        echo "$rpc"
+        rpc=$(chunked_framing "<rpc $DEFAULTNS><commit/></rpc>")
+        echo "$rpc"
+    done > $dir/small.xml
+    t0=$(date +%s%N)
+    $clixon_netconf -qe1f $cfg < $dir/small.xml > /dev/null
+    t1=$(date +%s%N)
+    # Latency per commit in microseconds
+    usec=$(( (t1-t0)/1000/perfreq ))
+    echo "$perfnr entries: $usec us/commit"
+    if [ -z "$usec0" ]; then
+        usec0=$usec
+    fi
+
+    new "netconf small delete+commit with $perfnr entries"
+    rnd=$(( ( RANDOM % $perfnr ) ))
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y nc:operation=\"delete\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><a>$rnd</a></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "netconf commit small delete"
+    expecteof_netconf "time -p $clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>" 2>&1 | awk '/real/ {print $2}'
+
+    new "netconf check deleted entry $rnd removed from running"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$rnd]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+    new "netconf discard-changes"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+done
+
+new "small commit latency does not scale with datastore size"
+if [ $usec -gt $((usec0*perfmaxratio)) ]; then
+    err "at most $((usec0*perfmaxratio)) us/commit" "$usec us/commit"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
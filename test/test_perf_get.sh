@@ -0,0 +1,119 @@
+#!/usr/bin/env bash
+# Get performance of large configs
+# Load a large config and measure repeated get-config and get of the whole tree.
+# Each get copies the datastore cache into a transient reply tree which is freed after the
+# reply is sent, see XML_ARENA_GET
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Datastore sizes (number of list entries)
+: ${perfsizes:="1000 10000 50000"}
+
+# Number of gets made for each size
+: ${perfreq:=10}
+
+# time function (this is a mess to get right on freebsd/linux)
+: ${TIMEFN:=time -p} # portability: 2>&1 | awk '/real/ {print $2}'
+if ! $TIMEFN true; then err "A working time function" "'$TIMEFN' does not work"; fi
+
+APPNAME=example
+
+cfg=$dir/perf-get-conf.xml
+fyang=$dir/scaling.yang
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+      leaf c {
+        type string;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_CLI_MODE>example</CLICON_CLI_MODE>
+  <CLICON_CLI_DIR>/usr/local/lib/$APPNAME/cli</CLICON_CLI_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/$APPNAME/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_LINESCROLLING>0</CLICON_CLI_LINESCROLLING>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+
+for perfnr in $perfsizes; do
+    new "generate config with $perfnr list entries"
+    echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+    for (( i=0; i<$perfnr; i++ )); do
+        echo -n "<y><a>$i</a><b>$i</b><c>entry-$i</c></y>" >> $dir/startup_db
+    done
+    echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+
+        new "start backend -s startup -f $cfg"
+        start_backend -s startup -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "netconf get-config check $perfnr entries"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=0]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>0</a><b>0</b><c>entry-0</c></y></x></data></rpc-reply>"
+
+    new "netconf $perfreq get-config with $perfnr entries"
+    { time -p for (( i=0; i<$perfreq; i++ )); do
+        rpc=$(chunked_framing "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>")
+        echo "$rpc"
+    done | $clixon_netconf -qe1f $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+    new "netconf $perfreq get with $perfnr entries"
+    { time -p for (( i=0; i<$perfreq; i++ )); do
+        rpc=$(chunked_framing "<rpc $DEFAULTNS><get/></rpc>")
+        echo "$rpc"
+    done | $clixon_netconf -qe1f $cfg > /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+done
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,134 @@
+#!/usr/bin/env bash
+# Hash table performance test, see clicon_hash
+# Validate a leafref leaf-list referring to all entries of a list, for different list
+# sizes. Leafref target values are collected in a hash table (see leafref-index) and
+# each reference is a hash lookup.
+# The key values k<i> have few distinct character sums. With the former additive hash
+# they were chained in a few buckets of a fixed size table, and validation was quadratic
+# in the number of entries. With FNV-1a and resizable buckets it is linear.
+# Check that validate time per entry of the largest size is at most perfmaxratio times
+# the time per entry of the smallest size.
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries and references
+: ${perfsizes:="1000 10000 50000"}
+
+# Number of validates made for each size
+: ${perfreq:=5}
+
+# Max ratio of validate time per entry between largest and smallest size
+: ${perfmaxratio:=5}
+
+APPNAME=example
+
+cfg=$dir/perf-hash-conf.xml
+fyang=$dir/hash.yang
+fconfig=$dir/large.xml
+
+cat <<EOF > $fyang
+module hash{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+     list y {
+       key name;
+       leaf name {
+         type string;
+       }
+     }
+     leaf-list r {
+       type leafref {
+         path "../y/name";
+       }
+     }
+   }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+
+for perfnr in $perfsizes; do
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+
+        new "start backend -s init -f $cfg"
+        start_backend -s init -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "generate config with $perfnr entries and references"
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">"
+    for (( i=0; i<$perfnr; i++ )); do
+        rpc+="<y><name>k$i</name></y>"
+    done
+    for (( i=0; i<$perfnr; i++ )); do
+        rpc+="<r>k$i</r>"
+    done
+    rpc+="</x></config></edit-config></rpc>"
+    echo -n "$DEFAULTHELLO" > $fconfig
+    echo "$(chunked_framing "$rpc")" >> $fconfig
+
+    new "netconf write $perfnr entries"
+    expecteof_file "$clixon_netconf -qef $cfg" 0 "$fconfig" "^<rpc-reply $DEFAULTNS><ok/></rpc-reply>$"
+
+    new "netconf $perfreq validate with $perfnr references"
+    for (( i=0; i<$perfreq; i++ )); do
+        rpc=$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")
+        echo "$rpc"
+    done > $dir/validate.xml
+    t0=$(date +%s%N)
+    ret=$($clixon_netconf -qe1f $cfg < $dir/validate.xml)
+    t1=$(date +%s%N)
+    if [ $(echo "$ret" | grep -o "<ok/>" | wc -l) -ne $perfreq ]; then
+        err "$perfreq <ok/>" "$ret"
+    fi
+    # Validate time per entry in nanoseconds
+    nsec=$(( (t1-t0)/perfreq/perfnr ))
+    echo "$perfnr entries: $nsec ns/entry"
+    if [ -z "$nsec0" ]; then
+        nsec0=$nsec
+    fi
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        # kill backend
+        stop_backend -f $cfg
+    fi
+done
+
+new "validate time per entry does not scale with number of entries"
+if [ $nsec -gt $((nsec0*perfmaxratio)) ]; then
+    err "at most $((nsec0*perfmaxratio)) ns/entry" "$nsec ns/entry"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
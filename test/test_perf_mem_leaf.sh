@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+# Backend memory per leaf of large lists, using the clixon-lib stats rpc
+# Load a large list of entries with several leafs each and print memory per XML object
+# and per leaf for the running and candidate datastore caches.
+# Baseline (x86-64): element 96 bytes + body 56 bytes + value cbuf per leaf
+# Compact XML nodes: element 72 bytes + body 64 bytes (short values inline)
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+clixon_util_xpath=clixon_util_xpath
+
+# Number of list entries
+: ${perfnr:=20000}
+
+# Number of leafs per list entry (excluding key)
+nleaf=4
+
+APPNAME=example
+
+cfg=$dir/mem-leaf-conf.xml
+fyang=$dir/scaling.yang
+pidfile=$dir/pidfile
+
+cat <<EOF > $fyang
+module scaling{
+   yang-version 1.1;
+   namespace "urn:example:clixon";
+   prefix ex;
+   container x {
+    list y {
+      key "a";
+      leaf a {
+        type int32;
+      }
+      leaf b {
+        type int32;
+      }
+      leaf c {
+        type string;
+      }
+      leaf d {
+        type string;
+      }
+      leaf e {
+        type boolean;
+      }
+    }
+  }
+}
+EOF
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_FEATURE>ietf-netconf:startup</CLICON_FEATURE>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>$pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_CLI_MODE>example</CLICON_CLI_MODE>
+  <CLICON_CLI_DIR>/usr/local/lib/example/cli</CLICON_CLI_DIR>
+  <CLICON_CLISPEC_DIR>/usr/local/lib/example/clispec</CLICON_CLISPEC_DIR>
+  <CLICON_CLI_LINESCROLLING>0</CLICON_CLI_LINESCROLLING>
+</clixon-config>
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "generate config with $perfnr list entries"
+    echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+    for (( i=0; i<$perfnr; i++ )); do
+        # c is a short string, d is longer than inline values
+        echo -n "<y><a>$i</a><b>$i</b><c>c$i</c><d>a-long-description-of-entry-$i</d><e>true</e></y>" >> $dir/startup_db
+    done
+    echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "netconf get stats"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")
+res=$(echo "$DEFAULTHELLO$rpc" | $clixon_netconf -qef $cfg)
+err0=$(echo "$res" | $clixon_util_xpath -p "/rpc-reply/rpc-error")
+err=${err0#"nodeset:"}
+if [ -n "$err" ]; then
+    err1 "<rpc-reply><global>" "$err"
+fi
+
+# Each leaf is one element and one body object
+nleafs=$(( $perfnr * ($nleaf + 1) ))
+for db in running candidate; do
+    resdb0=$(echo "$res" | $clixon_util_xpath -p "/rpc-reply/datastores/datastore[name=\"$db\"]")
+    resdb=${resdb0#"nodeset:0:"}
+    if [ "$resdb0" = "$resdb" ]; then
+        err1 "nodeset:0:" "$resdb0"
+    fi
+    nr=$(echo $resdb | $clixon_util_xpath -p "datastore/nr" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}')
+    size=$(echo $resdb | $clixon_util_xpath -p "datastore/size" | awk -F ">" '{print $2}' | awk -F "<" '{print $1}')
+    echo "$db"
+    echo "   objects: $nr"
+    echo "   mem: $(( $size / 1000000 ))M"
+    echo "   bytes per object: $(( $size / $nr ))"
+    echo "   bytes per leaf: $(( $size / $nleafs ))"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
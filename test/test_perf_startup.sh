@@ -1,7 +1,7 @@
 #!/usr/bin/env bash
 # Startup performance tests for different formats and startup modes.
 # Generate file in different formats:
-# xml, xml pretty-printed, xml with prefixes, json
+# xml, xml pretty-printed, xml with prefixes, json, binary
 
 # Magic line must be first in script (see README.md)
 s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
@@ -159,6 +159,19 @@ for variant in prefix plain pretty; do
     { time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
 done
 
+# Binary format: first startup imports the xml file and saves running in binary,
+# second startup loads the binary file without parsing, binding or sorting
+format=binary
+sudo rm -f $sdb
+cp $sx $sdb
+new "Startup $format import xml"
+{ time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
+sudo cp $dir/running_db $sdb
+sudo chmod 666 $sdb
+new "Startup $format"
+{ time -p sudo $clixon_backend -F1 -D $DBG -s $mode -f $cfg -y $fyang -o CLICON_XMLDB_FORMAT=$format 2> /dev/null; } 2>&1 | awk '/real/ {print $2}'
+
 rm -rf $dir
 
 new "endtest"
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# YANG lookup micro-benchmark
+# Parse and bind XML to a YANG container with a large number of children.
+# Each XML node is bound with yang_find_datanode/yang_find_schemanode in its parent
+# which should not scale with the number of yang children (see YANG_CHILD_INDEX)
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml"}
+
+# Number of yang children (leafs) in container
+: ${perfnr:=5000}
+
+# Number of times every leaf is set in the XML
+: ${perfreq:=10}
+
+fyang=$dir/wide.yang
+fxml=$dir/wide.xml
+
+new "generate yang with $perfnr leafs"
+echo "module wide{" > $fyang
+echo "   yang-version 1.1;" >> $fyang
+echo "   namespace \"urn:example:clixon\";" >> $fyang
+echo "   prefix ex;" >> $fyang
+echo "   container x {" >> $fyang
+echo "     list y {" >> $fyang
+echo "       key k;" >> $fyang
+echo "       leaf k {" >> $fyang
+echo "         type int32;" >> $fyang
+echo "       }" >> $fyang
+for (( i=0; i<$perfnr; i++ )); do
+    echo "       leaf l$i {" >> $fyang
+    echo "         type int32;" >> $fyang
+    echo "       }" >> $fyang
+done
+echo "     }" >> $fyang
+echo "   }" >> $fyang
+echo "}" >> $fyang
+
+new "generate xml with $perfreq x $perfnr leafs"
+echo -n "<x xmlns=\"urn:example:clixon\">" > $fxml
+for (( j=0; j<$perfreq; j++ )); do
+    echo -n "<y><k>$j</k>" >> $fxml
+    for (( i=0; i<$perfnr; i++ )); do
+        echo -n "<l$i>$i</l$i>" >> $fxml
+    done
+    echo "</y>" >> $fxml
+done
+echo "</x>" >> $fxml
+
+new "xml parse and bind $perfreq x $perfnr leafs"
+expecteof_file "time -p $clixon_util_xml -y $fyang" 0 "$fxml" 2>&1 | awk '/real/ {print $2}'
+
+new "xml parse, bind and validate $perfreq x $perfnr leafs"
+expecteof_file "time -p $clixon_util_xml -vy $fyang" 0 "$fxml" 2>&1 | awk '/real/ {print $2}'
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,159 @@
+#!/usr/bin/env bash
+# Backend replies larger than the stream buffer are sent to clients in chunks while serialized
+# See REPLY_STREAM_BUFSIZE
+# 1. Large get-config and get replies are complete and well-formed
+# 2. Several large replies in one session are framed in order
+# 3. Small replies and edits after a streamed reply
+# 4. Empty data reply after a streamed reply in one session
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries, each about 60 bytes, ie several stream chunks
+: ${nr:=5000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf c {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+new "generate config with $nr list entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><c>entry-$i-abcdefghijklmnopqrstuvwxyz</c></y>" >> $dir/startup_db
+done
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Send rpcs in one netconf session and check replies
+# 1: rpc
+# 2: number of times rpc is sent
+function checkreplies()
+{
+    rpc=$1
+    n=$2
+
+    msgs=""
+    for (( j=0; j<$n; j++ )); do
+        msgs="$msgs$(chunked_framing "<rpc $DEFAULTNS message-id=\"$j\">$rpc</rpc>")"
+    done
+    ret=$($clixon_netconf -qf $cfg <<EOF
+$DEFAULTHELLO$msgs
+EOF
+       )
+    r=$?
+    if [ $r -ne 0 ]; then
+        err "0" "$r"
+    fi
+    count=$(echo "$ret" | grep -o "<y><a>[0-9]*</a><c>entry-[0-9]*-abcdefghijklmnopqrstuvwxyz</c></y>" | wc -l)
+    if [ $count -ne $((n*nr)) ]; then
+        err "$((n*nr)) entries" "$count"
+    fi
+    count=$(echo "$ret" | grep -o "</x></data></rpc-reply>" | wc -l)
+    if [ $count -ne $n ]; then
+        err "$n replies" "$count"
+    fi
+    for (( j=0; j<$n; j++ )); do
+        match=$(echo "$ret" | grep -o "<rpc-reply $DEFAULTNS message-id=\"$j\"><data><x xmlns=\"urn:example:clixon\"><y><a>0</a>")
+        if [ -z "$match" ]; then
+            err "reply $j" "$(echo "$ret" | head -c 1000)"
+        fi
+    done
+}
+
+new "netconf get-config $nr entries"
+checkreplies "<get-config><source><running/></source></get-config>" 1
+
+new "netconf get $nr entries"
+checkreplies "<get><filter type=\"xpath\" select=\"/ex:x\" xmlns:ex=\"urn:example:clixon\"/></get>" 1
+
+new "netconf three get-config in one session"
+checkreplies "<get-config><source><running/></source></get-config>" 3
+
+new "netconf small get-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=42]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>42</a><c>entry-42-abcdefghijklmnopqrstuvwxyz</c></y></x></data></rpc-reply>"
+
+new "netconf empty data reply after streamed reply"
+msgs="$(chunked_framing "<rpc $DEFAULTNS message-id=\"0\"><get-config><source><running/></source></get-config></rpc>")"
+msgs="$msgs$(chunked_framing "<rpc $DEFAULTNS message-id=\"1\"><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=-1]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>")"
+ret=$($clixon_netconf -qf $cfg <<EOF
+$DEFAULTHELLO$msgs
+EOF
+   )
+r=$?
+if [ $r -ne 0 ]; then
+    err "0" "$r"
+fi
+match=$(echo "$ret" | grep -o "<rpc-reply $DEFAULTNS message-id=\"1\"><data/></rpc-reply>")
+if [ -z "$match" ]; then
+    err "<rpc-reply $DEFAULTNS message-id=\"1\"><data/></rpc-reply>" "$(echo "$ret" | tail -c 1000)"
+fi
+
+new "netconf edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>42</a><c>changed</c></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "netconf get-config changed entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=42]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>42</a><c>changed</c></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,207 @@
+#!/usr/bin/env bash
+# Asynchronous state data callbacks
+# The main example registers two asynchronous state callbacks that reply after a delay, as if
+# retrieved from dataplane daemons. They are called concurrently so a get takes about one delay,
+# not two, and other sessions are served meanwhile. Callbacks not done before the deadline
+# CLICON_STATE_ASYNC_TIMEOUT are left out of the reply.
+# See clixon_plugin_statedata_async_register
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Delay of asynchronous state callbacks in ms
+: ${delay:=1000}
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+# Create config
+# 1: deadline of asynchronous callbacks in ms
+function config()
+{
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+  <CLICON_STATE_ASYNC_TIMEOUT>$1</CLICON_STATE_ASYNC_TIMEOUT>
+</clixon-config>
+EOF
+}
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container state {
+        config false;
+        leaf-list op {
+            type int32;
+        }
+    }
+    container other {
+        leaf v {
+            type int32;
+        }
+    }
+}
+EOF
+
+# Get state callback counter from stats rpc
+# 1: async-calls or async-timeouts
+function counter()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<state-callbacks[^>]*>.*<$1>\([0-9]*\)<\/$1>.*<\/state-callbacks>.*/\1/p"
+}
+
+# Framed rpc of a netconf session
+# 1: rpc body
+function rpc()
+{
+    chunked_framing "<rpc $DEFAULTNS>$1</rpc>"
+}
+
+getstate="<get><filter type=\"xpath\" select=\"/ex:state\" xmlns:ex=\"urn:example:clixon\"/></get>"
+getother="<get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:other\" xmlns:ex=\"urn:example:clixon\"/></get-config>"
+
+new "test params: -f $cfg"
+
+config $(( delay*3 ))
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -s -A $delay"
+    start_backend -s init -f $cfg -- -s -A $delay
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><other xmlns=\"urn:example:clixon\"><v>7</v></other></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+n0=$(counter async-calls)
+
+new "get state of synchronous and both asynchronous callbacks"
+t0=$(date +%s%N)
+ret=$(echo "$DEFAULTHELLO$(rpc "$getstate")" | $clixon_netconf -qf $cfg)
+t1=$(date +%s%N)
+for op in 42 44 45; do
+    if [ -z "$(echo "$ret" | grep "<op>$op</op>")" ]; then
+        err "<op>$op</op>" "$ret"
+    fi
+done
+ms=$(( (t1-t0)/1000000 ))
+echo "get with two asynchronous callbacks of ${delay}ms: ${ms}ms"
+
+new "asynchronous callbacks called concurrently"
+if [ $ms -ge $(( delay*2 )) ]; then
+    err "< $(( delay*2 ))ms" "${ms}ms"
+fi
+
+new "two asynchronous callbacks called"
+n1=$(counter async-calls)
+if [ -z "$n0" ] || [ -z "$n1" ] || [ $n1 -ne $(( n0+2 )) ]; then
+    err "$(( n0+2 ))" "$n1"
+fi
+
+new "other subtree: asynchronous callbacks not called"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"/ex:other\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>" "" "<rpc-reply $DEFAULTNS><data><other xmlns=\"urn:example:clixon\"><v>7</v></other></data></rpc-reply>"
+n2=$(counter async-calls)
+if [ "$n2" != "$n1" ]; then
+    err "$n1" "$n2"
+fi
+
+new "start get of state in background"
+echo "$DEFAULTHELLO$(rpc "$getstate")" | $clixon_netconf -qf $cfg > $dir/state.xml &
+pid=$!
+sleep 0.2
+
+new "other session served while asynchronous callbacks pending"
+t0=$(date +%s%N)
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getother</rpc>" "" "<rpc-reply $DEFAULTNS><data><other xmlns=\"urn:example:clixon\"><v>7</v></other></data></rpc-reply>"
+t1=$(date +%s%N)
+ms=$(( (t1-t0)/1000000 ))
+if [ $ms -ge $delay ]; then
+    err "< ${delay}ms" "${ms}ms"
+fi
+
+new "wait for get of state"
+wait $pid
+if [ -z "$(grep "<op>45</op>" $dir/state.xml)" ]; then
+    err "<op>45</op>" "$(cat $dir/state.xml)"
+fi
+
+new "pipelined get of state and get-config in one session, replies in order"
+ret=$(echo "$DEFAULTHELLO$(rpc "$getstate")$(rpc "$getother")" | $clixon_netconf -qf $cfg)
+order=$(echo "$ret" | grep -o "<op>44</op>\|<v>7</v>" | tr -d '\n')
+if [ "$order" != "<op>44</op><v>7</v>" ]; then
+    err "<op>44</op><v>7</v>" "$ret"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    stop_backend -f $cfg
+fi
+
+new "deadline before asynchronous callbacks are done"
+config $(( delay/4 ))
+if [ $BE -ne 0 ]; then
+    new "start backend -s init -f $cfg -- -s -A $delay"
+    start_backend -s init -f $cfg -- -s -A $delay
+fi
+
+new "wait backend"
+wait_backend
+
+n0=$(counter async-timeouts)
+
+new "get state: only synchronous state"
+ret=$(echo "$DEFAULTHELLO$(rpc "$getstate")" | $clixon_netconf -qf $cfg)
+if [ -z "$(echo "$ret" | grep "<op>42</op>")" ]; then
+    err "<op>42</op>" "$ret"
+fi
+if [ -n "$(echo "$ret" | grep "<op>44</op>")" ]; then
+    err "no <op>44</op>" "$ret"
+fi
+
+new "two asynchronous callbacks timed out"
+n1=$(counter async-timeouts)
+if [ -z "$n0" ] || [ -z "$n1" ] || [ $n1 -ne $(( n0+2 )) ]; then
+    err "$(( n0+2 ))" "$n1"
+fi
+
+new "late replies are discarded"
+sleep $(( delay/1000 + 1 ))
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS>$getother</rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,184 @@
+#!/usr/bin/env bash
+# Cache of state data with a time-to-live
+# A state container is marked with the state-cache-ttl extension. Repeated gets of the container
+# are served from the cache without calling the state callback of the main example, until the
+# time-to-live expires. Check state replies and cache counters in the stats rpc.
+# Then restart with read workers and all state cached, and check that the state of a get of
+# the whole tree, which may otherwise be served by a worker, is cached by the backend.
+# See clixon_plugin_statedata_cache_register and STATE_CACHE_SIZE
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+# Time-to-live in ms
+: ${ttl:=1000}
+
+cfg=$dir/conf_yang.xml
+cfgw=$dir/conf_workers.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+sed "s#</clixon-config>#  <CLICON_BACKEND_READ_WORKERS>2</CLICON_BACKEND_READ_WORKERS>\n</clixon-config>#;s#<CLICON_CONFIGFILE>$cfg#<CLICON_CONFIGFILE>$cfgw#" $cfg > $cfgw
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    import clixon-lib {
+        prefix cl;
+    }
+    container state {
+        config false;
+        cl:state-cache-ttl $ttl;
+        leaf-list op {
+            type int32;
+        }
+    }
+    container other {
+        leaf v {
+            type int32;
+        }
+    }
+}
+EOF
+
+# Get state cache counter from stats rpc
+# 1: hits, misses, stale or entries
+function counter()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<state-cache[^>]*>.*<$1>\([0-9]*\)<\/$1>.*<\/state-cache>.*/\1/p"
+}
+
+# Get with filter and check reply and counters
+# 1: xpath filter, or empty for the whole tree
+# 2: expected reply pattern
+# 3: counter expected to increase: hits, misses or stale
+function testget()
+{
+    n0=$(counter $3)
+    new "get $1"
+    if [ -n "$1" ]; then
+        rpc="<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>"
+    else
+        rpc="<rpc $DEFAULTNS><get/></rpc>"
+    fi
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "$rpc")" | $clixon_netconf -qf $cfg)
+    match=$(echo "$ret" | grep -o "$2")
+    if [ -z "$match" ]; then
+        err "$2" "$ret"
+    fi
+    new "$3 increased"
+    n1=$(counter $3)
+    if [ -z "$n0" ] || [ -z "$n1" ] || [ $n1 -le $n0 ]; then
+        err "$3 > $n0" "$n1"
+    fi
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -s"
+    start_backend -s init -f $cfg -- -s
+fi
+
+new "wait backend"
+wait_backend
+
+new "first get: not in cache"
+testget "/ex:state" "<op>42</op>" misses
+
+new "second get: from cache"
+testget "/ex:state" "<op>42</op>" hits
+
+new "node in cached subtree: not in cache"
+testget "/ex:state/ex:op" "<op>42</op>" misses
+
+new "node in cached subtree: from cache"
+testget "/ex:state/ex:op" "<op>42</op>" hits
+
+new "cache entries"
+n=$(counter entries)
+if [ -z "$n" ] || [ $n -lt 2 ]; then
+    err "entries >= 2" "$n"
+fi
+
+new "wait for time-to-live to expire"
+sleep $(( ttl/1000 + 1 ))
+
+new "get after time-to-live: stale"
+testget "/ex:state" "<op>42</op>" stale
+
+new "get again: from cache"
+testget "/ex:state" "<op>42</op>" hits
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+cfg0=$cfg
+cfg=$cfgw
+
+if [ $BE -ne 0 ]; then
+    new "start backend with read workers -s init -f $cfg -- -s -C 60000"
+    start_backend -s init -f $cfg -- -s -C 60000
+fi
+
+new "wait backend"
+wait_backend
+
+new "get whole tree with read workers: not in cache"
+testget "" "<op>42</op>" misses
+
+new "get whole tree with read workers: from cache"
+testget "" "<op>42</op>" hits
+
+new "get-config whole tree with read workers"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "get whole tree after get-config: from cache"
+testget "" "<op>42</op>" hits
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+cfg=$cfg0
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# State data callbacks routed by registered subtrees
+# The main example registers the subtrees of its state data callback. The callback is called
+# only for requests intersecting a registered subtree, and for requests that are not a plain
+# absolute path. Check state replies and call/skip counters in the stats rpc.
+# See clixon_plugin_statedata_register
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_BACKEND_DIR>/usr/local/lib/$APPNAME/backend</CLICON_BACKEND_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_YANG_LIBRARY>false</CLICON_YANG_LIBRARY>
+  <CLICON_NETCONF_MONITORING>false</CLICON_NETCONF_MONITORING>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container state {
+        config false;
+        leaf-list op {
+            type int32;
+        }
+    }
+    container other {
+        leaf v {
+            type int32;
+        }
+    }
+}
+EOF
+
+# Get state callback counters from stats rpc
+# 1: calls or skipped
+function counter()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n "s/.*<state-callbacks[^>]*>.*<$1>\([0-9]*\)<\/$1>.*<\/state-callbacks>.*/\1/p"
+}
+
+# Get with filter and check reply and counters
+# 1: xpath filter
+# 2: expected reply pattern
+# 3: counter expected to increase: calls or skipped
+function testget()
+{
+    n0=$(counter $3)
+    new "get $1"
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><get><filter type=\"xpath\" select=\"$1\" xmlns:ex=\"urn:example:clixon\"/></get></rpc>")" | $clixon_netconf -qf $cfg)
+    match=$(echo "$ret" | grep -o "$2")
+    if [ -z "$match" ]; then
+        err "$2" "$ret"
+    fi
+    new "$3 increased"
+    n1=$(counter $3)
+    if [ -z "$n0" ] || [ -z "$n1" ] || [ $n1 -le $n0 ]; then
+        err "$3 > $n0" "$n1"
+    fi
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg -- -s"
+    start_backend -s init -f $cfg -- -s
+fi
+
+new "wait backend"
+wait_backend
+
+new "edit-config"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><other xmlns=\"urn:example:clixon\"><v>7</v></other></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "state subtree: callback called"
+testget "/ex:state" "<op>42</op>" calls
+
+new "node in state subtree: callback called"
+testget "/ex:state/ex:op" "<op>42</op>" calls
+
+new "other subtree: callback skipped"
+testget "/ex:other" "<data><other xmlns=\"urn:example:clixon\"><v>7</v></other></data>" skipped
+
+new "all: callback called"
+testget "/" "<op>42</op>" calls
+
+new "descendant path: callback called"
+testget "//ex:op" "<op>42</op>" calls
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,170 @@
+#!/usr/bin/env bash
+# Incremental must/when validation
+# must and when statements of unchanged nodes are evaluated only if their xpath depends on a
+# node changed by the transaction. Check that unaffected statements are skipped, and that
+# affected statements of unchanged nodes are evaluated and give errors.
+# A must using the value of a container is evaluated when a descendant changes.
+# See CLICON_VALIDATE_INCREMENTAL and xpath_deps
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries
+: ${nr:=1000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_VALIDATE_INCREMENTAL>true</CLICON_VALIDATE_INCREMENTAL>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        leaf max {
+            type int32;
+        }
+        leaf other {
+            type string;
+        }
+        list y {
+            key a;
+            leaf a {
+                type int32;
+                must ". < ../../max" {
+                    error-message "a too large";
+                }
+            }
+            leaf b {
+                type string;
+            }
+            leaf c {
+                when "../b = 'yes'";
+                type string;
+            }
+        }
+        container z {
+            must "string(.) != 'bad'" {
+                error-message "z is bad";
+            }
+            container w {
+                leaf v {
+                    type string;
+                }
+            }
+        }
+    }
+}
+EOF
+
+new "generate config with $nr entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\"><max>$((nr+10))</max><z><w><v>ok</v></w></z>" > $dir/startup_db
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><b>yes</b><c>c$i</c></y>"
+done >> $dir/startup_db
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup_db
+
+# Get number of skipped must/when statements from stats rpc
+function skipped()
+{
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")" | $clixon_netconf -qf $cfg)
+    echo "$ret" | sed -n 's/.*<constraints[^>]*><evaluated>[0-9]*<\/evaluated><skipped>\([0-9]*\)<\/skipped>.*/\1/p'
+}
+
+# Edit candidate and validate
+# 1: config of x
+# 2: expected reply
+function testvalidate()
+{
+    new "edit-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">$1</x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate"
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")" | $clixon_netconf -qf $cfg)
+    match=$(echo "$ret" | grep -o "$2")
+    if [ -z "$match" ]; then
+        err "$2" "$ret"
+    fi
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+s0=$(skipped)
+if [ -z "$s0" ]; then
+    err "skipped" "$ret"
+fi
+
+new "edit-config of unrelated leaf"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><other>foo</other></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "must and when of unchanged entries skipped"
+s1=$(skipped)
+if [ -z "$s1" ] || [ $((s1-s0)) -lt $((2*nr)) ]; then
+    err "skipped >= $((2*nr))" "$s0 $s1"
+fi
+
+new "decrease max: must of unchanged entries fails"
+testvalidate "<max>$((nr-5))</max>" "a too large"
+
+new "change b: when of unchanged sibling fails"
+testvalidate "<y><a>5</a><b>no</b></y>" "Failed WHEN condition of c"
+
+new "change descendant: must of unchanged container fails"
+testvalidate "<z><w><v>bad</v></w></z>" "z is bad"
+
+new "add entry with too large key"
+testvalidate "<y><a>$((nr+10))</a></y>" "a too large"
+
+new "add entry with valid key"
+testvalidate "<y><a>$((nr+9))</a><b>yes</b><c>c</c></y>" "<ok/>"
+
+new "get-config of entry"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=5]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>5</a><b>yes</b><c>c5</c></y></x></data></rpc-reply>"
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
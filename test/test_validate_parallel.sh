@@ -0,0 +1,160 @@
+#!/usr/bin/env bash
+# Parallel validation of large datastores
+# Validate and commit a large config with leafrefs, must and unique, serially and with workers.
+# Errors of parallel validation are the same as of serial validation, also with several
+# errors in different partitions of the tree: the first in serial order is reported.
+# See CLICON_VALIDATE_WORKERS and VALIDATE_PARALLEL_MIN
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of list entries, should be larger than VALIDATE_PARALLEL_MIN
+: ${nr:=20000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list z {
+            key name;
+            leaf name {
+                type string;
+            }
+        }
+        list y {
+            key a;
+            unique "u";
+            leaf a {
+                type int32;
+            }
+            leaf r {
+                type leafref {
+                    path "../../z/name";
+                }
+            }
+            leaf u {
+                type int32;
+            }
+            leaf m {
+                type int32;
+                must ". < 1000000" {
+                    error-message "m too large";
+                }
+            }
+        }
+    }
+}
+EOF
+
+new "generate config with $nr list entries"
+echo -n "<${DATASTORE_TOP}><x xmlns=\"urn:example:clixon\">" > $dir/startup0
+for (( i=0; i<10; i++ )); do
+    echo -n "<z><name>z$i</name></z>"
+done >> $dir/startup0
+for (( i=0; i<$nr; i++ )); do
+    echo -n "<y><a>$i</a><r>z$((i%10))</r><u>$i</u><m>$i</m></y>"
+done >> $dir/startup0
+echo "</x></${DATASTORE_TOP}>" >> $dir/startup0
+
+# Edit candidate and validate
+# 1: config of x
+# 2: expected reply
+function testvalidate()
+{
+    new "edit-config"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">$1</x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "validate"
+    ret=$(echo "$DEFAULTHELLO$(chunked_framing "<rpc $DEFAULTNS><validate><source><candidate/></source></validate></rpc>")" | $clixon_netconf -qf $cfg)
+    match=$(echo "$ret" | grep -o "$2")
+    if [ -z "$match" ]; then
+        err "$2" "$ret"
+    fi
+    echo "$ret" >> $dir/reply$workers
+
+    new "discard-changes"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><discard-changes/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+for workers in 0 4; do
+    cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+  <CLICON_VALIDATE_WORKERS>$workers</CLICON_VALIDATE_WORKERS>
+</clixon-config>
+EOF
+    cp $dir/startup0 $dir/startup_db
+    rm -f $dir/reply$workers
+
+    new "test params: -f $cfg workers: $workers"
+
+    if [ $BE -ne 0 ]; then
+        new "kill old backend"
+        sudo clixon_backend -zf $cfg
+        if [ $? -ne 0 ]; then
+            err
+        fi
+        new "start backend -s startup -f $cfg"
+        start_backend -s startup -f $cfg
+    fi
+
+    new "wait backend"
+    wait_backend
+
+    new "validate valid config"
+    testvalidate "<y><a>$nr</a><r>z1</r></y>" "<ok/>"
+
+    new "leafref errors early and late in list, first is reported"
+    testvalidate "<y><a>100</a><r>bad100</r></y><y><a>$((nr-5))</a><r>bad$((nr-5))</r></y>" "bad100"
+
+    new "must error late and leafref error early in list"
+    testvalidate "<y><a>50</a><r>bad50</r></y><y><a>$((nr-10))</a><m>2000000</m></y>" "bad50"
+
+    new "must error late in list"
+    testvalidate "<y><a>$((nr-10))</a><m>2000000</m></y>" "m too large"
+
+    new "unique error"
+    testvalidate "<y><a>$((nr-1))</a><u>7</u></y>" "data-not-unique"
+
+    new "edit-config and commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>$nr</a><r>z2</r></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get-config committed entry"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=$nr]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>$nr</a><r>z2</r></y></x></data></rpc-reply>"
+
+    if [ $BE -ne 0 ]; then
+        new "Kill backend"
+        # Check if premature kill
+        pid=$(pgrep -u root -f clixon_backend)
+        if [ -z "$pid" ]; then
+            err "backend already dead"
+        fi
+        stop_backend -f $cfg
+    fi
+done
+
+new "parallel validation errors same as serial"
+if ! cmp -s $dir/reply0 $dir/reply4; then
+    err "$(cat $dir/reply0)" "$(cat $dir/reply4)"
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
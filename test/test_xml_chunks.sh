@@ -0,0 +1,215 @@
+#!/usr/bin/env bash
+# Chunked child vectors of large lists, see XML_CHILD_CHUNKS
+# A list with more than XML_CHILDVEC_CHUNK_THRESHOLD entries is converted to chunks on the
+# first insert or remove in the middle. Chunks are XML_CHILDVEC_CHUNK_SIZE(512) and
+# filled to 3/4 (384) when converted.
+# Check insert, delete and lookup at chunk boundaries, chunk split and merge:
+# 1. Load even keys, commit
+# 2. Insert first, at first chunk boundary, and enough in one chunk to split it
+# 3. Delete more than a chunk, and the inserted keys, so that chunks are removed and merged
+# 4. Append and insert at the end
+# After each step the whole list and some boundary entries are checked
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+# Number of initial list entries, larger than XML_CHILDVEC_CHUNK_THRESHOLD
+: ${nr:=6000}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fkeys=$dir/keys
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key k;
+            leaf k {
+                type uint32;
+            }
+            leaf v {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Edit-config of keys in $1 (space-separated), optionally with operation $2
+function editkeys()
+{
+    keys=$1
+    op=$2
+    rpc="<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\">"
+    for k in $keys; do
+        if [ -n "$op" ]; then
+            rpc+="<y nc:operation=\"$op\"><k>$k</k></y>"
+        else
+            rpc+="<y><k>$k</k><v>v$k</v></y>"
+        fi
+    done
+    rpc+="</x></config></edit-config></rpc>"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "$rpc" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+}
+
+# Check whole list of datastore $1 against the keys in $fkeys
+function checkall()
+{
+    db=$1
+    reply=""
+    for k in $(sort -n $fkeys); do
+        reply+="<y><k>$k</k><v>v$k</v></y>"
+    done
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><$db/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\">$reply</x></data></rpc-reply>"
+}
+
+# Lookup key $2 in datastore $1, $3 is 1 if it exists
+function checkkey()
+{
+    db=$1
+    k=$2
+    if [ $3 -eq 1 ]; then
+        reply="<data><x xmlns=\"urn:example:clixon\"><y><k>$k</k><v>v$k</v></y></x></data>"
+    else
+        reply="<data/>"
+    fi
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><$db/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:k=$k]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$reply</rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+# Even keys 10, 12, .. Index i has key 10+2i
+seq 10 2 $((10+2*(nr-1))) > $fkeys
+last=$((10+2*(nr-1)))
+
+new "load $nr entries"
+editkeys "$(cat $fkeys)"
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check all"
+checkall candidate
+
+# First chunk is index 0..383, ie keys 10..776, second chunk from 778
+new "insert first entry, converts to chunks"
+editkeys "1"
+echo 1 >> $fkeys
+
+new "insert at end of first chunk and start of second"
+editkeys "775 777"
+echo 775 >> $fkeys
+echo 777 >> $fkeys
+
+# 300 entries in second chunk of 384, it is split
+ins=$(seq 779 2 1377)
+new "insert 300 entries in second chunk, split"
+editkeys "$ins"
+echo "$ins" >> $fkeys
+
+new "check all after inserts"
+checkall candidate
+
+for k in 1 10 775 776 777 778 779 1377 1378 1379 $last; do
+    new "lookup $k after inserts"
+    if grep -qx $k $fkeys; then
+        checkkey candidate $k 1
+    else
+        checkkey candidate $k 0
+    fi
+done
+
+# More than a chunk
+del=$(seq 2000 2 2800)
+new "delete 401 entries, chunks removed and merged"
+editkeys "$del" delete
+for k in $del; do
+    sed -i "/^$k\$/d" $fkeys
+done
+
+new "delete inserted entries"
+editkeys "1 775 777 $ins" delete
+for k in 1 775 777 $ins; do
+    sed -i "/^$k\$/d" $fkeys
+done
+
+new "check all after deletes"
+checkall candidate
+
+for k in 1 10 776 777 778 1998 2000 2800 2802 $last; do
+    new "lookup $k after deletes"
+    if grep -qx $k $fkeys; then
+        checkkey candidate $k 1
+    else
+        checkkey candidate $k 0
+    fi
+done
+
+new "append and insert at end"
+editkeys "$((last+2)) $((last-1))"
+echo $((last+2)) >> $fkeys
+echo $((last-1)) >> $fkeys
+
+new "commit"
+expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "check all candidate"
+checkall candidate
+
+new "check all running"
+checkall running
+
+for k in $((last-1)) $last $((last+1)) $((last+2)); do
+    new "lookup $k at end"
+    if grep -qx $k $fkeys; then
+        checkkey running $k 1
+    else
+        checkkey running $k 0
+    fi
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
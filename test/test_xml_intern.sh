@@ -0,0 +1,143 @@
+#!/usr/bin/env bash
+# Interned XML element names and prefixes, see clixon_str_intern
+# Names and prefixes are shared by all nodes and reference counted.
+# - Same name with different prefixes and namespaces
+# - Names released when all nodes are deleted, and interned again when re-added
+# - Commit sync comparing names of candidate and running by pointer
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml -D $DBG"}
+
+# Number of list entries
+: ${nr:=100}
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+fyang2=$dir/example2.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_DIR>$dir</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_DIR>$dir</CLICON_YANG_MAIN_DIR>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XMLDB_PRETTY>false</CLICON_XMLDB_PRETTY>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container x {
+        list y {
+            key a;
+            leaf a {
+                type int32;
+            }
+            leaf b {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+# Augments leaf b with same name as in example
+cat <<EOF > $fyang2
+module example2 {
+    yang-version 1.1;
+    namespace "urn:example:clixon2";
+    prefix ex2;
+    import example {
+        prefix ex;
+    }
+    augment "/ex:x/ex:y" {
+        leaf b {
+            type string;
+        }
+    }
+}
+EOF
+
+new "xml same name with and without prefix"
+expecteof "$clixon_util_xml -o" 0 '<a xmlns:p="urn:p"><p:b>1</p:b><b>2</b><p:b>3</p:b></a>' '^<a xmlns:p="urn:p"><p:b>1</p:b><b>2</b><p:b>3</p:b></a>$'
+
+new "xml prefix and name equal"
+expecteof "$clixon_util_xml -o" 0 '<a xmlns:b="urn:b"><b:b>1</b:b><b>2</b></a>' '^<a xmlns:b="urn:b"><b:b>1</b:b><b>2</b></a>$'
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s init -f $cfg"
+    start_backend -s init -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+entries=""
+for (( i=0; i<$nr; i++ )); do
+    entries+="<y><a>$i</a><b>b$i</b><ex2:b xmlns:ex2=\"urn:example:clixon2\">c$i</ex2:b></y>"
+done
+reply=""
+for (( i=0; i<$nr; i++ )); do
+    reply+="<y><a>$i</a><b>b$i</b><b xmlns=\"urn:example:clixon2\">c$i</b></y>"
+done
+
+for round in 1 2; do
+    new "add $nr entries with leafs b of both modules, round $round"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\">$entries</x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get-config running"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\">$reply</x></data></rpc-reply>"
+
+    new "change leaf b of example2 in entry 1"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\"><y><a>1</a><b xmlns=\"urn:example:clixon2\">new</b></y></x></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get-config entry 1, only leaf b of example2 changed"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:x/ex:y[ex:a=1]\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><x xmlns=\"urn:example:clixon\"><y><a>1</a><b>b1</b><b xmlns=\"urn:example:clixon2\">new</b></y></x></data></rpc-reply>"
+
+    new "delete all entries, round $round"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><x xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\" nc:operation=\"delete\"/></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "commit"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+    new "get-config running empty"
+    expecteof_netconf "$clixon_netconf -qef $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
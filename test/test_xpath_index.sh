@@ -0,0 +1,134 @@
+#!/usr/bin/env bash
+# Adaptive search indexes for xpath predicates on non-key leaves
+# See CLICON_XPATH_INDEX_THRESHOLD
+# 1. Lookup on a non-key leaf until it becomes an index, check result is same before and after
+# 2. Modify index leaf values, add and delete list entries and check index is maintained
+# 3. Check hit/miss counters in stats rpc
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+# Number of lookups before index is created
+threshold=3
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+  <CLICON_XPATH_INDEX_THRESHOLD>$threshold</CLICON_XPATH_INDEX_THRESHOLD>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container interfaces{
+        list interface{
+            key name;
+            leaf name{
+                type string;
+            }
+            leaf type{
+                type string;
+            }
+            leaf mtu{
+                type uint32;
+            }
+        }
+    }
+}
+EOF
+
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <interfaces xmlns="urn:example:clixon">
+      <interface><name>e0</name><type>eth</type></interface>
+      <interface><name>e1</name><type>loop</type></interface>
+      <interface><name>e2</name><type>eth</type></interface>
+      <interface><name>e3</name><type>loop</type></interface>
+      <interface><name>e4</name><type>eth</type></interface>
+   </interfaces>
+</${DATASTORE_TOP}>
+EOF
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+XPATH="/ex:interfaces/ex:interface[ex:type='eth']"
+FILTER="<filter type=\"xpath\" select=\"$XPATH\" xmlns:ex=\"urn:example:clixon\"/>"
+
+for (( i=0; i<=$threshold; i++ )); do
+    new "get-config type=eth lookup $i"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source>$FILTER</get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><interfaces xmlns=\"urn:example:clixon\"><interface><name>e0</name><type>eth</type></interface><interface><name>e2</name><type>eth</type></interface><interface><name>e4</name><type>eth</type></interface></interfaces></data></rpc-reply>"
+done
+
+new "get-config type=none no match"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"/ex:interfaces/ex:interface[ex:type='none']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data/></rpc-reply>"
+
+new "stats xpath-index"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><stats $LIBNS/></rpc>" "" "<xpath-index $LIBNS><hits>2</hits><misses>3</misses><indexes>1</indexes></xpath-index>"
+
+new "change type of e1 to eth"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:clixon\"><interface><name>e1</name><type>eth</type></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "change type of e2 to loop"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:clixon\"><interface><name>e2</name><type>loop</type></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "add e5 with type eth"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:clixon\"><interface><name>e5</name><type>eth</type><mtu>1500</mtu></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "delete e0"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><interface nc:operation=\"delete\"><name>e0</name></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+new "delete type of e4"
+expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><edit-config><target><candidate/></target><config><interfaces xmlns=\"urn:example:clixon\" xmlns:nc=\"urn:ietf:params:xml:ns:netconf:base:1.0\"><interface><name>e4</name><type nc:operation=\"delete\"/></interface></interfaces></config></edit-config></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+
+for db in candidate running; do
+    if [ $db = running ]; then
+        new "commit"
+        expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><commit/></rpc>" "" "<rpc-reply $DEFAULTNS><ok/></rpc-reply>"
+    fi
+    new "get-config $db type=eth after edits"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><$db/></source>$FILTER</get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><interfaces xmlns=\"urn:example:clixon\"><interface><name>e1</name><type>eth</type></interface><interface><name>e5</name><type>eth</type><mtu>1500</mtu></interface></interfaces></data></rpc-reply>"
+
+    new "get-config $db type=loop after edits"
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><$db/></source><filter type=\"xpath\" select=\"/ex:interfaces/ex:interface[ex:type='loop']\" xmlns:ex=\"urn:example:clixon\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS><data><interfaces xmlns=\"urn:example:clixon\"><interface><name>e2</name><type>loop</type></interface><interface><name>e3</name><type>loop</type></interface></interfaces></data></rpc-reply>"
+done
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
@@ -0,0 +1,211 @@
+#!/usr/bin/env bash
+# XPath list optimization and xpath cache
+# See XPATH_LIST_OPTIMIZE and XPATH_CACHE_SIZE
+# 1. Multi-key list nested in another list with keys in any order
+# 2. Keys given with "and", and with extra non-key predicates
+# 3. Leaf-list value, literal first, numbers
+# 4. Non-equality predicates that fall back to linear scan
+# 5. Numbers compared with non-canonical keys, eg [id=1] matches "01" and "1.0"
+# 6. Names with prefix of another namespace are not searched
+# 7. Check hit counters in stats rpc
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+APPNAME=example
+
+cfg=$dir/conf_yang.xml
+fyang=$dir/example.yang
+
+cat <<EOF > $cfg
+<clixon-config xmlns="http://clicon.org/config">
+  <CLICON_CONFIGFILE>$cfg</CLICON_CONFIGFILE>
+  <CLICON_YANG_DIR>${YANG_INSTALLDIR}</CLICON_YANG_DIR>
+  <CLICON_YANG_MAIN_FILE>$fyang</CLICON_YANG_MAIN_FILE>
+  <CLICON_SOCK>/usr/local/var/run/$APPNAME.sock</CLICON_SOCK>
+  <CLICON_BACKEND_PIDFILE>/usr/local/var/run/$APPNAME.pidfile</CLICON_BACKEND_PIDFILE>
+  <CLICON_XMLDB_DIR>$dir</CLICON_XMLDB_DIR>
+</clixon-config>
+EOF
+
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    container c{
+        list a{
+            key name;
+            leaf name{
+                type string;
+            }
+            list b{
+                key "k1 k2";
+                leaf k1{
+                    type uint32;
+                }
+                leaf k2{
+                    type uint32;
+                }
+                leaf v{
+                    type string;
+                }
+            }
+        }
+        leaf-list ll{
+            type string;
+        }
+        list s{
+            key id;
+            leaf id{
+                type string;
+            }
+        }
+        leaf-list nl{
+            type int32;
+        }
+    }
+}
+EOF
+
+cat <<EOF > $dir/startup_db
+<${DATASTORE_TOP}>
+   <c xmlns="urn:example:clixon">
+      <a><name>x</name>
+         <b><k1>1</k1><k2>1</k2><v>v11</v></b>
+         <b><k1>1</k1><k2>2</k2><v>v12</v></b>
+         <b><k1>2</k1><k2>1</k2><v>v21</v></b>
+      </a>
+      <a><name>y</name>
+         <b><k1>1</k1><k2>2</k2><v>w12</v></b>
+         <b><k1>3</k1><k2>3</k2><v>w33</v></b>
+      </a>
+      <ll>a</ll>
+      <ll>b</ll>
+      <ll>c</ll>
+      <s><id>01</id></s>
+      <s><id>1.0</id></s>
+      <s><id>2</id></s>
+      <nl>1</nl>
+      <nl>5</nl>
+   </c>
+</${DATASTORE_TOP}>
+EOF
+
+# Get-config from running with xpath filter
+# 1: xpath
+# 2: expected data, or empty
+function testrun()
+{
+    xpath=$1
+    data=$2
+
+    if [ -z "$data" ]; then
+        reply="<data/>"
+    else
+        reply="<data>$data</data>"
+    fi
+    expecteof_netconf "$clixon_netconf -qf $cfg" 0 "$DEFAULTHELLO" "<rpc $DEFAULTNS><get-config><source><running/></source><filter type=\"xpath\" select=\"$xpath\" xmlns:ex=\"urn:example:clixon\" xmlns:ex2=\"urn:example:other\"/></get-config></rpc>" "" "<rpc-reply $DEFAULTNS>$reply</rpc-reply>"
+}
+
+new "test params: -f $cfg"
+
+if [ $BE -ne 0 ]; then
+    new "kill old backend"
+    sudo clixon_backend -zf $cfg
+    if [ $? -ne 0 ]; then
+        err
+    fi
+    new "start backend -s startup -f $cfg"
+    start_backend -s startup -f $cfg
+fi
+
+new "wait backend"
+wait_backend
+
+new "nested multi-key list, keys in reverse order"
+testrun "/ex:c/ex:a[ex:name='x']/ex:b[ex:k2='2'][ex:k1='1']" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>1</k1><k2>2</k2><v>v12</v></b></a></c>"
+
+new "nested multi-key list again"
+testrun "/ex:c/ex:a[ex:name='x']/ex:b[ex:k2='2'][ex:k1='1']" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>1</k1><k2>2</k2><v>v12</v></b></a></c>"
+
+new "keys with and, in all outer list entries"
+testrun "/ex:c/ex:a/ex:b[ex:k1='1' and ex:k2='2']" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>1</k1><k2>2</k2><v>v12</v></b></a><a><name>y</name><b><k1>1</k1><k2>2</k2><v>w12</v></b></a></c>"
+
+new "keys and non-key leaf"
+testrun "/ex:c/ex:a/ex:b[ex:k1='1'][ex:k2='2'][ex:v='w12']" "<c xmlns=\"urn:example:clixon\"><a><name>y</name><b><k1>1</k1><k2>2</k2><v>w12</v></b></a></c>"
+
+new "literal first and numbers"
+testrun "/ex:c/ex:a['x'=ex:name]/ex:b[ex:k1=2][ex:k2=1]" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>2</k1><k2>1</k2><v>v21</v></b></a></c>"
+
+new "leaf-list value"
+testrun "/ex:c/ex:ll[.='b']" "<c xmlns=\"urn:example:clixon\"><ll>b</ll></c>"
+
+new "number and string key, numeric compare matches non-canonical values"
+testrun "/ex:c/ex:s[ex:id=1]" "<c xmlns=\"urn:example:clixon\"><s><id>01</id></s><s><id>1.0</id></s></c>"
+
+new "number and string key, literal first"
+testrun "/ex:c/ex:s[2=ex:id]" "<c xmlns=\"urn:example:clixon\"><s><id>2</id></s></c>"
+
+new "string literal and string key, no numeric compare"
+testrun "/ex:c/ex:s[ex:id='1']" ""
+
+new "non-integer number and integer keys"
+testrun "/ex:c/ex:a[ex:name='x']/ex:b[ex:k1=1.0][ex:k2=2.0]" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>1</k1><k2>2</k2><v>v12</v></b></a></c>"
+
+new "non-integer number and integer leaf-list"
+testrun "/ex:c/ex:nl[.=5.0]" "<c xmlns=\"urn:example:clixon\"><nl>5</nl></c>"
+
+new "negative number and unsigned keys, no match"
+testrun "/ex:c/ex:a[ex:name='x']/ex:b[ex:k1=-1][ex:k2=1]" ""
+
+new "no match"
+testrun "/ex:c/ex:a[ex:name='x']/ex:b[ex:k1='3'][ex:k2='3']" ""
+
+new "or is not optimized"
+testrun "/ex:c/ex:a/ex:b[ex:k1='3' or ex:k2='1']" "<c xmlns=\"urn:example:clixon\"><a><name>x</name><b><k1>1</k1><k2>1</k2><v>v11</v></b><b><k1>2</k1><k2>1</k2><v>v21</v></b></a><a><name>y</name><b><k1>3</k1><k2>3</k2><v>w33</v></b></a></c>"
+
+new "position is not optimized"
+testrun "/ex:c/ex:a[ex:name='y']/ex:b[2]" "<c xmlns=\"urn:example:clixon\"><a><name>y</name><b><k1>3</k1><k2>3</k2><v>w33</v></b></a></c>"
+
+new "list of other namespace, no match"
+testrun "/ex:c/ex2:s[ex:id='2']" ""
+
+new "key of other namespace, no match"
+testrun "/ex:c/ex:s[ex2:id='2']" ""
+
+new "stats"
+rpc=$(chunked_framing "<rpc $DEFAULTNS><stats $LIBNS/></rpc>")
+ret=$($clixon_netconf -qf $cfg<<EOF
+$DEFAULTHELLO$rpc
+EOF
+   )
+
+new "stats xpath-optimize hits and misses"
+expect="<xpath-optimize $LIBNS><hits>[1-9][0-9]*</hits><misses>[1-9][0-9]*</misses></xpath-optimize>"
+match=$(echo "$ret" | grep --null -Go "$expect")
+if [ -z "$match" ]; then
+    err "$expect" "$ret"
+fi
+
+new "stats xpath-cache hits"
+expect="<xpath-cache $LIBNS><hits>[1-9][0-9]*</hits><misses>[1-9][0-9]*</misses><entries>[1-9][0-9]*</entries></xpath-cache>"
+match=$(echo "$ret" | grep --null -Go "$expect")
+if [ -z "$match" ]; then
+    err "$expect" "$ret"
+fi
+
+if [ $BE -ne 0 ]; then
+    new "Kill backend"
+    # Check if premature kill
+    pid=$(pgrep -u root -f clixon_backend)
+    if [ -z "$pid" ]; then
+        err "backend already dead"
+    fi
+    stop_backend -f $cfg
+fi
+
+rm -rf $dir
+
+new "endtest"
+endtest
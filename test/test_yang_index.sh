@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+# YANG child index, see YANG_CHILD_INDEX
+# Children of a container with many children are looked up using a sorted index
+# Check that lookups find children added or modified after parsing:
+# - leafs expanded from a uses with refine
+# - leafs added by augment
+# - a refine that makes a leaf mandatory
+
+# Magic line must be first in script (see README.md)
+s="$_" ; . ./lib.sh || if [ "$s" = $0 ]; then exit 0; else return 0; fi
+
+: ${clixon_util_xml:="clixon_util_xml -D $DBG"}
+
+# Number of leafs in container, larger than YANG_CHILD_INDEX
+: ${nr:=40}
+
+fyang=$dir/example.yang
+
+new "generate yang with $nr leafs"
+cat <<EOF > $fyang
+module example {
+    yang-version 1.1;
+    namespace "urn:example:clixon";
+    prefix ex;
+    grouping g {
+        leaf r {
+            type string;
+        }
+        leaf s {
+            type string;
+        }
+    }
+    container x {
+EOF
+for (( i=0; i<$nr; i++ )); do
+    echo "        leaf l$i {" >> $fyang
+    echo "            type int32;" >> $fyang
+    echo "        }" >> $fyang
+done
+cat <<EOF >> $fyang
+        uses g {
+            refine r {
+                mandatory true;
+            }
+            refine s {
+                description "Refined";
+            }
+        }
+    }
+    augment "/ex:x" {
+        leaf w {
+            type string;
+        }
+        container v {
+            leaf u {
+                type string;
+            }
+        }
+    }
+}
+EOF
+
+XML="<x xmlns=\"urn:example:clixon\"><l0>0</l0><l$((nr-1))>$((nr-1))</l$((nr-1))><r>r</r><s>s</s><w>w</w><v><u>u</u></v></x>"
+
+new "first, last, uses and augmented leafs"
+expecteof "$clixon_util_xml -y $fyang -vo" 0 "$XML" "^$XML$"
+
+new "augmented leaf only, refined mandatory leaf missing, fail"
+expecteof "$clixon_util_xml -y $fyang -vo" 255 "<x xmlns=\"urn:example:clixon\"><w>w</w></x>" 2> /dev/null
+
+new "refined mandatory leaf and augmented leaf"
+expecteof "$clixon_util_xml -y $fyang -vo" 0 "<x xmlns=\"urn:example:clixon\"><r>r</r><w>w</w></x>" "^<x xmlns=\"urn:example:clixon\"><r>r</r><w>w</w></x>$"
+
+new "unknown leaf, fail"
+expecteof "$clixon_util_xml -y $fyang -vo" 255 "<x xmlns=\"urn:example:clixon\"><r>r</r><l$nr>0</l$nr></x>" 2> /dev/null
+
+rm -rf $dir
+
+new "endtest"
+endtest